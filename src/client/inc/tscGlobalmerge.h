@@ -29,13 +29,15 @@ extern "C" {
 #define MAX_NUM_OF_SUBQUERY_RETRY 3
   
 struct SQLFunctionCtx;
+struct SMergePartition;
 
 typedef struct SLocalDataSource {
-  tExtMemBuffer *pMemBuffer;
-  int32_t        flushoutIdx;
-  int32_t        pageId;
-  int32_t        rowIdx;
-  tFilePage      filePage;
+  tExtMemBuffer          *pMemBuffer;
+  struct SMergePartition *pPartition;  // the merged rows of a partition of the sources, or NULL for a flushout
+  int32_t                 flushoutIdx;
+  int32_t                 pageId;
+  int32_t                 rowIdx;
+  tFilePage               filePage;
 } SLocalDataSource;
 
 typedef struct SGlobalMerger {
@@ -48,6 +50,8 @@ typedef struct SGlobalMerger {
   tOrderDescriptor      *pDesc;
   tExtMemBuffer        **pExtMemBuffer;    // disk-based buffer
   char                  *buf;              // temp buffer
+  struct SMergePartition *pPartitions;     // the partitions merged by the merge pool, one source for each
+  int32_t                numOfPartitions;
 } SGlobalMerger;
 
 struct SSqlObj;
@@ -79,6 +83,10 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
 
 void tscDestroyGlobalMerger(SGlobalMerger* pMerger);
 
+int32_t tscInitGlobalMergePool();
+
+void tscCleanupGlobalMergePool();
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,6 +81,28 @@ int32_t convertSmlTimeStamp(TAOS_SML_KV *pVal, char *value,
 
 void destroySmlDataPoint(TAOS_SML_DATA_POINT* point);
 
+typedef struct {
+  int32_t table;  // index of the child table in the child tables of the super table
+  int32_t row;    // index of the point in the points of the child table
+} SSmlBatchPos;
+
+// Split the points of the child tables of a super table, SArray<SArray<TAOS_SML_DATA_POINT*>*>, into the batches
+// inserted by one stmt execution each. A batch takes tableSize bytes for each child table and rowSize bytes for each
+// row, and is at most maxBatchBytes unless a single row is larger. The end (exclusive) of each batch is pushed into
+// ends, a child table may be split across two batches. Return the number of batches.
+int32_t smlSplitBatches(SArray* cTables, int32_t tableSize, int32_t rowSize, int32_t maxBatchBytes, SArray* ends);
+
+// Insert a batch by one try, set the rows accepted by the vgroups of the batch into affectedRows
+typedef int32_t (*__sml_insert_batch_fn_t)(void* param, int32_t attempt, int32_t* affectedRows);
+
+// Insert a batch by fp, and try again on the errors of the vgroups not ready or the table meta outdated. Only the rows
+// accepted by the last try are added into the affected rows of info.
+int32_t smlInsertBatchWithRetry(TAOS* taos, __sml_insert_batch_fn_t fp, void* param, SSmlLinesInfo* info);
+int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info);
+
+int32_t tscInitSmlParsePool();
+void    tscCleanupSmlParsePool();
+
 int taos_insert_lines(TAOS* taos, char* lines[], int numLines, SMLProtocolType protocol,
                       SMLTimeStampType tsType, int* affectedRows);
 int taos_insert_telnet_lines(TAOS* taos, char* lines[], int numLines, SMLProtocolType protocol,
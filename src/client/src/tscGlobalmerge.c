@@ -16,6 +16,7 @@
 #include "os.h"
 #include "texpr.h"
 #include "tlosertree.h"
+#include "tsched.h"
 
 #include "tscGlobalmerge.h"
 #include "tscSubquery.h"
@@ -26,6 +27,10 @@
   (data + (schema)->pFields[colId].offset * ((schema)->capacity) + (rowId) * (schema)->pFields[colId].field.bytes)
 
 
+#define GLOBAL_MERGE_QUEUE_SIZE            1024
+#define GLOBAL_MERGE_MIN_SOURCES_PER_PART  4
+#define GLOBAL_MERGE_PAGES_PER_FILL        16
+
 typedef struct SCompareParam {
   SLocalDataSource **pLocalData;
   tOrderDescriptor * pDesc;
@@ -33,6 +38,36 @@ typedef struct SCompareParam {
   int32_t            groupOrderType;
 } SCompareParam;
 
+// the pages of merged rows produced by one task of the merge pool
+typedef struct SMergeFill {
+  char   *pages;
+  int32_t numOfPages;
+} SMergeFill;
+
+/*
+ * A partition of the sources merged by the merge pool. The final merge reads the pages of one fill while the next
+ * fill is merged, and each partition is a single source of the final merge.
+ */
+typedef struct SMergePartition {
+  SGlobalMerger merger;     // the sources of the partition and their loser tree
+  SMergeFill    fill[2];
+  int32_t       readFill;   // the fill read by the final merge
+  int32_t       readPage;   // the next page of the fill to be read
+  int32_t       pageSize;
+  bool          pending;    // the other fill is being merged
+  bool          completed;  // all rows of the sources are merged
+  tsem_t        ready;      // posted when a fill is merged
+  int64_t       mergeTime;  // spent by the merge pool
+} SMergePartition;
+
+static void *tscGlobalMergeQhandle = NULL;
+
+static int32_t tscCreateMergeLoserTree(SGlobalMerger *pMerger, int32_t groupOrderType);
+static int32_t tscCreateMergePartitions(SGlobalMerger *pMerger, int32_t groupOrderType, int64_t id);
+static void    tscDestroyMergePartitions(SGlobalMerger *pMerger);
+static bool    tscLoadMergedPage(SLocalDataSource *pOneDataSrc);
+static bool    isAllSourcesCompleted(SGlobalMerger *pMerger);
+
 static bool needToMerge(SSDataBlock* pBlock, SArray* columnIndexList, int32_t index, char **buf) {
   int32_t ret = 0;
 
@@ -143,6 +178,7 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
       (*pMerger)->pLocalDataSrc[idx] = ds;
 
       ds->pMemBuffer = pMemBuffer[i];
+      ds->pPartition = NULL;
       ds->flushoutIdx = j;
       ds->filePage.num = 0;
       ds->pageId = 0;
@@ -180,21 +216,15 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
 
   (*pMerger)->numOfBuffer = idx;
 
-  SCompareParam *param = malloc(sizeof(SCompareParam));
-  if (param == NULL) {
-    tfree((*pMerger));
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  // the sources are merged by partitions in the merge pool, and the final merge is of the partitions
+  if (tscCreateMergePartitions(*pMerger, pQueryInfo->groupbyExpr.orderType, id) != TSDB_CODE_SUCCESS) {
+    tscDebug("0x%"PRIx64" failed to create the merge partitions, the %d sources are merged by the fetching thread",
+             id, (*pMerger)->numOfBuffer);
   }
 
-  param->pLocalData = (*pMerger)->pLocalDataSrc;
-  param->pDesc = (*pMerger)->pDesc;
-  param->num = (*pMerger)->pLocalDataSrc[0]->pMemBuffer->numOfElemsPerPage;
-
-  param->groupOrderType = pQueryInfo->groupbyExpr.orderType;
-
-  int32_t code = tLoserTreeCreate(&(*pMerger)->pLoserTree, (*pMerger)->numOfBuffer, param, treeComparator);
-  if ((*pMerger)->pLoserTree == NULL || code != TSDB_CODE_SUCCESS) {
-    tfree(param);
+  int32_t code = tscCreateMergeLoserTree(*pMerger, pQueryInfo->groupbyExpr.orderType);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscDestroyMergePartitions(*pMerger);
     tfree((*pMerger));
     return code;
   }
@@ -204,13 +234,6 @@ int32_t tscCreateGlobalMerger(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, t
   // todo fixed row size is larger than the minimum page size;
   assert((*pMerger)->rowSize <= pMemBuffer[0]->pageSize);
 
-  if ((*pMerger)->pLoserTree == NULL) {
-    tfree((*pMerger)->pLoserTree);
-    tfree(param);
-    tfree((*pMerger));
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
-
   // restore the limitation value at the last stage
   if (pQueryInfo->orderProjectQuery) {
     pQueryInfo->limit.limit = pQueryInfo->clauseLimit;
@@ -316,6 +339,9 @@ void tscDestroyGlobalMerger(SGlobalMerger* pMerger) {
     return;
   }
 
+  // wait for the merge pool before the buffers are destroyed
+  tscDestroyMergePartitions(pMerger);
+
   for (int32_t i = 0; i < pMerger->numOfBuffer; ++i) {
     tfree(pMerger->pLocalDataSrc[i]);
   }
@@ -503,11 +529,17 @@ int32_t loadNewDataFromDiskFor(SGlobalMerger *pMerger, SLocalDataSource *pOneInt
   pOneInterDataSrc->rowIdx = 0;
   pOneInterDataSrc->pageId += 1;
 
-  if ((uint32_t)pOneInterDataSrc->pageId <
+  bool loaded = false;
+  if (pOneInterDataSrc->pPartition != NULL) {
+    loaded = tscLoadMergedPage(pOneInterDataSrc);
+  } else if ((uint32_t)pOneInterDataSrc->pageId <
       pOneInterDataSrc->pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pOneInterDataSrc->flushoutIdx].numOfPages) {
     tExtMemBufferLoadData(pOneInterDataSrc->pMemBuffer, &(pOneInterDataSrc->filePage), pOneInterDataSrc->flushoutIdx,
                           pOneInterDataSrc->pageId);
+    loaded = true;
+  }
 
+  if (loaded) {
 #if defined(_DEBUG_VIEW)
     printf("new page load to buffer\n");
     tColModelDisplay(pOneInterDataSrc->pMemBuffer->pColumnModel, pOneInterDataSrc->filePage.data,
@@ -702,6 +734,259 @@ static bool isAllSourcesCompleted(SGlobalMerger *pMerger) {
   return (pMerger->numOfBuffer == pMerger->numOfCompleted);
 }
 
+static int32_t tscCreateMergeLoserTree(SGlobalMerger *pMerger, int32_t groupOrderType) {
+  SCompareParam *param = malloc(sizeof(SCompareParam));
+  if (param == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  param->pLocalData = pMerger->pLocalDataSrc;
+  param->pDesc = pMerger->pDesc;
+  param->num = pMerger->pLocalDataSrc[0]->pMemBuffer->numOfElemsPerPage;
+
+  param->groupOrderType = groupOrderType;
+
+  int32_t code = tLoserTreeCreate(&pMerger->pLoserTree, pMerger->numOfBuffer, param, treeComparator);
+  if (pMerger->pLoserTree == NULL || code != TSDB_CODE_SUCCESS) {
+    tfree(param);
+    return code;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t tscInitGlobalMergePool() {
+  if (tsGlobalMergeThreads <= 0) return 0;
+
+  tscGlobalMergeQhandle = taosInitScheduler(GLOBAL_MERGE_QUEUE_SIZE, tsGlobalMergeThreads, "tscGlobalMerge");
+  if (tscGlobalMergeQhandle == NULL) {
+    return -1;
+  }
+
+  return 0;
+}
+
+void tscCleanupGlobalMergePool() {
+  void* p = tscGlobalMergeQhandle;
+  tscGlobalMergeQhandle = NULL;
+  if (p != NULL) {
+    taosCleanUpScheduler(p);
+  }
+}
+
+static void appendOneRowToPage(tFilePage *pPage, SLocalDataSource *pOneDataSrc) {
+  SColumnModel *pModel = pOneDataSrc->pMemBuffer->pColumnModel;
+
+  for (int32_t i = 0; i < pModel->numOfCols; ++i) {
+    char *dst = COLMODEL_GET_VAL(pPage->data, pModel, pPage->num, i);
+    char *src = COLMODEL_GET_VAL(pOneDataSrc->filePage.data, pModel, pOneDataSrc->rowIdx, i);
+    memcpy(dst, src, pModel->pFields[i].field.bytes);
+  }
+
+  pPage->num += 1;
+}
+
+// merge the sources of the partition into the pages of a fill, the pages have the layout of the pages of the sources
+static void tscMergePartitionFp(SSchedMsg *pMsg) {
+  SMergePartition *pPart = (SMergePartition *)pMsg->ahandle;
+  SMergeFill      *pFill = (SMergeFill *)pMsg->thandle;
+  SGlobalMerger   *pMerger = &pPart->merger;
+  SLoserTreeInfo  *pTree = pMerger->pLoserTree;
+  int32_t          capacity = pMerger->pLocalDataSrc[0]->pMemBuffer->numOfElemsPerPage;
+  int64_t          st = taosGetTimestampUs();
+
+  pFill->numOfPages = 0;
+  while (pFill->numOfPages < GLOBAL_MERGE_PAGES_PER_FILL && !isAllSourcesCompleted(pMerger)) {
+    tFilePage *pPage = (tFilePage *)(pFill->pages + (size_t)pFill->numOfPages * pPart->pageSize);
+    pPage->num = 0;
+
+    while (pPage->num < capacity && !isAllSourcesCompleted(pMerger)) {
+      SLocalDataSource *pOneDataSrc = pMerger->pLocalDataSrc[pTree->pNode[0].index];
+      appendOneRowToPage(pPage, pOneDataSrc);
+
+      pOneDataSrc->rowIdx += 1;
+      adjustLoserTreeFromNewData(pMerger, pOneDataSrc, pTree);
+    }
+
+    pFill->numOfPages += 1;
+  }
+
+  pPart->completed = isAllSourcesCompleted(pMerger);
+  pPart->mergeTime += (taosGetTimestampUs() - st);
+  tsem_post(&pPart->ready);
+}
+
+static void tscScheduleMergeFill(SMergePartition *pPart, int32_t fillIdx) {
+  SSchedMsg msg = {0};
+  msg.fp = tscMergePartitionFp;
+  msg.ahandle = pPart;
+  msg.thandle = &pPart->fill[fillIdx];
+
+  pPart->pending = true;
+  taosScheduleTask(tscGlobalMergeQhandle, &msg);
+}
+
+/*
+ * Copy the next merged page of the partition into the source, and start to merge the next fill once the final merge
+ * moves to the fill merged in advance. Return false if all rows of the partition have been read.
+ */
+static bool tscLoadMergedPage(SLocalDataSource *pOneDataSrc) {
+  SMergePartition *pPart = pOneDataSrc->pPartition;
+
+  if (pPart->readPage >= pPart->fill[pPart->readFill].numOfPages) {
+    if (!pPart->pending) {
+      return false;
+    }
+
+    tsem_wait(&pPart->ready);
+    pPart->pending = false;
+    pPart->readFill ^= 1;
+    pPart->readPage = 0;
+
+    if (pPart->fill[pPart->readFill].numOfPages == 0) {
+      return false;
+    }
+
+    if (!pPart->completed) {
+      tscScheduleMergeFill(pPart, pPart->readFill ^ 1);
+    }
+  }
+
+  memcpy(&pOneDataSrc->filePage, pPart->fill[pPart->readFill].pages + (size_t)pPart->readPage * pPart->pageSize,
+         pPart->pageSize);
+  pPart->readPage += 1;
+  return true;
+}
+
+// the sources of the partition are not released, as they are owned by the merger until the partitions are created
+static void tscFreeMergePartition(SMergePartition *pPart) {
+  if (pPart->merger.pLoserTree != NULL) {
+    tfree(pPart->merger.pLoserTree->param);
+    tfree(pPart->merger.pLoserTree);
+  }
+
+  tfree(pPart->merger.pLocalDataSrc);
+  tfree(pPart->fill[0].pages);
+  tfree(pPart->fill[1].pages);
+}
+
+/*
+ * Split the sources into runs of adjacent sources, which are merged by the merge pool, so the final merge in the
+ * fetching thread is of one source for each partition, and the pages of the sources are read by the merge pool ahead
+ * of the final merge. The rows are merged by the same comparator at both levels, so the order of the result is kept.
+ */
+static int32_t tscCreateMergePartitions(SGlobalMerger *pMerger, int32_t groupOrderType, int64_t id) {
+  int32_t numOfPartitions = MIN(tsGlobalMergeThreads, pMerger->numOfBuffer / GLOBAL_MERGE_MIN_SOURCES_PER_PART);
+  if (tscGlobalMergeQhandle == NULL || numOfPartitions <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t            pageSize = pMerger->pLocalDataSrc[0]->pMemBuffer->pageSize;
+  SMergePartition   *pPartitions = calloc(numOfPartitions, sizeof(SMergePartition));
+  SLocalDataSource **pLocalDataSrc = calloc(numOfPartitions, POINTER_BYTES);
+  if (pPartitions == NULL || pLocalDataSrc == NULL) {
+    goto _err;
+  }
+
+  int32_t start = 0;
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    SMergePartition *pPart = &pPartitions[i];
+    SGlobalMerger   *pSub = &pPart->merger;
+    int32_t          num = pMerger->numOfBuffer / numOfPartitions + ((i < pMerger->numOfBuffer % numOfPartitions) ? 1 : 0);
+
+    pSub->pLocalDataSrc = calloc(num, POINTER_BYTES);
+    pPart->fill[0].pages = malloc((size_t)pageSize * GLOBAL_MERGE_PAGES_PER_FILL);
+    pPart->fill[1].pages = malloc((size_t)pageSize * GLOBAL_MERGE_PAGES_PER_FILL);
+    pLocalDataSrc[i] = malloc(sizeof(SLocalDataSource) + pageSize);
+    if (pSub->pLocalDataSrc == NULL || pPart->fill[0].pages == NULL || pPart->fill[1].pages == NULL ||
+        pLocalDataSrc[i] == NULL) {
+      goto _err;
+    }
+
+    memcpy(pSub->pLocalDataSrc, pMerger->pLocalDataSrc + start, num * POINTER_BYTES);
+    pSub->numOfBuffer = num;
+    pSub->pDesc = pMerger->pDesc;
+    if (tscCreateMergeLoserTree(pSub, groupOrderType) != TSDB_CODE_SUCCESS) {
+      goto _err;
+    }
+
+    pPart->pageSize = pageSize;
+    pPart->readFill = 1;
+    start += num;
+  }
+
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    SMergePartition  *pPart = &pPartitions[i];
+    SLocalDataSource *ds = pLocalDataSrc[i];
+
+    ds->pMemBuffer = pPart->merger.pLocalDataSrc[0]->pMemBuffer;
+    ds->pPartition = pPart;
+    ds->flushoutIdx = -1;
+    ds->pageId = 0;
+    ds->rowIdx = 0;
+    ds->filePage.num = 0;
+
+    tsem_init(&pPart->ready, 0, 0);
+    tscScheduleMergeFill(pPart, 0);
+  }
+
+  // each partition has rows, so the first fill is not empty
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    tscLoadMergedPage(pLocalDataSrc[i]);
+  }
+
+  tscDebug("0x%"PRIx64" %d sources are merged by %d partitions in the merge pool", id, pMerger->numOfBuffer,
+           numOfPartitions);
+
+  tfree(pMerger->pLocalDataSrc);
+  pMerger->pLocalDataSrc = pLocalDataSrc;
+  pMerger->numOfBuffer = numOfPartitions;
+  pMerger->pPartitions = pPartitions;
+  pMerger->numOfPartitions = numOfPartitions;
+  return TSDB_CODE_SUCCESS;
+
+_err:
+  for (int32_t i = 0; pPartitions != NULL && i < numOfPartitions; ++i) {
+    tscFreeMergePartition(&pPartitions[i]);
+  }
+
+  for (int32_t i = 0; pLocalDataSrc != NULL && i < numOfPartitions; ++i) {
+    tfree(pLocalDataSrc[i]);
+  }
+
+  tfree(pPartitions);
+  tfree(pLocalDataSrc);
+  return TSDB_CODE_TSC_OUT_OF_MEMORY;
+}
+
+static void tscDestroyMergePartitions(SGlobalMerger *pMerger) {
+  if (pMerger->pPartitions == NULL) {
+    return;
+  }
+
+  int64_t mergeTime = 0;
+  for (int32_t i = 0; i < pMerger->numOfPartitions; ++i) {
+    SMergePartition *pPart = &pMerger->pPartitions[i];
+    if (pPart->pending) {
+      tsem_wait(&pPart->ready);
+    }
+
+    tsem_destroy(&pPart->ready);
+    mergeTime += pPart->mergeTime;
+
+    for (int32_t j = 0; j < pPart->merger.numOfBuffer; ++j) {
+      tfree(pPart->merger.pLocalDataSrc[j]);
+    }
+    tscFreeMergePartition(pPart);
+  }
+
+  tscDebug("%p %d partitions are merged by the merge pool in %" PRId64 " us", pMerger, pMerger->numOfPartitions,
+           mergeTime);
+
+  tfree(pMerger->pPartitions);
+  pMerger->numOfPartitions = 0;
+}
+
 SGlobalMerger* tscInitResObjForLocalQuery(int32_t numOfRes, int32_t rowLen, uint64_t id) {
   SGlobalMerger *pMerger = calloc(1, sizeof(SGlobalMerger));
   if (pMerger == NULL) {
@@ -778,7 +1063,7 @@ static void appendOneRowToDataBlock(SSDataBlock *pBlock, char *buf, SColumnModel
   pBlock->info.rows += 1;
 }
 
-SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup) {
+static SSDataBlock* doMultiwayMergeSortImpl(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
     return NULL;
@@ -872,6 +1157,19 @@ SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup) {
   return (pInfo->binfo.pRes->info.rows > 0)? pInfo->binfo.pRes:NULL;
 }
 
+// the time of the global merge, including the time waiting for the merge pool, is reported in the query cost summary
+SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup) {
+  SOperatorInfo* pOperator = (SOperatorInfo*) param;
+  int64_t        st = taosGetTimestampUs();
+
+  SSDataBlock* pBlock = doMultiwayMergeSortImpl(param, newgroup);
+
+  SQInfo* pQInfo = pOperator->pRuntimeEnv->qinfo;
+  pQInfo->summary.globalMergeTime += (taosGetTimestampUs() - st);
+
+  return pBlock;
+}
+
 static bool isSameGroup(SArray* orderColumnList, SSDataBlock* pBlock, char** dataCols) {
   int32_t numOfCols = (int32_t) taosArrayGetSize(orderColumnList);
   for (int32_t i = 0; i < numOfCols; ++i) {
@@ -11,6 +11,7 @@
 #include "tname.h"
 #include "hash.h"
 #include "tskiplist.h"
+#include "tsched.h"
 
 #include "tscUtil.h"
 #include "tsclient.h"
@@ -32,10 +33,26 @@ typedef struct  {
 
 static uint64_t linesSmlHandleId = 0;
 
-static int32_t insertChildTablePointsBatch(void* pVoid, char* name, char* name1, SArray* pArray, SArray* pArray1,
-                                           SArray* pArray2, SArray* pArray3, size_t size, SSmlLinesInfo* info);
-static int32_t doInsertChildTablePoints(void* pVoid, char* sql, char* name, SArray* pArray, SArray* pArray1,
-                                        SSmlLinesInfo* info);
+#define SML_PARSE_QUEUE_SIZE         1024
+#define SML_PARSE_MIN_LINES_PER_JOB  1024
+
+typedef struct {
+  int32_t nPending;
+  tsem_t  done;
+} SSmlParseCtx;
+
+typedef struct {
+  char**        lines;
+  int32_t       start;       // index of the first line of the job
+  int32_t       numLines;
+  SArray*       points;      // TAOS_SML_DATA_POINT of the lines
+  int32_t       code;        // error of the job, the first error in line order is returned after all jobs are done
+  int32_t       failedLine;  // index of the line failed
+  SSmlLinesInfo info;        // copy of the info of the call, the workers never share anything written
+} SSmlParseJob;
+
+static void* tscSmlParseQhandle = NULL;
+
 uint64_t genLinesSmlId() {
   uint64_t id;
 
@@ -792,56 +809,21 @@ static int32_t arrangePointsByChildTableName(TAOS_SML_DATA_POINT* points, int nu
   return 0;
 }
 
-static int32_t applyChildTableDataPointsWithInsertSQL(TAOS* taos, char* cTableName, char* sTableName, SSmlSTableSchema* sTableSchema,
-                                                  SArray* cTablePoints, size_t rowSize, SSmlLinesInfo* info) {
-  int32_t code = TSDB_CODE_SUCCESS;
-  size_t  numTags = taosArrayGetSize(sTableSchema->tags);
-  size_t  numCols = taosArrayGetSize(sTableSchema->fields);
-  size_t  rows = taosArrayGetSize(cTablePoints);
-  SArray* tagsSchema = sTableSchema->tags;
-  SArray* colsSchema = sTableSchema->fields;
-
-  TAOS_SML_KV* tagKVs[TSDB_MAX_TAGS] = {0};
-  for (int i = 0; i < rows; ++i) {
-    TAOS_SML_DATA_POINT* pDataPoint = taosArrayGetP(cTablePoints, i);
-    for (int j = 0; j < pDataPoint->tagNum; ++j) {
-      TAOS_SML_KV* kv = pDataPoint->tags + j;
-      tagKVs[kv->fieldSchemaIdx] = kv;
-    }
-  }
-
-  char* sql = malloc(tsMaxSQLStringLen + 1);
-  if (sql == NULL) {
-    tscError("malloc sql memory error");
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
-
-  int32_t freeBytes = tsMaxSQLStringLen + 1;
+static int32_t buildSmlInsertStmtSql(char* sql, int32_t freeBytes, char* sTableName, SArray* tagsSchema, SArray* colsSchema) {
+  size_t  numTags = taosArrayGetSize(tagsSchema);
+  size_t  numCols = taosArrayGetSize(colsSchema);
   int32_t totalLen = 0;
-  totalLen += sprintf(sql, "insert into %s using %s (", cTableName, sTableName);
+
+  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "insert into ? using %s (", sTableName);
   for (int i = 0; i < numTags; ++i) {
     SSchema* tagSchema = taosArrayGet(tagsSchema, i);
     totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "%s,", tagSchema->name);
   }
   --totalLen;
-  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ")");
-
-  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, " tags (");
+  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ") tags (");
 
-  //  for (int i = 0; i < numTags; ++i) {
-  //    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "?,");
-  //  }
   for (int i = 0; i < numTags; ++i) {
-    if (tagKVs[i] == NULL) {
-      totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "NULL,");
-    } else {
-      TAOS_SML_KV* kv = tagKVs[i];
-      size_t       beforeLen = totalLen;
-      int32_t      len = 0;
-      converToStr(sql + beforeLen, kv->type, kv->value, kv->length, &len);
-      totalLen += len;
-      totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ",");
-    }
+    totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "?,");
   }
   --totalLen;
   totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ") (");
@@ -851,305 +833,161 @@ static int32_t applyChildTableDataPointsWithInsertSQL(TAOS* taos, char* cTableNa
     totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "%s,", colSchema->name);
   }
   --totalLen;
-  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ") values ");
-
-  TAOS_SML_KV** colKVs = malloc(numCols * sizeof(TAOS_SML_KV*));
-  for (int r = 0; r < rows; ++r) {
-    totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "(");
+  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ") values (");
 
-    memset(colKVs, 0, numCols * sizeof(TAOS_SML_KV*));
-
-    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, r);
-    for (int i = 0; i < point->fieldNum; ++i) {
-      TAOS_SML_KV* kv = point->fields + i;
-      colKVs[kv->fieldSchemaIdx] = kv;
-    }
-
-    for (int i = 0; i < numCols; ++i) {
-      if (colKVs[i] == NULL) {
-        totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "NULL,");
-      } else {
-        TAOS_SML_KV* kv = colKVs[i];
-        size_t       beforeLen = totalLen;
-        int32_t      len = 0;
-        converToStr(sql + beforeLen, kv->type, kv->value, kv->length, &len);
-        totalLen += len;
-        totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ",");
-      }
-    }
-    --totalLen;
-    totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ")");
+  for (int i = 0; i < numCols; ++i) {
+    totalLen += snprintf(sql + totalLen, freeBytes - totalLen, "?,");
   }
-  free(colKVs);
-  sql[totalLen] = '\0';
-
-  tscDebug("SML:0x%" PRIx64 " insert child table table %s of super table %s sql: %s", info->id, cTableName, sTableName,
-           sql);
-
-  bool tryAgain = false;
-  int32_t try = 0;
-  do {
-    TAOS_RES* res = taos_query(taos, sql);
-    code = taos_errno(res);
-    if (code != 0) {
-      tscError("SML:0x%"PRIx64 " taos_query return %d:%s", info->id, code, taos_errstr(res));
-    }
-
-    tscDebug("SML:0x%"PRIx64 " taos_query inserted %d rows", info->id, taos_affected_rows(res));
-    info->affectedRows += taos_affected_rows(res);
-    taos_free_result(res);
-
-    tryAgain = false;
-    if ((code == TSDB_CODE_TDB_INVALID_TABLE_ID
-         || code == TSDB_CODE_VND_INVALID_VGROUP_ID
-         || code == TSDB_CODE_TDB_TABLE_RECONFIGURE
-         || code == TSDB_CODE_APP_NOT_READY
-         || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) && try++ < TSDB_MAX_REPLICA) {
-      tryAgain = true;
-    }
-
-    if (code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_VND_INVALID_VGROUP_ID) {
-      TAOS_RES* res2 = taos_query(taos, "RESET QUERY CACHE");
-      int32_t   code2 = taos_errno(res2);
-      if (code2 != TSDB_CODE_SUCCESS) {
-        tscError("SML:0x%" PRIx64 " insert child table by sql. reset query cache. error: %s", info->id, taos_errstr(res2));
-      }
-      taos_free_result(res2);
-      if (tryAgain) {
-        taosMsleep(100 * (2 << try));
-      }
-    }
-
-    if (code == TSDB_CODE_APP_NOT_READY || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) {
-      if (tryAgain) {
-        taosMsleep( 100 * (2 << try));
-      }
-    }
-  } while (tryAgain);
-
-  free(sql);
+  --totalLen;
+  totalLen += snprintf(sql + totalLen, freeBytes - totalLen, ")");
 
-  return code;
+  return totalLen;
 }
 
-static int32_t applyChildTableDataPointsWithStmt(TAOS* taos, char* cTableName, char* sTableName, SSmlSTableSchema* sTableSchema,
-                                         SArray* cTablePoints, size_t rowSize, SSmlLinesInfo* info) {
-  size_t numTags = taosArrayGetSize(sTableSchema->tags);
-  size_t numCols = taosArrayGetSize(sTableSchema->fields);
-  size_t rows = taosArrayGetSize(cTablePoints);
-
-  TAOS_SML_KV* tagKVs[TSDB_MAX_TAGS] = {0};
-  for (int i= 0; i < rows; ++i) {
-    TAOS_SML_DATA_POINT * pDataPoint = taosArrayGetP(cTablePoints, i);
-    for (int j = 0; j < pDataPoint->tagNum; ++j) {
-      TAOS_SML_KV* kv = pDataPoint->tags + j;
-      tagKVs[kv->fieldSchemaIdx] = kv;
-    }
-  }
-
-  //tag bind
-  SArray* tagBinds = taosArrayInit(numTags, sizeof(TAOS_BIND));
-  taosArraySetSize(tagBinds, numTags);
-  int isNullColBind = TSDB_TRUE;
-  for (int j = 0; j < numTags; ++j) {
-    TAOS_BIND* bind = taosArrayGet(tagBinds, j);
-    bind->is_null = &isNullColBind;
-  }
+// The binds point to the values of the kvs, and the stmt copies the values into the data block when they are bound
+static void bindSmlChildTableTags(TAOS_BIND* tagBinds, uintptr_t* lengths, size_t numTags, SArray* cTablePoints,
+                                  int* isNullBind) {
   for (int j = 0; j < numTags; ++j) {
-    if (tagKVs[j] == NULL) continue;
-    TAOS_SML_KV* kv =  tagKVs[j];
-    TAOS_BIND* bind = taosArrayGet(tagBinds, kv->fieldSchemaIdx);
-    bind->buffer_type = kv->type;
-    bind->length = malloc(sizeof(uintptr_t*));
-    *bind->length = kv->length;
-    bind->buffer = kv->value;
-    bind->is_null = NULL;
+    memset(tagBinds + j, 0, sizeof(TAOS_BIND));
+    tagBinds[j].is_null = isNullBind;
   }
 
-  //rows bind
-  SArray* rowsBind = taosArrayInit(rows, POINTER_BYTES);
+  size_t rows = taosArrayGetSize(cTablePoints);
   for (int i = 0; i < rows; ++i) {
-    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, i);
-
-    TAOS_BIND* colBinds = calloc(numCols, sizeof(TAOS_BIND));
-    if (colBinds == NULL) {
-      tscError("SML:0x%"PRIx64" taos_sml_insert insert points, failed to allocated memory for TAOS_BIND, "
-               "num of rows: %zu, num of cols: %zu", info->id, rows, numCols);
-      return TSDB_CODE_TSC_OUT_OF_MEMORY;
-    }
-
-    for (int j = 0; j < numCols; ++j) {
-      TAOS_BIND* bind = colBinds + j;
-      bind->is_null = &isNullColBind;
-    }
-    for (int j = 0; j < point->fieldNum; ++j) {
-      TAOS_SML_KV* kv = point->fields + j;
-      TAOS_BIND* bind = colBinds + kv->fieldSchemaIdx;
+    TAOS_SML_DATA_POINT* pDataPoint = taosArrayGetP(cTablePoints, i);
+    for (int j = 0; j < pDataPoint->tagNum; ++j) {
+      TAOS_SML_KV* kv = pDataPoint->tags + j;
+      TAOS_BIND*   bind = tagBinds + kv->fieldSchemaIdx;
       bind->buffer_type = kv->type;
-      bind->length = malloc(sizeof(uintptr_t*));
-      *bind->length = kv->length;
+      lengths[kv->fieldSchemaIdx] = kv->length;
+      bind->length = lengths + kv->fieldSchemaIdx;
       bind->buffer = kv->value;
       bind->is_null = NULL;
     }
-    taosArrayPush(rowsBind, &colBinds);
-  }
-
-  int32_t code = 0;
-  code = insertChildTablePointsBatch(taos, cTableName, sTableName, sTableSchema->tags, tagBinds, sTableSchema->fields, rowsBind, rowSize, info);
-  if (code != 0) {
-    tscError("SML:0x%"PRIx64" insert into child table %s failed. error %s", info->id, cTableName, tstrerror(code));
-  }
-
-  //free rows bind
-  for (int i = 0; i < rows; ++i) {
-    TAOS_BIND* colBinds = taosArrayGetP(rowsBind, i);
-    for (int j = 0; j < numCols; ++j) {
-      TAOS_BIND* bind = colBinds + j;
-      free(bind->length);
-    }
-    free(colBinds);
   }
-  taosArrayDestroy(&rowsBind);
-  //free tag bind
-  for (int i = 0; i < taosArrayGetSize(tagBinds); ++i) {
-    TAOS_BIND* bind = taosArrayGet(tagBinds, i);
-    free(bind->length);
-  }
-  taosArrayDestroy(&tagBinds);
-  return code;
 }
 
-static int32_t insertChildTablePointsBatch(TAOS* taos, char* cTableName, char* sTableName,
-                                           SArray* tagsSchema, SArray* tagsBind,
-                                           SArray* colsSchema, SArray* rowsBind,
-                                           size_t rowSize, SSmlLinesInfo* info) {
-  size_t numTags = taosArrayGetSize(tagsSchema);
-  size_t numCols = taosArrayGetSize(colsSchema);
-  char* sql = malloc(tsMaxSQLStringLen+1);
-  if (sql == NULL) {
-    tscError("malloc sql memory error");
-    return TSDB_CODE_TSC_OUT_OF_MEMORY;
-  }
-
-  int32_t freeBytes = tsMaxSQLStringLen + 1 ;
-  sprintf(sql, "insert into ? using %s (", sTableName);
-  for (int i = 0; i < numTags; ++i) {
-    SSchema* tagSchema = taosArrayGet(tagsSchema, i);
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "%s,", tagSchema->name);
-  }
-  snprintf(sql + strlen(sql) - 1, freeBytes-strlen(sql)+1, ")");
-
-  snprintf(sql + strlen(sql), freeBytes-strlen(sql), " tags (");
-
-  for (int i = 0; i < numTags; ++i) {
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "?,");
-  }
-  snprintf(sql + strlen(sql) - 1, freeBytes-strlen(sql)+1, ") (");
-
-  for (int i = 0; i < numCols; ++i) {
-    SSchema* colSchema = taosArrayGet(colsSchema, i);
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "%s,", colSchema->name);
-  }
-  snprintf(sql + strlen(sql)-1, freeBytes-strlen(sql)+1, ") values (");
-
-  for (int i = 0; i < numCols; ++i) {
-    snprintf(sql+strlen(sql), freeBytes-strlen(sql), "?,");
+static void bindSmlDataPointFields(TAOS_BIND* colBinds, uintptr_t* lengths, size_t numCols, TAOS_SML_DATA_POINT* point,
+                                   int* isNullBind) {
+  for (int j = 0; j < numCols; ++j) {
+    memset(colBinds + j, 0, sizeof(TAOS_BIND));
+    colBinds[j].is_null = isNullBind;
   }
-  snprintf(sql + strlen(sql)-1, freeBytes-strlen(sql)+1, ")");
-  sql[strlen(sql)] = '\0';
 
-  tscDebug("SML:0x%"PRIx64" insert child table table %s of super table %s : %s", info->id, cTableName, sTableName, sql);
-
-  size_t maxBatchSize = TSDB_MAX_WAL_SIZE/rowSize * 2 / 3;
-  size_t rows = taosArrayGetSize(rowsBind);
-  size_t batchSize = MIN(maxBatchSize, rows);
-  tscDebug("SML:0x%"PRIx64" insert rows into child table %s. num of rows: %zu, batch size: %zu",
-           info->id, cTableName, rows, batchSize);
-  SArray* batchBind = taosArrayInit(batchSize, POINTER_BYTES);
-  int32_t code = TSDB_CODE_SUCCESS;
-  for (int i = 0; i < rows;) {
-    int j = i;
-    for (; j < i + batchSize && j<rows; ++j) {
-      taosArrayPush(batchBind, taosArrayGet(rowsBind, j));
-    }
-    if (j > i) {
-      tscDebug("SML:0x%"PRIx64" insert child table batch from line %d to line %d.", info->id, i, j - 1);
-      code = doInsertChildTablePoints(taos, sql, cTableName, tagsBind, batchBind, info);
-      if (code != 0) {
-        taosArrayDestroy(&batchBind);
-        tfree(sql);
-        return code;
-      }
-      taosArrayClear(batchBind);
-    }
-    i = j;
+  for (int j = 0; j < point->fieldNum; ++j) {
+    TAOS_SML_KV* kv = point->fields + j;
+    TAOS_BIND*   bind = colBinds + kv->fieldSchemaIdx;
+    bind->buffer_type = kv->type;
+    lengths[kv->fieldSchemaIdx] = kv->length;
+    bind->length = lengths + kv->fieldSchemaIdx;
+    bind->buffer = kv->value;
+    bind->is_null = NULL;
   }
-  taosArrayDestroy(&batchBind);
-  tfree(sql);
-  return code;
-
 }
-static int32_t doInsertChildTablePoints(TAOS* taos, char* sql, char* cTableName, SArray* tagsBind, SArray* batchBind,
-                                        SSmlLinesInfo* info) {
-  int32_t code = 0;
 
-  TAOS_STMT* stmt = taos_stmt_init(taos);
+typedef struct {
+  TAOS*             taos;
+  char*             sql;
+  SSmlSTableSchema* sTableSchema;
+  SArray*           cTables;
+  SSmlBatchPos      start;
+  SSmlBatchPos      end;
+  SSmlLinesInfo*    info;
+  TAOS_BIND*        binds;
+  uintptr_t*        lengths;
+} SSmlBatchParam;
+
+/*
+ * Insert the points from position start to end (exclusive) of the child tables of a super table by one multiple table
+ * stmt. The rows of all the child tables are bound straight into the submit blocks of the stmt and sent by one
+ * execution, one submit message for each vgroup, instead of building and parsing an insert SQL for each child table.
+ */
+static int32_t doInsertSTableDataPointsBatchOnce(void* param, int32_t attempt, int32_t* affectedRows) {
+  SSmlBatchParam* pParam = param;
+  SSmlLinesInfo*  info = pParam->info;
+  SSmlBatchPos    start = pParam->start;
+  SSmlBatchPos    end = pParam->end;
+  size_t          numTags = taosArrayGetSize(pParam->sTableSchema->tags);
+  size_t          numCols = taosArrayGetSize(pParam->sTableSchema->fields);
+  size_t          numTables = taosArrayGetSize(pParam->cTables);
+  TAOS_BIND*      tagBinds = pParam->binds;
+  TAOS_BIND*      colBinds = pParam->binds + numTags;
+  uintptr_t*      lengths = pParam->lengths;
+  int             isNullBind = TSDB_TRUE;
+  int32_t         code = 0;
+
+  *affectedRows = 0;
+  TAOS_STMT* stmt = taos_stmt_init(pParam->taos);
   if (stmt == NULL) {
     return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
 
-  code = taos_stmt_prepare(stmt, sql, (unsigned long)strlen(sql));
-
+  code = taos_stmt_prepare(stmt, pParam->sql, (unsigned long)strlen(pParam->sql));
   if (code != 0) {
     tscError("SML:0x%"PRIx64" taos_stmt_prepare return %d:%s", info->id, code, taos_stmt_errstr(stmt));
     taos_stmt_close(stmt);
     return code;
   }
 
-  bool tryAgain = false;
-  int32_t try = 0;
-  do {
-    code = taos_stmt_set_tbname_tags(stmt, cTableName, TARRAY_GET_START(tagsBind));
-    if (code != 0) {
-      tscError("SML:0x%"PRIx64" taos_stmt_set_tbname return %d:%s", info->id, code, taos_stmt_errstr(stmt));
+  // unlike an insert SQL, the stmt is not parsed again with the schemas after TSDB_CODE_TDB_TABLE_RECONFIGURE
+  if (attempt > 0) {
+    tscStmtAttachSchema(stmt);
+  }
 
-      int affectedRows = taos_stmt_affected_rows(stmt);
-      info->affectedRows += affectedRows;
+  int32_t numRows = 0;
+  for (int32_t t = start.table; t < numTables && t <= end.table && code == 0; ++t) {
+    SArray* cTablePoints = taosArrayGetP(pParam->cTables, t);
+    int32_t from = (t == start.table) ? start.row : 0;
+    int32_t to = (t == end.table) ? end.row : (int32_t)taosArrayGetSize(cTablePoints);
+    if (from >= to) continue;
 
-      taos_stmt_close(stmt);
-      return code;
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, 0);
+    bindSmlChildTableTags(tagBinds, lengths, numTags, cTablePoints, &isNullBind);
+    code = taos_stmt_set_tbname_tags(stmt, point->childTableName, tagBinds);
+    if (code != 0) {
+      tscError("SML:0x%"PRIx64" taos_stmt_set_tbname return %d:%s", info->id, code, taos_stmt_errstr(stmt));
+      break;
     }
 
-    size_t rows = taosArrayGetSize(batchBind);
-    for (int32_t i = 0; i < rows; ++i) {
-      TAOS_BIND* colsBinds = taosArrayGetP(batchBind, i);
-      code = taos_stmt_bind_param(stmt, colsBinds);
+    for (int32_t r = from; r < to; ++r) {
+      point = taosArrayGetP(cTablePoints, r);
+      bindSmlDataPointFields(colBinds, lengths + numTags, numCols, point, &isNullBind);
+      code = taos_stmt_bind_param(stmt, colBinds);
       if (code != 0) {
         tscError("SML:0x%"PRIx64" taos_stmt_bind_param return %d:%s", info->id, code, taos_stmt_errstr(stmt));
-
-        int affectedRows = taos_stmt_affected_rows(stmt);
-        info->affectedRows += affectedRows;
-
-        taos_stmt_close(stmt);
-        return code;
+        break;
       }
       code = taos_stmt_add_batch(stmt);
       if (code != 0) {
         tscError("SML:0x%"PRIx64" taos_stmt_add_batch return %d:%s", info->id, code, taos_stmt_errstr(stmt));
-
-        int affectedRows = taos_stmt_affected_rows(stmt);
-        info->affectedRows += affectedRows;
-
-        taos_stmt_close(stmt);
-        return code;
+        break;
       }
     }
+    numRows += to - from;
+  }
 
+  if (code == 0) {
     code = taos_stmt_execute(stmt);
     if (code != 0) {
-      tscError("SML:0x%"PRIx64" taos_stmt_execute return %d:%s, try:%d", info->id, code, taos_stmt_errstr(stmt), try);
+      tscError("SML:0x%"PRIx64" taos_stmt_execute return %d:%s, try:%d", info->id, code, taos_stmt_errstr(stmt), attempt);
     }
-    tscDebug("SML:0x%"PRIx64" taos_stmt_execute inserted %d rows", info->id, taos_stmt_affected_rows(stmt));
+    tscDebug("SML:0x%"PRIx64" taos_stmt_execute inserted %d of %d rows of child tables from %d to %d",
+             info->id, taos_stmt_affected_rows(stmt), numRows, start.table, MIN(end.table, (int32_t)numTables - 1));
+  }
+
+  *affectedRows = taos_stmt_affected_rows(stmt);
+  taos_stmt_close(stmt);
+  return code;
+}
+
+int32_t smlInsertBatchWithRetry(TAOS* taos, __sml_insert_batch_fn_t fp, void* param, SSmlLinesInfo* info) {
+  int32_t code = 0;
+  int32_t affectedRows = 0;
+  bool    tryAgain = false;
+  int32_t try = 0;
+
+  do {
+    code = (*fp)(param, try, &affectedRows);
 
     tryAgain = false;
     if ((code == TSDB_CODE_TDB_INVALID_TABLE_ID
@@ -1164,7 +1002,7 @@ static int32_t doInsertChildTablePoints(TAOS* taos, char* sql, char* cTableName,
       TAOS_RES* res2 = taos_query(taos, "RESET QUERY CACHE");
       int32_t   code2 = taos_errno(res2);
       if (code2 != TSDB_CODE_SUCCESS) {
-        tscError("SML:0x%" PRIx64 " insert child table. reset query cache. error: %s", info->id, taos_errstr(res2));
+        tscError("SML:0x%" PRIx64 " insert child tables. reset query cache. error: %s", info->id, taos_errstr(res2));
       }
       taos_free_result(res2);
       if (tryAgain) {
@@ -1178,61 +1016,157 @@ static int32_t doInsertChildTablePoints(TAOS* taos, char* sql, char* cTableName,
     }
   } while (tryAgain);
 
-  int affectedRows = taos_stmt_affected_rows(stmt);
+  // the batch is executed again as a whole, the rows accepted by the other vgroups before are counted by the last try
   info->affectedRows += affectedRows;
+  return code;
+}
 
-  taos_stmt_close(stmt);
+static int32_t doInsertSTableDataPointsBatch(TAOS* taos, char* sql, SSmlSTableSchema* sTableSchema, SArray* cTables,
+                                             SSmlBatchPos start, SSmlBatchPos end, SSmlLinesInfo* info) {
+  size_t numTags = taosArrayGetSize(sTableSchema->tags);
+  size_t numCols = taosArrayGetSize(sTableSchema->fields);
+
+  SSmlBatchParam param = {.taos = taos, .sql = sql, .sTableSchema = sTableSchema, .cTables = cTables,
+                          .start = start, .end = end, .info = info};
+  param.binds = calloc(numTags + numCols, sizeof(TAOS_BIND));
+  param.lengths = calloc(numTags + numCols, sizeof(uintptr_t));
+  if (param.binds == NULL || param.lengths == NULL) {
+    tfree(param.binds);
+    tfree(param.lengths);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t code = smlInsertBatchWithRetry(taos, doInsertSTableDataPointsBatchOnce, &param, info);
+
+  free(param.binds);
+  free(param.lengths);
   return code;
+}
 
-  return 0;
+int32_t smlSplitBatches(SArray* cTables, int32_t tableSize, int32_t rowSize, int32_t maxBatchBytes, SArray* ends) {
+  size_t  numTables = taosArrayGetSize(cTables);
+  int32_t batchBytes = 0;
+
+  for (int32_t t = 0; t < numTables; ++t) {
+    int32_t rows = (int32_t)taosArrayGetSize(taosArrayGetP(cTables, t));
+    int32_t r = 0;
+    while (r < rows) {
+      if (batchBytes > 0 && batchBytes + tableSize + rowSize > maxBatchBytes) {
+        SSmlBatchPos end = {.table = t, .row = r};
+        taosArrayPush(ends, &end);
+        batchBytes = 0;
+      }
+
+      int32_t n = MIN(rows - r, (maxBatchBytes - batchBytes - tableSize) / rowSize);
+      n = MAX(n, 1);
+      r += n;
+      batchBytes += tableSize + n * rowSize;
+    }
+  }
+
+  if (batchBytes > 0) {
+    SSmlBatchPos end = {.table = (int32_t)numTables - 1,
+                        .row = (int32_t)taosArrayGetSize(taosArrayGetP(cTables, numTables - 1))};
+    taosArrayPush(ends, &end);
+  }
+
+  return (int32_t)taosArrayGetSize(ends);
 }
 
-static int32_t applyChildTableDataPoints(TAOS* taos, char* cTableName, char* sTableName, SSmlSTableSchema* sTableSchema,
-                                                 SArray* cTablePoints, size_t rowSize, SSmlLinesInfo* info) {
-  int32_t code = TSDB_CODE_SUCCESS;
-  size_t childTableDataPoints = taosArrayGetSize(cTablePoints);
-  if (childTableDataPoints < 10) {
-    code = applyChildTableDataPointsWithInsertSQL(taos, cTableName, sTableName, sTableSchema, cTablePoints, rowSize, info);
-  } else {
-    code = applyChildTableDataPointsWithStmt(taos, cTableName, sTableName, sTableSchema, cTablePoints, rowSize, info);
+static int32_t applySTableDataPoints(TAOS* taos, char* sTableName, SSmlSTableSchema* sTableSchema, SArray* cTables,
+                                     SSmlLinesInfo* info) {
+  int32_t rowSize = 0;
+  int32_t tableSize = sizeof(SSubmitBlk) + TSDB_TABLE_FNAME_LEN * 2;
+  for (int i = 0; i < taosArrayGetSize(sTableSchema->fields); ++i) {
+    SSchema* colSchema = taosArrayGet(sTableSchema->fields, i);
+    rowSize += colSchema->bytes;
+  }
+  for (int i = 0; i < taosArrayGetSize(sTableSchema->tags); ++i) {
+    SSchema* tagSchema = taosArrayGet(sTableSchema->tags, i);
+    tableSize += tagSchema->bytes;
   }
+
+  char* sql = malloc(tsMaxSQLStringLen + 1);
+  if (sql == NULL) {
+    tscError("malloc sql memory error");
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  buildSmlInsertStmtSql(sql, tsMaxSQLStringLen + 1, sTableName, sTableSchema->tags, sTableSchema->fields);
+
+  // the wal size limits the submit message of a vgroup, so the rows and the create table requests of the child tables
+  // sent by one execution are limited
+  int32_t maxBatchBytes = TSDB_MAX_WAL_SIZE * 2 / 3;
+  size_t  numTables = taosArrayGetSize(cTables);
+  tscDebug("SML:0x%"PRIx64" insert child tables of super table %s. num of child tables: %zu, row size: %d, "
+           "sql: %s", info->id, sTableName, numTables, rowSize, sql);
+
+  SArray* ends = taosArrayInit(4, sizeof(SSmlBatchPos));
+  if (ends == NULL) {
+    free(sql);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  smlSplitBatches(cTables, tableSize, rowSize, maxBatchBytes, ends);
+
+  int32_t      code = TSDB_CODE_SUCCESS;
+  SSmlBatchPos start = {0};
+  for (int32_t i = 0; i < taosArrayGetSize(ends) && code == 0; ++i) {
+    SSmlBatchPos* end = taosArrayGet(ends, i);
+    code = doInsertSTableDataPointsBatch(taos, sql, sTableSchema, cTables, start, *end, info);
+    start = *end;
+  }
+
+  taosArrayDestroy(&ends);
+  free(sql);
   return code;
 }
 
 static int32_t applyDataPoints(TAOS* taos, TAOS_SML_DATA_POINT* points, int32_t numPoints, SArray* stableSchemas, SSmlLinesInfo* info) {
   int32_t code = TSDB_CODE_SUCCESS;
+  size_t  numSTables = taosArrayGetSize(stableSchemas);
 
   SHashObj* cname2points = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
   arrangePointsByChildTableName(points, numPoints, cname2points, stableSchemas, info);
 
+  // the child tables of each super table, SArray<SArray<TAOS_SML_DATA_POINT*>*>
+  SArray* sTableCTables = taosArrayInit(numSTables, POINTER_BYTES);
+  for (int32_t i = 0; i < numSTables; ++i) {
+    SArray* cTables = taosArrayInit(16, POINTER_BYTES);
+    taosArrayPush(sTableCTables, &cTables);
+  }
+
   SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
   while (pCTablePoints) {
-    SArray* cTablePoints = *pCTablePoints;
-
+    SArray*              cTablePoints = *pCTablePoints;
     TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, 0);
-    SSmlSTableSchema*    sTableSchema = taosArrayGet(stableSchemas, point->schemaIdx);
+    taosArrayPush(taosArrayGetP(sTableCTables, point->schemaIdx), &cTablePoints);
+    pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
+  }
 
-    size_t rowSize = 0;
-    size_t numCols = taosArrayGetSize(sTableSchema->fields);
-    for (int i = 0; i < numCols; ++i) {
-      SSchema* colSchema = taosArrayGet(sTableSchema->fields, i);
-      rowSize += colSchema->bytes;
-    }
+  for (int32_t i = 0; i < numSTables; ++i) {
+    SArray* cTables = taosArrayGetP(sTableCTables, i);
+    if (taosArrayGetSize(cTables) == 0) continue;
 
-    tscDebug("SML:0x%"PRIx64" apply child table points. child table: %s of super table %s, row size: %zu",
-             info->id, point->childTableName, point->stableName, rowSize);
-    code = applyChildTableDataPoints(taos, point->childTableName, point->stableName, sTableSchema, cTablePoints, rowSize, info);
+    SSmlSTableSchema*    sTableSchema = taosArrayGet(stableSchemas, i);
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(taosArrayGetP(cTables, 0), 0);
+
+    tscDebug("SML:0x%"PRIx64" apply data points of %zu child tables of super table %s",
+             info->id, taosArrayGetSize(cTables), point->stableName);
+    code = applySTableDataPoints(taos, point->stableName, sTableSchema, cTables, info);
     if (code != 0) {
-      tscError("SML:0x%"PRIx64" Apply child table points failed. child table %s, error %s", info->id, point->childTableName, tstrerror(code));
+      tscError("SML:0x%"PRIx64" Apply data points failed. super table %s, error %s", info->id, point->stableName, tstrerror(code));
       goto cleanup;
     }
 
-    tscDebug("SML:0x%"PRIx64" successfully applied data points of child table %s", info->id, point->childTableName);
-
-    pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
+    tscDebug("SML:0x%"PRIx64" successfully applied data points of super table %s", info->id, point->stableName);
   }
 
 cleanup:
+  for (int32_t i = 0; i < numSTables; ++i) {
+    SArray* cTables = taosArrayGetP(sTableCTables, i);
+    taosArrayDestroy(&cTables);
+  }
+  taosArrayDestroy(&sTableCTables);
+
   pCTablePoints = taosHashIterate(cname2points, NULL);
   while (pCTablePoints) {
     SArray* pPoints = *pCTablePoints;
@@ -2733,13 +2667,15 @@ void destroySmlDataPoint(TAOS_SML_DATA_POINT* point) {
   free(point->childTableName);
 }
 
-int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
-  for (int32_t i = 0; i < numLines; ++i) {
+static int32_t tscParseLinesImpl(char* lines[], int32_t start, int32_t numLines, SArray* points, int32_t* failedLine,
+                                 SSmlLinesInfo* info) {
+  for (int32_t i = start; i < start + numLines; ++i) {
     TAOS_SML_DATA_POINT point = {0};
     int32_t code = tscParseLine(lines[i], &point, info);
     if (code != TSDB_CODE_SUCCESS) {
       tscError("SML:0x%"PRIx64" data point line parse failed. line %d : %s", info->id, i, lines[i]);
       destroySmlDataPoint(&point);
+      *failedLine = i;
       return code;
     } else {
       tscDebug("SML:0x%"PRIx64" data point line parse success. line %d", info->id, i);
@@ -2750,6 +2686,119 @@ int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* faile
   return TSDB_CODE_SUCCESS;
 }
 
+int32_t tscInitSmlParsePool() {
+  if (tsSmlParseThreads <= 0) return 0;
+
+  tscSmlParseQhandle = taosInitScheduler(SML_PARSE_QUEUE_SIZE, tsSmlParseThreads, "tscSmlParse");
+  if (tscSmlParseQhandle == NULL) {
+    return -1;
+  }
+
+  return 0;
+}
+
+void tscCleanupSmlParsePool() {
+  void* p = tscSmlParseQhandle;
+  tscSmlParseQhandle = NULL;
+  if (p != NULL) {
+    taosCleanUpScheduler(p);
+  }
+}
+
+static void tscParseLinesJobFp(SSchedMsg* pMsg) {
+  SSmlParseJob* pJob = (SSmlParseJob*)pMsg->ahandle;
+  SSmlParseCtx* pCtx = (SSmlParseCtx*)pMsg->thandle;
+
+  pJob->code = tscParseLinesImpl(pJob->lines, pJob->start, pJob->numLines, pJob->points, &pJob->failedLine, &pJob->info);
+
+  if (atomic_sub_fetch_32(&pCtx->nPending, 1) == 0) {
+    tsem_post(&pCtx->done);
+  }
+}
+
+/*
+ * The lines are split into runs of adjacent lines which are parsed by the workers of the parse pool, each into its own
+ * array of points, and the arrays are appended to the points in the order of the lines. The key and value of each kv
+ * are allocated by the worker thread, so they come from the malloc arena of the worker instead of one contended arena.
+ */
+static int32_t tscParseLinesParallel(char* lines[], int numLines, SArray* points, int32_t* failedLine,
+                                     SSmlLinesInfo* info) {
+  int32_t      numOfJobs = MIN(tsSmlParseThreads * 4, numLines / SML_PARSE_MIN_LINES_PER_JOB);
+  int32_t      code = TSDB_CODE_SUCCESS;
+  SSmlParseCtx ctx = {0};
+
+  SSmlParseJob* jobs = calloc(numOfJobs, sizeof(SSmlParseJob));
+  if (jobs == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t start = 0;
+  for (int32_t i = 0; i < numOfJobs; ++i) {
+    SSmlParseJob* pJob = jobs + i;
+    pJob->lines = lines;
+    pJob->start = start;
+    pJob->numLines = numLines / numOfJobs + ((i < numLines % numOfJobs) ? 1 : 0);
+    pJob->info = *info;
+    pJob->points = taosArrayInit(pJob->numLines, sizeof(TAOS_SML_DATA_POINT));
+    if (pJob->points == NULL) {
+      code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      goto _clean;
+    }
+    start += pJob->numLines;
+  }
+
+  ctx.nPending = numOfJobs;
+  tsem_init(&ctx.done, 0, 0);
+  for (int32_t i = 0; i < numOfJobs; ++i) {
+    SSchedMsg msg = {0};
+    msg.fp = tscParseLinesJobFp;
+    msg.ahandle = jobs + i;
+    msg.thandle = &ctx;
+    taosScheduleTask(tscSmlParseQhandle, &msg);
+  }
+  tsem_wait(&ctx.done);
+  tsem_destroy(&ctx.done);
+
+  // as the serial parse, the points before the first failed line are returned to be freed by the caller, and the
+  // points after it are dropped
+  for (int32_t i = 0; i < numOfJobs; ++i) {
+    SSmlParseJob* pJob = jobs + i;
+    if (code != TSDB_CODE_SUCCESS) {
+      for (size_t j = 0; j < taosArrayGetSize(pJob->points); ++j) {
+        destroySmlDataPoint(taosArrayGet(pJob->points, j));
+      }
+      continue;
+    }
+
+    taosArrayAddAll(points, pJob->points);
+    code = pJob->code;
+    if (code != TSDB_CODE_SUCCESS) *failedLine = pJob->failedLine;
+  }
+
+_clean:
+  for (int32_t i = 0; i < numOfJobs; ++i) {
+    taosArrayDestroy(&jobs[i].points);
+  }
+  free(jobs);
+  return code;
+}
+
+int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  int32_t failedLine = -1;
+
+  if (tscSmlParseQhandle == NULL || numLines < SML_PARSE_MIN_LINES_PER_JOB * 2) {
+    code = tscParseLinesImpl(lines, 0, numLines, points, &failedLine, info);
+  } else {
+    code = tscParseLinesParallel(lines, numLines, points, &failedLine, info);
+  }
+
+  if (code != TSDB_CODE_SUCCESS && failedLines != NULL && failedLine >= 0) {
+    taosArrayPush(failedLines, &failedLine);
+  }
+  return code;
+}
+
 int taos_insert_lines(TAOS* taos, char* lines[], int numLines, SMLProtocolType protocol, SMLTimeStampType tsType, int *affectedRows) {
   int32_t code = 0;
 
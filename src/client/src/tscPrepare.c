@@ -2120,6 +2120,13 @@ int taos_stmt_affected_rows(TAOS_STMT* stmt) {
   return pStmt->numOfRows;
 }
 
+void tscStmtAttachSchema(TAOS_STMT* stmt) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt != NULL && pStmt->pSql != NULL) {
+    pStmt->pSql->cmd.insertParam.schemaAttached = 1;
+  }
+}
+
 TAOS_RES *taos_stmt_use_result(TAOS_STMT* stmt) {
   if (stmt == NULL) {
     tscError("statement is invalid.");
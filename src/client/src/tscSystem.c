@@ -22,6 +22,8 @@
 #include "tsched.h"
 #include "tscLog.h"
 #include "tsclient.h"
+#include "tscParseLine.h"
+#include "tscGlobalmerge.h"
 #include "tglobal.h"
 #include "tconfig.h"
 #include "ttimezone.h"
@@ -236,6 +238,18 @@ void taos_init_imp(void) {
 
   tscDebug("client task queue is initialized, numOfWorkers: %d", tscNumOfThreads);
 
+  if (tscInitSmlParsePool() != 0) {
+    tscError("failed to init schemaless parse pool");
+    tscInitRes = -1;
+    return;
+  }
+
+  if (tscInitGlobalMergePool() != 0) {
+    tscError("failed to init global merge pool");
+    tscInitRes = -1;
+    return;
+  }
+
   tscTmr = taosTmrInit(tsMaxConnections * 2, 200, 60000, "TSC");
   if(0 == tscEmbedded){
     taosTmrReset(tscCheckDiskUsage, 20 * 1000, NULL, tscTmr, &tscCheckDiskUsageTmr);      
@@ -289,6 +303,9 @@ void taos_cleanup(void) {
   tscQhandle = NULL;
   taosCleanUpScheduler(p);
 
+  tscCleanupSmlParsePool();
+  tscCleanupGlobalMergePool();
+
   id = tscRefId;
   tscRefId = -1;
   taosCloseRef(id);
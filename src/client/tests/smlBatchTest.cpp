@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "os.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "taoserror.h"
+#include "tarray.h"
+#include "hash.h"
+#include "tglobal.h"
+#include "tscParseLine.h"
+
+namespace {
+
+// child tables of a super table with the numbers of points, the points are not read by smlSplitBatches
+SArray* newChildTables(const std::vector<int32_t>& rows) {
+  static TAOS_SML_DATA_POINT point;
+
+  SArray* cTables = (SArray*)taosArrayInit(rows.size(), POINTER_BYTES);
+  for (size_t t = 0; t < rows.size(); ++t) {
+    SArray* points = (SArray*)taosArrayInit(rows[t], POINTER_BYTES);
+    for (int32_t r = 0; r < rows[t]; ++r) {
+      TAOS_SML_DATA_POINT* p = &point;
+      taosArrayPush(points, &p);
+    }
+    taosArrayPush(cTables, &points);
+  }
+  return cTables;
+}
+
+void destroyChildTables(SArray* cTables) {
+  for (size_t t = 0; t < taosArrayGetSize(cTables); ++t) {
+    SArray* points = (SArray*)taosArrayGetP(cTables, t);
+    taosArrayDestroy(&points);
+  }
+  taosArrayDestroy(&cTables);
+}
+
+// split the child tables and check the batches cover all the rows in order, each no more than maxBatchBytes unless
+// it is a single row
+std::vector<SSmlBatchPos> splitBatches(SArray* cTables, int32_t tableSize, int32_t rowSize, int32_t maxBatchBytes) {
+  SArray* ends = (SArray*)taosArrayInit(4, sizeof(SSmlBatchPos));
+  int32_t n = smlSplitBatches(cTables, tableSize, rowSize, maxBatchBytes, ends);
+  EXPECT_EQ(n, (int32_t)taosArrayGetSize(ends));
+
+  std::vector<SSmlBatchPos> res;
+  SSmlBatchPos              start = {0};
+  for (int32_t i = 0; i < n; ++i) {
+    SSmlBatchPos end = *(SSmlBatchPos*)taosArrayGet(ends, i);
+    res.push_back(end);
+
+    int64_t bytes = 0;
+    int32_t rows = 0;
+    for (int32_t t = start.table; t <= end.table; ++t) {
+      int32_t numOfRows = (int32_t)taosArrayGetSize((SArray*)taosArrayGetP(cTables, t));
+      int32_t from = (t == start.table) ? start.row : 0;
+      int32_t to = (t == end.table) ? end.row : numOfRows;
+      if (to > from) {
+        bytes += tableSize + (int64_t)(to - from) * rowSize;
+        rows += to - from;
+      }
+    }
+    EXPECT_GT(rows, 0);
+    if (rows > 1) {
+      EXPECT_LE(bytes, maxBatchBytes);
+    }
+    start = end;
+  }
+
+  size_t numTables = taosArrayGetSize(cTables);
+  EXPECT_EQ(start.table, (int32_t)numTables - 1);
+  EXPECT_EQ(start.row, (int32_t)taosArrayGetSize((SArray*)taosArrayGetP(cTables, numTables - 1)));
+
+  taosArrayDestroy(&ends);
+  return res;
+}
+
+std::string influxLine(int32_t i) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "st,t1=t%d c1=%di64 %" PRId64, i % 10, i, (int64_t)1626006833639000000LL + i);
+  return buf;
+}
+
+// parse the lines, return the code, the first line failed and the values of c1 of the points
+int32_t parseLines(std::vector<std::string>& lines, int32_t* failedLine, std::vector<int64_t>* values) {
+  std::vector<char*> ptrs;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    ptrs.push_back((char*)lines[i].c_str());
+  }
+
+  SSmlLinesInfo info = {0};
+  info.protocol = TSDB_SML_LINE_PROTOCOL;
+  info.tsType = SML_TIME_STAMP_NANO_SECONDS;
+
+  SArray* points = (SArray*)taosArrayInit(lines.size(), sizeof(TAOS_SML_DATA_POINT));
+  SArray* failedLines = (SArray*)taosArrayInit(1, sizeof(int32_t));
+  int32_t code = tscParseLines(ptrs.data(), (int)ptrs.size(), points, failedLines, &info);
+
+  *failedLine = taosArrayGetSize(failedLines) > 0 ? *(int32_t*)taosArrayGet(failedLines, 0) : -1;
+  for (size_t i = 0; i < taosArrayGetSize(points); ++i) {
+    TAOS_SML_DATA_POINT* point = (TAOS_SML_DATA_POINT*)taosArrayGet(points, i);
+    values->push_back(*(int64_t*)point->fields[1].value);
+    destroySmlDataPoint(point);
+  }
+
+  taosArrayDestroy(&failedLines);
+  taosArrayDestroy(&points);
+  return code;
+}
+
+// the results of the tries of a batch of two vgroups, the rows accepted and the code of each try
+struct SFakeBatch {
+  std::vector<std::pair<int32_t, int32_t>> tries;
+  int32_t                                  numOfTries;
+};
+
+int32_t fakeInsertBatch(void* param, int32_t attempt, int32_t* affectedRows) {
+  SFakeBatch* pBatch = (SFakeBatch*)param;
+  EXPECT_EQ(attempt, pBatch->numOfTries);
+  EXPECT_LT(pBatch->numOfTries, (int32_t)pBatch->tries.size());
+
+  *affectedRows = pBatch->tries[pBatch->numOfTries].first;
+  return pBatch->tries[pBatch->numOfTries++].second;
+}
+
+}  // namespace
+
+TEST(testCase, smlSplitBatchesSingle) {
+  SArray* cTables = newChildTables({3, 5, 2});
+
+  std::vector<SSmlBatchPos> ends = splitBatches(cTables, 100, 10, 1000);
+  ASSERT_EQ(ends.size(), 1);
+  ASSERT_EQ(ends[0].table, 2);
+  ASSERT_EQ(ends[0].row, 2);
+
+  destroyChildTables(cTables);
+}
+
+TEST(testCase, smlSplitBatchesSplitTable) {
+  // 100 + 10 * 10 = 200 bytes of the first table, the second one is split at 300 bytes
+  SArray* cTables = newChildTables({10, 50});
+
+  std::vector<SSmlBatchPos> ends = splitBatches(cTables, 100, 10, 300);
+  ASSERT_EQ(ends.size(), 4);
+  int32_t rows[] = {0, 20, 40, 50};
+  for (int32_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(ends[i].table, 1);
+    ASSERT_EQ(ends[i].row, rows[i]);
+  }
+
+  destroyChildTables(cTables);
+}
+
+TEST(testCase, smlSplitBatchesLargeRow) {
+  // a row larger than the limit is a batch by itself
+  SArray* cTables = newChildTables({3});
+
+  std::vector<SSmlBatchPos> ends = splitBatches(cTables, 100, 2000, 1000);
+  ASSERT_EQ(ends.size(), 3);
+  for (int32_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(ends[i].table, 0);
+    ASSERT_EQ(ends[i].row, i + 1);
+  }
+
+  destroyChildTables(cTables);
+}
+
+TEST(testCase, smlSplitBatchesWalSize) {
+  // the limit of the batches inserted by the stmt of schemaless writes
+  int32_t maxBatchBytes = TSDB_MAX_WAL_SIZE * 2 / 3;
+  int32_t tableSize = 1024;
+  int32_t rowSize = 200;
+
+  std::vector<int32_t> rows;
+  int64_t              total = 0;
+  for (int32_t t = 0; t < 2000; ++t) {
+    rows.push_back(t % 37 + 1);
+    total += tableSize + (int64_t)rows.back() * rowSize;
+  }
+  SArray* cTables = newChildTables(rows);
+
+  std::vector<SSmlBatchPos> ends = splitBatches(cTables, tableSize, rowSize, maxBatchBytes);
+  ASSERT_GE((int64_t)ends.size(), (total + maxBatchBytes - 1) / maxBatchBytes);
+
+  destroyChildTables(cTables);
+}
+
+TEST(testCase, smlParseLinesParallel) {
+  std::vector<std::string> lines;
+  for (int32_t i = 0; i < 5000; ++i) {
+    lines.push_back(influxLine(i));
+  }
+
+  int32_t              failedLine = 0;
+  std::vector<int64_t> serial;
+  ASSERT_EQ(parseLines(lines, &failedLine, &serial), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(failedLine, -1);
+
+  tsSmlParseThreads = 4;
+  ASSERT_EQ(tscInitSmlParsePool(), 0);
+
+  std::vector<int64_t> parallel;
+  ASSERT_EQ(parseLines(lines, &failedLine, &parallel), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(failedLine, -1);
+  ASSERT_EQ(parallel, serial);
+  for (int32_t i = 0; i < (int32_t)parallel.size(); ++i) {
+    ASSERT_EQ(parallel[i], i);
+  }
+
+  // the first error in line order is returned, whichever worker fails first
+  lines[4500] = "st,t1=t0 c1=1i64 bad";
+  lines[1500] = "st,t1=t0 c1= 1626006833639000000";
+  std::vector<int64_t> failed;
+  ASSERT_NE(parseLines(lines, &failedLine, &failed), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(failedLine, 1500);
+  ASSERT_EQ(failed.size(), 1500);
+
+  tscCleanupSmlParsePool();
+  tsSmlParseThreads = 0;
+}
+
+TEST(testCase, smlInsertBatchPartialFailure) {
+  SSmlLinesInfo info = {0};
+
+  // the first vgroup accepts its 60 rows, the second one of 40 rows is not ready, then the batch is inserted again
+  SFakeBatch batch = {{{60, TSDB_CODE_APP_NOT_READY}, {100, TSDB_CODE_SUCCESS}}, 0};
+  ASSERT_EQ(smlInsertBatchWithRetry(NULL, fakeInsertBatch, &batch, &info), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(batch.numOfTries, 2);
+  ASSERT_EQ(info.affectedRows, 100);
+
+  // the rows of the batches are added up
+  SFakeBatch next = {{{70, TSDB_CODE_TDB_TABLE_RECONFIGURE}, {30, TSDB_CODE_APP_NOT_READY}, {50, TSDB_CODE_SUCCESS}}, 0};
+  ASSERT_EQ(smlInsertBatchWithRetry(NULL, fakeInsertBatch, &next, &info), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(next.numOfTries, 3);
+  ASSERT_EQ(info.affectedRows, 150);
+
+  // an error not retried ends the batch with the rows accepted by the last try
+  SFakeBatch failed = {{{60, TSDB_CODE_APP_NOT_READY}, {20, TSDB_CODE_TDB_TIMESTAMP_OUT_OF_RANGE}}, 0};
+  ASSERT_EQ(smlInsertBatchWithRetry(NULL, fakeInsertBatch, &failed, &info), TSDB_CODE_TDB_TIMESTAMP_OUT_OF_RANGE);
+  ASSERT_EQ(failed.numOfTries, 2);
+  ASSERT_EQ(info.affectedRows, 170);
+}
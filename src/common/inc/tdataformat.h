@@ -674,6 +674,7 @@ static FORCE_INLINE char *memRowEnd(SMemRow row) {
 
 SMemRow tdMemRowDup(SMemRow row);
 void    tdAppendMemRowToDataCol(SMemRow row, STSchema *pSchema, SDataCols *pCols, bool forceSetNull, int rowOffset);
+void    tdAppendDataRowsToDataCols(SMemRow *rows, int nRows, STSchema *pSchema, SDataCols *pCols);
 
 // NOTE: offset here including the header size
 static FORCE_INLINE void *tdGetMemRowDataOfCol(void *row, int16_t colId, int8_t colType, uint16_t offset) {
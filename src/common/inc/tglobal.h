@@ -54,6 +54,16 @@ extern int32_t  tsShellActivityTimer;
 extern uint32_t tsMaxTmrCtrl;
 extern float    tsNumOfThreadsPerCore;
 extern int32_t  tsNumOfCommitThreads;
+extern int32_t  tsNumOfCommitFSetThreads;
+extern int32_t  tsNumOfCommitCompThreads;
+extern int32_t  tsReadAheadBlocks;
+extern int32_t  tsNumOfReadAheadThreads;
+extern int32_t  tsBlockCacheSize;
+extern int32_t  tsBlockIdxCacheSize;
+extern int32_t  tsBlockBloomFilter;
+extern int32_t  tsStringDictEncode;
+extern char     tsColumnCodec[];
+extern int32_t  tsTagIndex;
 extern float    tsRatioOfQueryCores;
 extern int8_t   tsDaylight;
 extern char     tsTimezone[];
@@ -241,6 +251,8 @@ extern int8_t tsDeadLockKillQuery;
 extern char tsDefaultJSONStrType[];
 extern char tsSmlChildTableName[];
 extern char tsSmlTagNullName[];
+extern int32_t tsSmlParseThreads;
+extern int32_t tsGlobalMergeThreads;
 
 
 typedef struct {
@@ -553,6 +553,37 @@ void tdAppendMemRowToDataCol(SMemRow row, STSchema *pSchema, SDataCols *pCols, b
   }
 }
 
+/**
+ *  Append data rows of the same schema column by column, which is the same as appending them one by one with
+ *  forceSetNull.
+ */
+void tdAppendDataRowsToDataCols(SMemRow *rows, int nRows, STSchema *pSchema, SDataCols *pCols) {
+  ASSERT(nRows > 0 && pCols->numOfRows + nRows <= pCols->maxPoints);
+
+  int rcol = 0;
+  for (int dcol = 0; dcol < pCols->numOfCols; ++dcol) {
+    SDataCol *pDataCol = &(pCols->cols[dcol]);
+    while (rcol < schemaNCols(pSchema) && schemaColAt(pSchema, rcol)->colId < pDataCol->colId) {
+      rcol++;
+    }
+
+    if (rcol < schemaNCols(pSchema) && schemaColAt(pSchema, rcol)->colId == pDataCol->colId) {
+      STColumn *pRowCol = schemaColAt(pSchema, rcol);
+      for (int i = 0; i < nRows; ++i) {
+        void *value = tdGetRowDataOfCol(memRowDataBody(rows[i]), pRowCol->type, pRowCol->offset + TD_DATA_ROW_HEAD_SIZE);
+        dataColAppendVal(pDataCol, value, pCols->numOfRows + i, pCols->maxPoints, 0);
+      }
+      rcol++;
+    } else {
+      const void *value = getNullValue(pDataCol->type);
+      for (int i = 0; i < nRows; ++i) {
+        dataColAppendVal(pDataCol, value, pCols->numOfRows + i, pCols->maxPoints, 0);
+      }
+    }
+  }
+  pCols->numOfRows += nRows;
+}
+
 int tdMergeDataCols(SDataCols *target, SDataCols *source, int rowsToMerge, int *pOffset, bool forceSetNull) {
   ASSERT(rowsToMerge > 0 && rowsToMerge <= source->numOfRows);
   ASSERT(target->numOfCols == source->numOfCols);
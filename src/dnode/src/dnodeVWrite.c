@@ -207,6 +207,14 @@ static void *dnodeProcessVWriteQueue(void *wparam) {
              pWrite->rpcMsg.ahandle, taosMsg[pWrite->walHead.msgType], qtypeStr[qtype], pWrite->walHead.version);
 
       pWrite->code = vnodeProcessWrite(pVnode, &pWrite->walHead, qtype, pWrite);
+    }
+
+    // write the wal of all msgs at once, then apply them
+    vnodeFlushWrites(pVnode);
+
+    taosResetQitems(pWorker->qall);
+    for (int32_t i = 0; i < numOfMsgs; ++i) {
+      taosGetQitem(pWorker->qall, &qtype, (void **)&pWrite);
       if (pWrite->code <= 0) atomic_add_fetch_32(&pWrite->processedCount, 1);
       if (pWrite->code > 0) pWrite->code = 0;
       if (pWrite->code == 0 && pWrite->walHead.msgType != TSDB_MSG_TYPE_SUBMIT) forceFsync = true;
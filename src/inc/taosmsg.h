@@ -564,6 +564,8 @@ typedef struct {
   uint8_t  role;
   uint8_t  replica;
   uint8_t  compact;
+  int64_t  memArenaPages;
+  int64_t  memArenaBytes;
 } SVnodeLoad;
 
 typedef struct {
@@ -71,6 +71,7 @@ typedef struct {
   int8_t  compression;
   int8_t  update;
   int8_t  cacheLastRow;    // 0:no cache, 1: cache last row, 2: cache last NULL column 3: 1&2
+  char    db[TSDB_DB_NAME_LEN];  // name of the database without the account, matched by the columnCodec rules
 } STsdbCfg;
 
 #define CACHE_NO_LAST(c)          ((c)->cacheLastRow == 0)
@@ -82,6 +83,8 @@ typedef struct {
   int64_t totalStorage;  // total bytes occupie
   int64_t compStorage;
   int64_t pointsWritten;  // total data points written
+  int64_t memArenaPages;  // pages of the skiplist arenas of the mem and imem
+  int64_t memArenaBytes;  // bytes of the pages above
 } STsdbStat;
 
 typedef struct STsdbRepo STsdbRepo;
@@ -169,6 +172,10 @@ typedef void *TsdbQueryHandleT;  // Use void to hide implementation details
 #define BLOCK_LOAD_TABLE_SEQ_ORDER    2
 #define BLOCK_LOAD_TABLE_RR_ORDER     3
 
+// check a file block by its statistics before loading it, return false if no row of the block is qualified
+typedef bool (*block_filter_func)(void *param, SDataStatis *pStatis, int32_t numOfCols, int32_t numOfRows,
+                                  TsdbQueryHandleT pHandle);
+
 // query condition to build multi-table data block iterator
 typedef struct STsdbQueryCond {
   STimeWindow  twindow;
@@ -178,6 +185,8 @@ typedef struct STsdbQueryCond {
   SColumnInfo *colList;
   bool         loadExternalRows;  // load external rows or not
   int32_t      type;              // data block load type:
+  block_filter_func blockFilterFp;  // NULL if no file block is skipped by statistics
+  void *            blockFilterParam;
 } STsdbQueryCond;
 
 typedef struct STableData STableData;
@@ -192,6 +201,7 @@ typedef struct {
   SList *      actList;
   SList *      extraBuffList;
   SList *      bufBlockList;
+  struct SSkipListArena *pArena;  // skip list nodes of all tables, released together with the memtable
   int64_t      pointsAdd;   // TODO
   int64_t      storageAdd;  // TODO
 } SMemTable;
@@ -337,6 +347,28 @@ void tsdbRetrieveDataBlockInfo(TsdbQueryHandleT *pQueryHandle, SDataBlockInfo *p
  */
 int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT *pQueryHandle, SDataStatis **pBlockStatis);
 
+/**
+ * Check the bloom filter of a column of the file block being checked by the block filter
+ *
+ * @param pQueryHandle
+ * @param colId
+ * @param type        data type of the column
+ * @param pVal        value of the column type, in varstr for binary
+ * @return false if the value is definitely not in the block
+ */
+bool tsdbCheckBlockBloomFilter(TsdbQueryHandleT pQueryHandle, int16_t colId, int8_t type, const void *pVal);
+
+/**
+ * Get the dictionary of a dictionary encoded binary or nchar column of the file block being checked by the block
+ * filter, valid until the next call
+ *
+ * @param pQueryHandle
+ * @param colId
+ * @param ppDict      the first of the distinct values of the column, in varstr one after another
+ * @return the number of distinct values, or -1 if the column of the block is not dictionary encoded
+ */
+int32_t tsdbGetBlockColDict(TsdbQueryHandleT pQueryHandle, int16_t colId, const char **ppDict);
+
 /**
  *
  * The query condition with primary timestamp is passed to iterator during its constructor function,
@@ -404,17 +436,31 @@ int64_t tsdbSkipOffset(TsdbQueryHandleT queryHandle);
  * @param totalStorage. total bytes took by the tsdb
  * @param compStorage. total bytes took by the tsdb after compressed
  */
-void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage);
+void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage,
+                    int64_t *memArenaPages, int64_t *memArenaBytes);
 
 int  tsdbInitCommitQueue();
 void tsdbDestroyCommitQueue();
+int  tsdbInitReadAheadPool();
+void tsdbDestroyReadAheadPool();
+
+// statistics of the caches of decompressed column chunks of all vnodes, the counters are reset once they are got
+typedef struct {
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+  int64_t bytes;
+  int64_t entries;
+} STsdbBlockCacheStat;
+
+void tsdbGetBlockCacheStat(STsdbBlockCacheStat *pStat);
 int  tsdbSyncCommit(STsdbRepo *repo);
 void tsdbIncCommitRef(int vgId);
 void tsdbDecCommitRef(int vgId);
 void tsdbSwitchTable(TsdbQueryHandleT pQueryHandle);
 
 // For TSDB file sync
-int tsdbSyncSend(void *pRepo, SOCKET socketFd);
+int tsdbSyncSend(void *pRepo, SOCKET socketFd, int8_t caps);
 int tsdbSyncRecv(void *pRepo, SOCKET socketFd);
 
 // For TSDB Compact
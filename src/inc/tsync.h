@@ -79,7 +79,11 @@ typedef void     (*FStopSyncFile)(int32_t vgId, uint64_t fversion);
 // get file version
 typedef int32_t  (*FGetVersion)(int32_t vgId, uint64_t *fver, uint64_t *vver);
 
-typedef int32_t  (*FSendFile)(void *tsdb, SOCKET socketFd);
+// capabilities of the file sync, the node restoring data tells the ones it has in the sync-data rsp
+#define TAOS_SYNC_CAP_FILE_INCR 0x1  // filesets can be synced incrementally
+
+// caps are the file sync capabilities of the peer
+typedef int32_t  (*FSendFile)(void *tsdb, SOCKET socketFd, int8_t caps);
 typedef int32_t  (*FRecvFile)(void *tsdb, SOCKET socketFd);
 
 typedef struct {
@@ -26,8 +26,23 @@ typedef struct {
   int64_t submitReqSucNum;
   int64_t submitRowNum;
   int64_t submitRowSucNum;
+  int64_t blockCacheHits;
+  int64_t blockCacheMisses;
+  int64_t blockCacheEvictions;
+  int64_t blockCacheBytes;
+  int64_t blockCacheEntries;
 } SVnodeStatisInfo;
 
+typedef struct {
+  int32_t vgId;
+  int32_t queuedMsgs;
+  int64_t queuedBytes;
+  int64_t flowctrlMsgs;
+  int64_t flowctrlRejected;
+  int64_t memArenaPages;
+  int64_t memArenaBytes;
+} SVnodeWQueueStat;
+
 typedef struct {
   int32_t len;
   void *  rsp;
@@ -79,12 +94,14 @@ void*   vnodeAcquireNotClose(int32_t vgId);
 void*   vnodeGetWal(void *pVnode);
 int32_t vnodeGetVnodeList(int32_t vnodeList[], int32_t *numOfVnodes);
 void    vnodeBuildStatusMsg(void *pStatus);
+int32_t vnodeGetWQueueStat(SVnodeWQueueStat *pStats, int32_t maxNum);
 void    vnodeSetAccess(SVgroupAccess *pAccess, int32_t numOfVnodes);
 
 // vnodeWrite
 int32_t vnodeWriteToWQueue(void *pVnode, void *pHead, int32_t qtype, void *pRpcMsg);
 void    vnodeFreeFromWQueue(void *pVnode, SVWriteMsg *pWrite);
 int32_t vnodeProcessWrite(void *pVnode, void *pHead, int32_t qtype, void *pRspRet);
+int32_t vnodeFlushWrites(void *pVnode);
 
 SVnodeStatisInfo vnodeGetStatisInfo();
 
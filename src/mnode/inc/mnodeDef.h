@@ -153,6 +153,8 @@ typedef struct SVgObj {
   int64_t        totalStorage;
   int64_t        compStorage;
   int64_t        pointsWritten;
+  int64_t        memArenaPages;
+  int64_t        memArenaBytes;
   struct SDbObj *pDb;
   void *         idPool;
 } SVgObj;
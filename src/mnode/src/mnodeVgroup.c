@@ -343,6 +343,8 @@ void mnodeUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVl
     pVgroup->totalStorage = htobe64(pVload->totalStorage);
     pVgroup->compStorage = htobe64(pVload->compStorage);
     pVgroup->pointsWritten = htobe64(pVload->pointsWritten);
+    pVgroup->memArenaPages = htobe64(pVload->memArenaPages);
+    pVgroup->memArenaBytes = htobe64(pVload->memArenaBytes);
   }
 
   if (pVload->dbCfgVersion != pVgroup->pDb->dbCfgVersion || pVload->replica != pVgroup->numOfVnodes ||
@@ -104,6 +104,46 @@ int64_t taosRead(FileFd fd, void *buf, int64_t count) {
   return count;
 }
 
+// Read at offset without moving the file offset, so it can be called with other reads on the same fd
+int64_t taosPRead(FileFd fd, void *buf, int64_t count, int64_t offset) {
+  int64_t leftbytes = count;
+  int64_t readbytes;
+  char *  tbuf = (char *)buf;
+
+  while (leftbytes > 0) {
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+    OVERLAPPED ol = {0};
+    DWORD      nread = 0;
+    ol.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    ol.OffsetHigh = (DWORD)(offset >> 32);
+    if (!ReadFile((HANDLE)_get_osfhandle(fd), tbuf, (DWORD)leftbytes, &nread, &ol)) {
+      if (GetLastError() == ERROR_HANDLE_EOF) return (int64_t)(count - leftbytes);
+      errno = EIO;
+      return -1;
+    }
+    readbytes = nread;
+#else
+    readbytes = pread(fd, (void *)tbuf, (size_t)leftbytes, (off_t)offset);
+    if (readbytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      } else {
+        return -1;
+      }
+    }
+#endif
+    if (readbytes == 0) {
+      return (int64_t)(count - leftbytes);
+    }
+
+    leftbytes -= readbytes;
+    tbuf += readbytes;
+    offset += readbytes;
+  }
+
+  return count;
+}
+
 int64_t taosWrite(FileFd fd, void *buf, int64_t n) {
   int64_t nleft = n;
   int64_t nwritten = 0;
@@ -124,6 +164,53 @@ int64_t taosWrite(FileFd fd, void *buf, int64_t n) {
   return n;
 }
 
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+int64_t taosWritev(FileFd fd, struct iovec *iov, int32_t iovcnt) {
+  int64_t n = 0;
+  for (int32_t i = 0; i < iovcnt; ++i) {
+    if (taosWrite(fd, iov[i].iov_base, iov[i].iov_len) < 0) {
+      return -1;
+    }
+    n += iov[i].iov_len;
+  }
+
+  return n;
+}
+#else
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// the iov is modified if it is written partially
+int64_t taosWritev(FileFd fd, struct iovec *iov, int32_t iovcnt) {
+  int64_t n = 0;
+
+  while (iovcnt > 0) {
+    int64_t nwritten = writev(fd, iov, MIN(iovcnt, IOV_MAX));
+    if (nwritten < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    n += nwritten;
+
+    while (iovcnt > 0 && nwritten >= (int64_t)iov->iov_len) {
+      nwritten -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+
+    if (nwritten > 0) {
+      iov->iov_base = (char *)iov->iov_base + nwritten;
+      iov->iov_len -= nwritten;
+    }
+  }
+
+  return n;
+}
+#endif
+
 int64_t taosLSeek(FileFd fd, int64_t offset, int32_t whence) { return (int64_t)lseek(fd, (long)offset, whence); }
 
 int64_t taosCopy(char *from, char *to) {
@@ -130,6 +130,9 @@ typedef enum {
   MON_CMD_CREATE_TB_GRANTS,
   MON_CMD_CREATE_MT_RESTFUL,
   MON_CMD_CREATE_TB_RESTFUL,
+  MON_CMD_CREATE_MT_BLOCK_CACHE,
+  MON_CMD_CREATE_TB_BLOCK_CACHE,
+  MON_CMD_CREATE_MT_WQUEUE,
   MON_CMD_MAX
 } EMonCmd;
 
@@ -174,6 +177,8 @@ static void  monSaveVgroupsInfo();
 static void  monSaveDisksInfo();
 static void  monSaveGrantsInfo();
 static void  monSaveHttpReqInfo();
+static void  monSaveBlockCacheInfo();
+static void  monSaveWQueueInfo();
 static void  monGetSysStats();
 static void *monThreadFunc(void *param);
 static void  monBuildMonitorSql(char *sql, int32_t cmd);
@@ -323,6 +328,8 @@ static void *monThreadFunc(void *param) {
         monSaveDisksInfo();
         monSaveGrantsInfo();
         monSaveHttpReqInfo();
+        monSaveBlockCacheInfo();
+        monSaveWQueueInfo();
         monSaveSystemInfo();
       }
     }
@@ -475,6 +482,23 @@ static void monBuildMonitorSql(char *sql, int32_t cmd) {
   } else if (cmd == MON_CMD_CREATE_TB_RESTFUL) {
     snprintf(sql, SQL_LENGTH, "create table if not exists %s.restful_%d using %s.restful_info tags(%d, '%s')", tsMonitorDbName,
              dnodeGetDnodeId(), tsMonitorDbName, dnodeGetDnodeId(), tsLocalEp);
+  } else if (cmd == MON_CMD_CREATE_MT_BLOCK_CACHE) {
+    snprintf(sql, SQL_LENGTH,
+             "create table if not exists %s.block_cache_info(ts timestamp"
+             ", hits bigint, misses bigint, evictions bigint"
+             ", used_bytes bigint, entries bigint"
+             ") tags (dnode_id int, dnode_ep binary(%d))",
+             tsMonitorDbName, TSDB_EP_LEN);
+  } else if (cmd == MON_CMD_CREATE_TB_BLOCK_CACHE) {
+    snprintf(sql, SQL_LENGTH, "create table if not exists %s.block_cache_%d using %s.block_cache_info tags(%d, '%s')",
+             tsMonitorDbName, dnodeGetDnodeId(), tsMonitorDbName, dnodeGetDnodeId(), tsLocalEp);
+  } else if (cmd == MON_CMD_CREATE_MT_WQUEUE) {
+    snprintf(sql, SQL_LENGTH,
+             "create table if not exists %s.vnode_wqueue_info(ts timestamp"
+             ", queued_msgs int, queued_bytes bigint, flowctrl_msgs bigint, flowctrl_rejected bigint"
+             ", mem_arena_pages bigint, mem_arena_bytes bigint"
+             ") tags (vgroup_id int, dnode_id int, dnode_ep binary(%d))",
+             tsMonitorDbName, TSDB_EP_LEN);
   }
 
   sql[SQL_LENGTH] = 0;
@@ -1205,6 +1229,79 @@ static void monSaveVgroupsInfo() {
   taos_free_result(result);
 }
 
+static void monSaveBlockCacheInfo() {
+  int64_t ts = taosGetTimestampUs();
+  char *  sql = tsMonitor.sql;
+  SVnodeStatisInfo *pInfo = &tsMonStat.vInfo;
+
+  snprintf(sql, SQL_LENGTH,
+           "insert into %s.block_cache_%d values(%" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64
+           ", %" PRId64 ")",
+           tsMonitorDbName, dnodeGetDnodeId(), ts, pInfo->blockCacheHits, pInfo->blockCacheMisses,
+           pInfo->blockCacheEvictions, pInfo->blockCacheBytes, pInfo->blockCacheEntries);
+
+  monDebug("save block cache, sql:%s", sql);
+
+  void *res = taos_query(tsMonitor.conn, tsMonitor.sql);
+  int32_t code = taos_errno(res);
+  taos_free_result(res);
+
+  if (code != 0) {
+    monError("failed to save block_cache_%d info, reason:%s, sql:%s", dnodeGetDnodeId(), tstrerror(code),
+             tsMonitor.sql);
+  } else {
+    monIncSubmitReqCnt();
+    monDebug("successfully to save block_cache_%d info, sql:%s", dnodeGetDnodeId(), tsMonitor.sql);
+  }
+}
+
+static void monExecuteWQueueSql(char *sql) {
+  monDebug("save vnode write queues, sql:%s", sql);
+
+  void *res = taos_query(tsMonitor.conn, sql);
+  int32_t code = taos_errno(res);
+  taos_free_result(res);
+
+  if (code != 0) {
+    monError("failed to save vnode write queues of dnode %d, reason:%s, sql:%s", dnodeGetDnodeId(), tstrerror(code),
+             sql);
+  } else {
+    monIncSubmitReqCnt();
+    monDebug("successfully to save vnode write queues, sql:%s", sql);
+  }
+}
+
+// the table of each vnode is created by the insert, as the vnodes of the dnode change
+static void monSaveWQueueInfo() {
+  SVnodeWQueueStat *pStats = calloc(TSDB_MAX_VNODES, sizeof(SVnodeWQueueStat));
+  if (pStats == NULL) return;
+
+  int32_t num = vnodeGetWQueueStat(pStats, TSDB_MAX_VNODES);
+  int64_t ts = taosGetTimestampUs();
+  char *  sql = tsMonitor.sql;
+  int32_t pos = 0;
+
+  for (int32_t i = 0; i < num; ++i) {
+    SVnodeWQueueStat *pStat = &pStats[i];
+    if (pos == 0) pos = snprintf(sql, SQL_LENGTH, "insert into");
+
+    pos += snprintf(sql + pos, SQL_LENGTH - pos,
+                    " %s.vnode_wqueue_%d_%d using %s.vnode_wqueue_info tags(%d, %d, '%s') values(%" PRId64 ", %d, %" PRId64
+                    ", %" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64 ")",
+                    tsMonitorDbName, dnodeGetDnodeId(), pStat->vgId, tsMonitorDbName, pStat->vgId, dnodeGetDnodeId(),
+                    tsLocalEp, ts, pStat->queuedMsgs, pStat->queuedBytes, pStat->flowctrlMsgs, pStat->flowctrlRejected,
+                    pStat->memArenaPages, pStat->memArenaBytes);
+
+    // leave enough room for the next vnode
+    if (pos > SQL_LENGTH - 512 || i == num - 1) {
+      monExecuteWQueueSql(sql);
+      pos = 0;
+    }
+  }
+
+  free(pStats);
+}
+
 static void monSaveDisksInfo() {
   int64_t ts = taosGetTimestampUs();
   char *  sql = tsMonitor.sql;
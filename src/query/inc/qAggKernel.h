@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QAGGKERNEL_H
+#define TDENGINE_QAGGKERNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Aggregate kernels on a contiguous column of numOfRows fixed length values.
+ *
+ * The column is processed in chunks. If the block may have null values, a separate pass builds the not null mask of
+ * the chunk first, so the typed loops have no per row branches and are vectorized by the compiler. A block without
+ * null values, which is known from the block statistics, skips the null pass.
+ *
+ * All kernels return the number of not null values.
+ */
+int32_t aggCountNotNull(const char *pData, int32_t type, int32_t numOfRows);
+
+// sum of tinyint, smallint, int and bigint values
+int32_t aggSumSigned(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, int64_t *sum);
+
+// sum of utinyint, usmallint, uint and ubigint values
+int32_t aggSumUnsigned(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, uint64_t *sum);
+
+// sum of the values of any numeric type in double
+int32_t aggSumDouble(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, double *sum);
+
+/*
+ * The min or max value of a numeric column is copied to pVal, and its position to *index: the last one of the min
+ * value and the first one of the max value, the same as a row by row comparison updating on (cur < val) ^ isMin.
+ * *index is -1 if there is no value to compare, i.e. all values are null or NaN.
+ */
+int32_t aggMinMax(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, bool isMin, char *pVal,
+                  int32_t *index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QAGGKERNEL_H
@@ -22,6 +22,8 @@ extern "C" {
 
 #include "texpr.h"
 #include "hash.h"
+#include "tbitmap.h"
+#include "tcompare.h"
 #include "tname.h"
 
 #define FILTER_DEFAULT_GROUP_SIZE 4
@@ -36,6 +38,11 @@ extern "C" {
 
 #define FILTER_RM_UNIT_MIN_ROWS 100
 
+// rows evaluated at a time by the batch engine, the selection bitmap has one bit per row
+#define FILTER_BATCH_ROWS 1024
+#define FILTER_BITS_WORDS(n) (((n) + 63) / 64)
+#define FILTER_BIT_GET(b, i) (((b)[(i) >> 6] >> ((i) & 63)) & 1)
+
 enum {
   FLD_TYPE_COLUMN = 1,
   FLD_TYPE_VALUE = 2,  
@@ -106,6 +113,9 @@ typedef int32_t(*filter_desc_compare_func)(const void *, const void *);
 typedef bool(*filter_exec_func)(void *, int32_t, int8_t**, SDataStatis *, int16_t);
 typedef int32_t (*filer_get_col_from_id)(void *, int32_t, void **);
 typedef int32_t (*filer_get_col_from_name)(void *, int32_t, char*, void **);
+typedef bool (*filer_check_bloom_func)(void *, int16_t, int8_t, const void *);
+typedef int32_t (*filer_get_dict_func)(void *, int16_t, const char **);
+typedef bool (*filer_get_index_func)(void *, int16_t, int8_t, const void *, int32_t, const SBitmap **);
 
 typedef struct SFilterRangeCompare {
   int64_t s;
@@ -212,6 +222,8 @@ typedef struct SFilterComUnit {
   uint8_t optr;
   int8_t func;
   int8_t rfunc;
+  SRegexMatcher *matcher;  // match/nmatch pattern compiled once for the unit
+  char *buf;               // scratch buffer of the nchar data converted to mbs for the matcher
 } SFilterComUnit;
 
 typedef struct SFilterPCtx {
@@ -327,6 +339,7 @@ typedef struct SFilterInfo {
 
 extern int32_t filterInitFromTree(tExprNode* tree, void **pinfo, uint32_t options);
 extern bool filterExecute(SFilterInfo *info, int32_t numOfRows, int8_t** p, SDataStatis *statis, int16_t numOfCols);
+extern bool filterExecuteBatch(SFilterInfo *info, int32_t numOfRows, uint64_t** pBits, SDataStatis *statis, int16_t numOfCols);
 extern int32_t filterSetColFieldData(SFilterInfo *info, void *param, filer_get_col_from_id fp);
 extern int32_t filterSetJsonColFieldData(SFilterInfo *info, void *param, filer_get_col_from_name fp);
 extern int32_t filterGetTimeRange(SFilterInfo *info, STimeWindow *win);
@@ -334,6 +347,9 @@ extern int32_t filterConverNcharColumns(SFilterInfo* pFilterInfo, int32_t rows,
 extern int32_t filterFreeNcharColumns(SFilterInfo* pFilterInfo);
 extern void filterFreeInfo(SFilterInfo *info);
 extern bool filterRangeExecute(SFilterInfo *info, SDataStatis *pDataStatis, int32_t numOfCols, int32_t numOfRows);
+extern bool filterBloomExecute(SFilterInfo *info, void *param, filer_check_bloom_func fp);
+extern bool filterDictExecute(SFilterInfo *info, void *param, filer_get_dict_func fp);
+extern int32_t filterIndexExecute(SFilterInfo *info, void *param, filer_get_index_func fp, SBitmap **pRes);
 extern int32_t filterIsIndexedColumnQuery(SFilterInfo* info, int32_t idxId, bool *res);
 extern int32_t filterGetIndexedColumnInfo(SFilterInfo* info, char** val, int32_t *order, int32_t *flag);
 
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "taosdef.h"
+#include "ttype.h"
+
+#include "qAggKernel.h"
+
+#define AGG_KERNEL_CHUNK 1024  // rows of the not null mask kept on the stack
+
+#define AGG_NOT_NULL_MASK(T, nullVal)                 \
+  do {                                                \
+    const T *_d = (const T *)pData;                   \
+    for (int32_t i = 0; i < n; ++i) {                 \
+      mask[i] = (uint8_t)(_d[i] != (T)(nullVal));     \
+      count += mask[i];                               \
+    }                                                 \
+  } while (0)
+
+// The null values are compared by their bits, the null value of float and double is a NaN
+static int32_t aggNotNullMask(const char *pData, int32_t type, int32_t n, uint8_t *mask) {
+  int32_t count = 0;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+      AGG_NOT_NULL_MASK(uint8_t, TSDB_DATA_BOOL_NULL);
+      break;
+    case TSDB_DATA_TYPE_TINYINT:
+      AGG_NOT_NULL_MASK(uint8_t, TSDB_DATA_TINYINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      AGG_NOT_NULL_MASK(uint16_t, TSDB_DATA_SMALLINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      AGG_NOT_NULL_MASK(uint32_t, TSDB_DATA_INT_NULL);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      AGG_NOT_NULL_MASK(uint64_t, TSDB_DATA_BIGINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      AGG_NOT_NULL_MASK(uint32_t, TSDB_DATA_FLOAT_NULL);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      AGG_NOT_NULL_MASK(uint64_t, TSDB_DATA_DOUBLE_NULL);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      AGG_NOT_NULL_MASK(uint8_t, TSDB_DATA_UTINYINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      AGG_NOT_NULL_MASK(uint16_t, TSDB_DATA_USMALLINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      AGG_NOT_NULL_MASK(uint32_t, TSDB_DATA_UINT_NULL);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      AGG_NOT_NULL_MASK(uint64_t, TSDB_DATA_UBIGINT_NULL);
+      break;
+    default:
+      memset(mask, 1, n);
+      count = n;
+      break;
+  }
+
+  return count;
+}
+
+// Integer sums, a null value is cleared by the mask instead of a branch
+#define DEFINE_AGG_SUM(NAME, T, ACC)                               \
+  static ACC NAME(const T *d, const uint8_t *mask, int32_t n) {    \
+    ACC s = 0;                                                     \
+    if (mask == NULL) {                                            \
+      for (int32_t i = 0; i < n; ++i) {                            \
+        s += (ACC)d[i];                                            \
+      }                                                            \
+    } else {                                                       \
+      for (int32_t i = 0; i < n; ++i) {                            \
+        s += (ACC)d[i] & (ACC)(-(ACC)mask[i]);                     \
+      }                                                            \
+    }                                                              \
+    return s;                                                      \
+  }
+
+// Sums in double are kept in 4 partial sums, which the compiler is not allowed to do by itself
+#define DEFINE_AGG_SUM_DOUBLE(NAME, T)                                        \
+  static double NAME(const T *d, const uint8_t *mask, int32_t n) {            \
+    double  s[4] = {0};                                                       \
+    int32_t i = 0;                                                            \
+    if (mask == NULL) {                                                       \
+      for (; i + 4 <= n; i += 4) {                                            \
+        s[0] += (double)d[i];                                                 \
+        s[1] += (double)d[i + 1];                                             \
+        s[2] += (double)d[i + 2];                                             \
+        s[3] += (double)d[i + 3];                                             \
+      }                                                                       \
+      for (; i < n; ++i) {                                                    \
+        s[0] += (double)d[i];                                                 \
+      }                                                                       \
+    } else {                                                                  \
+      for (; i + 4 <= n; i += 4) {                                            \
+        s[0] += mask[i] ? (double)d[i] : 0;                                   \
+        s[1] += mask[i + 1] ? (double)d[i + 1] : 0;                           \
+        s[2] += mask[i + 2] ? (double)d[i + 2] : 0;                           \
+        s[3] += mask[i + 3] ? (double)d[i + 3] : 0;                           \
+      }                                                                       \
+      for (; i < n; ++i) {                                                    \
+        s[0] += mask[i] ? (double)d[i] : 0;                                   \
+      }                                                                       \
+    }                                                                         \
+    return (s[0] + s[1]) + (s[2] + s[3]);                                     \
+  }
+
+/*
+ * The min or max value of a chunk is found first, a null value is replaced by the identity value of the comparison
+ * by the mask. The position of the value is looked up only if the chunk updates the result.
+ */
+#define DEFINE_AGG_MINMAX(NAME, T, MINV, MAXV)                                    \
+  static T NAME(const T *d, const uint8_t *mask, int32_t n, bool isMin) {         \
+    T m = isMin ? (MAXV) : (MINV);                                                \
+    if (isMin) {                                                                  \
+      if (mask == NULL) {                                                         \
+        for (int32_t i = 0; i < n; ++i) m = (d[i] < m) ? d[i] : m;                \
+      } else {                                                                    \
+        for (int32_t i = 0; i < n; ++i) {                                         \
+          T v = mask[i] ? d[i] : (MAXV);                                          \
+          m = (v < m) ? v : m;                                                    \
+        }                                                                         \
+      }                                                                           \
+    } else {                                                                      \
+      if (mask == NULL) {                                                         \
+        for (int32_t i = 0; i < n; ++i) m = (d[i] > m) ? d[i] : m;                \
+      } else {                                                                    \
+        for (int32_t i = 0; i < n; ++i) {                                         \
+          T v = mask[i] ? d[i] : (MINV);                                          \
+          m = (v > m) ? v : m;                                                    \
+        }                                                                         \
+      }                                                                           \
+    }                                                                             \
+    return m;                                                                     \
+  }                                                                               \
+                                                                                  \
+  static int32_t NAME##Index(const T *d, const uint8_t *mask, int32_t n, bool isMin, T val) { \
+    if (isMin) {                                                                  \
+      for (int32_t i = n - 1; i >= 0; --i) {                                      \
+        if (d[i] == val && (mask == NULL || mask[i])) return i;                   \
+      }                                                                           \
+    } else {                                                                      \
+      for (int32_t i = 0; i < n; ++i) {                                           \
+        if (d[i] == val && (mask == NULL || mask[i])) return i;                   \
+      }                                                                           \
+    }                                                                             \
+    return -1;                                                                    \
+  }
+
+DEFINE_AGG_SUM(aggSumInt8, int8_t, int64_t)
+DEFINE_AGG_SUM(aggSumInt16, int16_t, int64_t)
+DEFINE_AGG_SUM(aggSumInt32, int32_t, int64_t)
+DEFINE_AGG_SUM(aggSumInt64, int64_t, int64_t)
+DEFINE_AGG_SUM(aggSumUint8, uint8_t, uint64_t)
+DEFINE_AGG_SUM(aggSumUint16, uint16_t, uint64_t)
+DEFINE_AGG_SUM(aggSumUint32, uint32_t, uint64_t)
+DEFINE_AGG_SUM(aggSumUint64, uint64_t, uint64_t)
+
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleInt8, int8_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleInt16, int16_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleInt32, int32_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleInt64, int64_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleUint8, uint8_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleUint16, uint16_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleUint32, uint32_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleUint64, uint64_t)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleFloat, float)
+DEFINE_AGG_SUM_DOUBLE(aggSumDoubleDouble, double)
+
+DEFINE_AGG_MINMAX(aggMinMaxInt8, int8_t, INT8_MIN, INT8_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxInt16, int16_t, INT16_MIN, INT16_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxInt32, int32_t, INT32_MIN, INT32_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxInt64, int64_t, INT64_MIN, INT64_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxUint8, uint8_t, 0, UINT8_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxUint16, uint16_t, 0, UINT16_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxUint32, uint32_t, 0, UINT32_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxUint64, uint64_t, 0, UINT64_MAX)
+DEFINE_AGG_MINMAX(aggMinMaxFloat, float, -INFINITY, INFINITY)
+DEFINE_AGG_MINMAX(aggMinMaxDouble, double, -INFINITY, INFINITY)
+
+// Run the statements on each chunk of the column, with p, n and pMask of the data, size and not null mask of it
+#define AGG_FOREACH_CHUNK(pData, type, numOfRows, hasNull, count, ...)                   \
+  do {                                                                                   \
+    uint8_t _mask[AGG_KERNEL_CHUNK];                                                     \
+    int32_t _bytes = tDataTypes[(type)].bytes;                                           \
+    for (int32_t _start = 0; _start < (numOfRows); _start += AGG_KERNEL_CHUNK) {         \
+      int32_t        n = MIN(AGG_KERNEL_CHUNK, (numOfRows) - _start);                    \
+      const char *   p = (pData) + (int64_t)_start * _bytes;                             \
+      const uint8_t *pMask = NULL;                                                       \
+      if (hasNull) {                                                                     \
+        (count) += aggNotNullMask(p, (type), n, _mask);                                  \
+        pMask = _mask;                                                                   \
+      } else {                                                                           \
+        (count) += n;                                                                    \
+      }                                                                                  \
+      __VA_ARGS__;                                                                       \
+    }                                                                                    \
+  } while (0)
+
+int32_t aggCountNotNull(const char *pData, int32_t type, int32_t numOfRows) {
+  int32_t count = 0;
+  AGG_FOREACH_CHUNK(pData, type, numOfRows, true, count, (void)p, (void)pMask);
+  return count;
+}
+
+int32_t aggSumSigned(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, int64_t *sum) {
+  int32_t count = 0;
+  int64_t s = 0;
+
+  AGG_FOREACH_CHUNK(pData, type, numOfRows, hasNull, count, {
+    switch (type) {
+      case TSDB_DATA_TYPE_TINYINT:  s += aggSumInt8((const int8_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_SMALLINT: s += aggSumInt16((const int16_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_INT:      s += aggSumInt32((const int32_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_BIGINT:   s += aggSumInt64((const int64_t *)p, pMask, n); break;
+      default: break;
+    }
+  });
+
+  *sum = s;
+  return count;
+}
+
+int32_t aggSumUnsigned(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, uint64_t *sum) {
+  int32_t  count = 0;
+  uint64_t s = 0;
+
+  AGG_FOREACH_CHUNK(pData, type, numOfRows, hasNull, count, {
+    switch (type) {
+      case TSDB_DATA_TYPE_UTINYINT:  s += aggSumUint8((const uint8_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_USMALLINT: s += aggSumUint16((const uint16_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_UINT:      s += aggSumUint32((const uint32_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_UBIGINT:   s += aggSumUint64((const uint64_t *)p, pMask, n); break;
+      default: break;
+    }
+  });
+
+  *sum = s;
+  return count;
+}
+
+int32_t aggSumDouble(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, double *sum) {
+  int32_t count = 0;
+  double  s = 0;
+
+  AGG_FOREACH_CHUNK(pData, type, numOfRows, hasNull, count, {
+    switch (type) {
+      case TSDB_DATA_TYPE_TINYINT:   s += aggSumDoubleInt8((const int8_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_SMALLINT:  s += aggSumDoubleInt16((const int16_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_INT:       s += aggSumDoubleInt32((const int32_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_BIGINT:    s += aggSumDoubleInt64((const int64_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_UTINYINT:  s += aggSumDoubleUint8((const uint8_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_USMALLINT: s += aggSumDoubleUint16((const uint16_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_UINT:      s += aggSumDoubleUint32((const uint32_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_UBIGINT:   s += aggSumDoubleUint64((const uint64_t *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_FLOAT:     s += aggSumDoubleFloat((const float *)p, pMask, n); break;
+      case TSDB_DATA_TYPE_DOUBLE:    s += aggSumDoubleDouble((const double *)p, pMask, n); break;
+      default: break;
+    }
+  });
+
+  *sum = s;
+  return count;
+}
+
+// Update the result by the chunk if it is the first one or it is better, in the same way as the row by row update
+#define AGG_MINMAX_CHUNK(T, NAME)                                 \
+  do {                                                            \
+    T _m = NAME((const T *)p, pMask, n, isMin);                   \
+    if (*index < 0 || ((*(T *)pVal < _m) ^ isMin)) {              \
+      int32_t _pos = NAME##Index((const T *)p, pMask, n, isMin, _m); \
+      if (_pos >= 0) {                                            \
+        *(T *)pVal = _m;                                          \
+        *index = (int32_t)(p - pData) / _bytes + _pos;            \
+      }                                                           \
+    }                                                             \
+  } while (0)
+
+int32_t aggMinMax(const char *pData, int32_t type, int32_t numOfRows, bool hasNull, bool isMin, char *pVal,
+                  int32_t *index) {
+  int32_t count = 0;
+  *index = -1;
+
+  AGG_FOREACH_CHUNK(pData, type, numOfRows, hasNull, count, {
+    switch (type) {
+      case TSDB_DATA_TYPE_TINYINT:   AGG_MINMAX_CHUNK(int8_t, aggMinMaxInt8); break;
+      case TSDB_DATA_TYPE_SMALLINT:  AGG_MINMAX_CHUNK(int16_t, aggMinMaxInt16); break;
+      case TSDB_DATA_TYPE_INT:       AGG_MINMAX_CHUNK(int32_t, aggMinMaxInt32); break;
+      case TSDB_DATA_TYPE_BIGINT:    AGG_MINMAX_CHUNK(int64_t, aggMinMaxInt64); break;
+      case TSDB_DATA_TYPE_UTINYINT:  AGG_MINMAX_CHUNK(uint8_t, aggMinMaxUint8); break;
+      case TSDB_DATA_TYPE_USMALLINT: AGG_MINMAX_CHUNK(uint16_t, aggMinMaxUint16); break;
+      case TSDB_DATA_TYPE_UINT:      AGG_MINMAX_CHUNK(uint32_t, aggMinMaxUint32); break;
+      case TSDB_DATA_TYPE_UBIGINT:   AGG_MINMAX_CHUNK(uint64_t, aggMinMaxUint64); break;
+      case TSDB_DATA_TYPE_FLOAT:     AGG_MINMAX_CHUNK(float, aggMinMaxFloat); break;
+      case TSDB_DATA_TYPE_DOUBLE:    AGG_MINMAX_CHUNK(double, aggMinMaxDouble); break;
+      default: break;
+    }
+  });
+
+  return count;
+}
@@ -21,6 +21,7 @@
 #include "ttype.h"
 #include "tsdb.h"
 
+#include "qAggKernel.h"
 #include "qAggMain.h"
 #include "qFill.h"
 #include "qHistogram.h"
@@ -911,7 +912,9 @@ static void count_function(SQLFunctionCtx *pCtx) {
   if (pCtx->preAggVals.isSet) {
     numOfElem = pCtx->size - pCtx->preAggVals.statis.numOfNull;
   } else {
-    if (pCtx->hasNull) {
+    if (pCtx->hasNull && !IS_VAR_DATA_TYPE(pCtx->inputType)) {
+      numOfElem = aggCountNotNull(GET_INPUT_DATA_LIST(pCtx), pCtx->inputType, pCtx->size);
+    } else if (pCtx->hasNull) {
       for (int32_t i = 0; i < pCtx->size; ++i) {
         char *val = GET_INPUT_DATA(pCtx, i);
         if (isNull(val, pCtx->inputType)) {
@@ -963,41 +966,6 @@ int32_t countRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
 int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
   return BLK_DATA_NO_NEEDED;
 }
-#define LIST_ADD_N_DOUBLE_FLOAT(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      SET_DOUBLE_VAL(&(x) , GET_DOUBLE_VAL(&(x)) + GET_FLOAT_VAL(&(d)[i]));                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-#define LIST_ADD_N_DOUBLE(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      SET_DOUBLE_VAL(&(x) , (x) + (d)[i]);                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-
-#define LIST_ADD_N(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      (x) += (d)[i];                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-
 #define UPDATE_DATA(ctx, left, right, num, sign, k) \
   do {                                              \
     if (((left) < (right)) ^ (sign)) {              \
@@ -1007,6 +975,21 @@ int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
     }                                               \
   } while (0)
 
+// the timestamp of the selected row is taken from ptsList at index, the tag columns are updated without it if no list
+#define MINMAX_UPDATE_DATA(ctx, type, output, val, sign, index)     \
+  do {                                                              \
+    type *_out = (type *)(output);                                  \
+    type  _val = *(type *)(val);                                    \
+    if ((*_out < _val) ^ (sign)) {                                  \
+      *_out = _val;                                                 \
+      if ((ctx)->ptsList != NULL) {                                 \
+        DO_UPDATE_TAG_COLUMNS(ctx, GET_TS_DATA(ctx, index));        \
+      } else {                                                      \
+        DO_UPDATE_TAG_COLUMNS_WITHOUT_TS(ctx);                      \
+      }                                                             \
+    }                                                               \
+  } while (0)
+
 #define DUPATE_DATA_WITHOUT_TS(ctx, left, right, num, sign) \
   do {                                                      \
     if (((left) < (right)) ^ (sign)) {                      \
@@ -1016,22 +999,6 @@ int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
     }                                                       \
   } while (0)
 
-#define LOOPCHECK_N(val, list, ctx, tsdbType, sign, num)          \
-  for (int32_t i = 0; i < ((ctx)->size); ++i) {                   \
-    if ((ctx)->hasNull && isNull((char *)&(list)[i], tsdbType)) { \
-      continue;                                                   \
-    }                                                             \
-    TSKEY key = (ctx)->ptsList != NULL? GET_TS_DATA(ctx, i):0;    \
-    UPDATE_DATA(ctx, val, (list)[i], num, sign, key);             \
-  }
-
-#define TYPED_LOOPCHECK_N(type, data, list, ctx, tsdbType, sign, notNullElems) \
-  do {                                                                         \
-    type *_data = (type *)data;                                                \
-    type *_list = (type *)list;                                                \
-    LOOPCHECK_N(*_data, _list, ctx, tsdbType, sign, notNullElems);             \
-  } while (0)
-
 static void do_sum(SQLFunctionCtx *pCtx) {
   int32_t notNullElems = 0;
 
@@ -1051,39 +1018,21 @@ static void do_sum(SQLFunctionCtx *pCtx) {
       SET_DOUBLE_VAL(retVal, *retVal + GET_DOUBLE_VAL((const char*)&(pCtx->preAggVals.statis.sum)));
     }
   } else {  // computing based on the true data block
-    void *pData = GET_INPUT_DATA_LIST(pCtx);
-    notNullElems = 0;
+    char *pData = GET_INPUT_DATA_LIST(pCtx);
 
     if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      int64_t *retVal = (int64_t *)pCtx->pOutput;
-
-      if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-      }
+      int64_t sum = 0;
+      notNullElems = aggSumSigned(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, &sum);
+      *(int64_t *)pCtx->pOutput += sum;
     } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      uint64_t *retVal = (uint64_t *)pCtx->pOutput;
-
-      if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
-      }
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      double *retVal = (double *)pCtx->pOutput;
-      LIST_ADD_N_DOUBLE(*retVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
+      uint64_t sum = 0;
+      notNullElems = aggSumUnsigned(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, &sum);
+      *(uint64_t *)pCtx->pOutput += sum;
+    } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
       double *retVal = (double *)pCtx->pOutput;
-      LIST_ADD_N_DOUBLE_FLOAT(*retVal, pCtx, pData, float, notNullElems, pCtx->inputType);
+      double  sum = 0;
+      notNullElems = aggSumDouble(pData, pCtx->inputType, pCtx->size, pCtx->hasNull, &sum);
+      SET_DOUBLE_VAL(retVal, GET_DOUBLE_VAL(retVal) + sum);
     }
   }
 
@@ -1256,30 +1205,10 @@ static void avg_function(SQLFunctionCtx *pCtx) {
     } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE || pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
       *pVal += GET_DOUBLE_VAL((const char *)&(pCtx->preAggVals.statis.sum));
     }
-  } else {
-    void *pData = GET_INPUT_DATA_LIST(pCtx);
-
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      LIST_ADD_N_DOUBLE(*pVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-      LIST_ADD_N_DOUBLE_FLOAT(*pVal, pCtx, pData, float, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
-    }
+  } else if (IS_NUMERIC_TYPE(pCtx->inputType)) {
+    double sum = 0;
+    notNullElems = aggSumDouble(GET_INPUT_DATA_LIST(pCtx), pCtx->inputType, pCtx->size, pCtx->hasNull, &sum);
+    *pVal += sum;
   }
 
   if (!pCtx->hasNull) {
@@ -1452,54 +1381,52 @@ static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin,
     return;
   }
 
-  void  *p = GET_INPUT_DATA_LIST(pCtx);
-  TSKEY *tsList = GET_TS_LIST(pCtx);
-
-  *notNullElems = 0;
-
-  if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      TYPED_LOOPCHECK_N(int8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      TYPED_LOOPCHECK_N(int16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      int32_t *pData = p;
-      int32_t *retVal = (int32_t*) pOutput;
+  // The min or max value of the block and its first position, or the last one for min, updates the result once
+  int64_t val[1] = {0};
+  int32_t index = -1;
 
-      for (int32_t i = 0; i < pCtx->size; ++i) {
-        if (pCtx->hasNull && isNull((const char*)&pData[i], pCtx->inputType)) {
-          continue;
-        }
+  *notNullElems = aggMinMax(GET_INPUT_DATA_LIST(pCtx), pCtx->inputType, pCtx->size, pCtx->hasNull, isMin,
+                            (char *)val, &index);
+  if (index < 0) {
+    return;
+  }
 
-        if ((*retVal < pData[i]) ^ isMin) {
-          *retVal = pData[i];
-          if(tsList) {
-            TSKEY k = tsList[i];
-            DO_UPDATE_TAG_COLUMNS(pCtx, k);
-          }
-        }
-        *notNullElems += 1;
-      }
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      MINMAX_UPDATE_DATA(pCtx, int8_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      MINMAX_UPDATE_DATA(pCtx, int16_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      MINMAX_UPDATE_DATA(pCtx, int32_t, pOutput, val, isMin, index);
 #if defined(_DEBUG_VIEW)
-      qDebug("max value updated:%d", *retVal);
+      qDebug("max value updated:%d", *(int32_t *)pOutput);
 #endif
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      TYPED_LOOPCHECK_N(int64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      TYPED_LOOPCHECK_N(uint8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      TYPED_LOOPCHECK_N(uint16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      TYPED_LOOPCHECK_N(uint32_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-      TYPED_LOOPCHECK_N(uint64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-    TYPED_LOOPCHECK_N(double, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-    TYPED_LOOPCHECK_N(float, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      MINMAX_UPDATE_DATA(pCtx, int64_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      MINMAX_UPDATE_DATA(pCtx, uint8_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      MINMAX_UPDATE_DATA(pCtx, uint16_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      MINMAX_UPDATE_DATA(pCtx, uint32_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      MINMAX_UPDATE_DATA(pCtx, uint64_t, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      MINMAX_UPDATE_DATA(pCtx, float, pOutput, val, isMin, index);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      MINMAX_UPDATE_DATA(pCtx, double, pOutput, val, isMin, index);
+      break;
+    default:
+      break;
   }
 }
 
@@ -2043,8 +2043,11 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
 
   pRuntimeEnv->prevGroupId = INT32_MIN;
 
-  pRuntimeEnv->pResultRowHashTable = taosHashInit(numOfTables, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
-  pRuntimeEnv->pResultRowListSet = taosHashInit(numOfTables * 10, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  // looked up for each row of group by and window queries, so the open addressing layout is used
+  pRuntimeEnv->pResultRowHashTable = taosHashInitWithLayout(numOfTables, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY),
+                                                            true, HASH_NO_LOCK, HASH_OPEN_ADDRESSING);
+  pRuntimeEnv->pResultRowListSet = taosHashInitWithLayout(numOfTables * 10, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY),
+                                                          false, HASH_NO_LOCK, HASH_OPEN_ADDRESSING);
   pRuntimeEnv->pResultRowArrayList = taosArrayInit(numOfTables, sizeof(SResultRowCell));
   pRuntimeEnv->keyBuf  = malloc(pQueryAttr->maxTableColumnWidth + sizeof(int64_t) + POINTER_BYTES);
   pRuntimeEnv->pool    = initResultRowPool(getResultRowSize(pRuntimeEnv));
@@ -2323,7 +2326,8 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
 
 _clean:
   tfree(pRuntimeEnv->sasArray);
-  tfree(pRuntimeEnv->pResultRowHashTable);
+  taosHashCleanup(pRuntimeEnv->pResultRowHashTable);
+  pRuntimeEnv->pResultRowHashTable = NULL;
   tfree(pRuntimeEnv->keyBuf);
   tfree(pRuntimeEnv->prevRow);
   tfree(pRuntimeEnv->tagVal);
@@ -3000,45 +3004,110 @@ void filterRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSingleColumnFilterInf
   tfree(p);
 }
 
+static int32_t nextSelBit(const uint64_t* pSel, int32_t numOfRows, int32_t i, bool set) {
+  while (i < numOfRows) {
+    uint64_t w = set ? pSel[i >> 6] : ~pSel[i >> 6];
+    w &= (UINT64_MAX << (i & 63));
+    if (w != 0) {
+      i = (i & ~63) + BUILDIN_CTZL(w);
+      return MIN(i, numOfRows);
+    }
+
+    i = (i & ~63) + 64;
+  }
+
+  return numOfRows;
+}
+
+// Same as doCompactSDataBlock with the selection bitmap of filterExecuteBatch. The runs of selected rows are found a
+// word at a time, and the leading selected rows are left where they are.
+void doCompactSDataBlockBySel(SSDataBlock* pBlock, int32_t numOfRows, const uint64_t* pSel) {
+  int32_t start = nextSelBit(pSel, numOfRows, 0, false);
+  int32_t j = start;
+
+  while (j < numOfRows) {
+    int32_t cstart = nextSelBit(pSel, numOfRows, j, true);
+    if (cstart >= numOfRows) {
+      break;
+    }
+
+    j = nextSelBit(pSel, numOfRows, cstart, false);
+
+    int32_t len = j - cstart;
+    for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+      SColumnInfoData* pColumnInfoData = taosArrayGet(pBlock->pDataBlock, i);
+
+      int16_t bytes = pColumnInfoData->info.bytes;
+      memmove(pColumnInfoData->pData + start * bytes, pColumnInfoData->pData + cstart * bytes, len * bytes);
+    }
+
+    start += len;
+  }
+
+  pBlock->info.rows = start;
+  pBlock->pBlockStatis = NULL;  // clean the block statistics info
+
+  if (start > 0) {
+    SColumnInfoData* pColumnInfoData = taosArrayGet(pBlock->pDataBlock, 0);
+    if (pColumnInfoData->info.type == TSDB_DATA_TYPE_TIMESTAMP &&
+        pColumnInfoData->info.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      pBlock->info.window.skey = *(int64_t*)pColumnInfoData->pData;
+      pBlock->info.window.ekey = *(int64_t*)(pColumnInfoData->pData + TSDB_KEYSIZE * (start - 1));
+    }
+  }
+}
+
 void filterColRowsInDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SSDataBlock* pBlock, bool ascQuery) {
  int32_t numOfRows = pBlock->info.rows;
 
  int8_t *p = NULL;
  bool    all = true;
 
- if (pRuntimeEnv->pTsBuf != NULL) {
-   SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, 0);
-   p = calloc(numOfRows, sizeof(int8_t));
-
-   TSKEY* k = (TSKEY*) pColInfoData->pData;
-   for (int32_t i = 0; i < numOfRows; ++i) {
-     int32_t offset = ascQuery? i:(numOfRows - i - 1);
-     int32_t ret = doTSJoinFilter(pRuntimeEnv, k[offset], ascQuery);
-     if (ret == TS_JOIN_TAG_NOT_EQUALS) {
-       break;
-     } else if (ret == TS_JOIN_TS_NOT_EQUALS) {
-       all = false;
-       continue;
+ if (pRuntimeEnv->pTsBuf == NULL) {
+   uint64_t *pSel = NULL;
+   all = filterExecuteBatch(pRuntimeEnv->pQueryAttr->pFilters, numOfRows, &pSel, pBlock->pBlockStatis, pRuntimeEnv->pQueryAttr->numOfCols);
+   if (!all) {
+     if (pSel) {
+       doCompactSDataBlockBySel(pBlock, numOfRows, pSel);
      } else {
-       assert(ret == TS_JOIN_TS_EQUAL);
-       p[offset] = true;
+       pBlock->info.rows = 0;
+       pBlock->pBlockStatis = NULL;  // clean the block statistics info
      }
+   }
 
-     if (!tsBufNextPos(pRuntimeEnv->pTsBuf)) {
-       if (i < (numOfRows - 1)) {
-         all = false;
-       }
+   tfree(pSel);
+   return;
+ }
 
-       break;
-     }
+ SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, 0);
+ p = calloc(numOfRows, sizeof(int8_t));
+
+ TSKEY* k = (TSKEY*) pColInfoData->pData;
+ for (int32_t i = 0; i < numOfRows; ++i) {
+   int32_t offset = ascQuery? i:(numOfRows - i - 1);
+   int32_t ret = doTSJoinFilter(pRuntimeEnv, k[offset], ascQuery);
+   if (ret == TS_JOIN_TAG_NOT_EQUALS) {
+     break;
+   } else if (ret == TS_JOIN_TS_NOT_EQUALS) {
+     all = false;
+     continue;
+   } else {
+     assert(ret == TS_JOIN_TS_EQUAL);
+     p[offset] = true;
    }
 
-   // save the cursor status
-   pRuntimeEnv->current->cur = tsBufGetCursor(pRuntimeEnv->pTsBuf);
- } else {
-   all = filterExecute(pRuntimeEnv->pQueryAttr->pFilters, numOfRows, &p, pBlock->pBlockStatis, pRuntimeEnv->pQueryAttr->numOfCols);
+   if (!tsBufNextPos(pRuntimeEnv->pTsBuf)) {
+     if (i < (numOfRows - 1)) {
+       all = false;
+     }
+
+     break;
+   }
  }
 
+ // save the cursor status
+ pRuntimeEnv->current->cur = tsBufGetCursor(pRuntimeEnv->pTsBuf);
+
  if (!all) {
    if (p) {
      doCompactSDataBlock(pBlock, numOfRows, p);
@@ -4600,10 +4669,11 @@ void queryCostStatis(SQInfo *pQInfo) {
 
   calculateOperatorProfResults(pQInfo);
 
-  qDebug("QInfo:0x%"PRIx64" :cost summary: elapsed time:%"PRId64" us, first merge:%"PRId64" us, total blocks:%d, "
-         "load block statis:%d, load data block:%d, total rows:%"PRId64 ", check rows:%"PRId64,
-         pQInfo->qId, pSummary->elapsedTime, pSummary->firstStageMergeTime, pSummary->totalBlocks, pSummary->loadBlockStatis,
-         pSummary->loadBlocks, pSummary->totalRows, pSummary->totalCheckedRows);
+  qDebug("QInfo:0x%"PRIx64" :cost summary: elapsed time:%"PRId64" us, first merge:%"PRId64" us, global merge:%"PRId64
+         " us, total blocks:%d, load block statis:%d, load data block:%d, total rows:%"PRId64 ", check rows:%"PRId64,
+         pQInfo->qId, pSummary->elapsedTime, pSummary->firstStageMergeTime, pSummary->globalMergeTime,
+         pSummary->totalBlocks, pSummary->loadBlockStatis, pSummary->loadBlocks, pSummary->totalRows,
+         pSummary->totalCheckedRows);
 
   qDebug("QInfo:0x%"PRIx64" :cost summary: winResPool size:%.2f Kb, numOfWin:%"PRId64", tableInfoSize:%.2f Kb, hashTable:%.2f Kb", pQInfo->qId, pSummary->winInfoSize/1024.0,
       pSummary->numOfTimeWindows, pSummary->tableInfoSize/1024.0, pSummary->hashSize/1024.0);
@@ -5066,6 +5136,22 @@ static void doTableQueryInfoTimeWindowCheck(SQueryAttr* pQueryAttr, STableQueryI
   }
 }
 
+// the same check as doFilterByBlockStatistics, done by tsdb before the file block is loaded
+static bool doFilterFileBlock(void* param, SDataStatis* pStatis, int32_t numOfCols, int32_t numOfRows,
+                              TsdbQueryHandleT pHandle) {
+  SFilterInfo* pFilters = (SFilterInfo*)param;
+
+  if (!filterRangeExecute(pFilters, pStatis, numOfCols, numOfRows)) {
+    return false;
+  }
+
+  if (!filterBloomExecute(pFilters, pHandle, tsdbCheckBlockBloomFilter)) {
+    return false;
+  }
+
+  return filterDictExecute(pFilters, pHandle, tsdbGetBlockColDict);
+}
+
 STsdbQueryCond createTsdbQueryCond(SQueryAttr* pQueryAttr, STimeWindow* win) {
   STsdbQueryCond cond = {
       .colList   = pQueryAttr->tableCols,
@@ -5076,6 +5162,11 @@ STsdbQueryCond createTsdbQueryCond(SQueryAttr* pQueryAttr, STimeWindow* win) {
       .twindow = *win,
   };
 
+  if (pQueryAttr->pFilters != NULL) {
+    cond.blockFilterFp = doFilterFileBlock;
+    cond.blockFilterParam = pQueryAttr->pFilters;
+  }
+
   // set offset with
   if(pQueryAttr->skipOffset) {
      cond.offset = pQueryAttr->limit.offset;
@@ -333,10 +333,12 @@ bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int3
     return false;
   }
 
-  size_t ret = fseek(pMemBuffer->file, (pInfo->startPageId + pageIdx) * pMemBuffer->pageSize, SEEK_SET);
-  ret = fread(pFilePage, pMemBuffer->pageSize, 1, pMemBuffer->file);
+  // read by the offset instead of the position of the file, as the flushouts of a buffer may be loaded by the
+  // threads of the global merge at the same time
+  int64_t offset = (int64_t)(pInfo->startPageId + pageIdx) * pMemBuffer->pageSize;
+  int64_t ret = taosPRead(fileno(pMemBuffer->file), pFilePage, pMemBuffer->pageSize, offset);
 
-  return (ret > 0);
+  return (ret == pMemBuffer->pageSize);
 }
 
 bool tExtMemBufferIsAllDataInMem(tExtMemBuffer *pMemBuffer) { return (pMemBuffer->fileMeta.nFileSize == 0); }
@@ -20,6 +20,10 @@
 #include "tscUtil.h"
 #include "tsdbMeta.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 OptrStr gOptrStr[] = {
   {TSDB_RELATION_INVALID,                  "invalid"},
   {TSDB_RELATION_LESS,                     "<"},
@@ -1774,6 +1778,10 @@ void filterFreePCtx(SFilterPCtx *pctx) {
 void filterFreeInfo(SFilterInfo *info) {
   CHK_RETV(info == NULL);
 
+  for (uint32_t i = 0; info->cunits && i < info->unitNum; ++i) {
+    regexMatcherDestroy(info->cunits[i].matcher);
+    tfree(info->cunits[i].buf);
+  }
   tfree(info->cunits);
   tfree(info->blkUnitRes);
   tfree(info->blkUnits);
@@ -2635,6 +2643,31 @@ int32_t filterPostProcessRange(SFilterInfo *info) {
 }
 
 
+// compile the pattern of match/nmatch once instead of for each row
+static void filterInitComUnitMatcher(SFilterComUnit *cunit) {
+  cunit->matcher = NULL;
+  cunit->buf = NULL;
+
+  if (cunit->optr != TSDB_RELATION_MATCH && cunit->optr != TSDB_RELATION_NMATCH) {
+    return;
+  }
+
+  if (cunit->dataType == TSDB_DATA_TYPE_JSON) {
+    tVariant *val = cunit->valData;
+    cunit->matcher = regexMatcherCreate(val->pz, val->nLen);
+  } else {
+    cunit->matcher = regexMatcherCreate(varDataVal(cunit->valData), varDataLen(cunit->valData));
+  }
+
+  if (cunit->dataType == TSDB_DATA_TYPE_NCHAR || cunit->dataType == TSDB_DATA_TYPE_JSON) {
+    cunit->buf = malloc(cunit->dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE);
+  }
+
+  if (cunit->matcher == NULL || (cunit->buf == NULL && cunit->dataType != TSDB_DATA_TYPE_BINARY)) {
+    qError("failed to init the regex matcher of column %d", cunit->colId);
+  }
+}
+
 int32_t filterGenerateComInfo(SFilterInfo *info) {
   info->cunits = malloc(info->unitNum * sizeof(*info->cunits));
   info->blkUnitRes = malloc(sizeof(*info->blkUnitRes) * info->unitNum);
@@ -2666,6 +2699,8 @@ int32_t filterGenerateComInfo(SFilterInfo *info) {
     
     info->cunits[i].dataSize = FILTER_UNIT_COL_SIZE(info, unit);
     info->cunits[i].dataType = FILTER_UNIT_DATA_TYPE(unit);
+
+    filterInitComUnitMatcher(&info->cunits[i]);
   }
   
   return TSDB_CODE_SUCCESS;
@@ -2859,6 +2894,28 @@ _return:
   return TSDB_CODE_SUCCESS;
 }
 
+// match/nmatch with the pattern compiled for the unit, nchar data is converted from ucs4 to mbs first
+static int8_t filterDoRegexCompare(SFilterComUnit *cunit, void *varData, bool nchar) {
+  char   *str = varDataVal(varData);
+  int32_t len = varDataLen(varData);
+
+  if (cunit->matcher == NULL || (nchar && cunit->buf == NULL)) {
+    return false;
+  }
+
+  if (nchar) {
+    len = taosUcs4ToMbs(str, len, cunit->buf);
+    if (len < 0) {
+      qError("castConvert1 taosUcs4ToMbs error");
+      return false;
+    }
+    str = cunit->buf;
+  }
+
+  int32_t ret = regexMatcherExec(cunit->matcher, str, len);
+  return (cunit->optr == TSDB_RELATION_MATCH) ? (ret == 0) : (ret != 0);
+}
+
 bool filterExecuteBasedOnStatisImpl(void *pinfo, int32_t numOfRows, int8_t** p, SDataStatis *statis, int16_t numOfCols) {
   SFilterInfo *info = (SFilterInfo *)pinfo;
   bool all = true;
@@ -2893,6 +2950,8 @@ bool filterExecuteBasedOnStatisImpl(void *pinfo, int32_t numOfRows, int8_t** p,
               (*p)[i] = 0;
             } else if (cunit->rfunc >= 0) {
               (*p)[i] = (*gRangeCompare[cunit->rfunc])(colData, colData, cunit->valData, cunit->valData2, gDataCompare[cunit->func]);
+            } else if (cunit->matcher != NULL && cunit->dataType != TSDB_DATA_TYPE_JSON) {
+              (*p)[i] = filterDoRegexCompare(cunit, colData, cunit->dataType == TSDB_DATA_TYPE_NCHAR);
             } else {
               (*p)[i] = filterDoCompare(gDataCompare[cunit->func], cunit->optr, colData, cunit->valData);
             }
@@ -3039,21 +3098,7 @@ static void doJsonCompare(SFilterComUnit *cunit, int8_t *result, void* colData){
     if (jsonType != TSDB_DATA_TYPE_NCHAR){
       *result = false;
     }else{
-      char *newColData = calloc(cunit->dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
-      int len = taosUcs4ToMbs(varDataVal(realData), varDataLen(realData), varDataVal(newColData));
-      if (len < 0){
-        qError("castConvert1 taosUcs4ToMbs error");
-        tfree(newColData);
-        return;
-      }
-      varDataSetLen(newColData, len);
-      tVariant* val = cunit->valData;
-      char newValData[TSDB_REGEX_STRING_DEFAULT_LEN * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE] = {0};
-      assert(val->nLen <= TSDB_REGEX_STRING_DEFAULT_LEN * TSDB_NCHAR_SIZE);
-      memcpy(varDataVal(newValData), val->pz, val->nLen);
-      varDataSetLen(newValData, val->nLen);
-      *result = filterDoCompare(gDataCompare[cunit->func], cunit->optr, newColData, newValData);
-      tfree(newColData);
+      *result = filterDoRegexCompare(cunit, realData, true);
     }
   }else if(cunit->optr == TSDB_RELATION_LIKE){
     uint8_t  jsonType = *(char*)colData;
@@ -3132,16 +3177,8 @@ bool filterExecuteImplMisc(void *pinfo, int32_t numOfRows, int8_t** p, SDataStat
     }
     // match/nmatch for nchar type need convert from ucs4 to mbs
 
-    if(info->cunits[uidx].dataType == TSDB_DATA_TYPE_NCHAR && (info->cunits[uidx].optr == TSDB_RELATION_MATCH || info->cunits[uidx].optr == TSDB_RELATION_NMATCH)){
-      char *newColData = calloc(info->cunits[uidx].dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
-      int32_t len = taosUcs4ToMbs(varDataVal(colData), varDataLen(colData), varDataVal(newColData));
-      if (len < 0){
-        qError("castConvert1 taosUcs4ToMbs error");
-      }else{
-        varDataSetLen(newColData, len);
-        (*p)[i] = filterDoCompare(gDataCompare[info->cunits[uidx].func], info->cunits[uidx].optr, newColData, info->cunits[uidx].valData);
-      }
-      tfree(newColData);
+    if(info->cunits[uidx].dataType != TSDB_DATA_TYPE_JSON && (info->cunits[uidx].optr == TSDB_RELATION_MATCH || info->cunits[uidx].optr == TSDB_RELATION_NMATCH)){
+      (*p)[i] = filterDoRegexCompare(&info->cunits[uidx], colData, info->cunits[uidx].dataType == TSDB_DATA_TYPE_NCHAR);
     }else if(info->cunits[uidx].dataType == TSDB_DATA_TYPE_JSON){
       doJsonCompare(&(info->cunits[uidx]), &(*p)[i], colData);
     }else{
@@ -3193,16 +3230,8 @@ bool filterExecuteImpl(void *pinfo, int32_t numOfRows, int8_t** p, SDataStatis *
             } else if (cunit->rfunc >= 0) {
               (*p)[i] = (*gRangeCompare[cunit->rfunc])(colData, colData, cunit->valData, cunit->valData2, gDataCompare[cunit->func]);
             } else {
-              if(cunit->dataType == TSDB_DATA_TYPE_NCHAR && (cunit->optr == TSDB_RELATION_MATCH || cunit->optr == TSDB_RELATION_NMATCH)){
-                char *newColData = calloc(cunit->dataSize * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE, 1);
-                int32_t len = taosUcs4ToMbs(varDataVal(colData), varDataLen(colData), varDataVal(newColData));
-                if (len < 0){
-                  qError("castConvert1 taosUcs4ToMbs error");
-                }else{
-                  varDataSetLen(newColData, len);
-                  (*p)[i] = filterDoCompare(gDataCompare[cunit->func], cunit->optr, newColData, cunit->valData);
-                }
-                tfree(newColData);
+              if(cunit->dataType != TSDB_DATA_TYPE_JSON && (cunit->optr == TSDB_RELATION_MATCH || cunit->optr == TSDB_RELATION_NMATCH)){
+                (*p)[i] = filterDoRegexCompare(cunit, colData, cunit->dataType == TSDB_DATA_TYPE_NCHAR);
               }else if(cunit->dataType == TSDB_DATA_TYPE_JSON){
                 doJsonCompare(cunit, &(*p)[i], colData);
               }else{
@@ -3237,6 +3266,355 @@ FORCE_INLINE bool filterExecute(SFilterInfo *info, int32_t numOfRows, int8_t** p
   return (*info->func)(info, numOfRows, p, statis, numOfCols);
 }
 
+// The batch engine evaluates FILTER_BATCH_ROWS rows of one unit at a time with a loop specialized by the column type
+// and the operator, which the compiler turns into SIMD compares. The results are packed into a bitmap with one bit
+// per row, the units of a group are combined by AND and the groups by OR, word by word.
+enum {
+  FILTER_BATCH_EQ = 0,
+  FILTER_BATCH_NE,
+  FILTER_BATCH_GT,
+  FILTER_BATCH_GE,
+  FILTER_BATCH_LT,
+  FILTER_BATCH_LE,
+  FILTER_BATCH_EE,  // lo <  v <  hi
+  FILTER_BATCH_EI,  // lo <  v <= hi
+  FILTER_BATCH_IE,  // lo <= v <  hi
+  FILTER_BATCH_II,  // lo <= v <= hi
+  FILTER_BATCH_NOTNULL,
+  FILTER_BATCH_ISNULL,
+};
+
+// in the order of gRangeCompare
+static const int8_t gBatchRangeMode[] = {FILTER_BATCH_EE, FILTER_BATCH_EI, FILTER_BATCH_IE, FILTER_BATCH_II,
+                                         FILTER_BATCH_GT, FILTER_BATCH_GE, FILTER_BATCH_LT, FILTER_BATCH_LE};
+
+// float and double keep the tolerance of compareFloatVal and compareDoubleVal, a NAN value is less than the constant
+#define FILTER_BATCH_INT_EQ(_v, _c) ((_v) == (_c))
+#define FILTER_BATCH_INT_GT(_v, _c) ((_v) > (_c))
+#define FILTER_BATCH_FLOAT_EQ(_v, _c) (fabsf((_v) - (_c)) <= FLT_COMPAR_TOL_FACTOR * FLT_EPSILON)
+#define FILTER_BATCH_FLOAT_GT(_v, _c) (!FILTER_BATCH_FLOAT_EQ(_v, _c) & ((_v) > (_c)))
+#define FILTER_BATCH_DOUBLE_EQ(_v, _c) (fabs((_v) - (_c)) <= FLT_COMPAR_TOL_FACTOR * FLT_EPSILON)
+#define FILTER_BATCH_DOUBLE_GT(_v, _c) (!FILTER_BATCH_DOUBLE_EQ(_v, _c) & ((_v) > (_c)))
+
+#define FILTER_BATCH_LOOP(_cond)                                  \
+  do {                                                            \
+    for (int32_t i = 0; i < n; ++i) {                             \
+      res[i] = (uint8_t)((b[i] != nul) & (_cond));                \
+    }                                                             \
+  } while (0)
+
+// _bt is the type the null value is checked with, which differs from _t for float and double
+#define FILTER_BATCH_KERNEL(_name, _t, _bt, _eq, _gt)                                                               \
+  static void _name(const void *data, int32_t n, uint8_t *res, int8_t mode, _bt nul, _t lo, _t hi) {                \
+    const _t * v = (const _t *)data;                                                                                 \
+    const _bt *b = (const _bt *)data;                                                                                \
+    switch (mode) {                                                                                                  \
+      case FILTER_BATCH_EQ: FILTER_BATCH_LOOP(_eq(v[i], lo)); break;                                                 \
+      case FILTER_BATCH_NE: FILTER_BATCH_LOOP(!_eq(v[i], lo)); break;                                                \
+      case FILTER_BATCH_GT: FILTER_BATCH_LOOP(_gt(v[i], lo)); break;                                                 \
+      case FILTER_BATCH_GE: FILTER_BATCH_LOOP(_eq(v[i], lo) | _gt(v[i], lo)); break;                                 \
+      case FILTER_BATCH_LT: FILTER_BATCH_LOOP(!_eq(v[i], hi) & !_gt(v[i], hi)); break;                               \
+      case FILTER_BATCH_LE: FILTER_BATCH_LOOP(!_gt(v[i], hi)); break;                                                \
+      case FILTER_BATCH_EE: FILTER_BATCH_LOOP(_gt(v[i], lo) & !_eq(v[i], hi) & !_gt(v[i], hi)); break;               \
+      case FILTER_BATCH_EI: FILTER_BATCH_LOOP(_gt(v[i], lo) & !_gt(v[i], hi)); break;                                \
+      case FILTER_BATCH_IE: FILTER_BATCH_LOOP((_eq(v[i], lo) | _gt(v[i], lo)) & !_eq(v[i], hi) & !_gt(v[i], hi)); break; \
+      case FILTER_BATCH_II: FILTER_BATCH_LOOP((_eq(v[i], lo) | _gt(v[i], lo)) & !_gt(v[i], hi)); break;              \
+      case FILTER_BATCH_NOTNULL: FILTER_BATCH_LOOP(1); break;                                                        \
+      default:                                                                                                       \
+        for (int32_t i = 0; i < n; ++i) {                                                                            \
+          res[i] = (uint8_t)(b[i] == nul);                                                                           \
+        }                                                                                                            \
+        break;                                                                                                       \
+    }                                                                                                                \
+  }
+
+FILTER_BATCH_KERNEL(filterBatchInt8, int8_t, int8_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchInt16, int16_t, int16_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchInt32, int32_t, int32_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchInt64, int64_t, int64_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchUint8, uint8_t, uint8_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchUint16, uint16_t, uint16_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchUint32, uint32_t, uint32_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchUint64, uint64_t, uint64_t, FILTER_BATCH_INT_EQ, FILTER_BATCH_INT_GT)
+FILTER_BATCH_KERNEL(filterBatchFloat, float, uint32_t, FILTER_BATCH_FLOAT_EQ, FILTER_BATCH_FLOAT_GT)
+FILTER_BATCH_KERNEL(filterBatchDouble, double, uint64_t, FILTER_BATCH_DOUBLE_EQ, FILTER_BATCH_DOUBLE_GT)
+
+#define FILTER_BATCH_VAL(_t, _p) ((_p) ? *(_t *)(_p) : 0)
+
+// Return the kernel mode of the unit, or -1 if it is evaluated row by row
+static int8_t filterBatchUnitMode(SFilterComUnit *cunit) {
+  int8_t mode = -1;
+
+  if (cunit->optr == TSDB_RELATION_ISNULL) {
+    mode = FILTER_BATCH_ISNULL;
+  } else if (cunit->optr == TSDB_RELATION_NOTNULL) {
+    mode = FILTER_BATCH_NOTNULL;
+  } else if (cunit->rfunc >= 0) {
+    mode = gBatchRangeMode[cunit->rfunc];
+  } else {
+    switch (cunit->optr) {
+      case TSDB_RELATION_EQUAL:         mode = FILTER_BATCH_EQ; break;
+      case TSDB_RELATION_NOT_EQUAL:     mode = FILTER_BATCH_NE; break;
+      case TSDB_RELATION_GREATER:       mode = FILTER_BATCH_GT; break;
+      case TSDB_RELATION_GREATER_EQUAL: mode = FILTER_BATCH_GE; break;
+      case TSDB_RELATION_LESS:          mode = FILTER_BATCH_LT; break;
+      case TSDB_RELATION_LESS_EQUAL:    mode = FILTER_BATCH_LE; break;
+      default:
+        return -1;
+    }
+  }
+
+  // only the plain numeric comparators of gDataCompare have kernels
+  switch (cunit->func) {
+    case 0: case 1: case 2: case 3: case 11: case 12: case 13: case 14:
+      break;
+    case 4:
+      if (mode < FILTER_BATCH_NOTNULL && (isnan(FILTER_BATCH_VAL(float, cunit->valData)) ||
+                                          isnan(FILTER_BATCH_VAL(float, cunit->valData2)))) {
+        return -1;
+      }
+      break;
+    case 5:
+      if (mode < FILTER_BATCH_NOTNULL && (isnan(FILTER_BATCH_VAL(double, cunit->valData)) ||
+                                          isnan(FILTER_BATCH_VAL(double, cunit->valData2)))) {
+        return -1;
+      }
+      break;
+    default:
+      return -1;
+  }
+
+  return mode;
+}
+
+static int8_t filterBatchUnitRow(SFilterComUnit *cunit, void *colData) {
+  uint8_t optr = cunit->optr;
+
+  if (isNull(colData, cunit->dataType)) {
+    return optr == TSDB_RELATION_ISNULL;
+  }
+
+  if (optr == TSDB_RELATION_NOTNULL) {
+    return 1;
+  } else if (optr == TSDB_RELATION_ISNULL) {
+    return 0;
+  } else if (cunit->rfunc >= 0) {
+    return (*gRangeCompare[cunit->rfunc])(colData, colData, cunit->valData, cunit->valData2, gDataCompare[cunit->func]);
+  }
+
+  if (optr == TSDB_RELATION_MATCH || optr == TSDB_RELATION_NMATCH) {
+    return filterDoRegexCompare(cunit, colData, cunit->dataType == TSDB_DATA_TYPE_NCHAR);
+  }
+
+  return filterDoCompare(gDataCompare[cunit->func], optr, colData, cunit->valData);
+}
+
+// Evaluate rows [start, start + n) of the unit into one byte per row
+static void filterBatchUnitRows(SFilterComUnit *cunit, int32_t start, int32_t n, uint8_t *res) {
+  if (cunit->colData == NULL) {
+    memset(res, cunit->optr == TSDB_RELATION_ISNULL, n);
+    return;
+  }
+
+  char  *data = (char *)cunit->colData + (int64_t)cunit->dataSize * start;
+  int8_t mode = filterBatchUnitMode(cunit);
+  if (mode < 0) {
+    for (int32_t i = 0; i < n; ++i) {
+      res[i] = filterBatchUnitRow(cunit, data + (int64_t)cunit->dataSize * i);
+    }
+    return;
+  }
+
+  // the range functions compare the lower bound with valData and the upper bound with valData2
+  void *lo = cunit->valData;
+  void *hi = (cunit->rfunc >= 0) ? cunit->valData2 : cunit->valData;
+
+  switch (cunit->func) {
+    case 1:
+      filterBatchInt8(data, n, res, mode,
+                      (int8_t)(cunit->dataType == TSDB_DATA_TYPE_BOOL ? TSDB_DATA_BOOL_NULL : TSDB_DATA_TINYINT_NULL),
+                      FILTER_BATCH_VAL(int8_t, lo), FILTER_BATCH_VAL(int8_t, hi));
+      break;
+    case 2:
+      filterBatchInt16(data, n, res, mode, (int16_t)TSDB_DATA_SMALLINT_NULL, FILTER_BATCH_VAL(int16_t, lo),
+                       FILTER_BATCH_VAL(int16_t, hi));
+      break;
+    case 0:
+      filterBatchInt32(data, n, res, mode, (int32_t)TSDB_DATA_INT_NULL, FILTER_BATCH_VAL(int32_t, lo),
+                       FILTER_BATCH_VAL(int32_t, hi));
+      break;
+    case 3:
+      filterBatchInt64(data, n, res, mode, (int64_t)TSDB_DATA_BIGINT_NULL, FILTER_BATCH_VAL(int64_t, lo),
+                       FILTER_BATCH_VAL(int64_t, hi));
+      break;
+    case 4:
+      filterBatchFloat(data, n, res, mode, (uint32_t)TSDB_DATA_FLOAT_NULL, FILTER_BATCH_VAL(float, lo),
+                       FILTER_BATCH_VAL(float, hi));
+      break;
+    case 5:
+      filterBatchDouble(data, n, res, mode, (uint64_t)TSDB_DATA_DOUBLE_NULL, FILTER_BATCH_VAL(double, lo),
+                        FILTER_BATCH_VAL(double, hi));
+      break;
+    case 11:
+      filterBatchUint8(data, n, res, mode, (uint8_t)TSDB_DATA_UTINYINT_NULL, FILTER_BATCH_VAL(uint8_t, lo),
+                       FILTER_BATCH_VAL(uint8_t, hi));
+      break;
+    case 12:
+      filterBatchUint16(data, n, res, mode, (uint16_t)TSDB_DATA_USMALLINT_NULL, FILTER_BATCH_VAL(uint16_t, lo),
+                        FILTER_BATCH_VAL(uint16_t, hi));
+      break;
+    case 13:
+      filterBatchUint32(data, n, res, mode, (uint32_t)TSDB_DATA_UINT_NULL, FILTER_BATCH_VAL(uint32_t, lo),
+                        FILTER_BATCH_VAL(uint32_t, hi));
+      break;
+    default:
+      filterBatchUint64(data, n, res, mode, (uint64_t)TSDB_DATA_UBIGINT_NULL, FILTER_BATCH_VAL(uint64_t, lo),
+                        FILTER_BATCH_VAL(uint64_t, hi));
+      break;
+  }
+}
+
+// Pack 64 bytes of 0/1 into a bitmap word
+static FORCE_INLINE uint64_t filterBatchPack(const uint8_t *res) {
+  uint64_t w = 0;
+#if defined(__SSE2__)
+  __m128i zero = _mm_setzero_si128();
+  for (int32_t k = 0; k < 4; ++k) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(res + k * 16));
+    w |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_sub_epi8(zero, x)) << (k * 16);
+  }
+#else
+  for (int32_t k = 0; k < 64; ++k) {
+    w |= (uint64_t)res[k] << k;
+  }
+#endif
+  return w;
+}
+
+// Evaluate rows [start, start + n) into bits, with the groups left by filterRmUnitByRange if blk is set
+static void filterBatchExecChunk(SFilterInfo *info, bool blk, int32_t start, int32_t n, uint64_t *bits) {
+  uint8_t  res[FILTER_BATCH_ROWS];
+  uint64_t gbits[FILTER_BITS_WORDS(FILTER_BATCH_ROWS)];
+  int32_t  words = FILTER_BITS_WORDS(n);
+  uint64_t lastMask = (n & 63) ? ((1ULL << (n & 63)) - 1) : UINT64_MAX;
+  uint32_t groupNum = blk ? info->blkGroupNum : info->groupNum;
+  uint32_t *unitIdx = info->blkUnits;
+
+  memset(bits, 0, words * sizeof(uint64_t));
+  memset(res + n, 0, words * 64 - n);
+
+  for (uint32_t g = 0; g < groupNum; ++g) {
+    uint32_t  unitNum = 0;
+    uint32_t *unitIdxs = NULL;
+    if (blk) {
+      unitNum = *(unitIdx++);
+      unitIdxs = unitIdx;
+      unitIdx += unitNum;
+    } else {
+      unitNum = info->groups[g].unitNum;
+      unitIdxs = info->groups[g].unitIdxs;
+    }
+
+    for (uint32_t u = 0; u < unitNum; ++u) {
+      filterBatchUnitRows(&info->cunits[unitIdxs[u]], start, n, res);
+
+      uint64_t any = 0;
+      for (int32_t w = 0; w < words; ++w) {
+        uint64_t m = filterBatchPack(res + w * 64);
+        gbits[w] = (u == 0) ? m : (gbits[w] & m);
+        any |= gbits[w];
+      }
+
+      // no row of the chunk can satisfy the group any more
+      if (any == 0) {
+        break;
+      }
+    }
+
+    uint64_t all = UINT64_MAX;
+    for (int32_t w = 0; w < words; ++w) {
+      bits[w] |= gbits[w];
+      all &= (w == words - 1) ? (bits[w] | ~lastMask) : bits[w];
+    }
+
+    // all rows of the chunk are selected, the remaining groups are skipped
+    if (all == UINT64_MAX) {
+      break;
+    }
+  }
+}
+
+// The json units are still evaluated row by row, the result is converted to the bitmap
+static bool filterExecuteBatchByRow(SFilterInfo *info, int32_t numOfRows, uint64_t** pBits, SDataStatis *statis, int16_t numOfCols) {
+  int8_t *p = NULL;
+  bool all = filterExecute(info, numOfRows, &p, statis, numOfCols);
+
+  if (p != NULL) {
+    if (*pBits == NULL) {
+      *pBits = calloc(FILTER_BITS_WORDS(numOfRows), sizeof(uint64_t));
+    }
+
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      (*pBits)[i >> 6] |= (uint64_t)(p[i] != 0) << (i & 63);
+    }
+    tfree(p);
+  }
+
+  return all;
+}
+
+bool filterExecuteBatch(SFilterInfo *info, int32_t numOfRows, uint64_t** pBits, SDataStatis *statis, int16_t numOfCols) {
+  if (FILTER_ALL_RES(info)) {
+    return true;
+  }
+
+  if (FILTER_EMPTY_RES(info)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < info->unitNum; ++i) {
+    if (info->cunits[i].dataType == TSDB_DATA_TYPE_JSON) {
+      return filterExecuteBatchByRow(info, numOfRows, pBits, statis, numOfCols);
+    }
+  }
+
+  bool blk = false;
+  if (statis && numOfRows >= FILTER_RM_UNIT_MIN_ROWS) {
+    info->blkFlag = 0;
+
+    filterRmUnitByRange(info, statis, numOfCols, numOfRows);
+
+    uint8_t blkFlag = info->blkFlag;
+    info->blkFlag = 0;
+
+    if (FILTER_GET_FLAG(blkFlag, FI_STATUS_BLK_ALL)) {
+      return true;
+    } else if (FILTER_GET_FLAG(blkFlag, FI_STATUS_BLK_EMPTY)) {
+      return false;
+    }
+
+    blk = (blkFlag != 0);
+  }
+
+  int32_t words = FILTER_BITS_WORDS(numOfRows);
+  if (*pBits == NULL) {
+    *pBits = calloc(words, sizeof(uint64_t));
+  }
+
+  for (int32_t start = 0; start < numOfRows; start += FILTER_BATCH_ROWS) {
+    int32_t n = MIN(FILTER_BATCH_ROWS, numOfRows - start);
+    filterBatchExecChunk(info, blk, start, n, *pBits + start / 64);
+  }
+
+  bool all = true;
+  for (int32_t w = 0; w < words && all; ++w) {
+    uint64_t mask = (w == words - 1 && (numOfRows & 63)) ? ((1ULL << (numOfRows & 63)) - 1) : UINT64_MAX;
+    all = (((*pBits)[w] & mask) == mask);
+  }
+
+  return all;
+}
+
 int32_t filterSetExecFunc(SFilterInfo *info) {
   if (FILTER_ALL_RES(info)) {
     info->func = filterExecuteImplAll;
@@ -3498,6 +3876,205 @@ bool filterRangeExecute(SFilterInfo *info, SDataStatis *pDataStatis, int32_t num
 }
 
 
+// A data block can be skipped only if each group has an equal unit whose value is not in the bloom filter of the block
+bool filterBloomExecute(SFilterInfo *info, void *param, filer_check_bloom_func fp) {
+  if (FILTER_EMPTY_RES(info)) {
+    return false;
+  }
+
+  if (FILTER_ALL_RES(info) || info->groupNum == 0) {
+    return true;
+  }
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+    bool          groupRes = true;
+
+    for (uint32_t u = 0; u < group->unitNum; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+      if (cunit->optr != TSDB_RELATION_EQUAL || cunit->valData == NULL || cunit->dataType == TSDB_DATA_TYPE_JSON) {
+        continue;
+      }
+
+      // the callback returns true for the types without bloom filter
+      if (!(*fp)(param, (int16_t)cunit->colId, (int8_t)cunit->dataType, cunit->valData)) {
+        groupRes = false;
+        break;
+      }
+    }
+
+    if (groupRes) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// The bitmap of the equal or in unit, or NULL in pRes if the column has no index
+static int32_t filterIndexUnit(SFilterComUnit *cunit, void *param, filer_get_index_func fp, SBitmap **pRes) {
+  const SBitmap *pBitmap = NULL;
+  *pRes = NULL;
+
+  if (cunit->optr == TSDB_RELATION_EQUAL) {
+    const void *val = IS_VAR_DATA_TYPE(cunit->dataType) ? varDataVal(cunit->valData) : cunit->valData;
+    int32_t     len = IS_VAR_DATA_TYPE(cunit->dataType) ? varDataLen(cunit->valData) : tDataTypes[cunit->dataType].bytes;
+    if (!(*fp)(param, (int16_t)cunit->colId, (int8_t)cunit->dataType, val, len, &pBitmap)) {
+      return TSDB_CODE_SUCCESS;
+    }
+
+    *pRes = (pBitmap == NULL) ? tBitmapCreate() : tBitmapDup(pBitmap);
+    return (*pRes == NULL) ? TSDB_CODE_QRY_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+  }
+
+  SHashObj *pSet = cunit->valData;
+  SBitmap  *pUnion = tBitmapCreate();
+  if (pUnion == NULL) return TSDB_CODE_QRY_OUT_OF_MEMORY;
+
+  void *p = taosHashIterate(pSet, NULL);
+  while (p) {
+    void    *key = taosHashGetDataKey(pSet, p);
+    uint32_t len = taosHashGetDataKeyLen(pSet, p);
+    if (!(*fp)(param, (int16_t)cunit->colId, (int8_t)cunit->dataType, key, len, &pBitmap)) {
+      taosHashCancelIterate(pSet, p);
+      tBitmapDestroy(pUnion);
+      return TSDB_CODE_SUCCESS;
+    }
+
+    if (pBitmap != NULL && tBitmapOr(pUnion, pBitmap) < 0) {
+      taosHashCancelIterate(pSet, p);
+      tBitmapDestroy(pUnion);
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+
+    p = taosHashIterate(pSet, p);
+  }
+
+  *pRes = pUnion;
+  return TSDB_CODE_SUCCESS;
+}
+
+// The candidate rows from the inverted indexes of the columns: a group is the intersection of the bitmaps of its equal
+// and in units, and the filter is the union of its groups. The other units are not evaluated, so the caller still
+// executes the filter on the candidates. pRes is NULL if a group has no unit on an indexed column, then all the rows
+// are candidates.
+int32_t filterIndexExecute(SFilterInfo *info, void *param, filer_get_index_func fp, SBitmap **pRes) {
+  *pRes = NULL;
+
+  if (FILTER_EMPTY_RES(info)) {
+    *pRes = tBitmapCreate();
+    return (*pRes == NULL) ? TSDB_CODE_QRY_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+  }
+
+  if (FILTER_ALL_RES(info) || info->groupNum == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SBitmap *pAll = NULL, *pGroup = NULL, *pUnit = NULL;
+  int32_t  code = TSDB_CODE_SUCCESS;
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+
+    for (uint32_t u = 0; u < group->unitNum; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+      if ((cunit->optr != TSDB_RELATION_EQUAL && cunit->optr != TSDB_RELATION_IN) || cunit->valData == NULL ||
+          cunit->dataType == TSDB_DATA_TYPE_JSON) {
+        continue;
+      }
+
+      ERR_JRET(filterIndexUnit(cunit, param, fp, &pUnit));
+      if (pUnit == NULL) {
+        continue;
+      }
+
+      if (pGroup == NULL) {
+        pGroup = pUnit;
+      } else {
+        int32_t ret = tBitmapAnd(pGroup, pUnit);
+        tBitmapDestroy(pUnit);
+        CHK_JMP(ret < 0);
+      }
+      pUnit = NULL;
+
+      if (tBitmapCardinality(pGroup) == 0) {
+        break;
+      }
+    }
+
+    if (pGroup == NULL) {
+      qDebug("group %u has no indexed unit, all rows are candidates", g);
+      tBitmapDestroy(pAll);
+      return TSDB_CODE_SUCCESS;
+    }
+
+    if (pAll == NULL) {
+      pAll = pGroup;
+    } else {
+      int32_t ret = tBitmapOr(pAll, pGroup);
+      tBitmapDestroy(pGroup);
+      CHK_JMP(ret < 0);
+    }
+    pGroup = NULL;
+  }
+
+  *pRes = pAll;
+  return TSDB_CODE_SUCCESS;
+
+_return:
+  tBitmapDestroy(pGroup);
+  tBitmapDestroy(pAll);
+  return (code != TSDB_CODE_SUCCESS) ? code : TSDB_CODE_QRY_OUT_OF_MEMORY;
+}
+
+// A data block can also be skipped if each group has an equal or in unit on a dictionary encoded column that none of
+// the distinct values of the column satisfies, the values are compared instead of the rows
+bool filterDictExecute(SFilterInfo *info, void *param, filer_get_dict_func fp) {
+  if (FILTER_EMPTY_RES(info)) {
+    return false;
+  }
+
+  if (FILTER_ALL_RES(info) || info->groupNum == 0) {
+    return true;
+  }
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+    bool          groupRes = true;
+
+    for (uint32_t u = 0; u < group->unitNum; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+      if ((cunit->optr != TSDB_RELATION_EQUAL && cunit->optr != TSDB_RELATION_IN) || cunit->valData == NULL ||
+          (cunit->dataType != TSDB_DATA_TYPE_BINARY && cunit->dataType != TSDB_DATA_TYPE_NCHAR)) {
+        continue;
+      }
+
+      const char *pDict = NULL;
+      int32_t     num = (*fp)(param, (int16_t)cunit->colId, &pDict);
+      if (num < 0) {
+        continue;
+      }
+
+      bool unitRes = false;
+      for (int32_t i = 0; i < num && !unitRes; ++i, pDict += varDataTLen(pDict)) {
+        if (!isNull(pDict, cunit->dataType)) {
+          unitRes = filterDoCompare(gDataCompare[cunit->func], cunit->optr, (void *)pDict, cunit->valData);
+        }
+      }
+
+      if (!unitRes) {
+        groupRes = false;
+        break;
+      }
+    }
+
+    if (groupRes) {
+      return true;
+    }
+  }
+
+  return false;
+}
 
 int32_t filterGetTimeRange(SFilterInfo *info, STimeWindow       *win) {
   SFilterRange ra = {0};
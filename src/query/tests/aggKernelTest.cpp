@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iostream>
+
+#include "os.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "ttype.h"
+
+#include "qAggKernel.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+const int32_t numericTypes[] = {TSDB_DATA_TYPE_TINYINT,  TSDB_DATA_TYPE_SMALLINT,  TSDB_DATA_TYPE_INT,
+                                TSDB_DATA_TYPE_BIGINT,   TSDB_DATA_TYPE_UTINYINT,  TSDB_DATA_TYPE_USMALLINT,
+                                TSDB_DATA_TYPE_UINT,     TSDB_DATA_TYPE_UBIGINT,   TSDB_DATA_TYPE_FLOAT,
+                                TSDB_DATA_TYPE_DOUBLE};
+
+const int32_t sizes[] = {0, 1, 7, 1023, 1024, 1025, 3000};
+
+// values in a small range, so that the min and max values appear several times
+void genColumn(char *pData, int32_t type, int32_t numOfRows, int32_t nullRatio) {
+  int32_t bytes = tDataTypes[type].bytes;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char *p = pData + i * bytes;
+    if (nullRatio > 0 && rand() % 100 < nullRatio) {
+      setNull(p, type, bytes);
+      continue;
+    }
+
+    int64_t v = rand() % 100 - (IS_UNSIGNED_NUMERIC_TYPE(type) ? 0 : 50);
+    switch (type) {
+      case TSDB_DATA_TYPE_TINYINT:   *(int8_t *)p = (int8_t)v; break;
+      case TSDB_DATA_TYPE_SMALLINT:  *(int16_t *)p = (int16_t)(v * 300); break;
+      case TSDB_DATA_TYPE_INT:       *(int32_t *)p = (int32_t)(v * 100000); break;
+      case TSDB_DATA_TYPE_BIGINT:    *(int64_t *)p = v * 10000000000L; break;
+      case TSDB_DATA_TYPE_UTINYINT:  *(uint8_t *)p = (uint8_t)v; break;
+      case TSDB_DATA_TYPE_USMALLINT: *(uint16_t *)p = (uint16_t)(v * 300); break;
+      case TSDB_DATA_TYPE_UINT:      *(uint32_t *)p = (uint32_t)(v * 100000); break;
+      case TSDB_DATA_TYPE_UBIGINT:   *(uint64_t *)p = (uint64_t)v * 10000000000L; break;
+      case TSDB_DATA_TYPE_FLOAT:     *(float *)p = (float)v / 4; break;
+      case TSDB_DATA_TYPE_DOUBLE:    *(double *)p = (double)v / 8; break;
+    }
+  }
+}
+
+double getValue(const char *p, int32_t type) {
+  double v = 0;
+  GET_TYPED_DATA(v, double, type, p);
+  return v;
+}
+
+// row by row reference of the kernels
+void checkColumn(const char *pData, int32_t type, int32_t numOfRows, bool hasNull) {
+  int32_t bytes = tDataTypes[type].bytes;
+
+  int32_t  count = 0;
+  int64_t  isum = 0;
+  uint64_t usum = 0;
+  double   dsum = 0;
+  int32_t  minIndex = -1, maxIndex = -1;
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    const char *p = pData + i * bytes;
+    if (isNull(p, type)) {
+      continue;
+    }
+
+    count++;
+    double v = getValue(p, type);
+    dsum += v;
+    if (IS_SIGNED_NUMERIC_TYPE(type)) {
+      int64_t iv = 0;
+      GET_TYPED_DATA(iv, int64_t, type, p);
+      isum += iv;
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+      uint64_t uv = 0;
+      GET_TYPED_DATA(uv, uint64_t, type, p);
+      usum += uv;
+    }
+
+    if (minIndex < 0 || v <= getValue(pData + minIndex * bytes, type)) minIndex = i;
+    if (maxIndex < 0 || v > getValue(pData + maxIndex * bytes, type)) maxIndex = i;
+  }
+
+  if (hasNull) {
+    ASSERT_EQ(aggCountNotNull(pData, type, numOfRows), count);
+  }
+
+  double dres = 0;
+  ASSERT_EQ(aggSumDouble(pData, type, numOfRows, hasNull, &dres), count);
+  ASSERT_NEAR(dres, dsum, fabs(dsum) * 1e-12 + 1e-9);
+
+  if (IS_SIGNED_NUMERIC_TYPE(type)) {
+    int64_t ires = 0;
+    ASSERT_EQ(aggSumSigned(pData, type, numOfRows, hasNull, &ires), count);
+    ASSERT_EQ(ires, isum);
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(type)) {
+    uint64_t ures = 0;
+    ASSERT_EQ(aggSumUnsigned(pData, type, numOfRows, hasNull, &ures), count);
+    ASSERT_EQ(ures, usum);
+  }
+
+  int64_t val[1] = {0};
+  int32_t index = -1;
+  ASSERT_EQ(aggMinMax(pData, type, numOfRows, hasNull, true, (char *)val, &index), count);
+  ASSERT_EQ(index, minIndex);
+  if (index >= 0) {
+    ASSERT_EQ(memcmp(val, pData + index * bytes, bytes), 0);
+  }
+
+  ASSERT_EQ(aggMinMax(pData, type, numOfRows, hasNull, false, (char *)val, &index), count);
+  ASSERT_EQ(index, maxIndex);
+  if (index >= 0) {
+    ASSERT_EQ(memcmp(val, pData + index * bytes, bytes), 0);
+  }
+}
+
+}  // namespace
+
+TEST(testCase, aggKernelNoNullTest) {
+  char *pData = (char *)malloc(3000 * sizeof(int64_t));
+  for (int32_t t = 0; t < tListLen(numericTypes); ++t) {
+    for (int32_t s = 0; s < tListLen(sizes); ++s) {
+      genColumn(pData, numericTypes[t], sizes[s], 0);
+      checkColumn(pData, numericTypes[t], sizes[s], false);
+      checkColumn(pData, numericTypes[t], sizes[s], true);
+    }
+  }
+  free(pData);
+}
+
+TEST(testCase, aggKernelNullTest) {
+  char *pData = (char *)malloc(3000 * sizeof(int64_t));
+  int32_t nullRatios[] = {1, 30, 100};
+  for (int32_t t = 0; t < tListLen(numericTypes); ++t) {
+    for (int32_t s = 0; s < tListLen(sizes); ++s) {
+      for (int32_t r = 0; r < tListLen(nullRatios); ++r) {
+        genColumn(pData, numericTypes[t], sizes[s], nullRatios[r]);
+        checkColumn(pData, numericTypes[t], sizes[s], true);
+      }
+    }
+  }
+  free(pData);
+}
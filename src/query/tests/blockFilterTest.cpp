@@ -0,0 +1,280 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "os.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+// column 1 is an int column, column 2 a binary column
+const int16_t intColId = 1;
+const int16_t binColId = 2;
+
+// values of a file block, as the bloom filters of the block without false positives
+struct SBlockValues {
+  std::set<int64_t>     ints;
+  std::set<std::string> strs;
+  int32_t               numOfChecks;
+};
+
+bool checkBloom(void *param, int16_t colId, int8_t type, const void *pVal) {
+  SBlockValues *pBlock = (SBlockValues *)param;
+  pBlock->numOfChecks++;
+
+  if (colId == intColId) {
+    int64_t v = 0;
+    GET_TYPED_DATA(v, int64_t, type, (void *)pVal);
+    return pBlock->ints.count(v) > 0;
+  }
+
+  if (colId == binColId) {
+    return pBlock->strs.count(std::string((const char *)varDataVal(pVal), varDataLen(pVal))) > 0;
+  }
+
+  return true;
+}
+
+// dictionary of the binary column of the block, the values of the block in order and a null if hasNull, or not
+// dictionary encoded if the block has no string
+struct SBlockDict {
+  SBlockValues *pBlock;
+  bool          hasNull;
+  std::string   dict;
+};
+
+int32_t getDict(void *param, int16_t colId, const char **ppDict) {
+  SBlockDict *pDict = (SBlockDict *)param;
+  pDict->pBlock->numOfChecks++;
+
+  if (colId != binColId || pDict->pBlock->strs.empty()) {
+    return -1;
+  }
+
+  pDict->dict.clear();
+  for (std::set<std::string>::iterator it = pDict->pBlock->strs.begin(); it != pDict->pBlock->strs.end(); ++it) {
+    VarDataLenT len = (VarDataLenT)it->size();
+    pDict->dict.append((const char *)&len, VARSTR_HEADER_SIZE);
+    pDict->dict.append(*it);
+  }
+  if (pDict->hasNull) {
+    VarDataLenT len = 1;
+    pDict->dict.append((const char *)&len, VARSTR_HEADER_SIZE);
+    pDict->dict.append(1, (char)TSDB_DATA_BINARY_NULL);
+  }
+
+  *ppDict = pDict->dict.data();
+  return (int32_t)pDict->pBlock->strs.size() + (pDict->hasNull ? 1 : 0);
+}
+
+tExprNode *colNode(int16_t colId) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  pNode->pSchema->colId = colId;
+  if (colId == intColId) {
+    pNode->pSchema->type = TSDB_DATA_TYPE_INT;
+    pNode->pSchema->bytes = sizeof(int32_t);
+  } else {
+    pNode->pSchema->type = TSDB_DATA_TYPE_BINARY;
+    pNode->pSchema->bytes = 16 + VARSTR_HEADER_SIZE;
+  }
+  sprintf(pNode->pSchema->name, "c%d", colId);
+  return pNode;
+}
+
+tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+tExprNode *intPredicate(uint8_t optr, int64_t v) {
+  tExprNode *pVal = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pVal->nodeType = TSQL_NODE_VALUE;
+  pVal->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+  pVal->pVal->i64 = v;
+  return exprNode(optr, colNode(intColId), pVal);
+}
+
+tExprNode *binPredicate(uint8_t optr, const char *s) {
+  tExprNode *pVal = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pVal->nodeType = TSQL_NODE_VALUE;
+  pVal->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pVal->pVal, s, strlen(s), TSDB_DATA_TYPE_BINARY);
+  return exprNode(optr, colNode(binColId), pVal);
+}
+
+SFilterInfo *initFilter(tExprNode *pTree) {
+  SFilterInfo *pInfo = NULL;
+  int32_t      code = filterInitFromTree(pTree, (void **)&pInfo, 0);
+  tExprTreeDestroy(pTree, NULL);
+  EXPECT_EQ(code, TSDB_CODE_SUCCESS);
+  return pInfo;
+}
+
+// whether a block of the values is loaded by the filter of pTree
+bool loadBlock(tExprNode *pTree, SBlockValues *pBlock) {
+  SFilterInfo *pInfo = initFilter(pTree);
+  if (pInfo == NULL) {
+    return true;
+  }
+
+  bool res = filterBloomExecute(pInfo, pBlock, checkBloom);
+  filterFreeInfo(pInfo);
+  return res;
+}
+
+// whether a block of the values is loaded by the filter of pTree checked against the dictionary
+bool loadDictBlock(tExprNode *pTree, SBlockValues *pBlock, bool hasNull) {
+  SFilterInfo *pInfo = initFilter(pTree);
+  if (pInfo == NULL) {
+    return true;
+  }
+
+  SBlockDict dict = {pBlock, hasNull, std::string()};
+  bool       res = filterDictExecute(pInfo, &dict, getDict);
+  filterFreeInfo(pInfo);
+  return res;
+}
+
+SBlockValues newBlock() {
+  SBlockValues block;
+  for (int64_t v = 10; v < 20; ++v) {
+    block.ints.insert(v);
+  }
+  block.strs.insert("ok");
+  block.strs.insert("warn");
+  block.numOfChecks = 0;
+  return block;
+}
+
+}  // namespace
+
+TEST(testCase, blockFilterBloomEqual) {
+  SBlockValues block = newBlock();
+
+  ASSERT_TRUE(loadBlock(intPredicate(TSDB_RELATION_EQUAL, 15), &block));
+  ASSERT_FALSE(loadBlock(intPredicate(TSDB_RELATION_EQUAL, 25), &block));
+  ASSERT_TRUE(loadBlock(binPredicate(TSDB_RELATION_EQUAL, "warn"), &block));
+  ASSERT_FALSE(loadBlock(binPredicate(TSDB_RELATION_EQUAL, "error"), &block));
+}
+
+TEST(testCase, blockFilterBloomNonEqual) {
+  SBlockValues block = newBlock();
+
+  // only equal conditions are checked by the bloom filters
+  ASSERT_TRUE(loadBlock(intPredicate(TSDB_RELATION_GREATER, 25), &block));
+  ASSERT_TRUE(loadBlock(binPredicate(TSDB_RELATION_NOT_EQUAL, "error"), &block));
+  ASSERT_TRUE(loadBlock(binPredicate(TSDB_RELATION_LIKE, "err%"), &block));
+  ASSERT_EQ(block.numOfChecks, 0);
+}
+
+TEST(testCase, blockFilterBloomGroups) {
+  SBlockValues block = newBlock();
+
+  // AND: one equality ruled out is enough
+  ASSERT_FALSE(loadBlock(
+      exprNode(TSDB_RELATION_AND, intPredicate(TSDB_RELATION_EQUAL, 25), binPredicate(TSDB_RELATION_EQUAL, "ok")),
+      &block));
+  ASSERT_FALSE(loadBlock(
+      exprNode(TSDB_RELATION_AND, binPredicate(TSDB_RELATION_EQUAL, "error"), intPredicate(TSDB_RELATION_GREATER, 5)),
+      &block));
+  ASSERT_TRUE(loadBlock(
+      exprNode(TSDB_RELATION_AND, intPredicate(TSDB_RELATION_EQUAL, 12), binPredicate(TSDB_RELATION_EQUAL, "ok")),
+      &block));
+
+  // OR: every group must have an equality ruled out
+  ASSERT_TRUE(loadBlock(
+      exprNode(TSDB_RELATION_OR, intPredicate(TSDB_RELATION_EQUAL, 25), binPredicate(TSDB_RELATION_EQUAL, "ok")),
+      &block));
+  ASSERT_TRUE(loadBlock(
+      exprNode(TSDB_RELATION_OR, binPredicate(TSDB_RELATION_EQUAL, "error"), intPredicate(TSDB_RELATION_LESS, 5)),
+      &block));
+  ASSERT_FALSE(loadBlock(
+      exprNode(TSDB_RELATION_OR, intPredicate(TSDB_RELATION_EQUAL, 25), binPredicate(TSDB_RELATION_EQUAL, "error")),
+      &block));
+}
+
+TEST(testCase, blockFilterDict) {
+  SBlockValues block = newBlock();
+
+  ASSERT_TRUE(loadDictBlock(binPredicate(TSDB_RELATION_EQUAL, "warn"), &block, false));
+  ASSERT_FALSE(loadDictBlock(binPredicate(TSDB_RELATION_EQUAL, "error"), &block, false));
+  ASSERT_FALSE(loadDictBlock(binPredicate(TSDB_RELATION_EQUAL, "error"), &block, true));
+
+  // only equal conditions on the binary columns are checked by the dictionaries
+  block.numOfChecks = 0;
+  ASSERT_TRUE(loadDictBlock(binPredicate(TSDB_RELATION_NOT_EQUAL, "ok"), &block, false));
+  ASSERT_TRUE(loadDictBlock(binPredicate(TSDB_RELATION_LIKE, "err%"), &block, false));
+  ASSERT_TRUE(loadDictBlock(intPredicate(TSDB_RELATION_EQUAL, 25), &block, false));
+  ASSERT_EQ(block.numOfChecks, 0);
+
+  // the column of the block is not dictionary encoded
+  SBlockValues plain = newBlock();
+  plain.strs.clear();
+  ASSERT_TRUE(loadDictBlock(binPredicate(TSDB_RELATION_EQUAL, "error"), &plain, false));
+  ASSERT_EQ(plain.numOfChecks, 1);
+}
+
+TEST(testCase, blockFilterDictGroups) {
+  SBlockValues block = newBlock();
+
+  // AND: one value not in the dictionary is enough
+  ASSERT_FALSE(loadDictBlock(
+      exprNode(TSDB_RELATION_AND, binPredicate(TSDB_RELATION_EQUAL, "error"), intPredicate(TSDB_RELATION_GREATER, 5)),
+      &block, false));
+  ASSERT_TRUE(loadDictBlock(
+      exprNode(TSDB_RELATION_AND, binPredicate(TSDB_RELATION_EQUAL, "ok"), intPredicate(TSDB_RELATION_EQUAL, 25)),
+      &block, false));
+
+  // OR: every group must have a value not in the dictionary
+  ASSERT_TRUE(loadDictBlock(
+      exprNode(TSDB_RELATION_OR, binPredicate(TSDB_RELATION_EQUAL, "error"), binPredicate(TSDB_RELATION_EQUAL, "ok")),
+      &block, false));
+  ASSERT_TRUE(loadDictBlock(
+      exprNode(TSDB_RELATION_OR, binPredicate(TSDB_RELATION_EQUAL, "error"), intPredicate(TSDB_RELATION_LESS, 5)),
+      &block, false));
+  ASSERT_FALSE(loadDictBlock(
+      exprNode(TSDB_RELATION_OR, binPredicate(TSDB_RELATION_EQUAL, "error"), binPredicate(TSDB_RELATION_EQUAL, "fatal")),
+      &block, true));
+}
+
+TEST(testCase, blockFilterStatis) {
+  SDataStatis statis = {0};
+  statis.colId = intColId;
+  statis.min = 10;
+  statis.max = 19;
+
+  SFilterInfo *pInfo = initFilter(intPredicate(TSDB_RELATION_GREATER, 25));
+  ASSERT_NE(pInfo, (SFilterInfo *)NULL);
+  ASSERT_FALSE(filterRangeExecute(pInfo, &statis, 1, 100));
+  filterFreeInfo(pInfo);
+
+  pInfo = initFilter(intPredicate(TSDB_RELATION_GREATER, 15));
+  ASSERT_TRUE(filterRangeExecute(pInfo, &statis, 1, 100));
+  filterFreeInfo(pInfo);
+
+  // all the values of the block are null
+  statis.numOfNull = 100;
+  pInfo = initFilter(intPredicate(TSDB_RELATION_GREATER, 15));
+  ASSERT_FALSE(filterRangeExecute(pInfo, &statis, 1, 100));
+  filterFreeInfo(pInfo);
+
+  pInfo = initFilter(exprNode(TSDB_RELATION_ISNULL, colNode(intColId), NULL));
+  ASSERT_TRUE(filterRangeExecute(pInfo, &statis, 1, 100));
+  filterFreeInfo(pInfo);
+}
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <utility>
+
+#include "os.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+const int32_t numOfCols = 11;
+const uint8_t colTypes[numOfCols] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_BOOL,     TSDB_DATA_TYPE_TINYINT,
+                                     TSDB_DATA_TYPE_SMALLINT,  TSDB_DATA_TYPE_INT,      TSDB_DATA_TYPE_BIGINT,
+                                     TSDB_DATA_TYPE_FLOAT,     TSDB_DATA_TYPE_DOUBLE,   TSDB_DATA_TYPE_UINT,
+                                     TSDB_DATA_TYPE_UBIGINT,   TSDB_DATA_TYPE_BINARY};
+const int32_t binaryBytes = 16 + VARSTR_HEADER_SIZE;
+
+struct SColumns {
+  int32_t numOfRows;
+  char   *data[numOfCols];
+};
+
+int32_t getColBytes(int32_t i) {
+  return colTypes[i] == TSDB_DATA_TYPE_BINARY ? binaryBytes : tDataTypes[colTypes[i]].bytes;
+}
+
+int32_t getColData(void *param, int32_t colId, void **data) {
+  SColumns *pCols = (SColumns *)param;
+  *data = pCols->data[colId - 1];
+  return TSDB_CODE_SUCCESS;
+}
+
+// values in [-50, 50) with about 10% null values
+void genColumns(SColumns *pCols, int32_t numOfRows) {
+  pCols->numOfRows = numOfRows;
+  for (int32_t c = 0; c < numOfCols; ++c) {
+    int32_t bytes = getColBytes(c);
+    pCols->data[c] = (char *)calloc(numOfRows, bytes);
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      char *p = pCols->data[c] + bytes * i;
+      if (c > 0 && rand() % 10 == 0) {
+        setNull(p, colTypes[c], bytes);
+        continue;
+      }
+
+      int32_t v = rand() % 100 - 50;
+      switch (colTypes[c]) {
+        case TSDB_DATA_TYPE_TIMESTAMP: *(int64_t *)p = 1600000000000L + i; break;
+        case TSDB_DATA_TYPE_BOOL:      *(int8_t *)p = (v > 0); break;
+        case TSDB_DATA_TYPE_TINYINT:   *(int8_t *)p = (int8_t)v; break;
+        case TSDB_DATA_TYPE_SMALLINT:  *(int16_t *)p = (int16_t)v; break;
+        case TSDB_DATA_TYPE_INT:       *(int32_t *)p = v; break;
+        case TSDB_DATA_TYPE_BIGINT:    *(int64_t *)p = v; break;
+        case TSDB_DATA_TYPE_FLOAT:     *(float *)p = v / 4.0f; break;
+        case TSDB_DATA_TYPE_DOUBLE:    *(double *)p = v / 4.0; break;
+        case TSDB_DATA_TYPE_UINT:      *(uint32_t *)p = (uint32_t)(v + 50); break;
+        case TSDB_DATA_TYPE_UBIGINT:   *(uint64_t *)p = (uint64_t)(v + 50); break;
+        default: {
+          int32_t len = sprintf((char *)varDataVal(p), "s%d", v + 50);
+          varDataSetLen(p, len);
+          break;
+        }
+      }
+    }
+  }
+}
+
+void freeColumns(SColumns *pCols) {
+  for (int32_t c = 0; c < numOfCols; ++c) {
+    free(pCols->data[c]);
+  }
+}
+
+tExprNode *colNode(int32_t c) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  pNode->pSchema->type = colTypes[c];
+  pNode->pSchema->bytes = getColBytes(c);
+  pNode->pSchema->colId = c + 1;
+  sprintf(pNode->pSchema->name, "c%d", c);
+  return pNode;
+}
+
+tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+// column c compared with a random constant of the column range
+tExprNode *randPredicate(int32_t c) {
+  static const uint8_t optrs[] = {TSDB_RELATION_LESS,          TSDB_RELATION_GREATER,       TSDB_RELATION_EQUAL,
+                                  TSDB_RELATION_LESS_EQUAL,    TSDB_RELATION_GREATER_EQUAL, TSDB_RELATION_NOT_EQUAL,
+                                  TSDB_RELATION_ISNULL,        TSDB_RELATION_NOTNULL};
+  uint8_t optr = optrs[rand() % tListLen(optrs)];
+
+  if (optr == TSDB_RELATION_ISNULL || optr == TSDB_RELATION_NOTNULL) {
+    return exprNode(optr, colNode(c), NULL);
+  }
+
+  // the range merge only accepts != on bool columns
+  if (optr == TSDB_RELATION_NOT_EQUAL && colTypes[c] != TSDB_DATA_TYPE_BOOL && colTypes[c] != TSDB_DATA_TYPE_BINARY) {
+    optr = TSDB_RELATION_EQUAL;
+  }
+
+  tExprNode *pVal = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pVal->nodeType = TSQL_NODE_VALUE;
+  pVal->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+
+  int32_t v = rand() % 100 - 50;
+  switch (colTypes[c]) {
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+      pVal->pVal->i64 = 1600000000000L + rand() % 5000;
+      break;
+    case TSDB_DATA_TYPE_BOOL:
+      pVal->pVal->nType = TSDB_DATA_TYPE_BOOL;
+      pVal->pVal->i64 = rand() % 2;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+    case TSDB_DATA_TYPE_DOUBLE:
+      pVal->pVal->nType = TSDB_DATA_TYPE_DOUBLE;
+      pVal->pVal->dKey = v / 4.0;
+      break;
+    case TSDB_DATA_TYPE_UINT:
+    case TSDB_DATA_TYPE_UBIGINT:
+      pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+      pVal->pVal->i64 = v + 50;
+      break;
+    case TSDB_DATA_TYPE_BINARY: {
+      char buf[16];
+      int32_t k = rand() % 4;
+      if (k == 0) {
+        optr = TSDB_RELATION_LIKE;
+        sprintf(buf, "s%d%%", rand() % 10);
+      } else if (k == 1) {
+        optr = (rand() % 2) ? TSDB_RELATION_MATCH : TSDB_RELATION_NMATCH;
+        sprintf(buf, "^s[%d-%d]", rand() % 5, 5 + rand() % 5);
+      } else {
+        sprintf(buf, "s%d", v + 50);
+      }
+      tVariantCreateFromBinary(pVal->pVal, buf, strlen(buf), TSDB_DATA_TYPE_BINARY);
+      break;
+    }
+    default:
+      pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+      pVal->pVal->i64 = v;
+      break;
+  }
+
+  return exprNode(optr, colNode(c), pVal);
+}
+
+// an expression of numOfPredicates predicates on different columns combined randomly by AND and OR
+tExprNode *randTree(int32_t numOfPredicates) {
+  int32_t cols[numOfCols];
+  for (int32_t c = 0; c < numOfCols; ++c) {
+    cols[c] = c;
+  }
+  for (int32_t c = numOfCols - 1; c > 0; --c) {
+    std::swap(cols[c], cols[rand() % (c + 1)]);
+  }
+
+  tExprNode *pTree = randPredicate(cols[0]);
+  for (int32_t i = 1; i < numOfPredicates; ++i) {
+    uint8_t optr = (rand() % 3 == 0) ? TSDB_RELATION_OR : TSDB_RELATION_AND;
+    pTree = exprNode(optr, pTree, randPredicate(cols[i % numOfCols]));
+  }
+  return pTree;
+}
+
+void checkFilter(tExprNode *pTree, SColumns *pCols, int32_t numOfRows) {
+  SFilterInfo *pInfo = NULL;
+  ASSERT_EQ(filterInitFromTree(pTree, (void **)&pInfo, 0), TSDB_CODE_SUCCESS);
+  tExprTreeDestroy(pTree, NULL);
+
+  // the filter is always true
+  if (pInfo == NULL) {
+    return;
+  }
+
+  filterSetColFieldData(pInfo, pCols, getColData);
+
+  int8_t   *p = NULL;
+  uint64_t *pBits = NULL;
+  bool      all = filterExecute(pInfo, numOfRows, &p, NULL, 0);
+  bool      allBatch = filterExecuteBatch(pInfo, numOfRows, &pBits, NULL, 0);
+
+  ASSERT_EQ(all, allBatch);
+  ASSERT_EQ(p == NULL, pBits == NULL);
+  for (int32_t i = 0; p != NULL && i < numOfRows; ++i) {
+    ASSERT_EQ(p[i] != 0, FILTER_BIT_GET(pBits, i) != 0) << "row " << i;
+  }
+  for (int32_t i = numOfRows; pBits != NULL && i < FILTER_BITS_WORDS(numOfRows) * 64; ++i) {
+    ASSERT_EQ(FILTER_BIT_GET(pBits, i), 0);
+  }
+
+  tfree(p);
+  tfree(pBits);
+  filterFreeInfo(pInfo);
+}
+
+}  // namespace
+
+TEST(testCase, filterBatchSinglePredicate) {
+  SColumns cols = {0};
+  srand(1);
+  genColumns(&cols, 3000);
+
+  for (int32_t c = 0; c < numOfCols; ++c) {
+    for (int32_t k = 0; k < 30; ++k) {
+      checkFilter(randPredicate(c), &cols, 3000);
+    }
+  }
+
+  freeColumns(&cols);
+}
+
+TEST(testCase, filterBatchGroups) {
+  SColumns cols = {0};
+  srand(2);
+  genColumns(&cols, 4099);
+
+  int32_t numOfPredicates[] = {2, 3, 5, 10};
+  int32_t numOfRows[] = {1, 63, 64, 65, 1024, 1500, 4099};
+  for (int32_t n = 0; n < tListLen(numOfPredicates); ++n) {
+    for (int32_t r = 0; r < tListLen(numOfRows); ++r) {
+      for (int32_t k = 0; k < 20; ++k) {
+        checkFilter(randTree(numOfPredicates[n]), &cols, numOfRows[r]);
+      }
+    }
+  }
+
+  freeColumns(&cols);
+}
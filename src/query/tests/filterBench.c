@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "tutil.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+
+// columns: ts, int, bigint, double, float, smallint
+#define BENCH_COLS 6
+
+static const uint8_t colTypes[BENCH_COLS] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT,   TSDB_DATA_TYPE_BIGINT,
+                                             TSDB_DATA_TYPE_DOUBLE,    TSDB_DATA_TYPE_FLOAT, TSDB_DATA_TYPE_SMALLINT};
+
+static int32_t getColData(void *param, int32_t colId, void **data) {
+  *data = ((char **)param)[colId - 1];
+  return TSDB_CODE_SUCCESS;
+}
+
+static tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+// column c compared with the constant v
+static tExprNode *predicate(int32_t c, uint8_t optr, double v) {
+  tExprNode *pCol = calloc(1, sizeof(tExprNode));
+  pCol->nodeType = TSQL_NODE_COL;
+  pCol->pSchema = calloc(1, sizeof(SSchema));
+  pCol->pSchema->type = colTypes[c];
+  pCol->pSchema->bytes = tDataTypes[colTypes[c]].bytes;
+  pCol->pSchema->colId = c + 1;
+  sprintf(pCol->pSchema->name, "c%d", c);
+
+  tExprNode *pVal = calloc(1, sizeof(tExprNode));
+  pVal->nodeType = TSQL_NODE_VALUE;
+  pVal->pVal = calloc(1, sizeof(tVariant));
+  if (IS_FLOAT_TYPE(colTypes[c])) {
+    pVal->pVal->nType = TSDB_DATA_TYPE_DOUBLE;
+    pVal->pVal->dKey = v;
+  } else {
+    pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+    pVal->pVal->i64 = (int64_t)v;
+  }
+
+  return exprNode(optr, pCol, pVal);
+}
+
+// 1:  a > 500
+// 3:  a > 500 and b < 800 and c >= -0.5
+// 10: (a > 100 and b < 900 and c > -0.9 and d < 0.9 and e >= 16) or
+//     (a < 50 and b >= 950 and ts > 1600000000000 and d >= 0.25 and e > 2000)
+static tExprNode *benchTree(int32_t numOfPredicates) {
+  if (numOfPredicates == 1) {
+    return predicate(1, TSDB_RELATION_GREATER, 500);
+  }
+
+  if (numOfPredicates == 3) {
+    tExprNode *pTree = exprNode(TSDB_RELATION_AND, predicate(1, TSDB_RELATION_GREATER, 500),
+                                predicate(2, TSDB_RELATION_LESS, 800));
+    return exprNode(TSDB_RELATION_AND, pTree, predicate(3, TSDB_RELATION_GREATER_EQUAL, -0.5));
+  }
+
+  tExprNode *pLeft = predicate(1, TSDB_RELATION_GREATER, 100);
+  pLeft = exprNode(TSDB_RELATION_AND, pLeft, predicate(2, TSDB_RELATION_LESS, 900));
+  pLeft = exprNode(TSDB_RELATION_AND, pLeft, predicate(3, TSDB_RELATION_GREATER, -0.9));
+  pLeft = exprNode(TSDB_RELATION_AND, pLeft, predicate(4, TSDB_RELATION_LESS, 0.9));
+  pLeft = exprNode(TSDB_RELATION_AND, pLeft, predicate(5, TSDB_RELATION_GREATER_EQUAL, 16));
+
+  tExprNode *pRight = predicate(1, TSDB_RELATION_LESS, 50);
+  pRight = exprNode(TSDB_RELATION_AND, pRight, predicate(2, TSDB_RELATION_GREATER_EQUAL, 950));
+  pRight = exprNode(TSDB_RELATION_AND, pRight, predicate(0, TSDB_RELATION_GREATER, 1600000000000.0));
+  pRight = exprNode(TSDB_RELATION_AND, pRight, predicate(4, TSDB_RELATION_GREATER_EQUAL, 0.25));
+  pRight = exprNode(TSDB_RELATION_AND, pRight, predicate(5, TSDB_RELATION_GREATER, 2000));
+
+  return exprNode(TSDB_RELATION_OR, pLeft, pRight);
+}
+
+static void runBench(int32_t numOfPredicates, char **cols, int32_t numOfRows, int32_t blockRows, int32_t loops) {
+  SFilterInfo *pInfo = NULL;
+  tExprNode   *pTree = benchTree(numOfPredicates);
+  if (filterInitFromTree(pTree, (void **)&pInfo, 0) != TSDB_CODE_SUCCESS) {
+    printf("failed to init the filter of %d predicates\n", numOfPredicates);
+    exit(1);
+  }
+  tExprTreeDestroy(pTree, NULL);
+
+  int64_t rowUs = 0, batchUs = 0, selected = 0;
+  char   *blockCols[BENCH_COLS];
+
+  for (int32_t l = 0; l < loops; ++l) {
+    for (int32_t start = 0; start < numOfRows; start += blockRows) {
+      int32_t rows = MIN(blockRows, numOfRows - start);
+      for (int32_t c = 0; c < BENCH_COLS; ++c) {
+        blockCols[c] = cols[c] + (int64_t)tDataTypes[colTypes[c]].bytes * start;
+      }
+      filterSetColFieldData(pInfo, blockCols, getColData);
+
+      int8_t   *p = NULL;
+      uint64_t *pBits = NULL;
+
+      int64_t st = taosGetTimestampUs();
+      bool    all = filterExecute(pInfo, rows, &p, NULL, 0);
+      int64_t mid = taosGetTimestampUs();
+      bool    allBatch = filterExecuteBatch(pInfo, rows, &pBits, NULL, 0);
+      int64_t et = taosGetTimestampUs();
+
+      rowUs += mid - st;
+      batchUs += et - mid;
+
+      if (all != allBatch || (p == NULL) != (pBits == NULL)) {
+        printf("%d predicates: result mismatch at block %d\n", numOfPredicates, start);
+        exit(1);
+      }
+      for (int32_t i = 0; p != NULL && i < rows; ++i) {
+        if ((p[i] != 0) != (FILTER_BIT_GET(pBits, i) != 0)) {
+          printf("%d predicates: result mismatch at row %d\n", numOfPredicates, start + i);
+          exit(1);
+        }
+        selected += (p[i] != 0);
+      }
+
+      tfree(p);
+      tfree(pBits);
+    }
+  }
+
+  int64_t total = (int64_t)numOfRows * loops;
+  printf("predicates:%3d  selectivity:%6.2f%%  row:%8.3f ns/row  batch:%8.3f ns/row  speedup:%6.2fx\n",
+         numOfPredicates, selected * 100.0 / total, rowUs * 1000.0 / total, batchUs * 1000.0 / total,
+         (double)rowUs / (batchUs > 0 ? batchUs : 1));
+
+  filterFreeInfo(pInfo);
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfRows = 1000000;
+  int32_t blockRows = 4096;
+  int32_t loops = 5;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-b") == 0 && i < argc - 1) {
+      blockRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-n]: number of rows, default: %d\n", numOfRows);
+      printf("  [-b]: number of rows of each block, default: %d\n", blockRows);
+      printf("  [-l]: number of loops, default: %d\n", loops);
+      exit(0);
+    }
+  }
+
+  // about 2% null values in each column except the timestamp
+  char *cols[BENCH_COLS];
+  for (int32_t c = 0; c < BENCH_COLS; ++c) {
+    int32_t bytes = tDataTypes[colTypes[c]].bytes;
+    cols[c] = malloc((int64_t)bytes * numOfRows);
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      char *p = cols[c] + (int64_t)bytes * i;
+      if (c > 0 && rand() % 50 == 0) {
+        setNull(p, colTypes[c], bytes);
+        continue;
+      }
+
+      switch (colTypes[c]) {
+        case TSDB_DATA_TYPE_TIMESTAMP: *(int64_t *)p = 1600000000000L - numOfRows / 2 + i; break;
+        case TSDB_DATA_TYPE_INT:       *(int32_t *)p = rand() % 1000; break;
+        case TSDB_DATA_TYPE_BIGINT:    *(int64_t *)p = rand() % 1000; break;
+        case TSDB_DATA_TYPE_DOUBLE:    *(double *)p = rand() * 2.0 / RAND_MAX - 1; break;
+        case TSDB_DATA_TYPE_FLOAT:     *(float *)p = (float)rand() / RAND_MAX; break;
+        default:                       *(int16_t *)p = (int16_t)(rand() % 4096); break;
+      }
+    }
+  }
+
+  int32_t numOfPredicates[] = {1, 3, 10};
+  for (int32_t i = 0; i < tListLen(numOfPredicates); ++i) {
+    runBench(numOfPredicates[i], cols, numOfRows, blockRows, loops);
+  }
+
+  for (int32_t c = 0; c < BENCH_COLS; ++c) {
+    free(cols[c]);
+  }
+  return 0;
+}
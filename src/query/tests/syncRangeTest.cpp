@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "os.h"
+#include "taosdef.h"
+
+// tsdbFile.h is not C++ code, the size of the file header of the tsdb files
+#define TSDB_FILE_HEAD_SIZE 512
+#include "tsdbSync.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+// the ranges of a file of size are adjacent and cover the whole file
+void checkRanges(uint64_t size) {
+  uint32_t nRanges = tsdbSyncNRanges(size);
+  int64_t  offset = 0;
+  for (uint32_t i = 0; i < nRanges; ++i) {
+    ASSERT_EQ(tsdbSyncRangeOffset(i), offset);
+    int64_t len = tsdbSyncRangeLen(size, i);
+    ASSERT_GT(len, 0);
+    ASSERT_LE(len, i == 0 ? TSDB_FILE_HEAD_SIZE : TSDB_SYNC_RANGE_SIZE);
+    offset += len;
+  }
+  ASSERT_EQ(offset, (int64_t)size);
+}
+
+}  // namespace
+
+TEST(testCase, syncRangeSplit) {
+  ASSERT_EQ(tsdbSyncNRanges(0), 0);
+  ASSERT_EQ(tsdbSyncNRanges(1), 1);
+  ASSERT_EQ(tsdbSyncNRanges(TSDB_FILE_HEAD_SIZE), 1);
+  ASSERT_EQ(tsdbSyncNRanges(TSDB_FILE_HEAD_SIZE + 1), 2);
+  ASSERT_EQ(tsdbSyncNRanges(TSDB_FILE_HEAD_SIZE + TSDB_SYNC_RANGE_SIZE), 2);
+  ASSERT_EQ(tsdbSyncNRanges(TSDB_FILE_HEAD_SIZE + TSDB_SYNC_RANGE_SIZE + 1), 3);
+
+  // the file header is a range by itself
+  ASSERT_EQ(tsdbSyncRangeLen(TSDB_FILE_HEAD_SIZE + 100, 0), TSDB_FILE_HEAD_SIZE);
+  ASSERT_EQ(tsdbSyncRangeLen(TSDB_FILE_HEAD_SIZE + 100, 1), 100);
+
+  uint64_t sizes[] = {1,
+                      TSDB_FILE_HEAD_SIZE - 1,
+                      TSDB_FILE_HEAD_SIZE,
+                      TSDB_FILE_HEAD_SIZE + 1,
+                      TSDB_FILE_HEAD_SIZE + TSDB_SYNC_RANGE_SIZE,
+                      TSDB_FILE_HEAD_SIZE + 3 * TSDB_SYNC_RANGE_SIZE + 12345,
+                      (uint64_t)5 * 1024 * 1024 * 1024 + 7};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    checkRanges(sizes[i]);
+  }
+}
+
+TEST(testCase, syncRangeReusable) {
+  // blocks appended to a local file by the commits after the replica is offline
+  uint64_t lsize = TSDB_FILE_HEAD_SIZE + 2 * TSDB_SYNC_RANGE_SIZE + 1000;
+  uint64_t size = lsize + TSDB_SYNC_RANGE_SIZE;
+
+  // the header and the full ranges have the same lengths, the partial range at the end of the local file does not
+  ASSERT_TRUE(tsdbSyncRangeReusable(size, lsize, 0));
+  ASSERT_TRUE(tsdbSyncRangeReusable(size, lsize, 1));
+  ASSERT_TRUE(tsdbSyncRangeReusable(size, lsize, 2));
+  ASSERT_FALSE(tsdbSyncRangeReusable(size, lsize, 3));
+  ASSERT_FALSE(tsdbSyncRangeReusable(size, lsize, 4));
+
+  // a local file larger than the new one, the ranges after the new file are not compared at all
+  ASSERT_TRUE(tsdbSyncRangeReusable(lsize, size, 2));
+  ASSERT_FALSE(tsdbSyncRangeReusable(lsize, size, 3));
+
+  // no local file, every range is received
+  for (uint32_t i = 0; i < tsdbSyncNRanges(size); ++i) {
+    ASSERT_FALSE(tsdbSyncRangeReusable(size, 0, i));
+  }
+
+  // a local file with the header only
+  ASSERT_TRUE(tsdbSyncRangeReusable(size, TSDB_FILE_HEAD_SIZE, 0));
+  ASSERT_FALSE(tsdbSyncRangeReusable(size, TSDB_FILE_HEAD_SIZE, 1));
+  ASSERT_FALSE(tsdbSyncRangeReusable(size, TSDB_FILE_HEAD_SIZE - 1, 0));
+}
+
+TEST(testCase, syncMetaIncrFlag) {
+  // the flag never collides with the length of a metainfo
+  uint32_t tlen = TSDB_MAX_WAL_SIZE;
+  ASSERT_EQ(tlen & TSDB_SYNC_META_INCR, 0u);
+  uint32_t flagged = tlen | TSDB_SYNC_META_INCR;
+  ASSERT_NE(flagged & TSDB_SYNC_META_INCR, 0u);
+  ASSERT_EQ(flagged & ~TSDB_SYNC_META_INCR, tlen);
+}
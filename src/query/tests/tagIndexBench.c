@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tdataformat.h"
+#include "texpr.h"
+#include "tutil.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+#include "tsdbTagIndex.h"
+
+// tags: region binary(16) with 10 values, model binary(16) with 50 values, site int with a value for 100 tables
+#define BENCH_TAGS 3
+
+static const uint8_t tagTypes[BENCH_TAGS] = {TSDB_DATA_TYPE_BINARY, TSDB_DATA_TYPE_BINARY, TSDB_DATA_TYPE_INT};
+static const int16_t tagBytes[BENCH_TAGS] = {16 + VARSTR_HEADER_SIZE, 16 + VARSTR_HEADER_SIZE, sizeof(int32_t)};
+
+static int32_t getTagData(void *param, int32_t colId, void **data) {
+  *data = tdGetKVRowValOfCol((SKVRow)param, colId);
+  return TSDB_CODE_SUCCESS;
+}
+
+static bool getTagIndex(void *param, int16_t colId, int8_t type, const void *val, int32_t len,
+                        const SBitmap **ppBitmap) {
+  return tsdbTagIndexGet((STagIndex *)param, colId, type, val, len, ppBitmap);
+}
+
+static tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+// tag t compared with the constant, a string for binary tags
+static tExprNode *predicate(int32_t t, uint8_t optr, const char *str, int64_t v) {
+  tExprNode *pCol = calloc(1, sizeof(tExprNode));
+  pCol->nodeType = TSQL_NODE_COL;
+  pCol->pSchema = calloc(1, sizeof(SSchema));
+  pCol->pSchema->type = tagTypes[t];
+  pCol->pSchema->bytes = tagBytes[t];
+  pCol->pSchema->colId = t + 1;
+  sprintf(pCol->pSchema->name, "t%d", t);
+
+  tExprNode *pVal = calloc(1, sizeof(tExprNode));
+  pVal->nodeType = TSQL_NODE_VALUE;
+  pVal->pVal = calloc(1, sizeof(tVariant));
+  if (str != NULL) {
+    tVariantCreateFromBinary(pVal->pVal, str, strlen(str), TSDB_DATA_TYPE_BINARY);
+  } else {
+    pVal->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+    pVal->pVal->i64 = v;
+  }
+
+  return exprNode(optr, pCol, pVal);
+}
+
+static tExprNode *benchTree(int32_t q, int32_t numOfTables) {
+  switch (q) {
+    case 0:
+      return predicate(0, TSDB_RELATION_EQUAL, "r3", 0);
+    case 1:
+      return exprNode(TSDB_RELATION_AND, predicate(0, TSDB_RELATION_EQUAL, "r3", 0),
+                      predicate(1, TSDB_RELATION_EQUAL, "m17", 0));
+    case 2:
+      return predicate(2, TSDB_RELATION_EQUAL, NULL, numOfTables / 200);
+    case 3:
+      return exprNode(TSDB_RELATION_OR, predicate(2, TSDB_RELATION_EQUAL, NULL, 12),
+                      predicate(1, TSDB_RELATION_EQUAL, "m7", 0));
+    default:
+      return exprNode(TSDB_RELATION_AND, predicate(0, TSDB_RELATION_EQUAL, "r1", 0),
+                      predicate(2, TSDB_RELATION_GREATER, NULL, numOfTables / 200));
+  }
+}
+
+static const char *benchDesc[] = {"region = 'r3'", "region = 'r3' and model = 'm17'", "site = N/200",
+                                  "site = 12 or model = 'm7'", "region = 'r1' and site > N/200"};
+
+static void runBench(int32_t q, SKVRow *tags, int32_t numOfTables, STagIndex *pIndex, int32_t loops) {
+  SFilterInfo *pInfo = NULL;
+  tExprNode   *pTree = benchTree(q, numOfTables);
+  if (filterInitFromTree(pTree, (void **)&pInfo, 0) != TSDB_CODE_SUCCESS) {
+    printf("failed to init the filter %s\n", benchDesc[q]);
+    exit(1);
+  }
+  tExprTreeDestroy(pTree, NULL);
+
+  int64_t scanUs = 0, indexUs = 0, scanRes = 0, indexRes = 0;
+  int8_t *p = NULL;
+
+  for (int32_t l = 0; l < loops; ++l) {
+    int64_t st = taosGetTimestampUs();
+    for (int32_t tid = 0; tid < numOfTables; ++tid) {
+      filterSetColFieldData(pInfo, tags[tid], getTagData);
+      if (filterExecute(pInfo, 1, &p, NULL, 0) || (p && *p)) {
+        scanRes++;
+      }
+    }
+
+    int64_t  mid = taosGetTimestampUs();
+    SBitmap *pCands = NULL;
+    if (filterIndexExecute(pInfo, pIndex, getTagIndex, &pCands) != TSDB_CODE_SUCCESS || pCands == NULL) {
+      printf("filter %s can not use the tag index\n", benchDesc[q]);
+      exit(1);
+    }
+
+    SBitmapIter iter;
+    uint32_t    tid = 0;
+    tBitmapIterInit(&iter, pCands);
+    while (tBitmapIterNext(&iter, &tid)) {
+      filterSetColFieldData(pInfo, tags[tid], getTagData);
+      if (filterExecute(pInfo, 1, &p, NULL, 0) || (p && *p)) {
+        indexRes++;
+      }
+    }
+    tBitmapDestroy(pCands);
+    int64_t et = taosGetTimestampUs();
+
+    scanUs += mid - st;
+    indexUs += et - mid;
+  }
+
+  if (scanRes != indexRes) {
+    printf("%s: result mismatch, scan:%" PRId64 " index:%" PRId64 "\n", benchDesc[q], scanRes, indexRes);
+    exit(1);
+  }
+
+  printf("tables:%8d  %-34s  qualified:%7" PRId64 "  scan:%10.3f ms  index:%8.3f ms  speedup:%8.2fx\n", numOfTables,
+         benchDesc[q], scanRes / loops, scanUs / 1000.0 / loops, indexUs / 1000.0 / loops,
+         (double)scanUs / (indexUs > 0 ? indexUs : 1));
+
+  tfree(p);
+  filterFreeInfo(pInfo);
+}
+
+static void benchTables(int32_t numOfTables, int32_t loops) {
+  STSchemaBuilder schemaBuilder = {0};
+  tdInitTSchemaBuilder(&schemaBuilder, 0);
+  for (int32_t t = 0; t < BENCH_TAGS; ++t) {
+    tdAddColToSchema(&schemaBuilder, tagTypes[t], t + 1, tagBytes[t]);
+  }
+  STSchema *pTagSchema = tdGetSchemaFromBuilder(&schemaBuilder);
+  tdDestroyTSchemaBuilder(&schemaBuilder);
+
+  SKVRowBuilder kvBuilder = {0};
+  tdInitKVRowBuilder(&kvBuilder);
+
+  SKVRow    *tags = malloc(sizeof(SKVRow) * numOfTables);
+  STagIndex *pIndex = tsdbNewTagIndex();
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t tid = 0; tid < numOfTables; ++tid) {
+    char    region[16 + VARSTR_HEADER_SIZE], model[16 + VARSTR_HEADER_SIZE];
+    int32_t site = tid / 100;
+
+    varDataSetLen(region, sprintf(varDataVal(region), "r%d", tid % 10));
+    varDataSetLen(model, sprintf(varDataVal(model), "m%d", (tid / 10) % 50));
+
+    tdResetKVRowBuilder(&kvBuilder);
+    tdAddColToKVRow(&kvBuilder, 1, TSDB_DATA_TYPE_BINARY, region, false);
+    tdAddColToKVRow(&kvBuilder, 2, TSDB_DATA_TYPE_BINARY, model, false);
+    tdAddColToKVRow(&kvBuilder, 3, TSDB_DATA_TYPE_INT, &site, false);
+    tags[tid] = tdGetKVRowFromBuilder(&kvBuilder);
+
+    tsdbTagIndexAdd(pIndex, pTagSchema, tags[tid], tid);
+  }
+  printf("tables:%8d  index built in %.3f ms\n", numOfTables, (taosGetTimestampUs() - st) / 1000.0);
+
+  for (int32_t q = 0; q < tListLen(benchDesc); ++q) {
+    runBench(q, tags, numOfTables, pIndex, loops);
+  }
+
+  for (int32_t tid = 0; tid < numOfTables; ++tid) {
+    kvRowFree(tags[tid]);
+  }
+  free(tags);
+  tsdbFreeTagIndex(pIndex);
+  tdDestroyKVRowBuilder(&kvBuilder);
+  tdFreeSchema(pTagSchema);
+}
+
+int main(int argc, char *argv[]) {
+  int32_t loops = 3;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-l]: number of loops, default: %d\n", loops);
+      exit(0);
+    }
+  }
+
+  int32_t numOfTables[] = {100000, 1000000};
+  for (int32_t i = 0; i < tListLen(numOfTables); ++i) {
+    benchTables(numOfTables[i], loops);
+  }
+
+  return 0;
+}
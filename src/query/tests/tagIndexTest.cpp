@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "os.h"
+#include "taosdef.h"
+#include "tbuffer.h"
+#include "tdataformat.h"
+#include "texpr.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+#include "tsdbTagIndex.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+// tags: region binary(16) with 5 values, site int with a value for 10 tables, level double (not indexed)
+const int32_t numOfTags = 3;
+const uint8_t tagTypes[numOfTags] = {TSDB_DATA_TYPE_BINARY, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_DOUBLE};
+const int16_t tagBytes[numOfTags] = {16 + VARSTR_HEADER_SIZE, sizeof(int32_t), sizeof(double)};
+
+struct STagTables {
+  STSchema            *pTagSchema;
+  STagIndex           *pIndex;
+  std::vector<SKVRow>  tags;
+  std::set<int32_t>    dropped;
+};
+
+int32_t getTagData(void *param, int32_t colId, void **data) {
+  *data = tdGetKVRowValOfCol((SKVRow)param, colId);
+  return TSDB_CODE_SUCCESS;
+}
+
+bool getTagIndex(void *param, int16_t colId, int8_t type, const void *val, int32_t len, const SBitmap **ppBitmap) {
+  return tsdbTagIndexGet((STagIndex *)param, colId, type, val, len, ppBitmap);
+}
+
+SKVRow newTags(const char *region, int32_t site, double level) {
+  char buf[16 + VARSTR_HEADER_SIZE];
+  varDataSetLen(buf, sprintf((char *)varDataVal(buf), "%s", region));
+
+  SKVRowBuilder builder = {0};
+  tdInitKVRowBuilder(&builder);
+  tdAddColToKVRow(&builder, 1, TSDB_DATA_TYPE_BINARY, buf, false);
+  tdAddColToKVRow(&builder, 2, TSDB_DATA_TYPE_INT, &site, false);
+  tdAddColToKVRow(&builder, 3, TSDB_DATA_TYPE_DOUBLE, &level, false);
+  SKVRow row = tdGetKVRowFromBuilder(&builder);
+  tdDestroyKVRowBuilder(&builder);
+  return row;
+}
+
+void initTables(STagTables *pTables, int32_t numOfTables) {
+  STSchemaBuilder schemaBuilder = {0};
+  tdInitTSchemaBuilder(&schemaBuilder, 0);
+  for (int32_t t = 0; t < numOfTags; ++t) {
+    tdAddColToSchema(&schemaBuilder, tagTypes[t], t + 1, tagBytes[t]);
+  }
+  pTables->pTagSchema = tdGetSchemaFromBuilder(&schemaBuilder);
+  tdDestroyTSchemaBuilder(&schemaBuilder);
+
+  pTables->pIndex = tsdbNewTagIndex();
+  for (int32_t tid = 0; tid < numOfTables; ++tid) {
+    char region[16];
+    sprintf(region, "r%d", tid % 5);
+    pTables->tags.push_back(newTags(region, tid / 10, tid / 10 * 0.5));
+    tsdbTagIndexAdd(pTables->pIndex, pTables->pTagSchema, pTables->tags[tid], tid);
+  }
+}
+
+void freeTables(STagTables *pTables) {
+  for (size_t tid = 0; tid < pTables->tags.size(); ++tid) {
+    kvRowFree(pTables->tags[tid]);
+  }
+  tsdbFreeTagIndex(pTables->pIndex);
+  tdFreeSchema(pTables->pTagSchema);
+}
+
+// change the tags of a table as tsdbUpdateTableTagValue does
+void updateTags(STagTables *pTables, int32_t tid, SKVRow newRow) {
+  tsdbTagIndexRemove(pTables->pIndex, pTables->pTagSchema, pTables->tags[tid], tid);
+  kvRowFree(pTables->tags[tid]);
+  pTables->tags[tid] = newRow;
+  tsdbTagIndexAdd(pTables->pIndex, pTables->pTagSchema, pTables->tags[tid], tid);
+}
+
+tExprNode *colNode(int32_t t) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  pNode->pSchema->type = tagTypes[t];
+  pNode->pSchema->bytes = tagBytes[t];
+  pNode->pSchema->colId = t + 1;
+  sprintf(pNode->pSchema->name, "t%d", t);
+  return pNode;
+}
+
+tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+tExprNode *valNode(tVariant *pVar) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = pVar;
+  return pNode;
+}
+
+tExprNode *regionEqual(const char *region) {
+  tVariant *pVar = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pVar, region, strlen(region), TSDB_DATA_TYPE_BINARY);
+  return exprNode(TSDB_RELATION_EQUAL, colNode(0), valNode(pVar));
+}
+
+tExprNode *siteCompare(uint8_t optr, int64_t site) {
+  tVariant *pVar = (tVariant *)calloc(1, sizeof(tVariant));
+  pVar->nType = TSDB_DATA_TYPE_BIGINT;
+  pVar->i64 = site;
+  return exprNode(optr, colNode(1), valNode(pVar));
+}
+
+tExprNode *levelEqual(double level) {
+  tVariant *pVar = (tVariant *)calloc(1, sizeof(tVariant));
+  pVar->nType = TSDB_DATA_TYPE_DOUBLE;
+  pVar->dKey = level;
+  return exprNode(TSDB_RELATION_EQUAL, colNode(2), valNode(pVar));
+}
+
+// the list of an IN condition serialized as the parser does
+tExprNode *regionIn(const std::vector<const char *> &regions) {
+  SBufferWriter bw = tbufInitWriter(NULL, false);
+  tbufWriteUint32(&bw, TSDB_DATA_TYPE_BINARY);
+  tbufWriteInt32(&bw, (int32_t)regions.size());
+  for (size_t i = 0; i < regions.size(); ++i) {
+    tbufWriteBinary(&bw, regions[i], strlen(regions[i]));
+  }
+
+  tVariant *pVar = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pVar, tbufGetData(&bw, false), tbufTell(&bw), TSDB_DATA_TYPE_BINARY);
+  tbufCloseWriter(&bw);
+  return exprNode(TSDB_RELATION_IN, colNode(0), valNode(pVar));
+}
+
+tExprNode *siteIn(const std::vector<int64_t> &sites) {
+  SBufferWriter bw = tbufInitWriter(NULL, false);
+  tbufWriteUint32(&bw, TSDB_DATA_TYPE_INT);
+  tbufWriteInt32(&bw, (int32_t)sites.size());
+  for (size_t i = 0; i < sites.size(); ++i) {
+    tbufWriteInt64(&bw, sites[i]);
+  }
+
+  tVariant *pVar = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pVar, tbufGetData(&bw, false), tbufTell(&bw), TSDB_DATA_TYPE_BINARY);
+  tbufCloseWriter(&bw);
+  return exprNode(TSDB_RELATION_IN, colNode(1), valNode(pVar));
+}
+
+// The tables qualified by scanning all the tables and by the candidates of the index must be the same. Return the
+// qualified tables, and the number of candidates in *pNumOfCands, or -1 if the index is not used.
+std::set<int32_t> checkIndex(tExprNode *pTree, STagTables *pTables, int64_t *pNumOfCands) {
+  std::set<int32_t> scanRes, indexRes;
+  SFilterInfo      *pInfo = NULL;
+
+  EXPECT_EQ(filterInitFromTree(pTree, (void **)&pInfo, 0), TSDB_CODE_SUCCESS);
+  tExprTreeDestroy(pTree, NULL);
+
+  int8_t *p = NULL;
+  for (size_t tid = 0; tid < pTables->tags.size(); ++tid) {
+    if (pTables->dropped.count((int32_t)tid) > 0) {
+      continue;
+    }
+
+    filterSetColFieldData(pInfo, pTables->tags[tid], getTagData);
+    if (filterExecute(pInfo, 1, &p, NULL, 0) || (p && *p)) {
+      scanRes.insert((int32_t)tid);
+    }
+  }
+
+  SBitmap *pCands = NULL;
+  EXPECT_EQ(filterIndexExecute(pInfo, pTables->pIndex, getTagIndex, &pCands), TSDB_CODE_SUCCESS);
+  if (pCands == NULL) {
+    *pNumOfCands = -1;
+    indexRes = scanRes;
+  } else {
+    *pNumOfCands = tBitmapCardinality(pCands);
+
+    SBitmapIter iter;
+    uint32_t    tid = 0;
+    tBitmapIterInit(&iter, pCands);
+    while (tBitmapIterNext(&iter, &tid)) {
+      filterSetColFieldData(pInfo, pTables->tags[tid], getTagData);
+      if (filterExecute(pInfo, 1, &p, NULL, 0) || (p && *p)) {
+        indexRes.insert((int32_t)tid);
+      }
+    }
+    tBitmapDestroy(pCands);
+  }
+
+  EXPECT_EQ(scanRes, indexRes);
+
+  tfree(p);
+  filterFreeInfo(pInfo);
+  return scanRes;
+}
+
+}  // namespace
+
+TEST(testCase, tagIndexEqual) {
+  STagTables tables;
+  initTables(&tables, 1000);
+
+  int64_t           numOfCands = 0;
+  std::set<int32_t> res = checkIndex(regionEqual("r3"), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 200);
+  ASSERT_EQ(numOfCands, 200);
+
+  res = checkIndex(siteCompare(TSDB_RELATION_EQUAL, 42), &tables, &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({420, 421, 422, 423, 424, 425, 426, 427, 428, 429}));
+  ASSERT_EQ(numOfCands, 10);
+
+  // the candidates of the units of a group are intersected
+  res = checkIndex(exprNode(TSDB_RELATION_AND, regionEqual("r1"), siteCompare(TSDB_RELATION_EQUAL, 42)), &tables,
+                   &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({421, 426}));
+  ASSERT_EQ(numOfCands, 2);
+
+  // the units not on indexed tags are evaluated on the candidates only
+  res = checkIndex(exprNode(TSDB_RELATION_AND, regionEqual("r1"), siteCompare(TSDB_RELATION_GREATER, 97)), &tables,
+                   &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({981, 986, 991, 996}));
+  ASSERT_EQ(numOfCands, 200);
+
+  res = checkIndex(regionEqual("nothing"), &tables, &numOfCands);
+  ASSERT_TRUE(res.empty());
+  ASSERT_EQ(numOfCands, 0);
+
+  freeTables(&tables);
+}
+
+TEST(testCase, tagIndexIn) {
+  STagTables tables;
+  initTables(&tables, 1000);
+
+  int64_t           numOfCands = 0;
+  std::set<int32_t> res = checkIndex(regionIn({"r0", "r4", "nothing"}), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 400);
+  ASSERT_EQ(numOfCands, 400);
+
+  res = checkIndex(siteIn({3, 50, 5000}), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 20);
+  ASSERT_EQ(numOfCands, 20);
+
+  res = checkIndex(exprNode(TSDB_RELATION_AND, regionIn({"r2", "r3"}), siteIn({7, 8})), &tables, &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({72, 73, 77, 78, 82, 83, 87, 88}));
+  ASSERT_EQ(numOfCands, 8);
+
+  freeTables(&tables);
+}
+
+TEST(testCase, tagIndexGroups) {
+  STagTables tables;
+  initTables(&tables, 1000);
+
+  // the candidates of the groups are united
+  int64_t           numOfCands = 0;
+  std::set<int32_t> res = checkIndex(
+      exprNode(TSDB_RELATION_OR, siteCompare(TSDB_RELATION_EQUAL, 1), siteCompare(TSDB_RELATION_EQUAL, 2)), &tables,
+      &numOfCands);
+  ASSERT_EQ(res.size(), 20);
+  ASSERT_EQ(numOfCands, 20);
+
+  // a group without a unit on an indexed tag makes all the tables candidates
+  res = checkIndex(exprNode(TSDB_RELATION_OR, regionEqual("r1"), siteCompare(TSDB_RELATION_GREATER, 97)), &tables,
+                   &numOfCands);
+  ASSERT_EQ(res.size(), 216);
+  ASSERT_EQ(numOfCands, -1);
+
+  // double tags are not indexed
+  res = checkIndex(levelEqual(2.5), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 10);
+  ASSERT_EQ(numOfCands, -1);
+
+  freeTables(&tables);
+}
+
+TEST(testCase, tagIndexUpdate) {
+  STagTables tables;
+  initTables(&tables, 1000);
+
+  int64_t numOfCands = 0;
+  updateTags(&tables, 420, newTags("r9", 42, 21));
+  updateTags(&tables, 5, newTags("r9", 500, 0));
+
+  std::set<int32_t> res = checkIndex(regionEqual("r9"), &tables, &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({5, 420}));
+  ASSERT_EQ(numOfCands, 2);
+
+  res = checkIndex(regionEqual("r0"), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 198);
+  ASSERT_EQ(numOfCands, 198);
+
+  res = checkIndex(siteCompare(TSDB_RELATION_EQUAL, 0), &tables, &numOfCands);
+  ASSERT_EQ(res.size(), 9);
+  ASSERT_EQ(res.count(5), 0);
+
+  res = checkIndex(siteCompare(TSDB_RELATION_EQUAL, 500), &tables, &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({5}));
+
+  // the table keeps its site, only the region changes
+  res = checkIndex(exprNode(TSDB_RELATION_AND, regionEqual("r9"), siteCompare(TSDB_RELATION_EQUAL, 42)), &tables,
+                   &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({420}));
+
+  // the table is dropped
+  tsdbTagIndexRemove(tables.pIndex, tables.pTagSchema, tables.tags[420], 420);
+  tables.dropped.insert(420);
+  res = checkIndex(regionEqual("r9"), &tables, &numOfCands);
+  ASSERT_EQ(res, std::set<int32_t>({5}));
+  ASSERT_EQ(numOfCands, 1);
+
+  freeTables(&tables);
+}
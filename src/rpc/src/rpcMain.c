@@ -206,7 +206,7 @@ static void  rpcProcessIdleTimer(void *param, void *tmrId);
 static void  rpcProcessProgressTimer(void *param, void *tmrId);
 
 static void  rpcFreeMsg(void *msg);
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen);
+static int32_t rpcCompressRpcMsg(char **ppCont, int32_t contLen);
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead);
 static int   rpcAddAuthPart(SRpcConn *pConn, char *msg, int msgLen);
 static int   rpcCheckAuthentication(SRpcConn *pConn, char *msg, int msgLen);
@@ -388,13 +388,14 @@ void rpcSendRequest(void *shandle, const SRpcEpSet *pEpSet, SRpcMsg *pMsg, int64
   SRpcInfo       *pRpc = (SRpcInfo *)shandle;
   SRpcReqContext *pContext;
 
-  int contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
-  pContext = (SRpcReqContext *) ((char*)pMsg->pCont-sizeof(SRpcHead)-sizeof(SRpcReqContext));
+  char *pCont = pMsg->pCont;
+  int   contLen = rpcCompressRpcMsg(&pCont, pMsg->contLen);
+  pContext = (SRpcReqContext *) (pCont-sizeof(SRpcHead)-sizeof(SRpcReqContext));
   pContext->ahandle = pMsg->ahandle;
   pContext->pRpc = (SRpcInfo *)shandle;
   pContext->epSet = *pEpSet;
   pContext->contLen = contLen;
-  pContext->pCont = pMsg->pCont;
+  pContext->pCont = (uint8_t *)pCont;
   pContext->msgType = pMsg->msgType;
   pContext->oldInUse = pEpSet->inUse;
 
@@ -429,12 +430,12 @@ void rpcSendResponse(const SRpcMsg *pRsp) {
     pMsg->contLen = 0;
   }
 
+  pMsg->contLen = rpcCompressRpcMsg((char **)&pMsg->pCont, pMsg->contLen);
+  msgLen = rpcMsgLenFromCont(pMsg->contLen);
+
   SRpcHead  *pHead = rpcHeadFromCont(pMsg->pCont);
   char      *msg = (char *)pHead;
 
-  pMsg->contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
-  msgLen = rpcMsgLenFromCont(pMsg->contLen);
-
   rpcLockConn(pConn);
 
   if ( pConn->inType == 0 || pConn->user[0] == 0 ) {
@@ -1468,22 +1469,23 @@ static void rpcProcessProgressTimer(void *param, void *tmrId) {
   rpcUnlockConn(pConn);
 }
 
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
-  SRpcHead  *pHead = rpcHeadFromCont(pCont);
-  int32_t    finalLen = 0;
+// The content is compressed into a new message which replaces the original one, so the compressed content is not
+// copied back, and the message kept for retransmission is of the compressed size
+static int32_t rpcCompressRpcMsg(char **ppCont, int32_t contLen) {
+  char      *pCont = *ppCont;
   int        overhead = sizeof(SRpcComp);
   
   if (!NEEDTO_COMPRESSS_MSG(contLen)) {
     return contLen;
   }
   
-  char *buf = malloc (contLen + overhead + 8);  // 8 extra bytes
-  if (buf == NULL) {
+  char *pNewCont = rpcMallocCont(contLen + 8);  // 8 extra bytes
+  if (pNewCont == NULL) {
     tError("failed to allocate memory for rpc msg compression, contLen:%d", contLen);
     return contLen;
   }
   
-  int32_t compLen = LZ4_compress_default(pCont, buf, contLen, contLen + overhead);
+  int32_t compLen = LZ4_compress_default(pCont, pNewCont + overhead, contLen, contLen + 8 - overhead);
   tDebug("compress rpc msg, before:%d, after:%d, overhead:%d", contLen, compLen, overhead);
   
   /*
@@ -1491,20 +1493,27 @@ static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
    * The first four bytes is set to 0, the second four bytes are utilized to keep the original length of message
    */
   if (compLen > 0 && compLen < contLen - overhead) {
-    SRpcComp *pComp = (SRpcComp *)pCont;
+    SRpcComp *pComp = (SRpcComp *)pNewCont;
     pComp->reserved = 0; 
     pComp->contLen = htonl(contLen); 
-    memcpy(pCont + overhead, buf, compLen);
     
-    pHead->comp = 1;
+    rpcHeadFromCont(pNewCont)->comp = 1;
     tDebug("compress rpc msg, before:%d, after:%d", contLen, compLen);
-    finalLen = compLen + overhead;
-  } else {
-    finalLen = contLen;
+
+    // shrink the new message in place, it fails only if the memory is not enough
+    char *pShrinked = rpcReallocCont(pNewCont, compLen + overhead);
+    if (pShrinked != NULL) pNewCont = pShrinked;
+
+    // the request context before the content moves with it, rpcSendRecv sets pSem, pRsp and pSet there already
+    memcpy(pNewCont - sizeof(SRpcHead) - sizeof(SRpcReqContext), pCont - sizeof(SRpcHead) - sizeof(SRpcReqContext),
+           sizeof(SRpcReqContext));
+    rpcFreeCont(pCont);
+    *ppCont = pNewCont;
+    return compLen + overhead;
   }
 
-  free(buf);
-  return finalLen;
+  rpcFreeCont(pNewCont);
+  return contLen;
 }
 
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
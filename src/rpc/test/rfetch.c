@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// loopback benchmark of large fetch responses: the server and the client run in one process, the server dumps the
+// result columns into each response like the vnode, and the client checks the response it receives. Requests of the
+// same size are sent by rpcSendRecv at last, and are checked by the server.
+
+#include "os.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "rpcLog.h"
+#include "trpc.h"
+#include "taoserror.h"
+#include "taosmsg.h"
+
+static char   *payload = NULL;
+static int32_t payloadSize = 0;
+static tsem_t  rspSem;
+static int32_t rspErrors = 0;
+
+// the result of a query: a timestamp, an int and a double column
+static void buildPayload(int32_t size) {
+  int32_t numOfRows = size / (sizeof(int64_t) + sizeof(int32_t) + sizeof(double));
+  payloadSize = size;
+  payload = calloc(1, size);
+
+  int64_t *ts = (int64_t *)payload;
+  int32_t *ival = (int32_t *)(ts + numOfRows);
+  double  *dval = (double *)(ival + numOfRows);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ts[i] = 1600000000000LL + i * 1000LL;
+    ival[i] = i % 1000;
+    dval[i] = (i % 977) * 0.5;
+  }
+}
+
+static void processFetchMsg(SRpcMsg *pMsg, SRpcEpSet *pEpSet) {
+  SRpcMsg rpcMsg = {0};
+
+  if (pMsg->contLen > 16 && (pMsg->contLen != payloadSize || memcmp(pMsg->pCont, payload, payloadSize) != 0)) {
+    printf("wrong request, contLen:%d\n", pMsg->contLen);
+    rspErrors++;
+  }
+  rpcFreeCont(pMsg->pCont);
+
+  rpcMsg.pCont = rpcMallocCont(payloadSize);
+  memcpy(rpcMsg.pCont, payload, payloadSize);
+  rpcMsg.contLen = payloadSize;
+  rpcMsg.handle = pMsg->handle;
+  rpcMsg.code = 0;
+  rpcSendResponse(&rpcMsg);
+}
+
+static void processFetchRsp(SRpcMsg *pMsg, SRpcEpSet *pEpSet) {
+  if (pMsg->code != 0 || pMsg->contLen != payloadSize || memcmp(pMsg->pCont, payload, payloadSize) != 0) {
+    printf("wrong response, code:0x%x contLen:%d\n", pMsg->code, pMsg->contLen);
+    rspErrors++;
+  }
+
+  rpcFreeCont(pMsg->pCont);
+  tsem_post(&rspSem);
+}
+
+static int retrieveAuthInfo(char *user, char *spi, char *encrypt, char *secret, char *ckey) {
+  *spi = 1;
+  *encrypt = 0;
+  strcpy(secret, "mypassword");
+  strcpy(ckey, "key");
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  SRpcInit  init;
+  SRpcEpSet epSet = {0};
+  char      secret[TSDB_KEY_LEN] = "mypassword";
+  int32_t   sizes[] = {64 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+  int32_t   numOfSizes = tListLen(sizes);
+  int32_t   numOfReqs = 200;
+  uint16_t  port = 7100;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      port = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfReqs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-m") == 0 && i < argc - 1) {
+      sizes[0] = atoi(argv[++i]);
+      numOfSizes = 1;
+    } else if (strcmp(argv[i], "-o") == 0 && i < argc - 1) {
+      tsCompressMsgSize = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i < argc - 1) {
+      rpcDebugFlag = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-p port]: server port number, default is:%d\n", port);
+      printf("  [-n requests]: number of fetch requests of each response size, default is:%d\n", numOfReqs);
+      printf("  [-m msgSize]: response size, default is 64KB, 1MB and 8MB\n");
+      printf("  [-o compSize]: compression message size, default is:%d\n", tsCompressMsgSize);
+      printf("  [-d debugFlag]: debug flag, default:%d\n", rpcDebugFlag);
+      printf("  [-h help]: print out this help\n\n");
+      exit(0);
+    }
+  }
+
+  // the version of the client is checked by the server
+  tsVersion = (2 << 24) | (4 << 16);
+
+  taosBlockSIGPIPE();
+  taosInitLog("rfetch.log", 100000, 10);
+  rpcInit();
+  tsem_init(&rspSem, 0, 0);
+
+  memset(&init, 0, sizeof(init));
+  init.localPort = port;
+  init.label = "SER";
+  init.numOfThreads = 1;
+  init.cfp = processFetchMsg;
+  init.sessions = 100;
+  init.idleTime = tsShellActivityTimer * 1500;
+  init.afp = retrieveAuthInfo;
+  void *pServer = rpcOpen(&init);
+
+  memset(&init, 0, sizeof(init));
+  init.localPort = 0;
+  init.label = "APP";
+  init.numOfThreads = 1;
+  init.cfp = processFetchRsp;
+  init.sessions = 100;
+  init.idleTime = tsShellActivityTimer * 1000;
+  init.user = "michael";
+  init.secret = secret;
+  init.ckey = "key";
+  init.spi = 1;
+  init.connType = TAOS_CONN_CLIENT;
+  void *pClient = rpcOpen(&init);
+
+  if (pServer == NULL || pClient == NULL) {
+    printf("failed to initialize RPC\n");
+    exit(1);
+  }
+
+  epSet.numOfEps = 1;
+  epSet.port[0] = port;
+  strcpy(epSet.fqdn[0], "127.0.0.1");
+
+  for (int32_t s = 0; s < numOfSizes; ++s) {
+    buildPayload(sizes[s]);
+
+    int64_t st = taosGetTimestampUs();
+    for (int32_t i = 0; i < numOfReqs; ++i) {
+      SRpcMsg rpcMsg = {0};
+      rpcMsg.pCont = rpcMallocCont(16);
+      rpcMsg.contLen = 16;
+      rpcMsg.msgType = TSDB_MSG_TYPE_FETCH;
+      rpcSendRequest(pClient, &epSet, &rpcMsg, NULL);
+      tsem_wait(&rspSem);
+    }
+    int64_t us = taosGetTimestampUs() - st;
+
+    printf("rsp size:%9d  compSize:%8d  responses:%5d  %9.1f us/rsp  %8.1f MB/s  errors:%d\n", payloadSize,
+           tsCompressMsgSize, numOfReqs, (double)us / numOfReqs, (double)payloadSize * numOfReqs / us, rspErrors);
+
+    // a compressed request is moved into a new message, which must keep the context set by rpcSendRecv
+    for (int32_t i = 0; i < 10; ++i) {
+      SRpcMsg rpcMsg = {0};
+      SRpcMsg rspMsg = {0};
+      rpcMsg.pCont = rpcMallocCont(payloadSize);
+      memcpy(rpcMsg.pCont, payload, payloadSize);
+      rpcMsg.contLen = payloadSize;
+      rpcMsg.msgType = TSDB_MSG_TYPE_FETCH;
+      rpcSendRecv(pClient, &epSet, &rpcMsg, &rspMsg);
+      if (rspMsg.code != 0 || rspMsg.contLen != payloadSize || memcmp(rspMsg.pCont, payload, payloadSize) != 0) {
+        printf("wrong sync response, code:0x%x contLen:%d\n", rspMsg.code, rspMsg.contLen);
+        rspErrors++;
+      }
+      rpcFreeCont(rspMsg.pCont);
+    }
+    tfree(payload);
+  }
+
+  rpcClose(pClient);
+  rpcClose(pServer);
+  taosCloseLog();
+
+  return rspErrors == 0 ? 0 : 1;
+}
@@ -86,6 +86,7 @@ typedef struct SsyncPeer {
   SOCKET   peerFd;          // forward FD
   int32_t  numOfRetrieves;  // number of retrieves tried
   int32_t  fileChanged;     // a flag to indicate file is changed during retrieving process
+  int8_t   caps;            // file sync capabilities of the peer restoring data
   int32_t  refCount;
   int8_t   isArb;
   int64_t  rid;
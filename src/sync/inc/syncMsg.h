@@ -76,7 +76,7 @@ typedef struct {
 typedef struct {
   SSyncHead head;
   int8_t    sync;
-  int8_t    reserved;
+  int8_t    caps;  // file sync capabilities, TAOS_SYNC_CAP_*
   uint16_t  tranId;
   int8_t    reserverd[4];
 } SSyncRsp;
@@ -1450,7 +1450,7 @@ static void syncMonitorFwdInfos(void *param, void *tmrId) {
 
 static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force) {
   SSyncPeer *pPeer;
-  SSyncHead *pSyncHead;
+  SSyncHead  syncHead;
   SWalHead * pWalHead = data;
   int32_t    fwdLen;
   int32_t    code = 0;
@@ -1480,10 +1480,9 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
   // only msg from RPC or CQ can be forwarded
   if (qtype != TAOS_QTYPE_RPC && qtype != TAOS_QTYPE_CQ) return 0;
 
-    // a hacker way to improve the performance
-  pSyncHead = (SSyncHead *)(((char *)pWalHead) - sizeof(SSyncHead));
-  syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead) + pWalHead->len);
-  fwdLen = pSyncHead->len + sizeof(SSyncHead);  // include the WAL and SYNC head
+  // the sync head and the wal are sent by one writev, so nothing is copied or written before the wal head
+  syncBuildSyncFwdMsg(&syncHead, pNode->vgId, sizeof(SWalHead) + pWalHead->len);
+  fwdLen = syncHead.len + sizeof(SSyncHead);  // include the WAL and SYNC head
 
   pthread_mutex_lock(&pNode->mutex);
 
@@ -1502,9 +1501,11 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
       }
     }
 
-    SOCKET peerFd = pPeer->peerFd;
+    SOCKET       peerFd = pPeer->peerFd;
+    struct iovec iov[2] = {{.iov_base = &syncHead, .iov_len = sizeof(SSyncHead)},
+                           {.iov_base = pWalHead, .iov_len = syncHead.len}};
     pthread_mutex_unlock(&pNode->mutex);
-    int32_t retLen = taosWriteMsg(peerFd, pSyncHead, fwdLen);
+    int32_t retLen = taosWriteMsgV(peerFd, iov, 2);
     pthread_mutex_lock(&pNode->mutex);
     if (retLen == fwdLen) {
       sTrace("%s, forward is sent, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id, syncRole[pPeer->role],
@@ -219,7 +219,7 @@ static int32_t syncRestoreDataStepByStep(SSyncPeer *pPeer) {
   uint64_t fversion = 0;
 
   sInfo("%s, start to restore, sstatus:%s", pPeer->id, syncStatus[pPeer->sstatus]);
-  SSyncRsp rsp = {.sync = 1, .tranId = syncGenTranId()};
+  SSyncRsp rsp = {.sync = 1, .caps = TAOS_SYNC_CAP_FILE_INCR, .tranId = syncGenTranId()};
   if (taosWriteMsg(pPeer->syncFd, &rsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp)) {
     sError("%s, failed to send sync rsp since %s", pPeer->id, strerror(errno));
     return -1;
@@ -121,7 +121,7 @@ static int32_t syncRetrieveFile(SSyncPeer *pPeer) {
     return -1;
   }
 
-  if (pNode->sendFileFp && (*pNode->sendFileFp)(pNode->pTsdb, pPeer->syncFd) != 0) {
+  if (pNode->sendFileFp && (*pNode->sendFileFp)(pNode->pTsdb, pPeer->syncFd, pPeer->caps) != 0) {
     sError("%s, failed to retrieve file", pPeer->id);
     return -1;
   }
@@ -382,7 +382,10 @@ static int32_t syncRetrieveFirstPkt(SSyncPeer *pPeer) {
     return -1;
   }
 
-  sInfo("%s, recv sync-data rsp from peer, tranId:%u rsp-tranId:%u", pPeer->id, msg.tranId, rsp.tranId);
+  // the peers of old versions have no capabilities
+  pPeer->caps = rsp.caps;
+  sInfo("%s, recv sync-data rsp from peer, tranId:%u rsp-tranId:%u caps:%d", pPeer->id, msg.tranId, rsp.tranId,
+        rsp.caps);
   return 0;
 }
 
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_BLOCK_CACHE_H_
+#define _TD_TSDB_BLOCK_CACHE_H_
+
+#include "tdataformat.h"
+
+// A memory bounded LRU cache of decompressed column chunks shared by all queries of a vnode.
+//
+// A chunk is identified by (fid, generation, file type, block offset, colId). The generation of a fid is bumped
+// each time the DATA or LAST file of the FSET is replaced, so chunks loaded from the old files can never be
+// returned for the new ones, even by queries which opened the FSET before the switch.
+typedef struct SBlockCache SBlockCache;
+
+SBlockCache *tsdbNewBlockCache(int64_t capacity);
+void         tsdbFreeBlockCache(SBlockCache *pCache);
+int64_t      tsdbBlockCacheGetGen(SBlockCache *pCache, int fid);
+int          tsdbBlockCacheGet(SBlockCache *pCache, int fid, int64_t gen, int8_t ftype, int64_t offset,
+                               SDataCol *pDataCol, int numOfRows, int maxPoints);
+void         tsdbBlockCachePut(SBlockCache *pCache, int fid, int64_t gen, int8_t ftype, int64_t offset,
+                               SDataCol *pDataCol);
+void         tsdbBlockCacheInvalidate(SBlockCache *pCache, int fid);
+void         tsdbBlockCacheInvalidateAll(SBlockCache *pCache);
+
+#endif /* _TD_TSDB_BLOCK_CACHE_H_ */
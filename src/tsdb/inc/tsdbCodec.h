@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_CODEC_H_
+#define _TD_TSDB_CODEC_H_
+
+#include "tdataformat.h"
+#include "tsdbMeta.h"
+
+// Codec of a column chunk, recorded in SBlockCol.codec. A chunk of TSDB_COL_CODEC_DEFAULT is compressed by the
+// algorithm of its block, the others whatever the algorithm of the block is.
+#define TSDB_COL_CODEC_DEFAULT 0
+#define TSDB_COL_CODEC_FAST    1  // one stage compression of the type
+#define TSDB_COL_CODEC_LZ4     2  // two stage compression of the type, with LZ4
+#define TSDB_COL_CODEC_ZLIB    3  // one stage compression of the type deflated by zlib, strings deflated directly
+#define TSDB_COL_CODEC_TSZ     4  // lossy compression of float and double columns by TSZ
+// Codec requested only, each block is compressed by the codec of the best size and speed trade-off on a sample
+#define TSDB_COL_CODEC_ADAPTIVE 255
+
+typedef struct {
+  uint8_t codec;
+  int8_t  level;  // level of TSDB_COL_CODEC_ZLIB
+} SColCodec;
+
+// Get the codec of a column of the table in the database db set by the columnCodec config
+SColCodec tsdbGetColCodec(const char *db, STable *pTable, int16_t colId);
+
+// Compress the rows of pDataCol by the codec requested to output of outputSize bytes, with *ppCBuf as the buffer of
+// the codecs of two steps, and return the length of the output and the codec used in *pCodec, or -1 on failure
+int32_t tsdbEncodeColData(SDataCol *pDataCol, int rows, int8_t comp, SColCodec codec, void *output,
+                          int32_t outputSize, void **ppCBuf, uint8_t *pCodec);
+
+// Decompress a column chunk of codec encoded in a block of algorithm comp to pDataCol, return the length of the
+// data decompressed or -1 on failure
+int32_t tsdbDecodeColData(SDataCol *pDataCol, void *input, int32_t inputSize, int8_t comp, uint8_t codec, int rows,
+                          char *buffer, int bufferSize);
+
+#endif /* _TD_TSDB_CODEC_H_ */
@@ -29,6 +29,15 @@ typedef struct {
   int64_t  size;
 } SKVRecord;
 
+// Time spent by each stage of writing data blocks in a commit
+typedef struct {
+  int64_t nBlocks;
+  int64_t nBytes;
+  int64_t compUs;   // encoding and compressing blocks
+  int64_t waitUs;   // waiting for the write stage to free a pipeline slot
+  int64_t writeUs;  // writing blocks to files
+} SCommitStat;
+
 #define TSDB_DEFAULT_BLOCK_ROWS(maxRows) ((maxRows)*4 / 5)
 
 void  tsdbGetRtnSnap(STsdbRepo *pRepo, SRtn *pRtn);
@@ -41,6 +50,10 @@ int tsdbWriteBlockIdx(SDFile *pHeadf, SArray *pIdxA, void **ppBuf);
 int   tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
                          SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf);
 int   tsdbApplyRtn(STsdbRepo *pRepo);
+int   tsdbInitCommitFSetPool();
+void  tsdbDestroyCommitFSetPool();
+int   tsdbInitCommitCompPool();
+void  tsdbDestroyCommitCompPool();
 
 static FORCE_INLINE int tsdbGetFidLevel(int fid, SRtn *pRtn) {
   if (fid >= pRtn->maxFid) {
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_IDX_CACHE_H_
+#define _TD_TSDB_IDX_CACHE_H_
+
+#include "tsdbReadImpl.h"
+
+// A memory bounded LRU cache of the decoded parts of HEAD files shared by all queries of a vnode: the SBlockIdx
+// array of each FSET and the SBlockInfo of each table.
+//
+// The SBlockIdx array is identified by (fid, generation) and the SBlockInfo by (fid, generation, uid). The
+// generation of a fid is bumped each time the HEAD file of the FSET is replaced, that is each time the FSET is
+// committed to, compacted or synced. A SBlockIdx array is referenced by the queries using it, so it stays valid
+// after it is evicted or invalidated until the last query releases it.
+typedef struct SIdxCache SIdxCache;
+
+SIdxCache *tsdbNewIdxCache(int64_t capacity);
+void       tsdbFreeIdxCache(SIdxCache *pCache);
+int64_t    tsdbIdxCacheGetGen(SIdxCache *pCache, int fid);
+void *     tsdbIdxCacheGetBlockIdx(SIdxCache *pCache, int fid, int64_t gen, SBlockIdx **ppBlkIdx, int *numOfBlkIdx);
+void       tsdbIdxCachePutBlockIdx(SIdxCache *pCache, int fid, int64_t gen, SArray *aBlkIdx);
+void       tsdbIdxCacheRelease(SIdxCache *pCache, void *pHandle);
+int        tsdbIdxCacheGetBlockInfo(SIdxCache *pCache, int fid, int64_t gen, uint64_t uid, SBlockInfo **ppBlkInfo,
+                                    uint32_t *len);
+void       tsdbIdxCachePutBlockInfo(SIdxCache *pCache, int fid, int64_t gen, uint64_t uid, SBlockInfo *pBlkInfo,
+                                    uint32_t len);
+void       tsdbIdxCacheInvalidate(SIdxCache *pCache, int fid);
+void       tsdbIdxCacheInvalidateAll(SIdxCache *pCache);
+
+#endif /* _TD_TSDB_IDX_CACHE_H_ */
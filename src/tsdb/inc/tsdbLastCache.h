@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_LAST_CACHE_H_
+#define _TD_TSDB_LAST_CACHE_H_
+
+// The LAST cache file keeps the lastKey, lastRow and lastCols of the tables so that a repository can be opened
+// without scanning the newest blocks of every table. It is rewritten at the end of each commit and only belongs
+// to the FS status it was written with, any other change of the FS makes it ignored.
+//
+// The cache of a table is saved only when it does not hold rows newer than the committed data, that is when the
+// table has no rows in the working memtable. The other tables are restored from the data files when the
+// repository is opened, before the WAL is replayed over them.
+#define TSDB_LAST_CACHE_FNAME "lastcache"
+#define TSDB_LAST_CACHE_TFNAME "lastcache.t"
+
+void tsdbGetLastCacheFname(int repoid, bool tmp, char fname[]);
+int  tsdbSaveLastCacheFile(STsdbRepo *pRepo);
+int  tsdbLoadLastCacheFile(STsdbRepo *pRepo, uint8_t *restored);
+bool tsdbIsLastCacheFileValid(STsdbRepo *pRepo);
+void tsdbRemoveLastCacheFile(STsdbRepo *pRepo);
+
+#endif /* _TD_TSDB_LAST_CACHE_H_ */
@@ -26,20 +26,45 @@ typedef struct {
   TSKEY keyLast;
 } SMergeInfo;
 
+// The in-order rows of a table are appended to chunks of doubling size, 16 rows in the first one and 4096 rows in the
+// largest ones. A chunk keeps the keys of its rows followed by the row pointers. The chunks and the array of them are
+// allocated from the buffer of the memtable like the rows, so they are never moved or freed before the memtable, and
+// the rows published by the write thread are read without lock. A larger array of chunks is published before the rows
+// of the new chunk, the old one stays valid.
+#define TSDB_MEM_ROWS_FIRST_CHUNK_BITS 4
+#define TSDB_MEM_ROWS_MAX_CHUNK_BITS 12
+#define TSDB_MEM_ROWS_MAX_ROWS (1 << 25)
+
 typedef struct {
-  STable *           pTable;
-  SSkipListIterator *pIter;
-} SCommitIter;
+  int32_t numOfRows;    // published after the key and the row are set
+  int32_t maxChunks;    // capacity of the array of chunks
+  void**  chunks;
+} SMemRows;
 
 struct STableData {
   uint64_t   uid;
   TSKEY      keyFirst;
   TSKEY      keyLast;
   int64_t    numOfRows;
-  SSkipList* pData;
+  SSkipList* pData;  // created for the first out-of-order or duplicate key, then all rows are in the skiplist
+  SMemRows   rows;   // rows appended in order before the skiplist is created
   T_REF_DECLARE()
 };
 
+typedef struct {
+  SSkipList*        pSkipList;  // NULL if the iterator walks the in-order rows
+  SSkipListIterator slIter;
+  SMemRows*         pRows;
+  int32_t           numOfRows;  // in-order rows visible to the iterator
+  int32_t           cur;
+  int32_t           order;
+} STableDataIter;
+
+typedef struct {
+  STable *        pTable;
+  STableDataIter *pIter;
+} SCommitIter;
+
 enum { TSDB_UPDATE_META, TSDB_DROP_META };
 
 #ifdef WINDOWS
@@ -64,30 +89,102 @@ int   tsdbRefMemTable(STsdbRepo* pRepo, SMemTable* pMemTable);
 int   tsdbUnRefMemTable(STsdbRepo* pRepo, SMemTable* pMemTable);
 int   tsdbTakeMemSnapshot(STsdbRepo* pRepo, SMemSnapshot* pSnapshot, SArray* pATable);
 void  tsdbUnTakeMemSnapShot(STsdbRepo* pRepo, SMemSnapshot* pSnapshot);
+int   tsdbGetMemArenaUsage(STsdbRepo* pRepo, int64_t* numOfPages, int64_t* allocBytes);
 void* tsdbAllocBytes(STsdbRepo* pRepo, int bytes);
 int   tsdbAsyncCommit(STsdbRepo* pRepo);
 int   tsdbSyncCommitConfig(STsdbRepo* pRepo);
-int   tsdbLoadDataFromCache(STable* pTable, SSkipListIterator* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
+int   tsdbLoadDataFromCache(STable* pTable, STableDataIter* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
                             TKEY* filterKeys, int nFilterKeys, bool keepDup, SMergeInfo* pMergeInfo);
 void* tsdbCommitData(STsdbRepo* pRepo);
 
-static FORCE_INLINE SMemRow tsdbNextIterRow(SSkipListIterator* pIter) {
+STableDataIter* tsdbCreateTableDataIter(STableData* pTableData, const TSKEY* pKey, int32_t order);
+void*           tsdbDestroyTableDataIter(STableDataIter* pIter);
+int32_t         tsdbTableDataIterGetRun(STableDataIter* pIter, TSKEY maxKey, int32_t maxRows, SMemRow** ppRows,
+                                        TSKEY** ppKeys);
+
+static FORCE_INLINE int32_t tsdbMemRowsChunkOf(int32_t idx, int32_t* offset) {
+  if (idx < (1 << TSDB_MEM_ROWS_FIRST_CHUNK_BITS)) {
+    *offset = idx;
+    return 0;
+  }
+
+  if (idx >= (1 << TSDB_MEM_ROWS_MAX_CHUNK_BITS)) {
+    *offset = idx & ((1 << TSDB_MEM_ROWS_MAX_CHUNK_BITS) - 1);
+    return (idx >> TSDB_MEM_ROWS_MAX_CHUNK_BITS) + TSDB_MEM_ROWS_MAX_CHUNK_BITS - TSDB_MEM_ROWS_FIRST_CHUNK_BITS;
+  }
+
+  int32_t bits = 31 - BUILDIN_CLZ((uint32_t)idx);
+  *offset = idx - (1 << bits);
+  return bits - TSDB_MEM_ROWS_FIRST_CHUNK_BITS + 1;
+}
+
+static FORCE_INLINE int32_t tsdbMemRowsChunkSize(int32_t chunk) {
+  if (chunk == 0) return (1 << TSDB_MEM_ROWS_FIRST_CHUNK_BITS);
+  if (chunk > TSDB_MEM_ROWS_MAX_CHUNK_BITS - TSDB_MEM_ROWS_FIRST_CHUNK_BITS) return (1 << TSDB_MEM_ROWS_MAX_CHUNK_BITS);
+  return (1 << (chunk + TSDB_MEM_ROWS_FIRST_CHUNK_BITS - 1));
+}
+
+static FORCE_INLINE TSKEY* tsdbMemRowsKeys(SMemRows* pRows, int32_t chunk) {
+  void** chunks = (void**)atomic_load_ptr(&pRows->chunks);
+  return (TSKEY*)chunks[chunk];
+}
+
+static FORCE_INLINE SMemRow* tsdbMemRowsRows(SMemRows* pRows, int32_t chunk) {
+  return (SMemRow*)(tsdbMemRowsKeys(pRows, chunk) + tsdbMemRowsChunkSize(chunk));
+}
+
+static FORCE_INLINE TSKEY tsdbMemRowsKeyAt(SMemRows* pRows, int32_t idx) {
+  int32_t offset = 0;
+  int32_t chunk = tsdbMemRowsChunkOf(idx, &offset);
+  return tsdbMemRowsKeys(pRows, chunk)[offset];
+}
+
+static FORCE_INLINE SMemRow tsdbMemRowsRowAt(SMemRows* pRows, int32_t idx) {
+  int32_t offset = 0;
+  int32_t chunk = tsdbMemRowsChunkOf(idx, &offset);
+  return tsdbMemRowsRows(pRows, chunk)[offset];
+}
+
+static FORCE_INLINE bool tsdbTableDataIterNext(STableDataIter* pIter) {
+  if (pIter->pSkipList != NULL) return tSkipListIterNext(&pIter->slIter);
+
+  if (pIter->order == TSDB_ORDER_ASC) {
+    if (pIter->cur < pIter->numOfRows) pIter->cur++;
+    return pIter->cur < pIter->numOfRows;
+  } else {
+    if (pIter->cur >= 0) pIter->cur--;
+    return pIter->cur >= 0;
+  }
+}
+
+// Move an iterator of the in-order rows to the last row of a run got by tsdbTableDataIterGetRun
+static FORCE_INLINE void tsdbTableDataIterSkip(STableDataIter* pIter, int32_t rows) {
+  ASSERT(pIter->pSkipList == NULL);
+  pIter->cur += (pIter->order == TSDB_ORDER_ASC) ? rows : -rows;
+}
+
+static FORCE_INLINE SMemRow tsdbNextIterRow(STableDataIter* pIter) {
   if (pIter == NULL) return NULL;
 
-  SSkipListNode* node = tSkipListIterGet(pIter);
-  if (node == NULL) return NULL;
+  if (pIter->pSkipList != NULL) {
+    SSkipListNode* node = tSkipListIterGet(&pIter->slIter);
+    if (node == NULL) return NULL;
+
+    return (SMemRow)SL_GET_NODE_DATA(node);
+  }
 
-  return (SMemRow)SL_GET_NODE_DATA(node);
+  if (pIter->cur < 0 || pIter->cur >= pIter->numOfRows) return NULL;
+  return tsdbMemRowsRowAt(pIter->pRows, pIter->cur);
 }
 
-static FORCE_INLINE TSKEY tsdbNextIterKey(SSkipListIterator* pIter) {
+static FORCE_INLINE TSKEY tsdbNextIterKey(STableDataIter* pIter) {
   SMemRow row = tsdbNextIterRow(pIter);
   if (row == NULL) return TSDB_DATA_TIMESTAMP_NULL;
 
   return memRowKey(row);
 }
 
-static FORCE_INLINE TKEY tsdbNextIterTKey(SSkipListIterator* pIter) {
+static FORCE_INLINE TKEY tsdbNextIterTKey(STableDataIter* pIter) {
   SMemRow row = tsdbNextIterRow(pIter);
   if (row == NULL) return TKEY_NULL;
 
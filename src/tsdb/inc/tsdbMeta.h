@@ -16,6 +16,8 @@
 #ifndef _TD_TSDB_META_H_
 #define _TD_TSDB_META_H_
 
+#include "tsdbTagIndex.h"
+
 #define TSDB_MAX_TABLE_SCHEMAS 16
 
 #pragma  pack (push,1)
@@ -36,6 +38,7 @@ typedef struct STable {
   STSchema*      tagSchema;
   SKVRow         tagVal;
   SSkipList*     pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  STagIndex*     pTagIndex;      // For TSDB_SUPER_TABLE, the inverted indexes of all tags if tagIndex is enabled
   SHashObj*      jsonKeyMap;     // For json tag key  {"key":[t1, t2, t3]}
   void*          eventHandler;   // TODO
   void*          streamHandler;  // TODO
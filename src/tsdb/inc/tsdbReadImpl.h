@@ -22,9 +22,21 @@
 #include "tsdbFile.h"
 #include "tskiplist.h"
 #include "tsdbMeta.h"
+#include "tsdbBlockCache.h"
+#include "tsdbCodec.h"
 
 typedef struct SReadH SReadH;
 
+typedef struct SReadAhead SReadAhead;
+
+typedef struct {
+  int64_t nBlocks;  // # of blocks read ahead
+  int64_t nBytes;   // bytes read ahead
+  int64_t nHit;     // # of block reads served by the read-ahead buffers
+  int64_t nMiss;    // # of block reads from files
+  int64_t waitUs;   // time waiting for the read-ahead in flight
+} SReadAheadStat;
+
 typedef struct {
   int32_t  tid;
   uint32_t len;
@@ -69,11 +81,14 @@ typedef struct {
 /**
  * aggrStat;   // only valid when blkVer > 0. 0 - no aggr part in .data/.last/.smad/.smal, 1 - has aggr in .smad/.smal
  * blkVer;     // 0 - original block, 1 - block since importing .smad/.smal
+ * hasBloom;   // only valid when aggrStat > 0. 1 - bloom filters follow the aggr part in .smad/.smal. It is the
+ *             // highest bit of the former 7-bit blkVer, so older versions take such blocks as of an unknown blkVer
  * aggrOffset; // only valid when blkVer > 0 and aggrStat > 0
  */
 #define SBlockFieldsP1   \
   uint64_t aggrStat : 1; \
-  uint64_t blkVer : 7;   \
+  uint64_t blkVer : 6;   \
+  uint64_t hasBloom : 1; \
   uint64_t aggrOffset : 56
 
 typedef struct {
@@ -120,7 +135,7 @@ typedef struct {
 typedef struct {
   int16_t  colId;
   uint8_t  offsetH;
-  uint8_t  reserved;  // reserved field, not used
+  uint8_t  codec;  // TSDB_COL_CODEC_XXX the column is compressed by
   int32_t  len;
   uint32_t type : 8;
   uint32_t offset : 24;
@@ -161,6 +176,29 @@ typedef struct {
 
 typedef void SAggrBlkData;  // SBlockCol cols[];
 
+/**
+ * Bloom filters of a block for equality lookups, written right after the aggr part of the block:
+ * SBlockBloomHead | SBlockBloomCol[numOfCols] | numOfCols filters of len bytes each | TSCKSUM
+ */
+typedef struct {
+  int32_t len;        // bytes of the filter of each column
+  int16_t numOfCols;  // # of columns with a filter
+  int16_t reserved;
+} SBlockBloomHead;
+
+typedef struct {
+  int16_t colId;
+  int16_t reserved;
+} SBlockBloomCol;
+
+typedef void SBlockBloomData;
+
+#define TSDB_BLOOM_BITS_PER_KEY 10
+#define TSDB_BLOOM_NUM_OF_HASHES 7
+#define TSDB_BLOOM_HAS_FILTER(type)                                                                   \
+  (IS_SIGNED_NUMERIC_TYPE(type) || IS_UNSIGNED_NUMERIC_TYPE(type) || (type) == TSDB_DATA_TYPE_BOOL || \
+   (type) == TSDB_DATA_TYPE_TIMESTAMP || (type) == TSDB_DATA_TYPE_BINARY)
+
 struct SReadH {
   STsdbRepo * pRepo;
   SDFileSet   rSet;     // FSET to read
@@ -175,6 +213,19 @@ struct SReadH {
   void *      pBuf;   // buffer
   void *      pCBuf;  // compression buffer
   void *      pExBuf;  // extra buffer
+  SReadAhead *pRa;     // NULL if blocks are not read ahead
+  SBlockCache *pCache;    // NULL if decompressed blocks are not cached
+  int64_t      cacheGen;  // generation of the FSET in the block cache
+  struct SIdxCache *pIdxCache;    // NULL if the SBlockIdx and SBlockInfo are not cached
+  int64_t           idxGen;       // generation of the FSET in the index cache
+  void *            pIdxHandle;   // cached SBlockIdx array in use, NULL if aBlkIdx is used
+  SBlockIdx *       pCachedIdx;   // SBlockIdx array of pIdxHandle
+  int               numOfCachedIdx;
+  SBlockBloomData *pBloom;  // bloom filters of the block loaded by tsdbLoadBlockBloom
+  void *           pDictBuf;    // column chunk read by tsdbLoadBlockColDict, reused by tsdbLoadColData
+  SDFile *         pDictFile;   // file of the chunk in pDictBuf
+  int64_t          dictOffset;  // offset of the chunk in pDictBuf
+  int32_t          dictLen;     // length of the chunk in pDictBuf, 0 if there is none
 };
 
 #define TSDB_READ_REPO(rh) ((rh)->pRepo)
@@ -216,6 +267,15 @@ static FORCE_INLINE size_t tsdbBlockAggrSize(int nCols, uint32_t blkVer) {
   }
 }
 
+static FORCE_INLINE size_t tsdbBlockBloomSize(int nCols, int32_t len) {
+  return sizeof(SBlockBloomHead) + (sizeof(SBlockBloomCol) + len) * nCols + sizeof(TSCKSUM);
+}
+
+// bytes of the bloom filter of a column with numOfRows values, in multiple of 8 bytes
+static FORCE_INLINE int32_t tsdbBlockBloomLen(int numOfRows) {
+  return ((numOfRows * TSDB_BLOOM_BITS_PER_KEY + 63) / 64) * 8;
+}
+
 int   tsdbInitReadH(SReadH *pReadh, STsdbRepo *pRepo);
 void  tsdbDestroyReadH(SReadH *pReadh);
 int   tsdbSetAndOpenReadFSet(SReadH *pReadh, SDFileSet *pSet);
@@ -230,6 +290,17 @@ int   tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock);
 int   tsdbEncodeSBlockIdx(void **buf, SBlockIdx *pIdx);
 void *tsdbDecodeSBlockIdx(void *buf, SBlockIdx *pIdx);
 void  tsdbGetBlockStatis(SReadH *pReadh, SDataStatis *pStatis, int numOfCols, SBlock *pBlock);
+int   tsdbEnableReadAhead(SReadH *pReadh, int nBlocks);
+void  tsdbReadAheadBlock(SReadH *pReadh, SBlock *pBlock);
+void  tsdbGetReadAheadStat(SReadH *pReadh, SReadAheadStat *pStat);
+void  tsdbEnableBlockCache(SReadH *pReadh);
+void  tsdbEnableIdxCache(SReadH *pReadh);
+int   tsdbLoadBlockBloom(SReadH *pReadh, SBlock *pBlock);
+bool  tsdbBlockBloomMayContain(SReadH *pReadh, int16_t colId, int8_t type, const void *pVal);
+uint32_t tsdbBlockBloomHash(int8_t type, const void *pVal);
+void  tsdbBlockBloomAdd(uint8_t *pFilter, int32_t len, uint32_t hash);
+bool  tsdbBlockBloomTest(const uint8_t *pFilter, int32_t len, uint32_t hash);
+int   tsdbLoadBlockColDict(SReadH *pReadh, SBlock *pBlock, int16_t colId, const char **ppDict);
 
 static FORCE_INLINE int tsdbMakeRoom(void **ppBuf, size_t size) {
   void * pBuf = *ppBuf;
@@ -265,6 +336,7 @@ static FORCE_INLINE SBlockCol *tsdbGetSBlockCol(SBlock *pBlock, SBlockCol **pDes
     (*pDestBlkCol)->type = pBlkCol->type;
     (*pDestBlkCol)->offset = pBlkCol->offset;
     (*pDestBlkCol)->offsetH = pBlkCol->offsetH;
+    (*pDestBlkCol)->codec = TSDB_COL_CODEC_DEFAULT;
   }
   return *pDestBlkCol;
 }
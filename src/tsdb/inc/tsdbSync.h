@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_SYNC_H_
+#define _TD_TSDB_SYNC_H_
+
+// Decisions of the receiver for a file, the metafile is either skipped or sent fully. TSDB_SYNC_INCR is only sent to
+// a sender which accepts it in the metainfo, the senders of old versions take any decision but skip as a full sync.
+#define TSDB_SYNC_SKIP 0
+#define TSDB_SYNC_FULL 1
+#define TSDB_SYNC_INCR 2
+
+// Set in the length of the metainfo by a sender whose receiver has TAOS_SYNC_CAP_FILE_INCR, to tell the receiver the
+// filesets can be synced incrementally
+#define TSDB_SYNC_META_INCR 0x80000000u
+
+// An incrementally synced file is split into ranges, only the ranges whose digests differ from the ranges of the
+// local file at the same offsets are transferred. Commits append blocks to the data and last files in place, so the
+// ranges before the appended blocks are kept. The file header rewritten by each commit is a range by itself.
+#define TSDB_SYNC_RANGE_SIZE (256 * 1024)
+#define TSDB_SYNC_DIGEST_LEN 16
+
+static FORCE_INLINE uint32_t tsdbSyncNRanges(uint64_t size) {
+  if (size <= TSDB_FILE_HEAD_SIZE) return size > 0 ? 1 : 0;
+  return 1 + (uint32_t)((size - TSDB_FILE_HEAD_SIZE + TSDB_SYNC_RANGE_SIZE - 1) / TSDB_SYNC_RANGE_SIZE);
+}
+
+static FORCE_INLINE int64_t tsdbSyncRangeOffset(uint32_t i) {
+  return i == 0 ? 0 : TSDB_FILE_HEAD_SIZE + (int64_t)(i - 1) * TSDB_SYNC_RANGE_SIZE;
+}
+
+static FORCE_INLINE int64_t tsdbSyncRangeLen(uint64_t size, uint32_t i) {
+  if (i == 0) return MIN(TSDB_FILE_HEAD_SIZE, (int64_t)size);
+  return MIN(TSDB_SYNC_RANGE_SIZE, (int64_t)size - tsdbSyncRangeOffset(i));
+}
+
+// Whether the range i of a file of size may be kept from the local file of lsize, which is when the local file has
+// the range of the same length. The digests of the two ranges decide then.
+static FORCE_INLINE bool tsdbSyncRangeReusable(uint64_t size, uint64_t lsize, uint32_t i) {
+  return i < tsdbSyncNRanges(lsize) && tsdbSyncRangeLen(size, i) == tsdbSyncRangeLen(lsize, i);
+}
+
+#endif /* _TD_TSDB_SYNC_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_TAG_INDEX_H_
+#define _TD_TSDB_TAG_INDEX_H_
+
+#include "tbitmap.h"
+#include "tdataformat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Inverted indexes of the tags of a super table. The index of a tag column maps each tag value to the bitmap of the
+// tids of the child tables with the value, so equal and in conditions on any tags are answered by bitmap operations
+// instead of scanning all child tables. NULL tags are not indexed since these conditions never match them. Float and
+// double tags are not indexed since equal values may have different bits.
+//
+// The index is protected by the meta lock of the repository like the skiplist index of the first tag.
+typedef struct STagIndex STagIndex;
+
+#define TSDB_TAG_INDEX_TYPE(t) ((t) != TSDB_DATA_TYPE_FLOAT && (t) != TSDB_DATA_TYPE_DOUBLE && (t) != TSDB_DATA_TYPE_JSON)
+
+STagIndex *tsdbNewTagIndex();
+void       tsdbFreeTagIndex(STagIndex *pIndex);
+void       tsdbTagIndexAdd(STagIndex *pIndex, STSchema *pTagSchema, SKVRow tagVal, int32_t tid);
+void       tsdbTagIndexRemove(STagIndex *pIndex, STSchema *pTagSchema, SKVRow tagVal, int32_t tid);
+bool       tsdbTagIndexGet(STagIndex *pIndex, int16_t colId, int8_t type, const void *val, int32_t len,
+                           const SBitmap **ppBitmap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TD_TSDB_TAG_INDEX_H_ */
@@ -60,12 +60,22 @@ extern "C" {
 #include "tsdbFile.h"
 // FS
 #include "tsdbFS.h"
+// File sync
+#include "tsdbSync.h"
+// Block Cache
+#include "tsdbBlockCache.h"
+// Column Codec
+#include "tsdbCodec.h"
 // ReadImpl
 #include "tsdbReadImpl.h"
+// Index Cache
+#include "tsdbIdxCache.h"
 // Commit
 #include "tsdbCommit.h"
 // Compact
 #include "tsdbCompact.h"
+// LAST cache file
+#include "tsdbLastCache.h"
 // Commit Queue
 #include "tsdbCommitQueue.h"
 
@@ -94,6 +104,9 @@ struct STsdbRepo {
   pthread_mutex_t mutex;
   bool            repoLocked;
   int32_t         code;  // Commit code
+  SCommitStat     commitStat;
+  SBlockCache*    pBlockCache;  // NULL if decompressed blocks are not cached
+  SIdxCache*      pIdxCache;    // NULL if the SBlockIdx and SBlockInfo of HEAD files are not cached
 
   SMergeBuf       mergeBuf;  //used when update=2
   int8_t          compactState;  // compact state: inCompact/noCompact/waitingCompact?
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+typedef struct {
+  int32_t fid;
+  int8_t  ftype;
+  int8_t  reserved;
+  int16_t colId;
+  int64_t gen;
+  int64_t offset;
+} SBlockCacheKey;
+
+typedef struct SBlockCacheEntry {
+  struct SBlockCacheEntry *prev;
+  struct SBlockCacheEntry *next;
+  SBlockCacheKey           key;
+  int32_t                  len;
+  char                     data[];
+} SBlockCacheEntry;
+
+struct SBlockCache {
+  pthread_mutex_t   mutex;
+  SHashObj *        pEntries;  // SBlockCacheKey -> SBlockCacheEntry *
+  SHashObj *        pGens;     // fid -> generation
+  SBlockCacheEntry *head;      // most recently used
+  SBlockCacheEntry *tail;      // least recently used
+  int64_t           capacity;
+  int64_t           used;
+};
+
+#define TSDB_BLOCK_CACHE_ENTRY_SIZE(len) (sizeof(SBlockCacheEntry) + (len))
+
+// statistics of all vnodes, reported by the monitor
+static STsdbBlockCacheStat tsBlockCacheStat = {0};
+
+static void tsdbBlockCacheUnlink(SBlockCache *pCache, SBlockCacheEntry *pEntry);
+static void tsdbBlockCacheLinkHead(SBlockCache *pCache, SBlockCacheEntry *pEntry);
+static void tsdbBlockCacheRemove(SBlockCache *pCache, SBlockCacheEntry *pEntry);
+static void tsdbBlockCacheSetKey(SBlockCacheKey *pKey, int fid, int64_t gen, int8_t ftype, int64_t offset,
+                                 int16_t colId);
+
+SBlockCache *tsdbNewBlockCache(int64_t capacity) {
+  SBlockCache *pCache = (SBlockCache *)calloc(1, sizeof(*pCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pCache->pEntries = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  pCache->pGens = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_NO_LOCK);
+  if (pCache->pEntries == NULL || pCache->pGens == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    taosHashCleanup(pCache->pEntries);
+    taosHashCleanup(pCache->pGens);
+    free(pCache);
+    return NULL;
+  }
+
+  pthread_mutex_init(&(pCache->mutex), NULL);
+  pCache->capacity = capacity;
+
+  return pCache;
+}
+
+void tsdbFreeBlockCache(SBlockCache *pCache) {
+  if (pCache == NULL) return;
+
+  tsdbBlockCacheInvalidateAll(pCache);
+  taosHashCleanup(pCache->pEntries);
+  taosHashCleanup(pCache->pGens);
+  pthread_mutex_destroy(&(pCache->mutex));
+  free(pCache);
+}
+
+int64_t tsdbBlockCacheGetGen(SBlockCache *pCache, int fid) {
+  int64_t gen = 0;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (pGen != NULL) {
+    gen = *pGen;
+  } else {
+    // Record the fid so that invalidating all the cache also moves it to a new generation
+    taosHashPut(pCache->pGens, &fid, sizeof(fid), &gen, sizeof(gen));
+  }
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  return gen;
+}
+
+// Copy the cached chunk to pDataCol, return 0 if it is found and -1 otherwise
+int tsdbBlockCacheGet(SBlockCache *pCache, int fid, int64_t gen, int8_t ftype, int64_t offset, SDataCol *pDataCol,
+                      int numOfRows, int maxPoints) {
+  SBlockCacheKey key;
+  tsdbBlockCacheSetKey(&key, fid, gen, ftype, offset, pDataCol->colId);
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  SBlockCacheEntry **ppEntry = (SBlockCacheEntry **)taosHashGet(pCache->pEntries, &key, sizeof(key));
+  if (ppEntry == NULL || (*ppEntry)->len > pDataCol->bytes * maxPoints || tdAllocMemForCol(pDataCol, maxPoints) < 0) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    atomic_add_fetch_64(&tsBlockCacheStat.misses, 1);
+    return -1;
+  }
+
+  SBlockCacheEntry *pEntry = *ppEntry;
+  memcpy(pDataCol->pData, pEntry->data, pEntry->len);
+  pDataCol->len = pEntry->len;
+
+  if (pCache->head != pEntry) {
+    tsdbBlockCacheUnlink(pCache, pEntry);
+    tsdbBlockCacheLinkHead(pCache, pEntry);
+  }
+
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  if (IS_VAR_DATA_TYPE(pDataCol->type)) {
+    dataColSetOffset(pDataCol, numOfRows);
+  }
+
+  atomic_add_fetch_64(&tsBlockCacheStat.hits, 1);
+  return 0;
+}
+
+void tsdbBlockCachePut(SBlockCache *pCache, int fid, int64_t gen, int8_t ftype, int64_t offset, SDataCol *pDataCol) {
+  int64_t size = TSDB_BLOCK_CACHE_ENTRY_SIZE(pDataCol->len);
+  if (size > pCache->capacity) return;
+
+  SBlockCacheEntry *pEntry = (SBlockCacheEntry *)malloc(size);
+  if (pEntry == NULL) return;
+
+  tsdbBlockCacheSetKey(&(pEntry->key), fid, gen, ftype, offset, pDataCol->colId);
+  pEntry->prev = NULL;
+  pEntry->next = NULL;
+  pEntry->len = pDataCol->len;
+  memcpy(pEntry->data, pDataCol->pData, pDataCol->len);
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  // The FSET is replaced after the chunk is loaded, or another query has already cached it
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (pGen == NULL || *pGen != gen ||
+      taosHashGet(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key)) != NULL) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  while (pCache->used + size > pCache->capacity && pCache->tail != NULL) {
+    tsdbBlockCacheRemove(pCache, pCache->tail);
+    atomic_add_fetch_64(&tsBlockCacheStat.evictions, 1);
+  }
+
+  if (taosHashPut(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key), &pEntry, sizeof(pEntry)) < 0) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  tsdbBlockCacheLinkHead(pCache, pEntry);
+  pCache->used += size;
+
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  atomic_add_fetch_64(&tsBlockCacheStat.bytes, size);
+  atomic_add_fetch_64(&tsBlockCacheStat.entries, 1);
+}
+
+// Drop all chunks of the FSET and move it to a new generation. It is called with the FS write lock held when the
+// DATA or LAST file of the FSET is replaced, so queries opening the FSET later never see the chunks of old files.
+void tsdbBlockCacheInvalidate(SBlockCache *pCache, int fid) {
+  pthread_mutex_lock(&(pCache->mutex));
+
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (pGen != NULL) {
+    (*pGen)++;
+  }
+
+  SBlockCacheEntry *pEntry = pCache->head;
+  while (pEntry != NULL) {
+    SBlockCacheEntry *pNext = pEntry->next;
+    if (pEntry->key.fid == fid) {
+      tsdbBlockCacheRemove(pCache, pEntry);
+    }
+    pEntry = pNext;
+  }
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+void tsdbBlockCacheInvalidateAll(SBlockCache *pCache) {
+  pthread_mutex_lock(&(pCache->mutex));
+
+  int64_t *pGen = taosHashIterate(pCache->pGens, NULL);
+  while (pGen != NULL) {
+    (*pGen)++;
+    pGen = taosHashIterate(pCache->pGens, pGen);
+  }
+
+  while (pCache->head != NULL) {
+    tsdbBlockCacheRemove(pCache, pCache->head);
+  }
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+void tsdbGetBlockCacheStat(STsdbBlockCacheStat *pStat) {
+  pStat->hits = atomic_exchange_64(&tsBlockCacheStat.hits, 0);
+  pStat->misses = atomic_exchange_64(&tsBlockCacheStat.misses, 0);
+  pStat->evictions = atomic_exchange_64(&tsBlockCacheStat.evictions, 0);
+  pStat->bytes = atomic_load_64(&tsBlockCacheStat.bytes);
+  pStat->entries = atomic_load_64(&tsBlockCacheStat.entries);
+}
+
+static void tsdbBlockCacheUnlink(SBlockCache *pCache, SBlockCacheEntry *pEntry) {
+  if (pEntry->prev) {
+    pEntry->prev->next = pEntry->next;
+  } else {
+    pCache->head = pEntry->next;
+  }
+
+  if (pEntry->next) {
+    pEntry->next->prev = pEntry->prev;
+  } else {
+    pCache->tail = pEntry->prev;
+  }
+
+  pEntry->prev = NULL;
+  pEntry->next = NULL;
+}
+
+static void tsdbBlockCacheLinkHead(SBlockCache *pCache, SBlockCacheEntry *pEntry) {
+  pEntry->prev = NULL;
+  pEntry->next = pCache->head;
+  if (pCache->head) {
+    pCache->head->prev = pEntry;
+  } else {
+    pCache->tail = pEntry;
+  }
+  pCache->head = pEntry;
+}
+
+static void tsdbBlockCacheRemove(SBlockCache *pCache, SBlockCacheEntry *pEntry) {
+  int64_t size = TSDB_BLOCK_CACHE_ENTRY_SIZE(pEntry->len);
+
+  tsdbBlockCacheUnlink(pCache, pEntry);
+  taosHashRemove(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key));
+  pCache->used -= size;
+  free(pEntry);
+
+  atomic_sub_fetch_64(&tsBlockCacheStat.bytes, size);
+  atomic_sub_fetch_64(&tsBlockCacheStat.entries, 1);
+}
+
+static void tsdbBlockCacheSetKey(SBlockCacheKey *pKey, int fid, int64_t gen, int8_t ftype, int64_t offset,
+                                 int16_t colId) {
+  memset(pKey, 0, sizeof(*pKey));
+  pKey->fid = fid;
+  pKey->ftype = ftype;
+  pKey->colId = colId;
+  pKey->gen = gen;
+  pKey->offset = offset;
+}
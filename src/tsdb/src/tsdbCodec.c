@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+#include "tglobal.h"
+
+#define TSDB_MAX_COL_CODEC_RULES 64
+#define TSDB_CODEC_SAMPLE_ROWS   512  // rows in the middle of a block tried by the adaptive codec
+#define TSDB_CODEC_GAIN_RATIO    8    // a slower codec is chosen only if it saves 1/8 of the faster one
+
+// A rule of the columnCodec config: [<db>.]<table>.<column id>=<codec>
+typedef struct {
+  char      db[TSDB_DB_NAME_LEN];       // empty string matches any database
+  char      name[TSDB_TABLE_NAME_LEN];  // empty string matches any table
+  int16_t   colId;                      // -1 matches any column
+  SColCodec codec;
+} SColCodecRule;
+
+static SColCodecRule  tsdbCodecRules[TSDB_MAX_COL_CODEC_RULES];
+static int            tsdbNumOfCodecRules = 0;
+static pthread_once_t tsdbCodecRulesOnce = PTHREAD_ONCE_INIT;
+
+static int     tsdbParseColCodec(const char *str, SColCodec *pCodec);
+static int     tsdbParseCodecRule(char *str, SColCodecRule *pRule);
+static void    tsdbParseCodecRules(void);
+static int32_t tsdbEncodeColDataImpl(int8_t type, const void *pData, int32_t tlen, int rows, int8_t comp,
+                                     SColCodec codec, void *output, int32_t outputSize, void **ppCBuf,
+                                     uint8_t *pCodec);
+static int     tsdbChooseColCodec(SDataCol *pDataCol, int rows, int8_t comp, void *output, int32_t outputSize,
+                                  void **ppCBuf, SColCodec *pCodec);
+
+SColCodec tsdbGetColCodec(const char *db, STable *pTable, int16_t colId) {
+  SColCodec codec = {TSDB_COL_CODEC_DEFAULT, 0};
+
+  pthread_once(&tsdbCodecRulesOnce, tsdbParseCodecRules);
+  if (tsdbNumOfCodecRules == 0) return codec;
+
+  // Sub tables take the codecs of their super table
+  STable *pNamed = (TABLE_TYPE(pTable) == TSDB_CHILD_TABLE && pTable->pSuper != NULL) ? pTable->pSuper : pTable;
+  tstr *  name = TABLE_NAME(pNamed);
+
+  for (int i = 0; i < tsdbNumOfCodecRules; i++) {
+    SColCodecRule *pRule = tsdbCodecRules + i;
+    if (pRule->colId >= 0 && pRule->colId != colId) continue;
+    if (pRule->db[0] != 0 && strcmp(pRule->db, db) != 0) continue;
+    if (pRule->name[0] != 0 &&
+        (strlen(pRule->name) != name->len || strncmp(pRule->name, name->data, name->len) != 0)) {
+      continue;
+    }
+    return pRule->codec;
+  }
+
+  return codec;
+}
+
+int32_t tsdbEncodeColData(SDataCol *pDataCol, int rows, int8_t comp, SColCodec codec, void *output,
+                          int32_t outputSize, void **ppCBuf, uint8_t *pCodec) {
+  int32_t tlen = dataColGetNEleLen(pDataCol, rows);
+
+  if (codec.codec == TSDB_COL_CODEC_ADAPTIVE &&
+      tsdbChooseColCodec(pDataCol, rows, comp, output, outputSize, ppCBuf, &codec) < 0) {
+    return -1;
+  }
+
+  return tsdbEncodeColDataImpl(pDataCol->type, pDataCol->pData, tlen, rows, comp, codec, output, outputSize, ppCBuf,
+                               pCodec);
+}
+
+int32_t tsdbDecodeColData(SDataCol *pDataCol, void *input, int32_t inputSize, int8_t comp, uint8_t codec, int rows,
+                          char *buffer, int bufferSize) {
+  int8_t type = pDataCol->type;
+  int8_t algorithm = comp;
+
+  switch (codec) {
+    case TSDB_COL_CODEC_DEFAULT:
+      break;
+    case TSDB_COL_CODEC_FAST:
+      algorithm = ONE_STAGE_COMP;
+      break;
+    case TSDB_COL_CODEC_LZ4:
+      algorithm = TWO_STAGE_COMP;
+      break;
+    case TSDB_COL_CODEC_ZLIB: {
+      if (IS_VAR_DATA_TYPE(type)) {
+        return tsDecompressZlibImp(input, inputSize, pDataCol->pData, pDataCol->spaceSize);
+      }
+      int clen = tsDecompressZlibImp(input, inputSize, buffer, bufferSize);
+      if (clen <= 0) return -1;
+      return (*(tDataTypes[type].decompFunc))(buffer, clen, rows, pDataCol->pData, pDataCol->spaceSize,
+                                              ONE_STAGE_COMP, NULL, 0);
+    }
+    case TSDB_COL_CODEC_TSZ:
+#ifdef TD_TSZ
+      if (type == TSDB_DATA_TYPE_FLOAT) {
+        return tsDecompressFloatLossyImp(input, inputSize, rows, pDataCol->pData);
+      } else if (type == TSDB_DATA_TYPE_DOUBLE) {
+        return tsDecompressDoubleLossyImp(input, inputSize, rows, pDataCol->pData);
+      }
+#endif
+      return -1;
+    default:
+      tsdbError("unknown codec %d of column %d", codec, pDataCol->colId);
+      return -1;
+  }
+
+  if (algorithm == NO_COMPRESSION) {
+    if (inputSize > pDataCol->spaceSize) return -1;
+    memcpy(pDataCol->pData, input, inputSize);
+    return inputSize;
+  }
+
+  return (*(tDataTypes[type].decompFunc))(input, inputSize, rows, pDataCol->pData, pDataCol->spaceSize, algorithm,
+                                          buffer, bufferSize);
+}
+
+static int32_t tsdbEncodeColDataImpl(int8_t type, const void *pData, int32_t tlen, int rows, int8_t comp,
+                                     SColCodec codec, void *output, int32_t outputSize, void **ppCBuf,
+                                     uint8_t *pCodec) {
+  int8_t  algorithm = comp;
+  int32_t flen = -1;
+
+  switch (codec.codec) {
+    case TSDB_COL_CODEC_FAST:
+      algorithm = ONE_STAGE_COMP;
+      break;
+    case TSDB_COL_CODEC_LZ4:
+      algorithm = TWO_STAGE_COMP;
+      break;
+    case TSDB_COL_CODEC_ZLIB:
+      if (IS_VAR_DATA_TYPE(type)) {
+        flen = tsCompressZlibImp(pData, tlen, output, outputSize, codec.level);
+      } else {
+        if (tsdbMakeRoom(ppCBuf, tlen + COMP_OVERFLOW_BYTES) < 0) return -1;
+        int32_t clen = (*(tDataTypes[type].compFunc))((char *)pData, tlen, rows, *ppCBuf, tlen + COMP_OVERFLOW_BYTES,
+                                                      ONE_STAGE_COMP, NULL, 0);
+        if (clen < 0) return -1;
+        flen = tsCompressZlibImp(*ppCBuf, clen, output, outputSize, codec.level);
+      }
+      if (flen < 0) {
+        terrno = TSDB_CODE_TDB_INVALID_ACTION;
+        return -1;
+      }
+      *pCodec = TSDB_COL_CODEC_ZLIB;
+      return flen;
+    case TSDB_COL_CODEC_TSZ:
+#ifdef TD_TSZ
+      if (type == TSDB_DATA_TYPE_FLOAT) {
+        flen = tsCompressFloatLossyImp(pData, rows, output);
+      } else if (type == TSDB_DATA_TYPE_DOUBLE) {
+        flen = tsCompressDoubleLossyImp(pData, rows, output);
+      }
+      if (flen > 0) {
+        *pCodec = TSDB_COL_CODEC_TSZ;
+        return flen;
+      }
+#endif
+      // only float and double columns are lossy compressed, others by the algorithm of the block
+      break;
+    default:
+      break;
+  }
+
+  if (algorithm == NO_COMPRESSION) {
+    memcpy(output, pData, tlen);
+    *pCodec = TSDB_COL_CODEC_DEFAULT;
+    return tlen;
+  }
+
+  if (algorithm == TWO_STAGE_COMP && tsdbMakeRoom(ppCBuf, tlen + COMP_OVERFLOW_BYTES) < 0) {
+    return -1;
+  }
+
+  if (tsStringDictEncode && (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR)) {
+    // strings of a few distinct values are encoded by a dictionary, see tsdbGetBlockColDict
+    flen = tsCompressStringDictImp((char *)pData, tlen, rows, output, outputSize);
+  }
+  if (flen < 0) {
+    flen = (*(tDataTypes[type].compFunc))((char *)pData, tlen, rows, output, outputSize, algorithm,
+                                          (algorithm == TWO_STAGE_COMP) ? *ppCBuf : NULL, tlen + COMP_OVERFLOW_BYTES);
+  }
+
+  // Recorded as the default if it is the algorithm of the block, so the block can be read by older versions
+  if (algorithm == comp) {
+    *pCodec = TSDB_COL_CODEC_DEFAULT;
+  } else {
+    *pCodec = (algorithm == ONE_STAGE_COMP) ? TSDB_COL_CODEC_FAST : TSDB_COL_CODEC_LZ4;
+  }
+  return flen;
+}
+
+// Compress the rows in the middle of the block by the fast, LZ4 and zlib codecs to output, and choose the fastest
+// unless a slower one saves TSDB_CODEC_GAIN_RATIO of its size
+static int tsdbChooseColCodec(SDataCol *pDataCol, int rows, int8_t comp, void *output, int32_t outputSize,
+                              void **ppCBuf, SColCodec *pCodec) {
+  int8_t      type = pDataCol->type;
+  int         nrows = MIN(rows, TSDB_CODEC_SAMPLE_ROWS);
+  int         start = (rows - nrows) / 2;
+  const void *pData = tdGetColDataOfRow(pDataCol, start);
+  int32_t     tlen;
+  uint8_t     used;
+
+  if (IS_VAR_DATA_TYPE(type)) {
+    const void *pLast = tdGetColDataOfRow(pDataCol, start + nrows - 1);
+    tlen = (int32_t)((char *)pLast - (char *)pData) + varDataTLen(pLast);
+  } else {
+    tlen = TYPE_BYTES[type] * nrows;
+  }
+  ASSERT(tlen + COMP_OVERFLOW_BYTES <= outputSize);
+
+  SColCodec candidates[] = {
+      {TSDB_COL_CODEC_FAST, 0}, {TSDB_COL_CODEC_LZ4, 0}, {TSDB_COL_CODEC_ZLIB, TS_ZLIB_DEFAULT_LEVEL}};
+  int32_t bestLen = -1;
+
+  for (int i = 0; i < tListLen(candidates); i++) {
+    // strings are compressed by LZ4 in both stages
+    if (candidates[i].codec == TSDB_COL_CODEC_LZ4 && IS_VAR_DATA_TYPE(type)) continue;
+
+    int32_t flen = tsdbEncodeColDataImpl(type, pData, tlen, nrows, comp, candidates[i], output,
+                                         tlen + COMP_OVERFLOW_BYTES, ppCBuf, &used);
+    if (flen < 0) return -1;
+
+    if (bestLen < 0 || flen < bestLen - bestLen / TSDB_CODEC_GAIN_RATIO) {
+      *pCodec = candidates[i];
+      bestLen = flen;
+    }
+  }
+
+  tsdbTrace("column %d of %d rows chooses codec %d, %d bytes of %d sampled", pDataCol->colId, rows, pCodec->codec,
+            bestLen, tlen);
+  return 0;
+}
+
+static void tsdbParseCodecRules(void) {
+  char  buf[1024];
+  char  rule[1024];
+  char *saveptr = NULL;
+
+  tstrncpy(buf, tsColumnCodec, sizeof(buf));
+  for (char *str = strtok_r(buf, ",", &saveptr); str != NULL; str = strtok_r(NULL, ",", &saveptr)) {
+    if (tsdbNumOfCodecRules >= TSDB_MAX_COL_CODEC_RULES) {
+      tsdbWarn("too many column codec rules, rules from %s are ignored", str);
+      break;
+    }
+
+    // parsed in a copy, as the rule is split in place
+    tstrncpy(rule, str, sizeof(rule));
+    if (tsdbParseCodecRule(rule, tsdbCodecRules + tsdbNumOfCodecRules) < 0) {
+      tsdbWarn("invalid column codec rule %s is ignored", str);
+      continue;
+    }
+    tsdbNumOfCodecRules++;
+  }
+
+  if (tsdbNumOfCodecRules > 0) {
+    tsdbInfo("%d column codec rules are set by %s", tsdbNumOfCodecRules, tsColumnCodec);
+  }
+}
+
+static int tsdbParseCodecRule(char *str, SColCodecRule *pRule) {
+  char *eq = strchr(str, '=');
+  if (eq == NULL) return -1;
+  *eq = 0;
+
+  char *dot = strrchr(str, '.');
+  if (dot == NULL) return -1;
+  *dot = 0;
+
+  char *name = str;
+  char *col = dot + 1;
+
+  // the table may be prefixed by the database, table names have no '.'
+  pRule->db[0] = 0;
+  if ((dot = strchr(str, '.')) != NULL) {
+    *dot = 0;
+    name = dot + 1;
+    if (str[0] == 0 || strlen(str) >= TSDB_DB_NAME_LEN) return -1;
+    if (strcmp(str, "*") != 0) tstrncpy(pRule->db, str, TSDB_DB_NAME_LEN);
+  }
+
+  if (strcmp(name, "*") == 0) {
+    pRule->name[0] = 0;
+  } else if (name[0] == 0 || strlen(name) >= TSDB_TABLE_NAME_LEN || strchr(name, '.') != NULL) {
+    return -1;
+  } else {
+    tstrncpy(pRule->name, name, TSDB_TABLE_NAME_LEN);
+  }
+
+  if (strcmp(col, "*") == 0) {
+    pRule->colId = -1;
+  } else {
+    char *end = NULL;
+    long  colId = strtol(col, &end, 10);
+    if (end == col || *end != 0 || colId <= 0 || colId > INT16_MAX) return -1;
+    pRule->colId = (int16_t)colId;
+  }
+
+  return tsdbParseColCodec(eq + 1, &(pRule->codec));
+}
+
+static int tsdbParseColCodec(const char *str, SColCodec *pCodec) {
+  pCodec->level = 0;
+
+  if (strcasecmp(str, "default") == 0) {
+    pCodec->codec = TSDB_COL_CODEC_DEFAULT;
+  } else if (strcasecmp(str, "fast") == 0) {
+    pCodec->codec = TSDB_COL_CODEC_FAST;
+  } else if (strcasecmp(str, "lz4") == 0) {
+    pCodec->codec = TSDB_COL_CODEC_LZ4;
+  } else if (strcasecmp(str, "tsz") == 0) {
+#ifdef TD_TSZ
+    pCodec->codec = TSDB_COL_CODEC_TSZ;
+#else
+    // not built with TSZ, the columns would be compressed by the block algorithm silently
+    return -1;
+#endif
+  } else if (strcasecmp(str, "adaptive") == 0) {
+    pCodec->codec = TSDB_COL_CODEC_ADAPTIVE;
+  } else if (strncasecmp(str, "zlib", 4) == 0) {
+    pCodec->codec = TSDB_COL_CODEC_ZLIB;
+    if (str[4] == 0) {
+      pCodec->level = TS_ZLIB_DEFAULT_LEVEL;
+    } else if (str[4] >= '1' && str[4] <= '9' && str[5] == 0) {
+      pCodec->level = str[4] - '0';
+    } else {
+      return -1;
+    }
+  } else {
+    return -1;
+  }
+
+  return 0;
+}
@@ -13,6 +13,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "tsdbint.h"
+#include "tglobal.h"
+#include "tsched.h"
 
 extern int32_t tsTsdbMetaCompactRatio;
 
@@ -25,6 +27,63 @@ static FORCE_INLINE int TSDB_KEY_FID(TSKEY key, int32_t days, int8_t precision)
   }
 }
 
+#define TSDB_COMMIT_PIPE_SLOTS 2
+
+// A block encoded in the pipeline and waiting for the write stage
+typedef struct {
+  void *  pBuf;    // SBlockData
+  void *  pExBuf;  // SAggrBlkData
+  SDFile *pDFile;
+  int64_t offset;
+  int32_t len;
+  SDFile *pDFileAggr;
+  int64_t offsetAggr;
+  int32_t aggrLen;  // 0 if no SAggrBlkData to write
+  tsem_t  free;     // posted by the write stage after the slot is written
+} SCommitPipeSlot;
+
+typedef struct {
+  void *    pBuf;   // compressed column with checksum
+  void *    pCBuf;  // buffer of two stage compression
+  int32_t   flen;
+  SColCodec reqCodec;  // codec requested
+  uint8_t   codec;     // codec used
+} SCommitColBuf;
+
+/*
+ * Pipeline of writing blocks in a commit: blocks are encoded by the commit thread with the columns compressed by the
+ * compression pool, and written to files by the commit write pool in order, so the compression of a block and the
+ * write of the previous one are done at the same time. The slots of a pipeline are handed to the write pool one at a
+ * time, the next one when the previous one is written, so a pipeline uses at most one writer at a time.
+ */
+typedef struct {
+  int32_t         nWrites;  // slots handed to the write stage and not written yet
+  int             cslot;    // next slot to encode to
+  SCommitPipeSlot slots[TSDB_COMMIT_PIPE_SLOTS];
+  int32_t         code;     // first error of the write stage
+  int64_t         writeUs;  // time spent by the write stage
+  // compression stage
+  int             nCols;    // capacity of aColIdx and aColBuf
+  int *           aColIdx;  // index in SDataCols of each column to compress
+  SCommitColBuf * aColBuf;
+  STsdbCfg *      pCfg;
+  SDataCols *     pDataCols;
+  int             rows;
+  int             nColsToComp;
+  int             nTasks;
+  int32_t         nPending;
+  int32_t         compCode;
+  tsem_t          compDone;
+} SCommitPipe;
+
+typedef struct {
+  int32_t len;
+  int32_t keyLen;
+  int16_t numOfCols;
+  int32_t aggrLen;  // including the bloom filters
+  bool    hasBloom;
+} SEncodedBlock;
+
 typedef struct {
   SRtn         rtn;     // retention snapshot
   SFSIter      fsIter;  // tsdb file iterator
@@ -42,8 +101,35 @@ typedef struct {
   SArray *     aSupBlk;  // Table super-block array
   SArray *     aSubBlk;  // table sub-block array
   SDataCols *  pDataCols;
+  SCommitPipe *pPipe;  // NULL if blocks are compressed and written by the commit thread
+  SCommitStat  stat;
 } SCommitH;
 
+// A FSET to commit or to apply retention on, used by the parallel commit
+typedef struct {
+  STsdbRepo *pRepo;
+  SDFileSet *pSet;      // existing FSET, NULL if a new FSET is created
+  int        fid;
+  bool       toCommit;  // false if only retention is applied on the existing FSET
+  SRtn       rtn;
+  SDFileSet  wSet;      // the FSET written by the worker, published after all workers finish
+  int32_t    code;
+  int64_t    elapsed;   // ms
+} SCommitFSetJob;
+
+typedef struct {
+  int32_t nPending;
+  tsem_t  done;
+} SCommitFSetCtx;
+
+static void *tsCommitFSetSched = NULL;
+static void *tsCommitCompSched = NULL;
+static void *tsCommitWriteSched = NULL;
+
+#define TSDB_COMMIT_FSET_QUEUE_SIZE 1024
+#define TSDB_COMMIT_COMP_QUEUE_SIZE 4096
+#define TSDB_COMMIT_WRITE_QUEUE_SIZE 1024
+
 #define TSDB_COMMIT_REPO(ch) TSDB_READ_REPO(&(ch->readh))
 #define TSDB_COMMIT_REPO_ID(ch) REPO_ID(TSDB_READ_REPO(&(ch->readh)))
 #define TSDB_COMMIT_WRITE_FSET(ch) (&((ch)->wSet))
@@ -67,6 +153,10 @@ static int  tsdbCommitTSData(STsdbRepo *pRepo);
 static void tsdbStartCommit(STsdbRepo *pRepo);
 static void tsdbEndCommit(STsdbRepo *pRepo, int eno);
 static int  tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid);
+static int  tsdbCommitToFileImpl(SCommitH *pCommith, SDFileSet *pSet, int fid);
+static int  tsdbCommitTSDataParallel(SCommitH *pCommith, SDFileSet *pSet);
+static void tsdbCommitFSetJobFp(SSchedMsg *pMsg);
+static int  tsdbSetCommitIterFrom(SCommitH *pCommith, TSKEY key);
 static int  tsdbCreateCommitIters(SCommitH *pCommith);
 static void tsdbDestroyCommitIters(SCommitH *pCommith);
 static void tsdbSeekCommitIter(SCommitH *pCommith, TSKEY key);
@@ -91,6 +181,12 @@ static void tsdbCloseCommitFile(SCommitH *pCommith, bool hasError);
 static bool tsdbCanAddSubBlock(SCommitH *pCommith, SBlock *pBlock, SMergeInfo *pInfo);
 static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIter *pCommitIter, SDataCols *pTarget,
                                       TSKEY maxKey, int maxRows, int8_t update);
+static SCommitPipe *    tsdbNewCommitPipe();
+static void             tsdbFreeCommitPipe(SCommitPipe *pPipe);
+static int              tsdbMakeCommitPipeColBufs(SCommitPipe *pPipe, int nCols);
+static SCommitPipeSlot *tsdbGetCommitPipeSlot(SCommitPipe *pPipe, SCommitStat *pStat);
+static void             tsdbPutCommitPipeSlot(SCommitPipe *pPipe, SCommitPipeSlot *pSlot);
+static int              tsdbFlushCommitPipe(SCommitPipe *pPipe, SCommitStat *pStat);
 
 void *tsdbCommitData(STsdbRepo *pRepo) {
   if (pRepo->imem == NULL) {
@@ -638,6 +734,12 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
     }
   }
 
+  if (tsCommitFSetSched != NULL) {
+    int code = tsdbCommitTSDataParallel(&commith, pSet);
+    tsdbDestroyCommitH(&commith);
+    return code;
+  }
+
   // Loop to commit to each file
   fid = tsdbNextCommitFid(&(commith));
   while (true) {
@@ -693,16 +795,22 @@ static void tsdbStartCommit(STsdbRepo *pRepo) {
   tsdbStartFSTxn(pRepo, pMem->pointsAdd, pMem->storageAdd);
 
   pRepo->code = TSDB_CODE_SUCCESS;
+  memset(&(pRepo->commitStat), 0, sizeof(pRepo->commitStat));
 }
 
 static void tsdbEndCommit(STsdbRepo *pRepo, int eno) {
   if (eno != TSDB_CODE_SUCCESS) {
     tsdbEndFSTxnWithError(REPO_FS(pRepo));
-  } else {
-    tsdbEndFSTxn(pRepo);
+  } else if (tsdbEndFSTxn(pRepo) == 0) {
+    // before the next memtable can be frozen
+    tsdbSaveLastCacheFile(pRepo);
   }
 
-  tsdbInfo("vgId:%d commit over, %s", REPO_ID(pRepo), (eno == TSDB_CODE_SUCCESS) ? "succeed" : "failed");
+  SCommitStat *pStat = &(pRepo->commitStat);
+  tsdbInfo("vgId:%d commit over, %s, blocks %" PRId64 " bytes %" PRId64 " compress %" PRId64 " ms wait %" PRId64
+           " ms write %" PRId64 " ms",
+           REPO_ID(pRepo), (eno == TSDB_CODE_SUCCESS) ? "succeed" : "failed", pStat->nBlocks, pStat->nBytes,
+           pStat->compUs / 1000, pStat->waitUs / 1000, pStat->writeUs / 1000);
 
   if (pRepo->appH.notifyStatus) pRepo->appH.notifyStatus(pRepo->appH.appH, TSDB_STATUS_COMMIT_OVER, eno);
 
@@ -724,7 +832,371 @@ static bool tsdbHasDataToCommit(SCommitIter *iters, int nIters, TSKEY minKey, TS
 }
 #endif
 
+int tsdbInitCommitFSetPool() {
+  if (tsNumOfCommitFSetThreads <= 0) return 0;
+
+  tsCommitFSetSched = taosInitScheduler(TSDB_COMMIT_FSET_QUEUE_SIZE, tsNumOfCommitFSetThreads, "tsdbCommitFSet");
+  if (tsCommitFSetSched == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+void tsdbDestroyCommitFSetPool() {
+  if (tsCommitFSetSched != NULL) {
+    taosCleanUpScheduler(tsCommitFSetSched);
+    tsCommitFSetSched = NULL;
+  }
+}
+
+/*
+ * Commit the FSETs in parallel by the FSET commit pool. The FSETs are planned in fid order as the serial commit does,
+ * each FSET with memory data is committed by a worker with its own SCommitH, then the written FSETs are published to
+ * the FS transaction in fid order by this thread, so the new FS status is still made current by tsdbEndFSTxn at once.
+ */
+static int tsdbCommitTSDataParallel(SCommitH *pCommith, SDFileSet *pSet) {
+  STsdbRepo *    pRepo = TSDB_COMMIT_REPO(pCommith);
+  STsdbCfg *     pCfg = REPO_CFG(pRepo);
+  SCommitFSetCtx ctx = {0};
+  int            code = 0;
+  int            nCommit = 0;
+  int64_t        st = taosGetTimestampMs();
+  int            fid;
+
+  SArray *aJobs = taosArrayInit(16, sizeof(SCommitFSetJob));
+  if (aJobs == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // Plan the FSETs in the same order as the serial commit
+  fid = tsdbNextCommitFid(pCommith);
+  while (true) {
+    if (pSet == NULL && fid == TSDB_IVLD_FID) break;
+
+    SCommitFSetJob job = {0};
+    job.pRepo = pRepo;
+    job.rtn = pCommith->rtn;
+
+    if (pSet && (fid == TSDB_IVLD_FID || pSet->fid < fid)) {
+      job.pSet = pSet;
+      job.fid = pSet->fid;
+      job.toCommit = false;
+
+      pSet = tsdbFSIterNext(&(pCommith->fsIter));
+    } else {
+      TSKEY minKey, maxKey;
+
+      if (pSet == NULL || pSet->fid > fid) {
+        job.pSet = NULL;
+        job.fid = fid;
+      } else {
+        job.pSet = pSet;
+        job.fid = pSet->fid;
+        pSet = tsdbFSIterNext(&(pCommith->fsIter));
+      }
+      job.toCommit = true;
+      nCommit++;
+
+      tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, job.fid, &minKey, &maxKey);
+      if (tsdbSetCommitIterFrom(pCommith, maxKey + 1) < 0) {
+        taosArrayDestroy(&aJobs);
+        return -1;
+      }
+      fid = tsdbNextCommitFid(pCommith);
+    }
+
+    if (taosArrayPush(aJobs, &job) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      taosArrayDestroy(&aJobs);
+      return -1;
+    }
+  }
+
+  // Commit the FSETs with memory data by the workers
+  ctx.nPending = nCommit;
+  tsem_init(&ctx.done, 0, 0);
+  for (size_t i = 0; i < taosArrayGetSize(aJobs); i++) {
+    SCommitFSetJob *pJob = taosArrayGet(aJobs, i);
+    if (!pJob->toCommit) continue;
+
+    SSchedMsg msg = {0};
+    msg.fp = tsdbCommitFSetJobFp;
+    msg.ahandle = pJob;
+    msg.thandle = &ctx;
+    taosScheduleTask(tsCommitFSetSched, &msg);
+  }
+  if (nCommit > 0) {
+    tsem_wait(&ctx.done);
+  }
+  tsem_destroy(&ctx.done);
+
+  // Publish in fid order. The FSETs written after an error are still published, so they are removed by
+  // tsdbEndFSTxnWithError as the serial commit does.
+  for (size_t i = 0; i < taosArrayGetSize(aJobs); i++) {
+    SCommitFSetJob *pJob = taosArrayGet(aJobs, i);
+
+    if (!pJob->toCommit) {
+      if (code == 0 && tsdbApplyRtnOnFSet(pRepo, pJob->pSet, &(pJob->rtn)) < 0) {
+        code = terrno;
+      }
+      continue;
+    }
+
+    if (pJob->code != TSDB_CODE_SUCCESS) {
+      tsdbError("vgId:%d failed to commit FSET %d since %s", REPO_ID(pRepo), pJob->fid, tstrerror(pJob->code));
+      if (code == 0) code = pJob->code;
+      continue;
+    }
+
+    tsdbDebug("vgId:%d FSET %d is committed in %" PRId64 " ms", REPO_ID(pRepo), pJob->fid, pJob->elapsed);
+    if (tsdbUpdateDFileSet(REPO_FS(pRepo), &(pJob->wSet)) < 0 && code == 0) {
+      code = terrno;
+    }
+  }
+
+  tsdbInfo("vgId:%d %d FSETs are committed by %d threads in %" PRId64 " ms, %s", REPO_ID(pRepo), nCommit,
+           tsNumOfCommitFSetThreads, taosGetTimestampMs() - st, (code == 0) ? "succeed" : "failed");
+
+  taosArrayDestroy(&aJobs);
+
+  if (code != 0) {
+    terrno = code;
+    return -1;
+  }
+  return 0;
+}
+
+static void tsdbCommitFSetJobFp(SSchedMsg *pMsg) {
+  SCommitFSetJob *pJob = (SCommitFSetJob *)pMsg->ahandle;
+  SCommitFSetCtx *pCtx = (SCommitFSetCtx *)pMsg->thandle;
+  STsdbRepo *     pRepo = pJob->pRepo;
+  STsdbCfg *      pCfg = REPO_CFG(pRepo);
+  SCommitH        commith;
+  TSKEY           minKey, maxKey;
+  int64_t         st = taosGetTimestampMs();
+
+  pJob->code = TSDB_CODE_SUCCESS;
+  if (tsdbInitCommitH(&commith, pRepo) < 0) {
+    pJob->code = terrno;
+  } else {
+    commith.rtn = pJob->rtn;
+    tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, pJob->fid, &minKey, &maxKey);
+
+    if (tsdbSetCommitIterFrom(&commith, minKey) < 0 || tsdbCommitToFileImpl(&commith, pJob->pSet, pJob->fid) < 0) {
+      pJob->code = terrno;
+    } else {
+      pJob->wSet = commith.wSet;
+    }
+    tsdbDestroyCommitH(&commith);
+  }
+  pJob->elapsed = taosGetTimestampMs() - st;
+
+  if (atomic_sub_fetch_32(&pCtx->nPending, 1) == 0) {
+    tsem_post(&pCtx->done);
+  }
+}
+
+int tsdbInitCommitCompPool() {
+  if (tsNumOfCommitCompThreads <= 0) return 0;
+
+  tsCommitCompSched = taosInitScheduler(TSDB_COMMIT_COMP_QUEUE_SIZE, tsNumOfCommitCompThreads, "tsdbCommitComp");
+  if (tsCommitCompSched == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // one writer for each pipeline that can be working at the same time
+  int nWriters = MAX(tsNumOfCommitThreads, 1) * MAX(tsNumOfCommitFSetThreads, 1);
+  tsCommitWriteSched = taosInitScheduler(TSDB_COMMIT_WRITE_QUEUE_SIZE, nWriters, "tsdbCommitWrite");
+  if (tsCommitWriteSched == NULL) {
+    tsdbDestroyCommitCompPool();
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+void tsdbDestroyCommitCompPool() {
+  if (tsCommitCompSched != NULL) {
+    taosCleanUpScheduler(tsCommitCompSched);
+    tsCommitCompSched = NULL;
+  }
+  if (tsCommitWriteSched != NULL) {
+    taosCleanUpScheduler(tsCommitWriteSched);
+    tsCommitWriteSched = NULL;
+  }
+}
+
+static SCommitPipe *tsdbNewCommitPipe() {
+  SCommitPipe *pPipe = (SCommitPipe *)calloc(1, sizeof(*pPipe));
+  if (pPipe == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  for (int i = 0; i < TSDB_COMMIT_PIPE_SLOTS; i++) {
+    tsem_init(&(pPipe->slots[i].free), 0, 1);
+  }
+  tsem_init(&(pPipe->compDone), 0, 0);
+
+  return pPipe;
+}
+
+static void tsdbFreeCommitPipe(SCommitPipe *pPipe) {
+  if (pPipe == NULL) return;
+
+  tsdbFlushCommitPipe(pPipe, NULL);
+
+  for (int i = 0; i < TSDB_COMMIT_PIPE_SLOTS; i++) {
+    SCommitPipeSlot *pSlot = pPipe->slots + i;
+    taosTZfree(pSlot->pBuf);
+    taosTZfree(pSlot->pExBuf);
+    tsem_destroy(&(pSlot->free));
+  }
+
+  for (int i = 0; i < pPipe->nCols; i++) {
+    taosTZfree(pPipe->aColBuf[i].pBuf);
+    taosTZfree(pPipe->aColBuf[i].pCBuf);
+  }
+  tfree(pPipe->aColIdx);
+  tfree(pPipe->aColBuf);
+  tsem_destroy(&(pPipe->compDone));
+
+  free(pPipe);
+}
+
+static int tsdbMakeCommitPipeColBufs(SCommitPipe *pPipe, int nCols) {
+  if (nCols <= pPipe->nCols) return 0;
+
+  int *aColIdx = (int *)realloc(pPipe->aColIdx, sizeof(int) * nCols);
+  if (aColIdx == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+  pPipe->aColIdx = aColIdx;
+
+  SCommitColBuf *aColBuf = (SCommitColBuf *)realloc(pPipe->aColBuf, sizeof(SCommitColBuf) * nCols);
+  if (aColBuf == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+  memset(aColBuf + pPipe->nCols, 0, sizeof(SCommitColBuf) * (nCols - pPipe->nCols));
+  pPipe->aColBuf = aColBuf;
+  pPipe->nCols = nCols;
+
+  return 0;
+}
+
+static int tsdbWriteCommitPipeSlot(SCommitPipeSlot *pSlot) {
+  if (tsdbSeekDFile(pSlot->pDFile, pSlot->offset, SEEK_SET) < 0 ||
+      tsdbWriteDFile(pSlot->pDFile, pSlot->pBuf, pSlot->len) < 0) {
+    return -1;
+  }
+
+  if (pSlot->aggrLen > 0 && (tsdbSeekDFile(pSlot->pDFileAggr, pSlot->offsetAggr, SEEK_SET) < 0 ||
+                             tsdbWriteDFile(pSlot->pDFileAggr, pSlot->pExBuf, pSlot->aggrLen) < 0)) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static void tsdbScheduleCommitPipeSlot(SCommitPipe *pPipe, SCommitPipeSlot *pSlot);
+
+static void tsdbCommitWriteFp(SSchedMsg *pMsg) {
+  SCommitPipe *    pPipe = (SCommitPipe *)pMsg->ahandle;
+  SCommitPipeSlot *pSlot = (SCommitPipeSlot *)pMsg->thandle;
+  int64_t          st = taosGetTimestampUs();
+
+  // The slots after a failed one are dropped, the FSET is reverted by the commit thread
+  if (atomic_load_32(&(pPipe->code)) == TSDB_CODE_SUCCESS && tsdbWriteCommitPipeSlot(pSlot) < 0) {
+    atomic_store_32(&(pPipe->code), terrno);
+  }
+
+  atomic_add_fetch_64(&(pPipe->writeUs), taosGetTimestampUs() - st);
+
+  // The slots are handed to the write stage in turn, so the next slot queued is the one after this one,
+  // and it keeps the pipeline alive till it is written. The pipeline can be freed once the slot is posted free.
+  int  next = (int)(pSlot - pPipe->slots + 1) % TSDB_COMMIT_PIPE_SLOTS;
+  bool more = atomic_sub_fetch_32(&(pPipe->nWrites), 1) > 0;
+  tsem_post(&(pSlot->free));
+  if (more) tsdbScheduleCommitPipeSlot(pPipe, pPipe->slots + next);
+}
+
+static void tsdbScheduleCommitPipeSlot(SCommitPipe *pPipe, SCommitPipeSlot *pSlot) {
+  SSchedMsg msg = {0};
+  msg.fp = tsdbCommitWriteFp;
+  msg.ahandle = pPipe;
+  msg.thandle = pSlot;
+  taosScheduleTask(tsCommitWriteSched, &msg);
+}
+
+static SCommitPipeSlot *tsdbGetCommitPipeSlot(SCommitPipe *pPipe, SCommitStat *pStat) {
+  SCommitPipeSlot *pSlot = pPipe->slots + pPipe->cslot;
+  int64_t          st = taosGetTimestampUs();
+
+  tsem_wait(&(pSlot->free));
+  pStat->waitUs += taosGetTimestampUs() - st;
+
+  int32_t code = atomic_load_32(&(pPipe->code));
+  if (code != TSDB_CODE_SUCCESS) {
+    tsem_post(&(pSlot->free));
+    terrno = code;
+    return NULL;
+  }
+
+  return pSlot;
+}
+
+static void tsdbPutCommitPipeSlot(SCommitPipe *pPipe, SCommitPipeSlot *pSlot) {
+  // Written right away if the write stage is idle, or after the slots before it otherwise
+  if (atomic_add_fetch_32(&(pPipe->nWrites), 1) == 1) {
+    tsdbScheduleCommitPipeSlot(pPipe, pSlot);
+  }
+
+  pPipe->cslot = (pPipe->cslot + 1) % TSDB_COMMIT_PIPE_SLOTS;
+}
+
+// Wait for all slots to be written and reset the pipeline for the next FSET
+static int tsdbFlushCommitPipe(SCommitPipe *pPipe, SCommitStat *pStat) {
+  if (pPipe == NULL) return 0;
+
+  for (int i = 0; i < TSDB_COMMIT_PIPE_SLOTS; i++) {
+    tsem_wait(&(pPipe->slots[i].free));
+    tsem_post(&(pPipe->slots[i].free));
+  }
+
+  int64_t writeUs = atomic_exchange_64(&(pPipe->writeUs), 0);
+  if (pStat != NULL) {
+    pStat->writeUs += writeUs;
+  }
+
+  int32_t code = atomic_exchange_32(&(pPipe->code), TSDB_CODE_SUCCESS);
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+    return -1;
+  }
+
+  return 0;
+}
+
 static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
+  if (tsdbCommitToFileImpl(pCommith, pSet, fid) < 0) {
+    return -1;
+  }
+
+  if (tsdbUpdateDFileSet(REPO_FS(TSDB_COMMIT_REPO(pCommith)), &(pCommith->wSet)) < 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static int tsdbCommitToFileImpl(SCommitH *pCommith, SDFileSet *pSet, int fid) {
   STsdbRepo *pRepo = TSDB_COMMIT_REPO(pCommith);
   STsdbCfg * pCfg = REPO_CFG(pRepo);
 
@@ -745,6 +1217,7 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
     if (pIter->pTable == NULL) continue;
 
     if (tsdbCommitToTable(pCommith, tid) < 0) {
+      tsdbFlushCommitPipe(pCommith->pPipe, &(pCommith->stat));
       tsdbCloseCommitFile(pCommith, true);
       // revert the file change
       tsdbApplyDFileSetChange(TSDB_COMMIT_WRITE_FSET(pCommith), pSet);
@@ -752,6 +1225,15 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
     }
   }
 
+  // Wait for the blocks in the pipeline to be written before the files are finished
+  if (tsdbFlushCommitPipe(pCommith->pPipe, &(pCommith->stat)) < 0) {
+    tsdbError("vgId:%d failed to write data blocks to FSET %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
+    tsdbCloseCommitFile(pCommith, true);
+    // revert the file change
+    tsdbApplyDFileSetChange(TSDB_COMMIT_WRITE_FSET(pCommith), pSet);
+    return -1;
+  }
+
   if (tsdbWriteBlockIdx(TSDB_COMMIT_HEAD_FILE(pCommith), pCommith->aBlkIdx, (void **)(&(TSDB_COMMIT_BUF(pCommith)))) <
       0) {
     tsdbError("vgId:%d failed to write SBlockIdx part to FSET %d since %s", REPO_ID(pRepo), fid, tstrerror(terrno));
@@ -772,10 +1254,6 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
   // Close commit file
   tsdbCloseCommitFile(pCommith, false);
 
-  if (tsdbUpdateDFileSet(REPO_FS(pRepo), &(pCommith->wSet)) < 0) {
-    return -1;
-  }
-
   return 0;
 }
 
@@ -806,12 +1284,11 @@ static int tsdbCreateCommitIters(SCommitH *pCommith) {
   for (int i = 0; i < pMem->maxTables; i++) {
     if ((pCommith->iters[i].pTable != NULL) && (pMem->tData[i] != NULL) &&
         (TABLE_UID(pCommith->iters[i].pTable) == pMem->tData[i]->uid)) {
-      if ((pCommith->iters[i].pIter = tSkipListCreateIter(pMem->tData[i]->pData)) == NULL) {
-        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      if ((pCommith->iters[i].pIter = tsdbCreateTableDataIter(pMem->tData[i], NULL, TSDB_ORDER_ASC)) == NULL) {
         return -1;
       }
 
-      tSkipListIterNext(pCommith->iters[i].pIter);
+      tsdbTableDataIterNext(pCommith->iters[i].pIter);
     }
   }
 
@@ -824,7 +1301,7 @@ static void tsdbDestroyCommitIters(SCommitH *pCommith) {
   for (int i = 1; i < pCommith->niters; i++) {
     if (pCommith->iters[i].pTable != NULL) {
       tsdbUnRefTable(pCommith->iters[i].pTable);
-      tSkipListDestroyIter(pCommith->iters[i].pIter);
+      tsdbDestroyTableDataIter(pCommith->iters[i].pIter);
     }
   }
 
@@ -843,6 +1320,26 @@ static void tsdbSeekCommitIter(SCommitH *pCommith, TSKEY key) {
   }
 }
 
+// Position the memory iterators at the first key not less than key
+static int tsdbSetCommitIterFrom(SCommitH *pCommith, TSKEY key) {
+  SMemTable *pMem = TSDB_COMMIT_REPO(pCommith)->imem;
+
+  for (int i = 0; i < pCommith->niters; i++) {
+    SCommitIter *pIter = pCommith->iters + i;
+    if (pIter->pTable == NULL || pIter->pIter == NULL) continue;
+
+    tsdbDestroyTableDataIter(pIter->pIter);
+    pIter->pIter = tsdbCreateTableDataIter(pMem->tData[i], &key, TSDB_ORDER_ASC);
+    if (pIter->pIter == NULL) {
+      return -1;
+    }
+
+    tsdbTableDataIterNext(pIter->pIter);
+  }
+
+  return 0;
+}
+
 static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
   STsdbCfg *pCfg = REPO_CFG(pRepo);
 
@@ -892,10 +1389,29 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
     return -1;
   }
 
+  if (tsCommitCompSched != NULL) {
+    pCommith->pPipe = tsdbNewCommitPipe();
+    if (pCommith->pPipe == NULL) {
+      tsdbDestroyCommitH(pCommith);
+      return -1;
+    }
+  }
+
   return 0;
 }
 
 static void tsdbDestroyCommitH(SCommitH *pCommith) {
+  tsdbFreeCommitPipe(pCommith->pPipe);
+  pCommith->pPipe = NULL;
+  if (pCommith->stat.nBlocks > 0) {
+    SCommitStat *pStat = &(TSDB_COMMIT_REPO(pCommith)->commitStat);
+    atomic_add_fetch_64(&(pStat->nBlocks), pCommith->stat.nBlocks);
+    atomic_add_fetch_64(&(pStat->nBytes), pCommith->stat.nBytes);
+    atomic_add_fetch_64(&(pStat->compUs), pCommith->stat.compUs);
+    atomic_add_fetch_64(&(pStat->waitUs), pCommith->stat.waitUs);
+    atomic_add_fetch_64(&(pStat->writeUs), pCommith->stat.writeUs);
+    memset(&(pCommith->stat), 0, sizeof(pCommith->stat));
+  }
   pCommith->pDataCols = tdFreeDataCols(pCommith->pDataCols);
   pCommith->aSubBlk = taosArrayDestroy(&pCommith->aSubBlk);
   pCommith->aSupBlk = taosArrayDestroy(&pCommith->aSupBlk);
@@ -1061,16 +1577,142 @@ static int tsdbComparKeyBlock(const void *arg1, const void *arg2) {
   }
 }
 
-int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
-                       SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf) {
-  STsdbCfg *  pCfg = REPO_CFG(pRepo);
-  SBlockData *pBlockData;
-  SAggrBlkData *pAggrBlkData = NULL;
-  int64_t     offset = 0, offsetAggr = 0;
-  int         rowsToWrite = pDataCols->numOfRows;
+// Compress a column by the codec requested or just copy it to *ppBuf at offset with the checksum appended, return the
+// length written and the codec used in *pCodec
+static int32_t tsdbCompressBlockCol(STsdbCfg *pCfg, SDataCol *pDataCol, int rows, SColCodec codec, void **ppBuf,
+                                    int32_t offset, void **ppCBuf, uint8_t *pCodec) {
+  int32_t flen;  // final length
+  int32_t tlen = dataColGetNEleLen(pDataCol, rows);
+  void *  tptr;
 
-  ASSERT(rowsToWrite > 0 && rowsToWrite <= pCfg->maxRowsPerFileBlock);
-  ASSERT((!isLast) || rowsToWrite < pCfg->minRowsPerFileBlock);
+  // Make room
+  if (tsdbMakeRoom(ppBuf, offset + tlen + COMP_OVERFLOW_BYTES + sizeof(TSCKSUM)) < 0) {
+    return -1;
+  }
+  tptr = POINTER_SHIFT(*ppBuf, offset);
+
+  // Compress or just copy
+  flen = tsdbEncodeColData(pDataCol, rows, pCfg->compression, codec, tptr, tlen + COMP_OVERFLOW_BYTES, ppCBuf, pCodec);
+  if (flen < 0) {
+    return -1;
+  }
+
+  // Add checksum
+  ASSERT(flen > 0);
+  flen += sizeof(TSCKSUM);
+  taosCalcChecksumAppend(0, (uint8_t *)tptr, flen);
+
+  return flen;
+}
+
+static void tsdbCompressBlockCols(SCommitPipe *pPipe, int task) {
+  for (int i = task; i < pPipe->nColsToComp; i += pPipe->nTasks) {
+    SCommitColBuf *pColBuf = pPipe->aColBuf + i;
+
+    pColBuf->flen = tsdbCompressBlockCol(pPipe->pCfg, pPipe->pDataCols->cols + pPipe->aColIdx[i], pPipe->rows,
+                                         pColBuf->reqCodec, &(pColBuf->pBuf), 0, &(pColBuf->pCBuf), &(pColBuf->codec));
+    if (pColBuf->flen < 0) {
+      atomic_store_32(&(pPipe->compCode), terrno);
+      break;
+    }
+  }
+}
+
+static void tsdbCommitCompFp(SSchedMsg *pMsg) {
+  SCommitPipe *pPipe = (SCommitPipe *)pMsg->ahandle;
+
+  tsdbCompressBlockCols(pPipe, (int)(intptr_t)pMsg->thandle);
+
+  if (atomic_sub_fetch_32(&(pPipe->nPending), 1) == 0) {
+    tsem_post(&(pPipe->compDone));
+  }
+}
+
+// Compress the columns in pPipe->aColIdx to pPipe->aColBuf by the compression pool and this thread
+static int tsdbCompressBlockColsParallel(SCommitPipe *pPipe, STsdbCfg *pCfg, SDataCols *pDataCols, int nCols,
+                                         int rows) {
+  pPipe->pCfg = pCfg;
+  pPipe->pDataCols = pDataCols;
+  pPipe->rows = rows;
+  pPipe->nColsToComp = nCols;
+  pPipe->nTasks = MIN(nCols, tsNumOfCommitCompThreads + 1);
+  pPipe->nPending = pPipe->nTasks - 1;
+  pPipe->compCode = TSDB_CODE_SUCCESS;
+
+  for (int task = 1; task < pPipe->nTasks; task++) {
+    SSchedMsg msg = {0};
+    msg.fp = tsdbCommitCompFp;
+    msg.ahandle = pPipe;
+    msg.thandle = (void *)(intptr_t)task;
+    taosScheduleTask(tsCommitCompSched, &msg);
+  }
+
+  tsdbCompressBlockCols(pPipe, 0);
+
+  if (pPipe->nTasks > 1) {
+    tsem_wait(&(pPipe->compDone));
+  }
+
+  if (pPipe->compCode != TSDB_CODE_SUCCESS) {
+    terrno = pPipe->compCode;
+    return -1;
+  }
+
+  return 0;
+}
+
+// Append the bloom filters of the columns not all NULL to the aggr part of size tsizeAggr in *ppExBuf
+static int tsdbEncodeBlockBloom(SDFile *pDFileAggr, SDataCols *pDataCols, void **ppExBuf, uint32_t tsizeAggr,
+                                uint32_t *pBloomLen) {
+  int rows = pDataCols->numOfRows;
+  int nCols = 0;
+
+  *pBloomLen = 0;
+  for (int ncol = 1; ncol < pDataCols->numOfCols; ncol++) {
+    SDataCol *pDataCol = pDataCols->cols + ncol;
+    if (TSDB_BLOOM_HAS_FILTER(pDataCol->type) && !isAllRowsNull(pDataCol)) nCols++;
+  }
+  if (nCols == 0) return 0;
+
+  int32_t len = tsdbBlockBloomLen(rows);
+  size_t  size = tsdbBlockBloomSize(nCols, len);
+  if (tsdbMakeRoom(ppExBuf, tsizeAggr + size) < 0) return -1;
+
+  SBlockBloomHead *pHead = (SBlockBloomHead *)POINTER_SHIFT(*ppExBuf, tsizeAggr);
+  SBlockBloomCol * pCols = (SBlockBloomCol *)POINTER_SHIFT(pHead, sizeof(SBlockBloomHead));
+  uint8_t *        pFilter = (uint8_t *)POINTER_SHIFT(pCols, sizeof(SBlockBloomCol) * nCols);
+
+  memset(pHead, 0, size);
+  pHead->len = len;
+  pHead->numOfCols = (int16_t)nCols;
+
+  for (int ncol = 1; ncol < pDataCols->numOfCols; ncol++) {
+    SDataCol *pDataCol = pDataCols->cols + ncol;
+    if (!TSDB_BLOOM_HAS_FILTER(pDataCol->type) || isAllRowsNull(pDataCol)) continue;
+
+    pCols->colId = pDataCol->colId;
+    for (int row = 0; row < rows; row++) {
+      const void *pVal = tdGetColDataOfRow(pDataCol, row);
+      if (isNull(pVal, pDataCol->type)) continue;
+      tsdbBlockBloomAdd(pFilter, len, tsdbBlockBloomHash(pDataCol->type, pVal));
+    }
+
+    pCols++;
+    pFilter += len;
+  }
+
+  taosCalcChecksumAppend(0, (uint8_t *)pHead, (uint32_t)size);
+  tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pHead, size - sizeof(TSCKSUM)));
+
+  *pBloomLen = (uint32_t)size;
+  return 0;
+}
+
+static int tsdbEncodeBlock(STsdbCfg *pCfg, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
+                           void **ppBuf, void **ppCBuf, void **ppExBuf, SCommitPipe *pPipe, SEncodedBlock *pEBlock) {
+  SBlockData *  pBlockData;
+  SAggrBlkData *pAggrBlkData = NULL;
+  int           rowsToWrite = pDataCols->numOfRows;
 
   // Make buffer space
   if (tsdbMakeRoom(ppBuf, tsdbBlockStatisSize(pDataCols->numOfCols, SBlockVerLatest)) < 0) {
@@ -1083,6 +1725,10 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   }
   pAggrBlkData = (SAggrBlkData *)(*ppExBuf);
 
+  if (pPipe != NULL && tsdbMakeCommitPipeColBufs(pPipe, pDataCols->numOfCols) < 0) {
+    return -1;
+  }
+
   // Get # of cols not all NULL(not including key column)
   int nColsNotAllNull = 0;
   for (int ncol = 1; ncol < pDataCols->numOfCols; ncol++) {  // ncol from 1, we skip the timestamp column
@@ -1111,11 +1757,26 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
                                                &(pAggrBlkCol->sum), &(pAggrBlkCol->minIndex), &(pAggrBlkCol->maxIndex),
                                                &(pAggrBlkCol->numOfNull));
     }
+    if (pPipe != NULL) {
+      pPipe->aColIdx[nColsNotAllNull + 1] = ncol;
+      pPipe->aColBuf[nColsNotAllNull + 1].reqCodec = tsdbGetColCodec(pCfg->db, pTable, pDataCol->colId);
+    }
     nColsNotAllNull++;
   }
 
   ASSERT(nColsNotAllNull >= 0 && nColsNotAllNull <= pDataCols->numOfCols);
 
+  // Compress the columns in parallel if there are more than the key column, or one by one below
+  bool compressed = false;
+  if (pPipe != NULL && tsCommitCompSched != NULL && nColsNotAllNull > 0) {
+    pPipe->aColIdx[0] = 0;
+    pPipe->aColBuf[0].reqCodec = (SColCodec){TSDB_COL_CODEC_DEFAULT, 0};
+    if (tsdbCompressBlockColsParallel(pPipe, pCfg, pDataCols, nColsNotAllNull + 1, rowsToWrite) < 0) {
+      return -1;
+    }
+    compressed = true;
+  }
+
   // Compress the data if neccessary
   int      tcol = 0;  // counter of not all NULL and written columns
   uint32_t toffset = 0;
@@ -1135,41 +1796,34 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
     if (ncol != 0 && (pDataCol->colId != pBlockCol->colId)) continue;
 
     int32_t flen;  // final length
-    int32_t tlen = dataColGetNEleLen(pDataCol, rowsToWrite);
-    void *  tptr;
-
-    // Make room
-    if (tsdbMakeRoom(ppBuf, lsize + tlen + COMP_OVERFLOW_BYTES + sizeof(TSCKSUM)) < 0) {
-      return -1;
-    }
-    pBlockData = (SBlockData *)(*ppBuf);
-    pBlockCol = pBlockData->cols + tcol;
-    tptr = POINTER_SHIFT(pBlockData, lsize);
+    uint8_t codec;
 
-    if (pCfg->compression == TWO_STAGE_COMP &&
-        tsdbMakeRoom(ppCBuf, tlen + COMP_OVERFLOW_BYTES) < 0) {
-      return -1;
-    }
+    if (compressed) {
+      SCommitColBuf *pColBuf = pPipe->aColBuf + ((ncol == 0) ? 0 : (tcol + 1));
 
-    // Compress or just copy
-    if (pCfg->compression) {
-      flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
-                                                      tlen + COMP_OVERFLOW_BYTES, pCfg->compression, *ppCBuf,
-                                                      tlen + COMP_OVERFLOW_BYTES);
+      flen = pColBuf->flen;
+      codec = pColBuf->codec;
+      if (tsdbMakeRoom(ppBuf, lsize + flen) < 0) {
+        return -1;
+      }
+      memcpy(POINTER_SHIFT(*ppBuf, lsize), pColBuf->pBuf, flen);
     } else {
-      flen = tlen;
-      memcpy(tptr, pDataCol->pData, flen);
-    }
+      // the key column is always compressed by the algorithm of the block
+      SColCodec reqCodec = {TSDB_COL_CODEC_DEFAULT, 0};
+      if (ncol != 0) reqCodec = tsdbGetColCodec(pCfg->db, pTable, pDataCol->colId);
 
-    // Add checksum
-    ASSERT(flen > 0);
-    flen += sizeof(TSCKSUM);
-    taosCalcChecksumAppend(0, (uint8_t *)tptr, flen);
-    tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(tptr, flen - sizeof(TSCKSUM)));
+      if ((flen = tsdbCompressBlockCol(pCfg, pDataCol, rowsToWrite, reqCodec, ppBuf, lsize, ppCBuf, &codec)) < 0) {
+        return -1;
+      }
+    }
+    pBlockData = (SBlockData *)(*ppBuf);
+    pBlockCol = pBlockData->cols + tcol;
+    tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, lsize + flen - sizeof(TSCKSUM)));
 
     if (ncol != 0) {
       tsdbSetBlockColOffset(pBlockCol, toffset);
       pBlockCol->len = flen;
+      pBlockCol->codec = codec;
       tcol++;
     } else {
       keyLen = flen;
@@ -1186,21 +1840,99 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   taosCalcChecksumAppend(0, (uint8_t *)pBlockData, tsize);
   tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, tsize - sizeof(TSCKSUM)));
 
-  // Write the whole block to file
-  if (tsdbAppendDFile(pDFile, (void *)pBlockData, lsize, &offset) < lsize) {
+  uint32_t bloomLen = 0;
+  if (nColsNotAllNull > 0) {
+    taosCalcChecksumAppend(0, (uint8_t *)pAggrBlkData, tsizeAggr);
+    tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr - sizeof(TSCKSUM)));
+    if (tsBlockBloomFilter && tsdbEncodeBlockBloom(pDFileAggr, pDataCols, ppExBuf, tsizeAggr, &bloomLen) < 0) {
+      return -1;
+    }
+  } else {
+    tsizeAggr = 0;
+  }
+
+  pEBlock->len = lsize;
+  pEBlock->keyLen = keyLen;
+  pEBlock->numOfCols = nColsNotAllNull;
+  pEBlock->aggrLen = tsizeAggr + bloomLen;
+  pEBlock->hasBloom = (bloomLen > 0);
+
+  return 0;
+}
+
+/*
+ * Encode and write a block of data. If pPipe is not NULL, the block is encoded to a free slot of the pipeline and
+ * handed to the write stage, so it is written while the next block is encoded. The offsets of the block are decided
+ * here by the file sizes, as the write stage appends the blocks of a file in the same order.
+ */
+static int tsdbWriteBlockToPipe(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr,
+                                SDataCols *pDataCols, SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf,
+                                void **ppCBuf, void **ppExBuf, SCommitPipe *pPipe, SCommitStat *pStat) {
+  STsdbCfg *       pCfg = REPO_CFG(pRepo);
+  SCommitPipeSlot *pSlot = NULL;
+  SEncodedBlock    eBlock = {0};
+  int64_t          offset = 0, offsetAggr = 0;
+  int              rowsToWrite = pDataCols->numOfRows;
+  int64_t          st;
+
+  ASSERT(rowsToWrite > 0 && rowsToWrite <= pCfg->maxRowsPerFileBlock);
+  ASSERT((!isLast) || rowsToWrite < pCfg->minRowsPerFileBlock);
+
+  if (pPipe != NULL) {
+    if ((pSlot = tsdbGetCommitPipeSlot(pPipe, pStat)) == NULL) {
+      return -1;
+    }
+    ppBuf = &(pSlot->pBuf);
+    ppExBuf = &(pSlot->pExBuf);
+  }
+
+  st = taosGetTimestampUs();
+  if (tsdbEncodeBlock(pCfg, pTable, pDFile, pDFileAggr, pDataCols, ppBuf, ppCBuf, ppExBuf, pPipe, &eBlock) < 0) {
+    if (pSlot != NULL) tsem_post(&(pSlot->free));
     return -1;
   }
+  if (pStat != NULL) {
+    pStat->compUs += taosGetTimestampUs() - st;
+  }
 
-  uint32_t aggrStatus = nColsNotAllNull > 0 ? 1 : 0;
-  if (aggrStatus > 0) {
+  if (pPipe != NULL) {
+    offset = pDFile->info.size;
+    pDFile->info.size += eBlock.len;
+    if (eBlock.aggrLen > 0) {
+      offsetAggr = pDFileAggr->info.size;
+      pDFileAggr->info.size += eBlock.aggrLen;
+    }
 
-    taosCalcChecksumAppend(0, (uint8_t *)pAggrBlkData, tsizeAggr);
-    tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr - sizeof(TSCKSUM)));
+    pSlot->pDFile = pDFile;
+    pSlot->offset = offset;
+    pSlot->len = eBlock.len;
+    pSlot->pDFileAggr = pDFileAggr;
+    pSlot->offsetAggr = offsetAggr;
+    pSlot->aggrLen = eBlock.aggrLen;
+    tsdbPutCommitPipeSlot(pPipe, pSlot);
+  } else {
+    st = taosGetTimestampUs();
 
     // Write the whole block to file
-    if (tsdbAppendDFile(pDFileAggr, (void *)pAggrBlkData, tsizeAggr, &offsetAggr) < tsizeAggr) {
+    if (tsdbAppendDFile(pDFile, *ppBuf, eBlock.len, &offset) < eBlock.len) {
       return -1;
     }
+
+    if (eBlock.aggrLen > 0) {
+      // Write the whole block to file
+      if (tsdbAppendDFile(pDFileAggr, *ppExBuf, eBlock.aggrLen, &offsetAggr) < (int)eBlock.aggrLen) {
+        return -1;
+      }
+    }
+
+    if (pStat != NULL) {
+      pStat->writeUs += taosGetTimestampUs() - st;
+    }
+  }
+
+  if (pStat != NULL) {
+    pStat->nBlocks++;
+    pStat->nBytes += eBlock.len + eBlock.aggrLen;
   }
 
   // Update pBlock membership variables
@@ -1208,15 +1940,16 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   pBlock->offset = offset;
   pBlock->algorithm = pCfg->compression;
   pBlock->numOfRows = rowsToWrite;
-  pBlock->len = lsize;
-  pBlock->keyLen = keyLen;
+  pBlock->len = eBlock.len;
+  pBlock->keyLen = eBlock.keyLen;
   pBlock->numOfSubBlocks = isSuper ? 1 : 0;
-  pBlock->numOfCols = nColsNotAllNull;
+  pBlock->numOfCols = eBlock.numOfCols;
   pBlock->keyFirst = dataColsKeyFirst(pDataCols);
   pBlock->keyLast = dataColsKeyLast(pDataCols);
   // since blkVer1
-  pBlock->aggrStat = aggrStatus;
+  pBlock->aggrStat = (eBlock.aggrLen > 0) ? 1 : 0;
   pBlock->blkVer = SBlockVerLatest;
+  pBlock->hasBloom = eBlock.hasBloom ? 1 : 0;
   pBlock->aggrOffset = (uint64_t)offsetAggr;
 
   tsdbDebug("vgId:%d tid:%d a block of data is written to file %s, offset %" PRId64
@@ -1227,12 +1960,19 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   return 0;
 }
 
+int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
+                       SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf) {
+  return tsdbWriteBlockToPipe(pRepo, pTable, pDFile, pDFileAggr, pDataCols, pBlock, isLast, isSuper, ppBuf, ppCBuf,
+                              ppExBuf, NULL, NULL);
+}
+
 static int tsdbWriteBlock(SCommitH *pCommith, SDFile *pDFile, SDataCols *pDataCols, SBlock *pBlock, bool isLast,
                           bool isSuper) {
-  return tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile,
-                            isLast ? TSDB_COMMIT_SMAL_FILE(pCommith) : TSDB_COMMIT_SMAD_FILE(pCommith), pDataCols,
-                            pBlock, isLast, isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
-                            (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))), (void **)(&(TSDB_COMMIT_EXBUF(pCommith))));
+  return tsdbWriteBlockToPipe(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile,
+                              isLast ? TSDB_COMMIT_SMAL_FILE(pCommith) : TSDB_COMMIT_SMAD_FILE(pCommith), pDataCols,
+                              pBlock, isLast, isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
+                              (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))), (void **)(&(TSDB_COMMIT_EXBUF(pCommith))),
+                              pCommith->pPipe, &(pCommith->stat));
 }
 
 static int tsdbWriteBlockInfo(SCommitH *pCommih) {
@@ -1308,7 +2048,7 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
     keyLimit = pBlock[1].keyFirst - 1;
   }
 
-  SSkipListIterator titer = *(pIter->pIter);
+  STableDataIter titer = *(pIter->pIter);
   if (tsdbLoadBlockDataCols(&(pCommith->readh), pBlock, NULL, &colId, 1) < 0) return -1;
 
   tsdbLoadDataFromCache(pIter->pTable, &titer, keyLimit, INT32_MAX, NULL, pCommith->readh.pDCols[0]->cols[0].pData,
@@ -1487,7 +2227,7 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
 
       tdAppendMemRowToDataCol(row, pSchema, pTarget, true, 0);
 
-      tSkipListIterNext(pCommitIter->pIter);
+      tsdbTableDataIterNext(pCommitIter->pIter);
     } else {
       if (update != TD_ROW_OVERWRITE_UPDATE) {
         //copy disk data
@@ -1511,7 +2251,7 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
                                 update != TD_ROW_PARTIAL_UPDATE ? 0 : -1);
       }
       (*iter)++;
-      tSkipListIterNext(pCommitIter->pIter);
+      tsdbTableDataIterNext(pCommitIter->pIter);
     }
 
     if (pTarget->numOfRows >= maxRows) break;
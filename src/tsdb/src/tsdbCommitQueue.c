@@ -59,6 +59,23 @@ int tsdbInitCommitQueue() {
   pthread_mutex_init(&(pQueue->lock), NULL);
   pthread_cond_init(&(pQueue->queueNotEmpty), NULL);
 
+  if (tsdbInitCommitCompPool() < 0) {
+    pthread_cond_destroy(&(pQueue->queueNotEmpty));
+    pthread_mutex_destroy(&(pQueue->lock));
+    free(pQueue->threads);
+    tdListFree(pQueue->queue);
+    return -1;
+  }
+
+  if (tsdbInitCommitFSetPool() < 0) {
+    tsdbDestroyCommitCompPool();
+    pthread_cond_destroy(&(pQueue->queueNotEmpty));
+    pthread_mutex_destroy(&(pQueue->lock));
+    free(pQueue->threads);
+    tdListFree(pQueue->queue);
+    return -1;
+  }
+
   for (int i = 0; i < nthreads; i++) {
     pthread_create(pQueue->threads + i, NULL, tsdbLoopCommit, NULL);
   }
@@ -85,6 +102,9 @@ void tsdbDestroyCommitQueue() {
     pthread_join(pQueue->threads[i], NULL);
   }
 
+  tsdbDestroyCommitFSetPool();
+  tsdbDestroyCommitCompPool();
+
   free(pQueue->threads);
   tdListFree(pQueue->queue);
   pthread_cond_destroy(&(pQueue->queueNotEmpty));
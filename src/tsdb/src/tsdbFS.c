@@ -37,6 +37,8 @@ static void tsdbScanAndTryFixDFilesHeader(STsdbRepo *pRepo, int32_t *nExpired);
 static int  tsdbProcessExpiredFS(STsdbRepo *pRepo);
 static int  tsdbCreateMeta(STsdbRepo *pRepo);
 static int  tsdbFetchTFileSet(STsdbRepo *pRepo, SArray **fArray);
+static void tsdbInvalidateBlockCache(STsdbRepo *pRepo, SFSStatus *pFrom, SFSStatus *pTo);
+static void tsdbInvalidateIdxCache(STsdbRepo *pRepo, SFSStatus *pFrom, SFSStatus *pTo);
 
 // For backward compatibility
 // ================== CURRENT file header info
@@ -386,6 +388,8 @@ int tsdbEndFSTxn(STsdbRepo *pRepo) {
 
   // Make new 
   tsdbWLockFS(pfs);
+  tsdbInvalidateBlockCache(pRepo, pfs->cstatus, pfs->nstatus);
+  tsdbInvalidateIdxCache(pRepo, pfs->cstatus, pfs->nstatus);
   pStatus = pfs->cstatus;
   pfs->cstatus = pfs->nstatus;
   pfs->nstatus = pStatus;
@@ -551,6 +555,60 @@ static void tsdbApplyFSTxnOnDisk(SFSStatus *pFrom, SFSStatus *pTo) {
   }
 }
 
+// Drop the cached blocks of FSETs whose DATA or LAST file is replaced or removed. Files appended in place keep
+// the cached blocks since the offsets of existing blocks do not change.
+static void tsdbInvalidateBlockCache(STsdbRepo *pRepo, SFSStatus *pFrom, SFSStatus *pTo) {
+  if (pRepo->pBlockCache == NULL) return;
+
+  size_t nset = taosArrayGetSize(pFrom->df);
+  for (size_t i = 0; i < nset; i++) {
+    SDFileSet *pSetFrom = taosArrayGet(pFrom->df, i);
+    SDFileSet *pSetTo = taosArraySearch(pTo->df, &(pSetFrom->fid), tsdbComparFidFSet, TD_EQ);
+
+    if (pSetTo != NULL) {
+      SDFile *pDFileFrom = TSDB_DFILE_IN_SET(pSetFrom, TSDB_FILE_DATA);
+      SDFile *pDFileTo = TSDB_DFILE_IN_SET(pSetTo, TSDB_FILE_DATA);
+      SDFile *pLFileFrom = TSDB_DFILE_IN_SET(pSetFrom, TSDB_FILE_LAST);
+      SDFile *pLFileTo = TSDB_DFILE_IN_SET(pSetTo, TSDB_FILE_LAST);
+
+      if (tfsIsSameFile(TSDB_FILE_F(pDFileFrom), TSDB_FILE_F(pDFileTo)) &&
+          tfsIsSameFile(TSDB_FILE_F(pLFileFrom), TSDB_FILE_F(pLFileTo)) &&
+          pDFileTo->info.size >= pDFileFrom->info.size && pLFileTo->info.size >= pLFileFrom->info.size) {
+        continue;
+      }
+    }
+
+    tsdbDebug("vgId:%d FSET %d is changed, invalidate its cached blocks", REPO_ID(pRepo), pSetFrom->fid);
+    tsdbBlockCacheInvalidate(pRepo->pBlockCache, pSetFrom->fid);
+  }
+}
+
+// Drop the cached SBlockIdx and SBlockInfo of FSETs whose HEAD file is replaced or removed. The HEAD file is
+// rewritten each time the FSET is committed to or compacted, while FSETs untouched by the transaction keep theirs.
+static void tsdbInvalidateIdxCache(STsdbRepo *pRepo, SFSStatus *pFrom, SFSStatus *pTo) {
+  if (pRepo->pIdxCache == NULL) return;
+
+  size_t nset = taosArrayGetSize(pFrom->df);
+  for (size_t i = 0; i < nset; i++) {
+    SDFileSet *pSetFrom = taosArrayGet(pFrom->df, i);
+    SDFileSet *pSetTo = taosArraySearch(pTo->df, &(pSetFrom->fid), tsdbComparFidFSet, TD_EQ);
+
+    if (pSetTo != NULL) {
+      SDFile *pHFileFrom = TSDB_DFILE_IN_SET(pSetFrom, TSDB_FILE_HEAD);
+      SDFile *pHFileTo = TSDB_DFILE_IN_SET(pSetTo, TSDB_FILE_HEAD);
+
+      if (tfsIsSameFile(TSDB_FILE_F(pHFileFrom), TSDB_FILE_F(pHFileTo)) &&
+          pHFileFrom->info.magic == pHFileTo->info.magic && pHFileFrom->info.size == pHFileTo->info.size &&
+          pHFileFrom->info.offset == pHFileTo->info.offset && pHFileFrom->info.len == pHFileTo->info.len) {
+        continue;
+      }
+    }
+
+    tsdbDebug("vgId:%d FSET %d is changed, invalidate its cached block indexes", REPO_ID(pRepo), pSetFrom->fid);
+    tsdbIdxCacheInvalidate(pRepo->pIdxCache, pSetFrom->fid);
+  }
+}
+
 // ================== SFSIter
 // ASSUMPTIONS: the FS Should be read locked when calling these functions
 void tsdbFSIterInit(SFSIter *pIter, STsdbFS *pfs, int direction) {
@@ -929,8 +987,9 @@ static int tsdbScanRootDir(STsdbRepo *pRepo) {
   while ((pf = tfsReaddir(tdir))) {
     tfsbasename(pf, bname);
 
-    if (strcmp(bname, tsdbTxnFname[TSDB_TXN_CURR_FILE]) == 0 || strcmp(bname, "data") == 0) {
-      // Skip current file and data directory
+    if (strcmp(bname, tsdbTxnFname[TSDB_TXN_CURR_FILE]) == 0 || strcmp(bname, "data") == 0 ||
+        strcmp(bname, TSDB_LAST_CACHE_FNAME) == 0) {
+      // Skip current file, LAST cache file and data directory
       continue;
     }
 
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+#define TSDB_IDX_CACHE_BLOCK_IDX 0
+#define TSDB_IDX_CACHE_BLOCK_INFO 1
+
+typedef struct {
+  int32_t  fid;
+  int8_t   type;
+  int8_t   reserved[3];
+  int64_t  gen;
+  uint64_t uid;  // 0 for the SBlockIdx array
+} SIdxCacheKey;
+
+typedef struct SIdxCacheEntry {
+  struct SIdxCacheEntry *prev;
+  struct SIdxCacheEntry *next;
+  SIdxCacheKey           key;
+  int32_t                refCount;  // the reference of the cache and those of the queries
+  uint32_t               len;
+  char                   data[];
+} SIdxCacheEntry;
+
+struct SIdxCache {
+  pthread_mutex_t mutex;
+  SHashObj *      pEntries;  // SIdxCacheKey -> SIdxCacheEntry *
+  SHashObj *      pGens;     // fid -> generation
+  SIdxCacheEntry *head;      // most recently used
+  SIdxCacheEntry *tail;      // least recently used
+  int64_t         capacity;
+  int64_t         used;
+};
+
+#define TSDB_IDX_CACHE_ENTRY_SIZE(len) (sizeof(SIdxCacheEntry) + (len))
+
+static SIdxCacheEntry *tsdbIdxCacheGet(SIdxCache *pCache, SIdxCacheKey *pKey);
+static void            tsdbIdxCachePut(SIdxCache *pCache, SIdxCacheEntry *pEntry);
+static void            tsdbIdxCacheUnlink(SIdxCache *pCache, SIdxCacheEntry *pEntry);
+static void            tsdbIdxCacheLinkHead(SIdxCache *pCache, SIdxCacheEntry *pEntry);
+static void            tsdbIdxCacheRemove(SIdxCache *pCache, SIdxCacheEntry *pEntry);
+static void            tsdbIdxCacheUnref(SIdxCacheEntry *pEntry);
+static SIdxCacheEntry *tsdbIdxCacheNewEntry(int fid, int64_t gen, int8_t type, uint64_t uid, uint32_t len);
+static void tsdbIdxCacheSetKey(SIdxCacheKey *pKey, int fid, int64_t gen, int8_t type, uint64_t uid);
+
+SIdxCache *tsdbNewIdxCache(int64_t capacity) {
+  SIdxCache *pCache = (SIdxCache *)calloc(1, sizeof(*pCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pCache->pEntries = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
+  pCache->pGens = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_NO_LOCK);
+  if (pCache->pEntries == NULL || pCache->pGens == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    taosHashCleanup(pCache->pEntries);
+    taosHashCleanup(pCache->pGens);
+    free(pCache);
+    return NULL;
+  }
+
+  pthread_mutex_init(&(pCache->mutex), NULL);
+  pCache->capacity = capacity;
+
+  return pCache;
+}
+
+void tsdbFreeIdxCache(SIdxCache *pCache) {
+  if (pCache == NULL) return;
+
+  tsdbIdxCacheInvalidateAll(pCache);
+  taosHashCleanup(pCache->pEntries);
+  taosHashCleanup(pCache->pGens);
+  pthread_mutex_destroy(&(pCache->mutex));
+  free(pCache);
+}
+
+int64_t tsdbIdxCacheGetGen(SIdxCache *pCache, int fid) {
+  int64_t gen = 0;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (pGen != NULL) {
+    gen = *pGen;
+  } else {
+    // Record the fid so that invalidating all the cache also moves it to a new generation
+    taosHashPut(pCache->pGens, &fid, sizeof(fid), &gen, sizeof(gen));
+  }
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  return gen;
+}
+
+// Return a handle of the cached SBlockIdx array of the FSET, which must be released by tsdbIdxCacheRelease, or NULL
+// if it is not cached
+void *tsdbIdxCacheGetBlockIdx(SIdxCache *pCache, int fid, int64_t gen, SBlockIdx **ppBlkIdx, int *numOfBlkIdx) {
+  SIdxCacheKey key;
+  tsdbIdxCacheSetKey(&key, fid, gen, TSDB_IDX_CACHE_BLOCK_IDX, 0);
+
+  pthread_mutex_lock(&(pCache->mutex));
+  SIdxCacheEntry *pEntry = tsdbIdxCacheGet(pCache, &key);
+  if (pEntry != NULL) {
+    pEntry->refCount++;
+  }
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  if (pEntry == NULL) return NULL;
+
+  *ppBlkIdx = (SBlockIdx *)pEntry->data;
+  *numOfBlkIdx = (int)(pEntry->len / sizeof(SBlockIdx));
+  return pEntry;
+}
+
+void tsdbIdxCachePutBlockIdx(SIdxCache *pCache, int fid, int64_t gen, SArray *aBlkIdx) {
+  uint32_t        len = (uint32_t)(taosArrayGetSize(aBlkIdx) * sizeof(SBlockIdx));
+  SIdxCacheEntry *pEntry = tsdbIdxCacheNewEntry(fid, gen, TSDB_IDX_CACHE_BLOCK_IDX, 0, len);
+  if (pEntry == NULL) return;
+
+  if (len > 0) {
+    memcpy(pEntry->data, TARRAY_GET_START(aBlkIdx), len);
+  }
+  tsdbIdxCachePut(pCache, pEntry);
+}
+
+void tsdbIdxCacheRelease(SIdxCache *pCache, void *pHandle) {
+  if (pHandle == NULL) return;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  tsdbIdxCacheUnref((SIdxCacheEntry *)pHandle);
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+// Copy the cached SBlockInfo of the table to *ppBlkInfo, return 0 if it is found and -1 otherwise
+int tsdbIdxCacheGetBlockInfo(SIdxCache *pCache, int fid, int64_t gen, uint64_t uid, SBlockInfo **ppBlkInfo,
+                             uint32_t *len) {
+  SIdxCacheKey key;
+  tsdbIdxCacheSetKey(&key, fid, gen, TSDB_IDX_CACHE_BLOCK_INFO, uid);
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  SIdxCacheEntry *pEntry = tsdbIdxCacheGet(pCache, &key);
+  if (pEntry == NULL || tsdbMakeRoom((void **)ppBlkInfo, pEntry->len) < 0) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    return -1;
+  }
+
+  memcpy(*ppBlkInfo, pEntry->data, pEntry->len);
+  *len = pEntry->len;
+
+  pthread_mutex_unlock(&(pCache->mutex));
+  return 0;
+}
+
+void tsdbIdxCachePutBlockInfo(SIdxCache *pCache, int fid, int64_t gen, uint64_t uid, SBlockInfo *pBlkInfo,
+                              uint32_t len) {
+  SIdxCacheEntry *pEntry = tsdbIdxCacheNewEntry(fid, gen, TSDB_IDX_CACHE_BLOCK_INFO, uid, len);
+  if (pEntry == NULL) return;
+
+  memcpy(pEntry->data, pBlkInfo, len);
+  tsdbIdxCachePut(pCache, pEntry);
+}
+
+// Drop all entries of the FSET and move it to a new generation. It is called with the FS write lock held when the
+// HEAD file of the FSET is replaced, so queries opening the FSET later never see the entries of the old file.
+void tsdbIdxCacheInvalidate(SIdxCache *pCache, int fid) {
+  pthread_mutex_lock(&(pCache->mutex));
+
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (pGen != NULL) {
+    (*pGen)++;
+  }
+
+  SIdxCacheEntry *pEntry = pCache->head;
+  while (pEntry != NULL) {
+    SIdxCacheEntry *pNext = pEntry->next;
+    if (pEntry->key.fid == fid) {
+      tsdbIdxCacheRemove(pCache, pEntry);
+    }
+    pEntry = pNext;
+  }
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+void tsdbIdxCacheInvalidateAll(SIdxCache *pCache) {
+  pthread_mutex_lock(&(pCache->mutex));
+
+  int64_t *pGen = taosHashIterate(pCache->pGens, NULL);
+  while (pGen != NULL) {
+    (*pGen)++;
+    pGen = taosHashIterate(pCache->pGens, pGen);
+  }
+
+  while (pCache->head != NULL) {
+    tsdbIdxCacheRemove(pCache, pCache->head);
+  }
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+static SIdxCacheEntry *tsdbIdxCacheGet(SIdxCache *pCache, SIdxCacheKey *pKey) {
+  SIdxCacheEntry **ppEntry = (SIdxCacheEntry **)taosHashGet(pCache->pEntries, pKey, sizeof(*pKey));
+  if (ppEntry == NULL) return NULL;
+
+  SIdxCacheEntry *pEntry = *ppEntry;
+  if (pCache->head != pEntry) {
+    tsdbIdxCacheUnlink(pCache, pEntry);
+    tsdbIdxCacheLinkHead(pCache, pEntry);
+  }
+
+  return pEntry;
+}
+
+static void tsdbIdxCachePut(SIdxCache *pCache, SIdxCacheEntry *pEntry) {
+  int64_t size = TSDB_IDX_CACHE_ENTRY_SIZE(pEntry->len);
+  int     fid = pEntry->key.fid;
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  // The FSET is replaced after the entry is loaded, or another query has already cached it
+  int64_t *pGen = (int64_t *)taosHashGet(pCache->pGens, &fid, sizeof(fid));
+  if (size > pCache->capacity || pGen == NULL || *pGen != pEntry->key.gen ||
+      taosHashGet(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key)) != NULL) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  while (pCache->used + size > pCache->capacity && pCache->tail != NULL) {
+    tsdbIdxCacheRemove(pCache, pCache->tail);
+  }
+
+  if (taosHashPut(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key), &pEntry, sizeof(pEntry)) < 0) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  tsdbIdxCacheLinkHead(pCache, pEntry);
+  pCache->used += size;
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+static void tsdbIdxCacheUnlink(SIdxCache *pCache, SIdxCacheEntry *pEntry) {
+  if (pEntry->prev) {
+    pEntry->prev->next = pEntry->next;
+  } else {
+    pCache->head = pEntry->next;
+  }
+
+  if (pEntry->next) {
+    pEntry->next->prev = pEntry->prev;
+  } else {
+    pCache->tail = pEntry->prev;
+  }
+
+  pEntry->prev = NULL;
+  pEntry->next = NULL;
+}
+
+static void tsdbIdxCacheLinkHead(SIdxCache *pCache, SIdxCacheEntry *pEntry) {
+  pEntry->prev = NULL;
+  pEntry->next = pCache->head;
+  if (pCache->head) {
+    pCache->head->prev = pEntry;
+  } else {
+    pCache->tail = pEntry;
+  }
+  pCache->head = pEntry;
+}
+
+// Remove the entry from the cache, it is freed once the last query using it releases it
+static void tsdbIdxCacheRemove(SIdxCache *pCache, SIdxCacheEntry *pEntry) {
+  tsdbIdxCacheUnlink(pCache, pEntry);
+  taosHashRemove(pCache->pEntries, &(pEntry->key), sizeof(pEntry->key));
+  pCache->used -= TSDB_IDX_CACHE_ENTRY_SIZE(pEntry->len);
+  tsdbIdxCacheUnref(pEntry);
+}
+
+static void tsdbIdxCacheUnref(SIdxCacheEntry *pEntry) {
+  if (--pEntry->refCount == 0) {
+    free(pEntry);
+  }
+}
+
+static SIdxCacheEntry *tsdbIdxCacheNewEntry(int fid, int64_t gen, int8_t type, uint64_t uid, uint32_t len) {
+  SIdxCacheEntry *pEntry = (SIdxCacheEntry *)malloc(TSDB_IDX_CACHE_ENTRY_SIZE(len));
+  if (pEntry == NULL) return NULL;
+
+  tsdbIdxCacheSetKey(&(pEntry->key), fid, gen, type, uid);
+  pEntry->prev = NULL;
+  pEntry->next = NULL;
+  pEntry->refCount = 1;
+  pEntry->len = len;
+
+  return pEntry;
+}
+
+static void tsdbIdxCacheSetKey(SIdxCacheKey *pKey, int fid, int64_t gen, int8_t type, uint64_t uid) {
+  memset(pKey, 0, sizeof(*pKey));
+  pKey->fid = fid;
+  pKey->type = type;
+  pKey->gen = gen;
+  pKey->uid = uid;
+}
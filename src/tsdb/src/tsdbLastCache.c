@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+
+// The LAST cache file is made of a header, one entry of each saved table ended by a zero tid, the number of
+// entries and the checksum of the whole file:
+//
+// header: | magic | version | FS version | total points | total storage | cacheLastRow |
+// entry:  | tid | uid | lastKey | flags | [rowLen | lastRow] | [sversion | ncols | (colId | ts | bytes | data)...] |
+#define TSDB_LAST_CACHE_MAGIC 0x4C415354
+#define TSDB_LAST_CACHE_VER_0 0
+#define TSDB_LAST_CACHE_FLUSH_SIZE (64 * 1024)
+
+#define TSDB_LAST_CACHE_HAS_ROW 0x1
+#define TSDB_LAST_CACHE_HAS_COLS 0x2
+
+#define TSDB_LAST_CACHE_HEAD_SIZE (sizeof(uint32_t) * 3 + sizeof(int64_t) * 2 + sizeof(int8_t))
+#define TSDB_LAST_CACHE_ENTRY_SIZE (sizeof(int32_t) + sizeof(uint64_t) + sizeof(TSKEY) + sizeof(uint8_t))
+#define TSDB_LAST_CACHE_COL_SIZE (sizeof(int16_t) + sizeof(TSKEY) + sizeof(uint16_t))
+#define TSDB_LAST_CACHE_MIN_ROW_SIZE (MAX(TD_MEM_ROW_DATA_HEAD_SIZE, TD_MEM_ROW_KV_HEAD_SIZE) + sizeof(TSKEY))
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t fsVersion;
+  int64_t  totalPoints;
+  int64_t  totalStorage;
+  int8_t   cacheLastRow;
+} SLastCacheHeader;
+
+static void  tsdbInitLastCacheHeader(STsdbRepo *pRepo, SLastCacheHeader *pHeader);
+static int   tsdbEncodeLastCacheHeader(void **buf, SLastCacheHeader *pHeader);
+static void *tsdbDecodeLastCacheHeader(void *buf, SLastCacheHeader *pHeader);
+static bool  tsdbIsLastCacheHeaderValid(SLastCacheHeader *pHeader, SLastCacheHeader *pExpected);
+static int   tsdbEncodeLastCacheEntry(STsdbRepo *pRepo, STable *pTable, void **ppBuf, int *used);
+static void *tsdbRestoreLastCacheEntry(STsdbRepo *pRepo, void *buf, void *end, uint8_t *restored, int *nRestored);
+static bool  tsdbTableHasMemData(STsdbRepo *pRepo, STable *pTable);
+static int   tsdbFlushLastCacheBuf(int fd, void *pBuf, int len, TSCKSUM *pCksum);
+
+void tsdbGetLastCacheFname(int repoid, bool tmp, char fname[]) {
+  snprintf(fname, TSDB_FILENAME_LEN, "%s/vnode/vnode%d/tsdb/%s", TFS_PRIMARY_PATH(), repoid,
+           tmp ? TSDB_LAST_CACHE_TFNAME : TSDB_LAST_CACHE_FNAME);
+}
+
+int tsdbSaveLastCacheFile(STsdbRepo *pRepo) {
+  STsdbMeta *      pMeta = pRepo->tsdbMeta;
+  SLastCacheHeader header;
+  char             tfname[TSDB_FILENAME_LEN] = "\0";
+  char             fname[TSDB_FILENAME_LEN] = "\0";
+  void *           pBuf = NULL;
+  void *           ptr;
+  TSCKSUM          cksum = 0;
+  int32_t          nEntries = 0;
+  int              used = 0;
+  int              tid = 1;
+  bool             finished = false;
+  int64_t          st = taosGetTimestampMs();
+
+  if (pRepo->state != TSDB_STATE_OK) {
+    // the cache is not restored from a broken repository
+    tsdbRemoveLastCacheFile(pRepo);
+    return 0;
+  }
+
+  tsdbGetLastCacheFname(REPO_ID(pRepo), true, tfname);
+  tsdbGetLastCacheFname(REPO_ID(pRepo), false, fname);
+
+  if (tsdbMakeRoom(&pBuf, TSDB_LAST_CACHE_FLUSH_SIZE * 2) < 0) {
+    goto _err;
+  }
+
+  int fd = open(tfname, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (fd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  tsdbInitLastCacheHeader(pRepo, &header);
+  ptr = pBuf;
+  used = tsdbEncodeLastCacheHeader(&ptr, &header);
+
+  // The meta lock is only held while encoding a buffer of entries so that creating tables is not blocked by writing
+  // the file
+  while (!finished) {
+    if (tsdbRLockRepoMeta(pRepo) < 0) {
+      close(fd);
+      goto _err;
+    }
+
+    for (; tid < pMeta->maxTables && used < TSDB_LAST_CACHE_FLUSH_SIZE; tid++) {
+      STable *pTable = pMeta->tables[tid];
+      if (pTable == NULL) continue;
+
+      int start = used;
+      if (tsdbEncodeLastCacheEntry(pRepo, pTable, &pBuf, &used) < 0) {
+        tsdbUnlockRepoMeta(pRepo);
+        close(fd);
+        goto _err;
+      }
+
+      // A table written after the memtable was frozen may cache uncommitted rows, leave it to the data files. The
+      // check must follow the encoding since the rows are added to the memtable before the cache is updated.
+      if (used > start && tsdbTableHasMemData(pRepo, pTable)) {
+        used = start;
+      } else if (used > start) {
+        nEntries++;
+      }
+    }
+
+    if (tid >= pMeta->maxTables) {
+      if (tsdbMakeRoom(&pBuf, used + sizeof(int32_t) * 2) < 0) {
+        tsdbUnlockRepoMeta(pRepo);
+        close(fd);
+        goto _err;
+      }
+
+      ptr = POINTER_SHIFT(pBuf, used);
+      used += taosEncodeFixedI32(&ptr, 0);
+      used += taosEncodeFixedI32(&ptr, nEntries);
+      finished = true;
+    }
+
+    tsdbUnlockRepoMeta(pRepo);
+
+    if (tsdbFlushLastCacheBuf(fd, pBuf, used, &cksum) < 0) {
+      close(fd);
+      goto _err;
+    }
+    used = 0;
+  }
+
+  if (taosWrite(fd, &cksum, sizeof(cksum)) < (int64_t)sizeof(cksum)) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    close(fd);
+    goto _err;
+  }
+
+  // The file is not synced, a torn file left by a crash fails the checksum and is ignored
+  close(fd);
+
+  if (taosRename(tfname, fname) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  tsdbDebug("vgId:%d LAST cache file is saved, %d tables, fs version %u, %" PRId64 " ms", REPO_ID(pRepo), nEntries,
+            header.fsVersion, taosGetTimestampMs() - st);
+
+  taosTZfree(pBuf);
+  return 0;
+
+_err:
+  tsdbWarn("vgId:%d failed to save LAST cache file since %s", REPO_ID(pRepo), tstrerror(terrno));
+  remove(tfname);
+  remove(fname);
+  taosTZfree(pBuf);
+  return -1;
+}
+
+// Restore the LAST cache of the tables saved in the file and set restored[tid] for each of them, the number of
+// restored tables is returned. A missing, corrupted or outdated file restores nothing, and the last two are removed so
+// that the file is saved again when the repository is closed.
+int tsdbLoadLastCacheFile(STsdbRepo *pRepo, uint8_t *restored) {
+  SLastCacheHeader header, expected;
+  char             fname[TSDB_FILENAME_LEN] = "\0";
+  struct stat      fst;
+  void *           pBuf = NULL;
+  void *           ptr;
+  void *           end;
+  int              nRestored = 0;
+  int32_t          nEntries = 0;
+  bool             invalid = true;
+
+  tsdbGetLastCacheFname(REPO_ID(pRepo), false, fname);
+
+  int fd = open(fname, O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    tsdbDebug("vgId:%d no LAST cache file %s, %s", REPO_ID(pRepo), fname, strerror(errno));
+    return 0;
+  }
+
+  if (fstat(fd, &fst) < 0 || fst.st_size < TSDB_LAST_CACHE_HEAD_SIZE + sizeof(int32_t) * 2 + sizeof(TSCKSUM) ||
+      fst.st_size > UINT32_MAX) {
+    tsdbWarn("vgId:%d LAST cache file %s is ignored since its size is invalid", REPO_ID(pRepo), fname);
+    close(fd);
+    tsdbRemoveLastCacheFile(pRepo);
+    return 0;
+  }
+
+  pBuf = mmap(NULL, (size_t)fst.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (pBuf == MAP_FAILED) {
+    tsdbWarn("vgId:%d failed to mmap LAST cache file %s since %s", REPO_ID(pRepo), fname, strerror(errno));
+    return 0;
+  }
+
+  if (!taosCheckChecksumWhole((uint8_t *)pBuf, (uint32_t)fst.st_size)) {
+    tsdbWarn("vgId:%d LAST cache file %s is ignored since it is corrupted", REPO_ID(pRepo), fname);
+    goto _exit;
+  }
+
+  ptr = tsdbDecodeLastCacheHeader(pBuf, &header);
+  tsdbInitLastCacheHeader(pRepo, &expected);
+  if (!tsdbIsLastCacheHeaderValid(&header, &expected)) {
+    tsdbInfo("vgId:%d LAST cache file %s is outdated, fs version %u cacheLast %d, current %u cacheLast %d",
+             REPO_ID(pRepo), fname, header.fsVersion, header.cacheLastRow, expected.fsVersion, expected.cacheLastRow);
+    goto _exit;
+  }
+
+  end = POINTER_SHIFT(pBuf, fst.st_size - sizeof(TSCKSUM));
+  while (true) {
+    int32_t tid;
+
+    if (POINTER_DISTANCE(end, ptr) < (int64_t)sizeof(int32_t) * 2) {
+      ptr = NULL;
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      break;
+    }
+
+    taosDecodeFixedI32(ptr, &tid);
+    if (tid == 0) {
+      taosDecodeFixedI32(POINTER_SHIFT(ptr, sizeof(int32_t)), &nEntries);
+      break;
+    }
+
+    ptr = tsdbRestoreLastCacheEntry(pRepo, ptr, end, restored, &nRestored);
+    if (ptr == NULL) break;
+  }
+
+  if (ptr == NULL) {
+    if (terrno == TSDB_CODE_TDB_OUT_OF_MEMORY) {
+      tsdbError("vgId:%d failed to restore LAST cache from file since %s", REPO_ID(pRepo), tstrerror(terrno));
+      invalid = false;
+      nRestored = -1;
+      goto _exit;
+    }
+    // the tables restored before the broken entry are still valid
+    tsdbWarn("vgId:%d LAST cache file %s is broken after %d tables", REPO_ID(pRepo), fname, nRestored);
+  }
+
+  if (nRestored >= 0) {
+    tsdbInfo("vgId:%d LAST cache of %d tables is restored from file, %d saved", REPO_ID(pRepo), nRestored, nEntries);
+  }
+  invalid = (ptr == NULL);
+
+_exit:
+  munmap(pBuf, (size_t)fst.st_size);
+  if (invalid) tsdbRemoveLastCacheFile(pRepo);
+  return nRestored;
+}
+
+// Whether the LAST cache file belongs to the current FS status, only the header is checked
+bool tsdbIsLastCacheFileValid(STsdbRepo *pRepo) {
+  SLastCacheHeader header, expected;
+  char             fname[TSDB_FILENAME_LEN] = "\0";
+  char             buf[TSDB_LAST_CACHE_HEAD_SIZE];
+
+  tsdbGetLastCacheFname(REPO_ID(pRepo), false, fname);
+
+  int fd = open(fname, O_RDONLY | O_BINARY);
+  if (fd < 0) return false;
+
+  int64_t size = taosRead(fd, buf, TSDB_LAST_CACHE_HEAD_SIZE);
+  close(fd);
+  if (size < (int64_t)TSDB_LAST_CACHE_HEAD_SIZE) return false;
+
+  tsdbDecodeLastCacheHeader(buf, &header);
+  tsdbInitLastCacheHeader(pRepo, &expected);
+  return tsdbIsLastCacheHeaderValid(&header, &expected);
+}
+
+void tsdbRemoveLastCacheFile(STsdbRepo *pRepo) {
+  char fname[TSDB_FILENAME_LEN] = "\0";
+
+  tsdbGetLastCacheFname(REPO_ID(pRepo), false, fname);
+  if (remove(fname) == 0) {
+    tsdbDebug("vgId:%d LAST cache file %s is removed", REPO_ID(pRepo), fname);
+  }
+}
+
+static void tsdbInitLastCacheHeader(STsdbRepo *pRepo, SLastCacheHeader *pHeader) {
+  SFSStatus *pStatus = REPO_FS(pRepo)->cstatus;
+
+  pHeader->magic = TSDB_LAST_CACHE_MAGIC;
+  pHeader->version = TSDB_LAST_CACHE_VER_0;
+  pHeader->fsVersion = pStatus->meta.version;
+  pHeader->totalPoints = pStatus->meta.totalPoints;
+  pHeader->totalStorage = pStatus->meta.totalStorage;
+  pHeader->cacheLastRow = REPO_CFG(pRepo)->cacheLastRow;
+}
+
+static bool tsdbIsLastCacheHeaderValid(SLastCacheHeader *pHeader, SLastCacheHeader *pExpected) {
+  return pHeader->magic == pExpected->magic && pHeader->version == pExpected->version &&
+         pHeader->fsVersion == pExpected->fsVersion && pHeader->totalPoints == pExpected->totalPoints &&
+         pHeader->totalStorage == pExpected->totalStorage && pHeader->cacheLastRow == pExpected->cacheLastRow;
+}
+
+static int tsdbEncodeLastCacheHeader(void **buf, SLastCacheHeader *pHeader) {
+  int tlen = 0;
+
+  tlen += taosEncodeFixedU32(buf, pHeader->magic);
+  tlen += taosEncodeFixedU32(buf, pHeader->version);
+  tlen += taosEncodeFixedU32(buf, pHeader->fsVersion);
+  tlen += taosEncodeFixedI64(buf, pHeader->totalPoints);
+  tlen += taosEncodeFixedI64(buf, pHeader->totalStorage);
+  tlen += taosEncodeFixedI8(buf, pHeader->cacheLastRow);
+
+  return tlen;
+}
+
+static void *tsdbDecodeLastCacheHeader(void *buf, SLastCacheHeader *pHeader) {
+  buf = taosDecodeFixedU32(buf, &(pHeader->magic));
+  buf = taosDecodeFixedU32(buf, &(pHeader->version));
+  buf = taosDecodeFixedU32(buf, &(pHeader->fsVersion));
+  buf = taosDecodeFixedI64(buf, &(pHeader->totalPoints));
+  buf = taosDecodeFixedI64(buf, &(pHeader->totalStorage));
+  buf = taosDecodeFixedI8(buf, &(pHeader->cacheLastRow));
+
+  return buf;
+}
+
+// Append the entry of a table to the buffer, nothing is appended if the cache of the table is not complete, i.e.
+// the cacheLast option changed and the table is not queried since then
+static int tsdbEncodeLastCacheEntry(STsdbRepo *pRepo, STable *pTable, void **ppBuf, int *used) {
+  STsdbCfg *pCfg = REPO_CFG(pRepo);
+  uint8_t   flags = 0;
+  int       tlen = TSDB_LAST_CACHE_ENTRY_SIZE;
+  int       code = 0;
+
+  TSDB_RLOCK_TABLE(pTable);
+
+  if (pTable->cacheLastConfigVersion != pRepo->cacheLastConfigVersion) goto _exit;
+
+  if (CACHE_LAST_ROW(pCfg)) {
+    if (pTable->lastRow != NULL) {
+      flags |= TSDB_LAST_CACHE_HAS_ROW;
+      tlen += sizeof(uint32_t) + memRowTLen(pTable->lastRow);
+    } else if (pTable->lastKey != TSKEY_INITIAL_VAL) {
+      goto _exit;
+    }
+  }
+
+  if (CACHE_LAST_NULL_COLUMN(pCfg)) {
+    if (pTable->lastCols != NULL) {
+      flags |= TSDB_LAST_CACHE_HAS_COLS;
+      tlen += sizeof(int32_t) + sizeof(int16_t);
+      for (int16_t i = 0; i < pTable->maxColNum; i++) {
+        tlen += TSDB_LAST_CACHE_COL_SIZE + pTable->lastCols[i].bytes;
+      }
+    } else if (pTable->lastKey != TSKEY_INITIAL_VAL) {
+      goto _exit;
+    }
+  }
+
+  if (tsdbMakeRoom(ppBuf, *used + tlen) < 0) {
+    code = -1;
+    goto _exit;
+  }
+
+  void *ptr = POINTER_SHIFT(*ppBuf, *used);
+  taosEncodeFixedI32(&ptr, TABLE_TID(pTable));
+  taosEncodeFixedU64(&ptr, TABLE_UID(pTable));
+  taosEncodeFixedI64(&ptr, pTable->lastKey);
+  taosEncodeFixedU8(&ptr, flags);
+
+  if (flags & TSDB_LAST_CACHE_HAS_ROW) {
+    uint32_t rowLen = memRowTLen(pTable->lastRow);
+    taosEncodeFixedU32(&ptr, rowLen);
+    memcpy(ptr, pTable->lastRow, rowLen);
+    ptr = POINTER_SHIFT(ptr, rowLen);
+  }
+
+  if (flags & TSDB_LAST_CACHE_HAS_COLS) {
+    taosEncodeFixedI32(&ptr, pTable->lastColSVersion);
+    taosEncodeFixedI16(&ptr, pTable->maxColNum);
+    for (int16_t i = 0; i < pTable->maxColNum; i++) {
+      SDataCol *pDataCol = pTable->lastCols + i;
+      taosEncodeFixedI16(&ptr, pDataCol->colId);
+      taosEncodeFixedI64(&ptr, pDataCol->ts);
+      taosEncodeFixedU16(&ptr, (uint16_t)pDataCol->bytes);
+      if (pDataCol->bytes > 0) {
+        memcpy(ptr, pDataCol->pData, pDataCol->bytes);
+        ptr = POINTER_SHIFT(ptr, pDataCol->bytes);
+      }
+    }
+  }
+
+  ASSERT(POINTER_DISTANCE(ptr, *ppBuf) == *used + tlen);
+  *used += tlen;
+
+_exit:
+  TSDB_RUNLOCK_TABLE(pTable);
+  return code;
+}
+
+// Restore the cache of a table from an entry and return the next entry, NULL is returned if the entry is broken or
+// out of memory with terrno set. The entry of a table dropped or recreated since the file was saved is skipped.
+static void *tsdbRestoreLastCacheEntry(STsdbRepo *pRepo, void *buf, void *end, uint8_t *restored, int *nRestored) {
+  STsdbMeta *pMeta = pRepo->tsdbMeta;
+  int32_t    tid;
+  uint64_t   uid;
+  TSKEY      lastKey;
+  uint8_t    flags;
+  uint32_t   rowLen = 0;
+  void *     pRowData = NULL;
+  int32_t    sversion = -1;
+  int16_t    ncols = 0;
+  void *     pColsData = NULL;
+
+  terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+
+  if (POINTER_DISTANCE(end, buf) < (int64_t)TSDB_LAST_CACHE_ENTRY_SIZE) return NULL;
+  buf = taosDecodeFixedI32(buf, &tid);
+  buf = taosDecodeFixedU64(buf, &uid);
+  buf = taosDecodeFixedI64(buf, &lastKey);
+  buf = taosDecodeFixedU8(buf, &flags);
+
+  if (flags & TSDB_LAST_CACHE_HAS_ROW) {
+    if (POINTER_DISTANCE(end, buf) < (int64_t)sizeof(uint32_t)) return NULL;
+    buf = taosDecodeFixedU32(buf, &rowLen);
+    if (POINTER_DISTANCE(end, buf) < (int64_t)rowLen || rowLen < TSDB_LAST_CACHE_MIN_ROW_SIZE) return NULL;
+    pRowData = buf;
+    buf = POINTER_SHIFT(buf, rowLen);
+    if (memRowTLen(pRowData) != rowLen || memRowKey(pRowData) != lastKey) return NULL;
+  }
+
+  if (flags & TSDB_LAST_CACHE_HAS_COLS) {
+    if (POINTER_DISTANCE(end, buf) < (int64_t)(sizeof(int32_t) + sizeof(int16_t))) return NULL;
+    buf = taosDecodeFixedI32(buf, &sversion);
+    buf = taosDecodeFixedI16(buf, &ncols);
+    if (ncols < 0) return NULL;
+
+    pColsData = buf;
+    for (int16_t i = 0; i < ncols; i++) {
+      uint16_t bytes;
+      if (POINTER_DISTANCE(end, buf) < (int64_t)TSDB_LAST_CACHE_COL_SIZE) return NULL;
+      buf = POINTER_SHIFT(buf, sizeof(int16_t) + sizeof(TSKEY));
+      buf = taosDecodeFixedU16(buf, &bytes);
+      if (POINTER_DISTANCE(end, buf) < (int64_t)bytes) return NULL;
+      buf = POINTER_SHIFT(buf, bytes);
+    }
+  }
+
+  terrno = TSDB_CODE_SUCCESS;
+
+  if (tid < 1 || tid >= pMeta->maxTables) return buf;
+  STable *pTable = pMeta->tables[tid];
+  if (pTable == NULL || TABLE_UID(pTable) != uid) return buf;
+
+  SMemRow   lastRow = NULL;
+  SDataCol *lastCols = NULL;
+
+  if (pRowData != NULL) {
+    lastRow = taosTMalloc(rowLen);
+    if (lastRow == NULL) goto _err;
+    memcpy(lastRow, pRowData, rowLen);
+  }
+
+  if (pColsData != NULL && ncols > 0) {
+    lastCols = (SDataCol *)calloc(ncols, sizeof(SDataCol));
+    if (lastCols == NULL) goto _err;
+
+    void *ptr = pColsData;
+    for (int16_t i = 0; i < ncols; i++) {
+      SDataCol *pDataCol = lastCols + i;
+      uint16_t  bytes;
+
+      ptr = taosDecodeFixedI16(ptr, &(pDataCol->colId));
+      ptr = taosDecodeFixedI64(ptr, &(pDataCol->ts));
+      ptr = taosDecodeFixedU16(ptr, &bytes);
+      if (bytes > 0) {
+        pDataCol->pData = malloc(bytes);
+        if (pDataCol->pData == NULL) goto _err;
+        memcpy(pDataCol->pData, ptr, bytes);
+        pDataCol->bytes = bytes;
+        ptr = POINTER_SHIFT(ptr, bytes);
+      }
+    }
+  }
+
+  TSDB_WLOCK_TABLE(pTable);
+  pTable->lastKey = lastKey;
+  if (lastRow != NULL) {
+    taosTZfree(pTable->lastRow);
+    pTable->lastRow = lastRow;
+  }
+  TSDB_WUNLOCK_TABLE(pTable);
+
+  if (pColsData != NULL) {
+    tsdbFreeLastColumns(pTable);
+    TSDB_WLOCK_TABLE(pTable);
+    pTable->lastCols = lastCols;
+    pTable->maxColNum = ncols;
+    pTable->lastColSVersion = sversion;
+    pTable->restoreColumnNum = ncols;
+    pTable->hasRestoreLastColumn = true;
+    TSDB_WUNLOCK_TABLE(pTable);
+  }
+
+  restored[tid] = 1;
+  (*nRestored)++;
+  return buf;
+
+_err:
+  terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+  taosTZfree(lastRow);
+  if (lastCols != NULL) {
+    for (int16_t i = 0; i < ncols; i++) {
+      tfree(lastCols[i].pData);
+    }
+    free(lastCols);
+  }
+  return NULL;
+}
+
+static bool tsdbTableHasMemData(STsdbRepo *pRepo, STable *pTable) {
+  // The memtable can be created by the write thread but not freed while the commit is not over
+  SMemTable *pMem = (SMemTable *)atomic_load_ptr(&(pRepo->mem));
+  bool       hasData = false;
+
+  if (pMem == NULL) return false;
+
+  taosRLockLatch(&(pMem->latch));
+  if (TABLE_TID(pTable) < pMem->maxTables) {
+    STableData *pTableData = pMem->tData[TABLE_TID(pTable)];
+    hasData = (pTableData != NULL && pTableData->uid == TABLE_UID(pTable));
+  }
+  taosRUnLockLatch(&(pMem->latch));
+
+  return hasData;
+}
+
+static int tsdbFlushLastCacheBuf(int fd, void *pBuf, int len, TSCKSUM *pCksum) {
+  if (len == 0) return 0;
+
+  if (taosWrite(fd, pBuf, len) < len) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  *pCksum = taosCalcChecksum(*pCksum, (uint8_t *)pBuf, (uint32_t)len);
+  return 0;
+}
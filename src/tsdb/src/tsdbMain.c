@@ -15,6 +15,7 @@
 
 // no test file errors here
 #include "taosdef.h"
+#include "tglobal.h"
 #include "tsdbint.h"
 #include "ttimer.h"
 #include "tthread.h"
@@ -139,6 +140,12 @@ int tsdbCloseRepo(STsdbRepo *repo, int toCommit) {
 
   tsem_wait(&(pRepo->readyToCommit));
 
+  // all the data is committed, save the LAST cache if no commit did for the current FS status, e.g. nothing is
+  // written since a sync or the files are changed by a compaction
+  if (toCommit && pRepo->mem == NULL && pRepo->code == TSDB_CODE_SUCCESS && !tsdbIsLastCacheFileValid(pRepo)) {
+    tsdbSaveLastCacheFile(pRepo);
+  }
+
   tsdbUnRefMemTable(pRepo, pRepo->mem);
   tsdbUnRefMemTable(pRepo, pRepo->imem);
   pRepo->mem = NULL;
@@ -215,12 +222,17 @@ int tsdbGetState(STsdbRepo *repo) { return repo->state; }
 
 int8_t tsdbGetCompactState(STsdbRepo *repo) { return (int8_t)(repo->compactState); }
 
-void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage) {
+void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage,
+                    int64_t *memArenaPages, int64_t *memArenaBytes) {
   ASSERT(repo != NULL);
   STsdbRepo *pRepo = repo;
+  tsdbGetMemArenaUsage(pRepo, &pRepo->stat.memArenaPages, &pRepo->stat.memArenaBytes);
+
   *totalPoints = pRepo->stat.pointsWritten;
   *totalStorage = pRepo->stat.totalStorage;
   *compStorage = pRepo->stat.compStorage;
+  *memArenaPages = pRepo->stat.memArenaPages;
+  *memArenaBytes = pRepo->stat.memArenaBytes;
 }
 
 int32_t tsdbConfigRepo(STsdbRepo *repo, STsdbCfg *pCfg) {
@@ -626,11 +638,31 @@ static STsdbRepo *tsdbNewRepo(STsdbCfg *pCfg, STsdbAppH *pAppH) {
     return NULL;
   }
 
+  if (tsBlockCacheSize > 0) {
+    pRepo->pBlockCache = tsdbNewBlockCache((int64_t)tsBlockCacheSize * 1024 * 1024);
+    if (pRepo->pBlockCache == NULL) {
+      tsdbError("vgId:%d failed to create block cache since %s", REPO_ID(pRepo), tstrerror(terrno));
+      tsdbFreeRepo(pRepo);
+      return NULL;
+    }
+  }
+
+  if (tsBlockIdxCacheSize > 0) {
+    pRepo->pIdxCache = tsdbNewIdxCache((int64_t)tsBlockIdxCacheSize * 1024 * 1024);
+    if (pRepo->pIdxCache == NULL) {
+      tsdbError("vgId:%d failed to create index cache since %s", REPO_ID(pRepo), tstrerror(terrno));
+      tsdbFreeRepo(pRepo);
+      return NULL;
+    }
+  }
+
   return pRepo;
 }
 
 static void tsdbFreeRepo(STsdbRepo *pRepo) {
   if (pRepo) {
+    tsdbFreeBlockCache(pRepo->pBlockCache);
+    tsdbFreeIdxCache(pRepo->pIdxCache);
     tsdbFreeFS(pRepo->fs);
     tsdbFreeBufPool(pRepo->pPool);
     tsdbFreeMeta(pRepo->tsdbMeta);
@@ -862,12 +894,9 @@ int tsdbRestoreInfo(STsdbRepo *pRepo) {
   SDFileSet *pSet;
   STsdbMeta *pMeta = pRepo->tsdbMeta;
   STsdbCfg * pCfg = REPO_CFG(pRepo);
-
-  if (tsdbInitReadH(&readh, pRepo) < 0) {
-    return -1;
-  }
-
-  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_BACKWARD);
+  uint8_t *  restored = NULL;
+  int        nTables = 0;
+  int        nRestored = 0;
 
   if (CACHE_LAST_NULL_COLUMN(pCfg)) {
     for (int i = 1; i < pMeta->maxTables; i++) {
@@ -878,26 +907,51 @@ int tsdbRestoreInfo(STsdbRepo *pRepo) {
     }
   }
 
+  // the tables saved in the LAST cache file need not to be restored from the data files
+  restored = (uint8_t *)calloc(pMeta->maxTables, sizeof(uint8_t));
+  if (restored == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  if ((nRestored = tsdbLoadLastCacheFile(pRepo, restored)) < 0) {
+    tfree(restored);
+    return -1;
+  }
+
+  for (int i = 1; i < pMeta->maxTables; i++) {
+    if (pMeta->tables[i] != NULL) nTables++;
+  }
+
+  if (nRestored == nTables) {
+    tfree(restored);
+    return 0;
+  }
+
+  if (tsdbInitReadH(&readh, pRepo) < 0) {
+    tfree(restored);
+    return -1;
+  }
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_BACKWARD);
+
   while ((pSet = tsdbFSIterNext(&fsiter)) != NULL) {
     if (tsdbSetAndOpenReadFSet(&readh, pSet) < 0) {
-      tsdbDestroyReadH(&readh);
-      return -1;
+      goto _err;
     }
 
     if (tsdbLoadBlockIdx(&readh) < 0) {
-      tsdbDestroyReadH(&readh);
-      return -1;
+      goto _err;
     }
 
     for (int i = 1; i < pMeta->maxTables; i++) {
       STable *pTable = pMeta->tables[i];
-      if (pTable == NULL) continue;
+      if (pTable == NULL || restored[i]) continue;
 
       //tsdbInfo("tsdbRestoreInfo restore vgId:%d,table:%s", REPO_ID(pRepo), pTable->name->data);
 
       if (tsdbSetReadTable(&readh, pTable) < 0) {
-        tsdbDestroyReadH(&readh);
-        return -1;
+        goto _err;
       }
 
       TSKEY      lastKey = tsdbGetTableLastKeyImpl(pTable);
@@ -906,28 +960,32 @@ int tsdbRestoreInfo(STsdbRepo *pRepo) {
         pTable->lastKey = pIdx->maxKey;
 
         if (CACHE_LAST_ROW(pCfg) && tsdbRestoreLastRow(pRepo, pTable, &readh, pIdx) != 0) {
-          tsdbDestroyReadH(&readh);
-          return -1;
+          goto _err;
         }
       }
       
       // restore NULL columns
       if (pIdx && CACHE_LAST_NULL_COLUMN(pCfg) && !pTable->hasRestoreLastColumn) {
         if (tsdbRestoreLastColumns(pRepo, pTable, &readh) != 0) {
-          tsdbDestroyReadH(&readh);
-          return -1;
+          goto _err;
         }
       }
     }
   }
 
   tsdbDestroyReadH(&readh);
+  tfree(restored);
 
   // if (CACHE_LAST_NULL_COLUMN(pCfg)) {
   //   atomic_store_8(&pRepo->hasCachedLastColumn, 1);
   // }
 
   return 0;
+
+_err:
+  tsdbDestroyReadH(&readh);
+  tfree(restored);
+  return -1;
 }
 
 int32_t tsdbLoadLastCache(STsdbRepo *pRepo, STable *pTable) {
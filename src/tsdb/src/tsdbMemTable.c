@@ -20,6 +20,7 @@
 #include "tsdbRowMergeBuf.h"
 
 #define TSDB_DATA_SKIPLIST_LEVEL 5
+#define TSDB_DATA_SKIPLIST_ARENA_PAGE_SIZE (32 * 1024)
 #define TSDB_MAX_INSERT_BATCH 512
 
 typedef struct {
@@ -34,17 +35,34 @@ typedef struct {
   void *  pMsg;
 } SSubmitMsgIter;
 
+typedef struct {
+  SMemRows *pRows;
+  int32_t   idx;
+  int32_t   numOfRows;
+} SMemRowsIter;
+
 static SMemTable *  tsdbNewMemTable(STsdbRepo *pRepo);
 static void         tsdbFreeMemTable(SMemTable *pMemTable);
-static STableData*  tsdbNewTableData(STsdbCfg *pCfg, STable *pTable);
+static STableData*  tsdbNewTableData(STable *pTable);
 static void         tsdbFreeTableData(STableData *pTableData);
+static int          tsdbCreateTableSkipList(STsdbCfg *pCfg, STableData *pTableData, SSkipListArena *pArena);
+static int          tsdbMemRowsAppend(STsdbRepo *pRepo, SMemRows *pRows, TSKEY key, SMemRow row);
+static int32_t      tsdbMemRowsSearch(SMemRows *pRows, int32_t start, int32_t end, TSKEY key);
+static void *       tsdbGetMemRowsNext(void *iter);
 static char *       tsdbGetTsTupleKey(const void *data);
 static int          tsdbAdjustMemMaxTables(SMemTable *pMemTable, int maxTables);
 static int          tsdbAppendTableRowToCols(STable *pTable, SDataCols *pCols, STSchema **ppSchema, SMemRow row);
+static int          tsdbAppendTableRowsToCols(STable *pTable, SDataCols *pCols, STSchema **ppSchema, SMemRows *pRows,
+                                              int32_t start, int32_t numOfRows);
+static void         tsdbLoadRowsFromCache(STable *pTable, STableDataIter *pIter, TSKEY maxKey, int maxRowsToRead,
+                                          SDataCols *pCols, SMergeInfo *pMergeInfo);
 static int          tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, SSubmitBlkIter *pIter);
 static SMemRow      tsdbGetSubmitBlkNext(SSubmitBlkIter *pIter);
 static int          tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg);
 static int          tsdbInsertDataToTable(STsdbRepo *pRepo, SSubmitBlk *pBlock, int32_t *affectedrows);
+static bool         tsdbCanAppendTableRows(STableData *pTableData, SSubmitBlkIter blkIter);
+static int          tsdbAppendTableRows(STsdbRepo *pRepo, STableData *pTableData, SSubmitBlkIter *pIter,
+                                        int32_t *pPoints, SMemRow *pLastRow);
 static int          tsdbInitSubmitMsgIter(SSubmitMsg *pMsg, SSubmitMsgIter *pIter);
 static int          tsdbGetSubmitMsgNext(SSubmitMsgIter *pIter, SSubmitBlk **pPBlock);
 static int          tsdbCheckTableSchema(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable);
@@ -195,6 +213,34 @@ int tsdbTakeMemSnapshot(STsdbRepo *pRepo, SMemSnapshot *pSnapshot, SArray *pATab
   return 0;
 }
 
+// The pages and bytes allocated by the skiplist arenas of the mem and imem
+int tsdbGetMemArenaUsage(STsdbRepo *pRepo, int64_t *numOfPages, int64_t *allocBytes) {
+  SMemTable *pMems[2] = {NULL};
+
+  *numOfPages = 0;
+  *allocBytes = 0;
+
+  if (tsdbLockRepo(pRepo) < 0) return -1;
+  pMems[0] = pRepo->mem;
+  pMems[1] = pRepo->imem;
+  tsdbRefMemTable(pRepo, pMems[0]);
+  tsdbRefMemTable(pRepo, pMems[1]);
+  if (tsdbUnlockRepo(pRepo) < 0) return -1;
+
+  for (int i = 0; i < 2; i++) {
+    if (pMems[i] == NULL || pMems[i]->pArena == NULL) continue;
+
+    int64_t pages = 0, usedBytes = 0, bytes = 0;
+    tSkipListArenaGetUsage(pMems[i]->pArena, &pages, &usedBytes, &bytes);
+    *numOfPages += pages;
+    *allocBytes += bytes;
+  }
+
+  tsdbUnRefMemTable(pRepo, pMems[0]);
+  tsdbUnRefMemTable(pRepo, pMems[1]);
+  return 0;
+}
+
 void tsdbUnTakeMemSnapShot(STsdbRepo *pRepo, SMemSnapshot *pSnapshot) {
   tsdbDebug("vgId:%d untake memory snapshot, pMem %p pIMem %p", REPO_ID(pRepo), pSnapshot->omem, pSnapshot->imem);
 
@@ -355,7 +401,7 @@ int tsdbSyncCommit(STsdbRepo *repo) {
  * 
  * The function tries to procceed AS MUCH AS POSSIBLE.
  */
-int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
+int tsdbLoadDataFromCache(STable *pTable, STableDataIter *pIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
                           TKEY *filterKeys, int nFilterKeys, bool keepDup, SMergeInfo *pMergeInfo) {
   ASSERT(maxRowsToRead > 0 && nFilterKeys >= 0);
   if (pIter == NULL) return 0;
@@ -374,6 +420,12 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
   pMergeInfo->keyLast = INT64_MIN;
   if (pCols) tdResetDataCols(pCols);
 
+  // the in-order rows are neither deleted nor duplicated, so they are taken as a whole if not merged with a block
+  if (pIter->pSkipList == NULL && nFilterKeys == 0 && pIter->order == TSDB_ORDER_ASC) {
+    tsdbLoadRowsFromCache(pTable, pIter, maxKey, maxRowsToRead, pCols, pMergeInfo);
+    return 0;
+  }
+
   row = tsdbNextIterRow(pIter);
   if (row == NULL || memRowKey(row) > maxKey) {
     rowKey = INT64_MAX;
@@ -415,7 +467,7 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
         tsdbAppendTableRowToCols(pTable, pCols, &pSchema, row);
       }
 
-      tSkipListIterNext(pIter);
+      tsdbTableDataIterNext(pIter);
       row = tsdbNextIterRow(pIter);
       if (row == NULL || memRowKey(row) > maxKey) {
         rowKey = INT64_MAX;
@@ -445,7 +497,7 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
         }
       }
 
-      tSkipListIterNext(pIter);
+      tsdbTableDataIterNext(pIter);
       row = tsdbNextIterRow(pIter);
       if (row == NULL || memRowKey(row) > maxKey) {
         rowKey = INT64_MAX;
@@ -500,6 +552,12 @@ static SMemTable* tsdbNewMemTable(STsdbRepo *pRepo) {
     goto _err;
   }
 
+  pMemTable->pArena = tSkipListArenaCreate(TSDB_DATA_SKIPLIST_ARENA_PAGE_SIZE);
+  if (pMemTable->pArena == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
   T_REF_INC(pMemTable);
 
   return pMemTable;
@@ -517,12 +575,13 @@ static void tsdbFreeMemTable(SMemTable* pMemTable) {
     tdListFree(pMemTable->extraBuffList);
     tdListFree(pMemTable->bufBlockList);
     tdListFree(pMemTable->actList);
+    tSkipListArenaDestroy(pMemTable->pArena);
     tfree(pMemTable->tData);
     free(pMemTable);
   }
 }
 
-static STableData *tsdbNewTableData(STsdbCfg *pCfg, STable *pTable) {
+static STableData *tsdbNewTableData(STable *pTable) {
   STableData *pTableData = (STableData *)calloc(1, sizeof(*pTableData));
   if (pTableData == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
@@ -534,34 +593,181 @@ static STableData *tsdbNewTableData(STsdbCfg *pCfg, STable *pTable) {
   pTableData->keyLast = 0;
   pTableData->numOfRows = 0;
 
-  uint8_t skipListCreateFlags;
+  T_REF_INC(pTableData);
+
+  return pTableData;
+}
+
+static void tsdbFreeTableData(STableData *pTableData) {
+  if (pTableData) {
+    int32_t ref = T_REF_DEC(pTableData);
+    if (ref == 0) {
+      tSkipListDestroy(pTableData->pData);
+      free(pTableData);
+    }
+  }
+}
+
+// Move the in-order rows into a new skiplist, which takes all rows of the table from now on. Queries which have
+// iterated the in-order rows go on with them, as they are never changed any more.
+static int tsdbCreateTableSkipList(STsdbCfg *pCfg, STableData *pTableData, SSkipListArena *pArena) {
+  ASSERT(pTableData->pData == NULL);
+
+  // only the vnode write thread inserts into the table data, while queries read it without lock
+  uint8_t skipListCreateFlags = SL_SINGLE_WRITER;
   if(pCfg->update == TD_ROW_DISCARD_UPDATE)
-    skipListCreateFlags = SL_DISCARD_DUP_KEY;
+    skipListCreateFlags |= SL_DISCARD_DUP_KEY;
   else
-    skipListCreateFlags = SL_UPDATE_DUP_KEY;
+    skipListCreateFlags |= SL_UPDATE_DUP_KEY;
 
-  pTableData->pData =
+  SSkipList *pSkipList =
       tSkipListCreate(TSDB_DATA_SKIPLIST_LEVEL, TSDB_DATA_TYPE_TIMESTAMP, TYPE_BYTES[TSDB_DATA_TYPE_TIMESTAMP],
                       tkeyComparFn, skipListCreateFlags, tsdbGetTsTupleKey);
-  if (pTableData->pData == NULL) {
+  if (pSkipList == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+  tSkipListSetArena(pSkipList, pArena);
+
+  // the rows are in the buffer of the memtable already, so they are linked without the insert hook
+  SMemRowsIter rowsIter = {.pRows = &pTableData->rows, .idx = 0, .numOfRows = pTableData->rows.numOfRows};
+  tSkipListPutBatchByIter(pSkipList, &rowsIter, tsdbGetMemRowsNext);
+
+  atomic_store_ptr(&pTableData->pData, pSkipList);
+  return 0;
+}
+
+// The keys and the pointers are aligned, as the rows before them in the buffer are not
+static void *tsdbMemRowsAlloc(STsdbRepo *pRepo, int bytes) {
+  char *ptr = (char *)tsdbAllocBytes(pRepo, bytes + sizeof(void *) - 1);
+  if (ptr == NULL) return NULL;
+
+  return (void *)ALIGN_NUM((uintptr_t)ptr, sizeof(void *));
+}
+
+// The chunks are allocated from the buffer of the memtable, so they are counted by the commit threshold and freed
+// with the memtable.
+static int tsdbMemRowsAppend(STsdbRepo *pRepo, SMemRows *pRows, TSKEY key, SMemRow row) {
+  int32_t offset = 0;
+  int32_t chunk = tsdbMemRowsChunkOf(pRows->numOfRows, &offset);
+  ASSERT(pRows->numOfRows < TSDB_MEM_ROWS_MAX_ROWS);
+
+  if (offset == 0) {
+    if (chunk >= pRows->maxChunks) {
+      int32_t maxChunks = (pRows->maxChunks == 0) ? 16 : pRows->maxChunks * 2;
+      void ** chunks = (void **)tsdbMemRowsAlloc(pRepo, sizeof(void *) * maxChunks);
+      if (chunks == NULL) return -1;
+
+      if (pRows->maxChunks > 0) memcpy(chunks, pRows->chunks, sizeof(void *) * pRows->maxChunks);
+      atomic_store_ptr(&pRows->chunks, chunks);
+      pRows->maxChunks = maxChunks;
+    }
+
+    void *pChunk = tsdbMemRowsAlloc(pRepo, (sizeof(TSKEY) + sizeof(SMemRow)) * tsdbMemRowsChunkSize(chunk));
+    if (pChunk == NULL) return -1;
+    pRows->chunks[chunk] = pChunk;
+  }
+
+  tsdbMemRowsKeys(pRows, chunk)[offset] = key;
+  tsdbMemRowsRows(pRows, chunk)[offset] = row;
+  atomic_store_32(&pRows->numOfRows, pRows->numOfRows + 1);
+
+  return 0;
+}
+
+// Return the first row in [start, end) whose key is not less than the key, or end
+static int32_t tsdbMemRowsSearch(SMemRows *pRows, int32_t start, int32_t end, TSKEY key) {
+  while (start < end) {
+    int32_t mid = start + (end - start) / 2;
+    if (tsdbMemRowsKeyAt(pRows, mid) < key) {
+      start = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+
+  return start;
+}
+
+static void *tsdbGetMemRowsNext(void *iter) {
+  SMemRowsIter *pIter = (SMemRowsIter *)iter;
+  if (pIter->idx >= pIter->numOfRows) return NULL;
+
+  return tsdbMemRowsRowAt(pIter->pRows, pIter->idx++);
+}
+
+STableDataIter *tsdbCreateTableDataIter(STableData *pTableData, const TSKEY *pKey, int32_t order) {
+  ASSERT(order == TSDB_ORDER_ASC || order == TSDB_ORDER_DESC);
+
+  STableDataIter *pIter = (STableDataIter *)calloc(1, sizeof(*pIter));
+  if (pIter == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-    free(pTableData);
     return NULL;
   }
 
-  T_REF_INC(pTableData);
+  pIter->order = order;
+  pIter->pSkipList = (SSkipList *)atomic_load_ptr(&pTableData->pData);
+  if (pIter->pSkipList != NULL) {
+    TKEY tkey = (pKey == NULL) ? 0 : keyToTkey(*pKey);
+    tSkipListInitIterFromVal(&pIter->slIter, pIter->pSkipList, (pKey == NULL) ? NULL : (const char *)&tkey,
+                             TSDB_DATA_TYPE_TIMESTAMP, order);
+    return pIter;
+  }
 
-  return pTableData;
+  // the iterator is put before the first row to visit like the one of skiplist
+  pIter->pRows = &pTableData->rows;
+  pIter->numOfRows = atomic_load_32(&pTableData->rows.numOfRows);
+  if (order == TSDB_ORDER_ASC) {
+    pIter->cur = (pKey == NULL) ? -1 : (tsdbMemRowsSearch(pIter->pRows, 0, pIter->numOfRows, *pKey) - 1);
+  } else if (pKey == NULL || *pKey == INT64_MAX) {
+    pIter->cur = pIter->numOfRows;
+  } else {
+    pIter->cur = tsdbMemRowsSearch(pIter->pRows, 0, pIter->numOfRows, *pKey + 1);
+  }
+
+  return pIter;
 }
 
-static void tsdbFreeTableData(STableData *pTableData) {
-  if (pTableData) {
-    int32_t ref = T_REF_DEC(pTableData);
-    if (ref == 0) {
-      tSkipListDestroy(pTableData->pData);
-      free(pTableData);
+void *tsdbDestroyTableDataIter(STableDataIter *pIter) {
+  tfree(pIter);
+  return NULL;
+}
+
+/**
+ * Get the rows from the current one of an iterator of the in-order rows, which are in data row format of the same
+ * schema version, not beyond maxKey in the order of the iterator, and in one chunk. The rows and their keys are
+ * returned in ascending order whatever the order of the iterator is.
+ */
+int32_t tsdbTableDataIterGetRun(STableDataIter *pIter, TSKEY maxKey, int32_t maxRows, SMemRow **ppRows,
+                                TSKEY **ppKeys) {
+  if (pIter->pSkipList != NULL || pIter->cur < 0 || pIter->cur >= pIter->numOfRows || maxRows <= 0) return 0;
+
+  int32_t  offset = 0;
+  int32_t  chunk = tsdbMemRowsChunkOf(pIter->cur, &offset);
+  SMemRow *rows = tsdbMemRowsRows(pIter->pRows, chunk);
+  TSKEY *  keys = tsdbMemRowsKeys(pIter->pRows, chunk);
+  if (!isDataRow(rows[offset])) return 0;
+
+  uint16_t sversion = memRowDataVersion(rows[offset]);
+  int32_t  num = 0;
+  if (pIter->order == TSDB_ORDER_ASC) {
+    int32_t end = MIN(tsdbMemRowsChunkSize(chunk), pIter->numOfRows - (pIter->cur - offset));
+    for (int32_t i = offset; i < end && num < maxRows; ++i, ++num) {
+      if (keys[i] > maxKey || !isDataRow(rows[i]) || memRowDataVersion(rows[i]) != sversion) break;
+    }
+
+    *ppRows = rows + offset;
+    *ppKeys = keys + offset;
+  } else {
+    for (int32_t i = offset; i >= 0 && num < maxRows; --i, ++num) {
+      if (keys[i] < maxKey || !isDataRow(rows[i]) || memRowDataVersion(rows[i]) != sversion) break;
     }
+
+    *ppRows = rows + offset - num + 1;
+    *ppKeys = keys + offset - num + 1;
   }
+
+  return num;
 }
 
 static char *tsdbGetTsTupleKey(const void *data) { return memRowKeys((SMemRow)data); }
@@ -604,6 +810,67 @@ static int tsdbAppendTableRowToCols(STable *pTable, SDataCols *pCols, STSchema *
   return 0;
 }
 
+// The rows of one chunk in data row format of the same schema version are transposed column by column
+static int tsdbAppendTableRowsToCols(STable *pTable, SDataCols *pCols, STSchema **ppSchema, SMemRows *pRows,
+                                     int32_t start, int32_t numOfRows) {
+  int32_t end = start + numOfRows;
+
+  while (start < end) {
+    int32_t  offset = 0;
+    int32_t  chunk = tsdbMemRowsChunkOf(start, &offset);
+    int32_t  num = MIN(end - start, tsdbMemRowsChunkSize(chunk) - offset);
+    SMemRow *rows = tsdbMemRowsRows(pRows, chunk) + offset;
+
+    for (int32_t i = 0; i < num;) {
+      if (!isDataRow(rows[i])) {
+        if (tsdbAppendTableRowToCols(pTable, pCols, ppSchema, rows[i]) < 0) return -1;
+        ++i;
+        continue;
+      }
+
+      uint16_t sversion = memRowDataVersion(rows[i]);
+      int32_t  j = i + 1;
+      while (j < num && isDataRow(rows[j]) && memRowDataVersion(rows[j]) == sversion) ++j;
+
+      if (*ppSchema == NULL || schemaVersion(*ppSchema) != sversion) {
+        *ppSchema = tsdbGetTableSchemaImpl(pTable, false, false, sversion, (int8_t)memRowType(rows[i]));
+        if (*ppSchema == NULL) {
+          ASSERT(false);
+          return -1;
+        }
+      }
+
+      tdAppendDataRowsToDataCols(rows + i, j - i, *ppSchema, pCols);
+      i = j;
+    }
+
+    start += num;
+  }
+
+  return 0;
+}
+
+static void tsdbLoadRowsFromCache(STable *pTable, STableDataIter *pIter, TSKEY maxKey, int maxRowsToRead,
+                                  SDataCols *pCols, SMergeInfo *pMergeInfo) {
+  STSchema *pSchema = NULL;
+  int32_t   start = pIter->cur;
+  if (start < 0 || start >= pIter->numOfRows) return;
+
+  int32_t end = (maxKey == INT64_MAX) ? pIter->numOfRows
+                                      : tsdbMemRowsSearch(pIter->pRows, start, pIter->numOfRows, maxKey + 1);
+  int32_t rows = MIN(end - start, maxRowsToRead);
+  if (pCols) rows = MIN(rows, pCols->maxPoints);
+  if (rows <= 0) return;
+
+  pMergeInfo->rowsInserted = rows;
+  pMergeInfo->nOperations = rows;
+  pMergeInfo->keyFirst = tsdbMemRowsKeyAt(pIter->pRows, start);
+  pMergeInfo->keyLast = tsdbMemRowsKeyAt(pIter->pRows, start + rows - 1);
+  if (pCols) tsdbAppendTableRowsToCols(pTable, pCols, &pSchema, pIter->pRows, start, rows);
+
+  pIter->cur = start + rows;
+}
+
 static int tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, SSubmitBlkIter *pIter) {
   if (pBlock->dataLen <= 0) return -1;
   pIter->totalLen = pBlock->dataLen;
@@ -826,7 +1093,7 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
       taosWUnLockLatch(&(pMemTable->latch));
     }
 
-    pTableData = tsdbNewTableData(pCfg, pTable);
+    pTableData = tsdbNewTableData(pTable);
     if (pTableData == NULL) {
       tsdbError("vgId:%d failed to insert data to table %s uid %" PRId64 " tid %d since %s", REPO_ID(pRepo),
                 TABLE_CHAR_NAME(pTable), TABLE_UID(pTable), TABLE_TID(pTable), tstrerror(terrno));
@@ -839,10 +1106,29 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
   ASSERT((pTableData != NULL) && pTableData->uid == TABLE_UID(pTable));
 
   SMemRow lastRow = NULL;
-  int64_t osize = SL_SIZE(pTableData->pData);
-  tsdbSetupSkipListHookFns(pTableData->pData, pRepo, pTable, &points, &lastRow);
-  tSkipListPutBatchByIter(pTableData->pData, &blkIter, (iter_next_fn_t)tsdbGetSubmitBlkNext);
-  int64_t dsize = SL_SIZE(pTableData->pData) - osize;
+  int64_t osize = 0;
+  int64_t dsize = 0;
+  int     code = 0;
+  if (pTableData->pData == NULL && tsdbCanAppendTableRows(pTableData, blkIter)) {
+    osize = pTableData->rows.numOfRows;
+    code = tsdbAppendTableRows(pRepo, pTableData, &blkIter, &points, &lastRow);
+    dsize = pTableData->rows.numOfRows - osize;
+  } else {
+    if (pTableData->pData == NULL) {
+      tsdbTrace("vgId:%d table %s tid %d uid %" PRIu64 " moves %d in-order rows into skiplist", REPO_ID(pRepo),
+                TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), TABLE_UID(pTable), pTableData->rows.numOfRows);
+      if (tsdbCreateTableSkipList(pCfg, pTableData, pMemTable->pArena) < 0) {
+        tsdbError("vgId:%d failed to insert data to table %s uid %" PRId64 " tid %d since %s", REPO_ID(pRepo),
+                  TABLE_CHAR_NAME(pTable), TABLE_UID(pTable), TABLE_TID(pTable), tstrerror(terrno));
+        return -1;
+      }
+    }
+
+    osize = SL_SIZE(pTableData->pData);
+    tsdbSetupSkipListHookFns(pTableData->pData, pRepo, pTable, &points, &lastRow);
+    tSkipListPutBatchByIter(pTableData->pData, &blkIter, (iter_next_fn_t)tsdbGetSubmitBlkNext);
+    dsize = SL_SIZE(pTableData->pData) - osize;
+  }
   (*pAffectedRows) += points;
 
   if(lastRow != NULL) {
@@ -863,6 +1149,42 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
   pRepo->stat.pointsWritten += points * schemaNCols(pSchema);
   pRepo->stat.totalStorage += points * schemaVLen(pSchema);
 
+  return code;
+}
+
+// The rows of the block can be appended if they are in order and after the last row of the table
+static bool tsdbCanAppendTableRows(STableData *pTableData, SSubmitBlkIter blkIter) {
+  SMemRows *pRows = &pTableData->rows;
+  int32_t   numOfRows = pRows->numOfRows;
+  TSKEY     lastKey = (numOfRows > 0) ? tsdbMemRowsKeyAt(pRows, numOfRows - 1) : INT64_MIN;
+  SMemRow   row = NULL;
+
+  while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
+    TSKEY key = memRowKey(row);
+    if ((numOfRows > 0 && key <= lastKey) || numOfRows >= TSDB_MEM_ROWS_MAX_ROWS) return false;
+
+    lastKey = key;
+    ++numOfRows;
+  }
+
+  return true;
+}
+
+static int tsdbAppendTableRows(STsdbRepo *pRepo, STableData *pTableData, SSubmitBlkIter *pIter, int32_t *pPoints,
+                               SMemRow *pLastRow) {
+  SMemRow row = NULL;
+
+  while ((row = tsdbGetSubmitBlkNext(pIter)) != NULL) {
+    void *pMem = tsdbAllocBytes(pRepo, memRowTLen(row));
+    if (pMem == NULL) return -1;
+
+    memRowCpy(pMem, row);
+    if (tsdbMemRowsAppend(pRepo, &pTableData->rows, memRowKey(pMem), pMem) < 0) return -1;
+
+    (*pPoints)++;
+    *pLastRow = pMem;
+  }
+
   return 0;
 }
 
@@ -14,6 +14,7 @@
  */
 #include "tsdbint.h"
 #include "tcompare.h"
+#include "tglobal.h"
 #include "tutil.h"
 
 #define TSDB_SUPER_TABLE_SL_LEVEL 5
@@ -394,7 +395,7 @@ int tsdbUpdateTableTagValue(STsdbRepo *repo, SUpdateTableTagValMsg *pMsg) {
   }
 
   bool      isChangeIndexCol = (pMsg->colId == colColId(schemaColAt(pTable->pSuper->tagSchema, 0)))
-      || pMsg->type == TSDB_DATA_TYPE_JSON;
+      || pMsg->type == TSDB_DATA_TYPE_JSON || pTable->pSuper->pTagIndex != NULL;
   // STColumn *pCol = bsearch(&(pMsg->colId), pMsg->data, pMsg->numOfTags, sizeof(STColumn), colIdCompar);
   // ASSERT(pCol != NULL);
 
@@ -877,6 +878,9 @@ static STable *tsdbCreateTableFromCfg(STableCfg *pCfg, bool isSuper, STable *pST
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         goto _err;
       }
+      if (tsTagIndex && (pTable->pTagIndex = tsdbNewTagIndex()) == NULL) {
+        goto _err;
+      }
     }
   } else {
     pTable->type = pCfg->type;
@@ -946,6 +950,7 @@ static void tsdbFreeTable(STable *pTable) {
     kvRowFree(pTable->tagVal);
 
     tSkipListDestroy(pTable->pIndex);
+    tsdbFreeTagIndex(pTable->pTagIndex);
     taosHashCleanup(pTable->jsonKeyMap);
     taosTZfree(pTable->lastRow);    
     tfree(pTable->sql);
@@ -1155,6 +1160,9 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper
     }
   }else{
     tSkipListPut(pSTable->pIndex, (void *)pTable);
+    if (pSTable->pTagIndex != NULL) {
+      tsdbTagIndexAdd(pSTable->pTagIndex, pSTable->tagSchema, pTable->tagVal, TABLE_TID(pTable));
+    }
   }
 
   return 0;
@@ -1217,6 +1225,10 @@ static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
     }
 
     taosArrayDestroy(&res);
+
+    if (pSTable->pTagIndex != NULL) {
+      tsdbTagIndexRemove(pSTable->pTagIndex, pSTable->tagSchema, pTable->tagVal, TABLE_TID(pTable));
+    }
   }
   return 0;
 }
@@ -1472,6 +1484,10 @@ static void *tsdbDecodeTable(void *buf, STable **pRTable) {
           tsdbFreeTable(pTable);
           return NULL;
         }
+        if (tsTagIndex && (pTable->pTagIndex = tsdbNewTagIndex()) == NULL) {
+          tsdbFreeTable(pTable);
+          return NULL;
+        }
       }
     }
 
@@ -24,6 +24,7 @@
 #include "taosdef.h"
 #include "tlosertree.h"
 #include "tsdbint.h"
+#include "tglobal.h"
 #include "texpr.h"
 #include "qFilter.h"
 #include "cJSON.h"
@@ -95,8 +96,8 @@ typedef struct STableCheckInfo {
   int32_t       numOfBlocks:29; // number of qualified data blocks not the original blocks
   uint8_t        chosen:2;       // indicate which iterator should move forward
   bool          initBuf;        // whether to initialize the in-memory skip list iterator or not
-  SSkipListIterator* iter;      // mem buffer skip list iterator
-  SSkipListIterator* iiter;     // imem buffer skip list iterator
+  STableDataIter* iter;         // mem buffer iterator
+  STableDataIter* iiter;        // imem buffer iterator
 } STableCheckInfo;
 
 typedef struct STableBlockInfo {
@@ -117,6 +118,7 @@ typedef struct SIOCostSummary {
   int64_t checkForNextTime;
   int64_t headFileLoad;
   int64_t headFileLoadTime;
+  int64_t skipBlocks;
 } SIOCostSummary;
 
 typedef struct STsdbQueryHandle {
@@ -146,6 +148,7 @@ typedef struct STsdbQueryHandle {
   SFSIter        fileIter;
   SReadH         rhelper;
   STableBlockInfo* pDataBlockInfo;
+  int32_t        raSlot;           // last block in pDataBlockInfo read ahead
   SDataCols     *pDataCols;        // in order to hold current file data block
   int32_t        allocSize;        // allocated data block size
   SMemRef       *pMemRef;
@@ -156,6 +159,13 @@ typedef struct STsdbQueryHandle {
   SArray        *prev;             // previous row which is before than time window
   SArray        *next;             // next row which is after the query time window
   SIOCostSummary cost;
+
+  block_filter_func blockFilterFp;     // skip the file blocks without qualified rows by their statistics
+  void*             blockFilterParam;
+  SBlock*           pStatisBlock;      // file block whose statistics are in statis, NULL if none
+  SBlock*           pFilterBlock;      // file block checked by blockFilterFp
+  int8_t            bloomStatus;       // bloom filter of pFilterBlock: 0 not loaded, 1 loaded, -1 not exists
+  int8_t            dictStatus;        // SBlockCol part of pFilterBlock: 0 not loaded, 1 loaded, -1 failed
   
   // callback
   readover_callback readover_cb;
@@ -187,7 +197,7 @@ static int32_t doGetExternalRow(STsdbQueryHandle* pQueryHandle, int16_t type, SM
 static void*   doFreeColumnInfoData(SArray* pColumnInfoData);
 static void*   destroyTableCheckInfo(SArray* pTableCheckInfo);
 static bool    tsdbGetExternalRow(TsdbQueryHandleT pHandle);
-static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo);
+static int32_t tsdbQueryTableList(STsdbMeta* pMeta, STable* pTable, SArray* pRes, void* filterInfo);
 static STableBlockInfo* moveToNextDataBlockInCurrentFile(STsdbQueryHandle* pQueryHandle);
 
 static void tsdbInitDataBlockLoadInfo(SDataBlockLoadInfo* pBlockLoadInfo) {
@@ -351,8 +361,8 @@ static void resetCheckInfo(STsdbQueryHandle* pQueryHandle) {
   for (int32_t i = 0; i < numOfTables; ++i) {
     STableCheckInfo* pCheckInfo = (STableCheckInfo*) taosArrayGet(pQueryHandle->pTableCheckInfo, i);
     pCheckInfo->lastKey = pQueryHandle->window.skey;
-    pCheckInfo->iter    = tSkipListDestroyIter(pCheckInfo->iter);
-    pCheckInfo->iiter   = tSkipListDestroyIter(pCheckInfo->iiter);
+    pCheckInfo->iter    = tsdbDestroyTableDataIter(pCheckInfo->iter);
+    pCheckInfo->iiter   = tsdbDestroyTableDataIter(pCheckInfo->iiter);
     pCheckInfo->initBuf = false;
 
     if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
@@ -443,6 +453,8 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(STsdbRepo* tsdb, STsdbQueryCond* pC
   pQueryHandle->locateStart = false;
   pQueryHandle->pMemRef     = pMemRef;
   pQueryHandle->loadType    = pCond->type;
+  pQueryHandle->blockFilterFp    = pCond->blockFilterFp;
+  pQueryHandle->blockFilterParam = pCond->blockFilterParam;
 
   pQueryHandle->outputCapacity  = ((STsdbRepo*)tsdb)->config.maxRowsPerFileBlock;
   pQueryHandle->loadExternalRow = pCond->loadExternalRows;
@@ -452,6 +464,12 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(STsdbRepo* tsdb, STsdbQueryCond* pC
     goto _end;
   }
 
+  if (tsdbEnableReadAhead(&pQueryHandle->rhelper, tsReadAheadBlocks) != 0) {
+    goto _end;
+  }
+  tsdbEnableBlockCache(&pQueryHandle->rhelper);
+  tsdbEnableIdxCache(&pQueryHandle->rhelper);
+
   assert(pCond != NULL && pMemRef != NULL);
   setQueryTimewindow(pQueryHandle, pCond);
 
@@ -559,6 +577,9 @@ void tsdbResetQueryHandle(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond) {
   pQueryHandle->activeIndex = 0;   // current active table index
   pQueryHandle->locateStart = false;
   pQueryHandle->loadExternalRow = pCond->loadExternalRows;
+  pQueryHandle->blockFilterFp    = pCond->blockFilterFp;
+  pQueryHandle->blockFilterParam = pCond->blockFilterParam;
+  pQueryHandle->pStatisBlock     = NULL;
 
   if (ASCENDING_TRAVERSE(pCond->order)) {
     assert(pQueryHandle->window.skey <= pQueryHandle->window.ekey);
@@ -587,6 +608,9 @@ void tsdbResetQueryHandleForNewTable(TsdbQueryHandleT queryHandle, STsdbQueryCon
   pQueryHandle->activeIndex = 0;   // current active table index
   pQueryHandle->locateStart = false;
   pQueryHandle->loadExternalRow = pCond->loadExternalRows;
+  pQueryHandle->blockFilterFp    = pCond->blockFilterFp;
+  pQueryHandle->blockFilterParam = pCond->blockFilterParam;
+  pQueryHandle->pStatisBlock     = NULL;
 
   if (ASCENDING_TRAVERSE(pCond->order)) {
     assert(pQueryHandle->window.skey <= pQueryHandle->window.ekey);
@@ -749,18 +773,14 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
   if (pMemT && pCheckInfo->tableId.tid < pMemT->maxTables) {
     pMem = pMemT->tData[pCheckInfo->tableId.tid];
     if (pMem != NULL && pMem->uid == pCheckInfo->tableId.uid) { // check uid
-      TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
-      pCheckInfo->iter =
-          tSkipListCreateIterFromVal(pMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->iter = tsdbCreateTableDataIter(pMem, &pCheckInfo->lastKey, order);
     }
   }
 
   if (pIMemT && pCheckInfo->tableId.tid < pIMemT->maxTables) {
     pIMem = pIMemT->tData[pCheckInfo->tableId.tid];
     if (pIMem != NULL && pIMem->uid == pCheckInfo->tableId.uid) { // check uid
-      TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
-      pCheckInfo->iiter =
-          tSkipListCreateIterFromVal(pIMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->iiter = tsdbCreateTableDataIter(pIMem, &pCheckInfo->lastKey, order);
     }
   }
 
@@ -769,17 +789,16 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
     return false;
   }
 
-  bool memEmpty  = (pCheckInfo->iter == NULL) || (pCheckInfo->iter != NULL && !tSkipListIterNext(pCheckInfo->iter));
-  bool imemEmpty = (pCheckInfo->iiter == NULL) || (pCheckInfo->iiter != NULL && !tSkipListIterNext(pCheckInfo->iiter));
+  bool memEmpty  = (pCheckInfo->iter == NULL) || (pCheckInfo->iter != NULL && !tsdbTableDataIterNext(pCheckInfo->iter));
+  bool imemEmpty = (pCheckInfo->iiter == NULL) || (pCheckInfo->iiter != NULL && !tsdbTableDataIterNext(pCheckInfo->iiter));
   if (memEmpty && imemEmpty) { // buffer is empty
     return false;
   }
 
   if (!memEmpty) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    assert(node != NULL);
+    SMemRow row = tsdbNextIterRow(pCheckInfo->iter);
+    assert(row != NULL);
 
-    SMemRow row = (SMemRow)SL_GET_NODE_DATA(node);
     TSKEY   key = memRowKey(row);  // first timestamp in buffer
     tsdbDebug("%p uid:%" PRId64 ", tid:%d check data in mem from skey:%" PRId64 ", order:%d, ts range in buf:%" PRId64
               "-%" PRId64 ", lastKey:%" PRId64 ", numOfRows:%"PRId64", 0x%"PRIx64,
@@ -798,10 +817,9 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
   }
 
   if (!imemEmpty) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    assert(node != NULL);
+    SMemRow row = tsdbNextIterRow(pCheckInfo->iiter);
+    assert(row != NULL);
 
-    SMemRow row = (SMemRow)SL_GET_NODE_DATA(node);
     TSKEY   key = memRowKey(row);  // first timestamp in buffer
     tsdbDebug("%p uid:%" PRId64 ", tid:%d check data in imem from skey:%" PRId64 ", order:%d, ts range in buf:%" PRId64
               "-%" PRId64 ", lastKey:%" PRId64 ", numOfRows:%"PRId64", 0x%"PRIx64,
@@ -822,24 +840,18 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
 }
 
 static void destroyTableMemIterator(STableCheckInfo* pCheckInfo) {
-  tSkipListDestroyIter(pCheckInfo->iter);
-  tSkipListDestroyIter(pCheckInfo->iiter);
+  tsdbDestroyTableDataIter(pCheckInfo->iter);
+  tsdbDestroyTableDataIter(pCheckInfo->iiter);
 }
 
 static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order, int32_t update) {
   SMemRow rmem = NULL, rimem = NULL;
   if (pCheckInfo->iter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    if (node != NULL) {
-      rmem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rmem = tsdbNextIterRow(pCheckInfo->iter);
   }
 
   if (pCheckInfo->iiter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    if (node != NULL) {
-      rimem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rimem = tsdbNextIterRow(pCheckInfo->iiter);
   }
 
   if (rmem == NULL && rimem == NULL) {
@@ -862,12 +874,12 @@ static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order,
   if (r1 == r2) {
     if(update == TD_ROW_DISCARD_UPDATE){
       pCheckInfo->chosen = CHECKINFO_CHOSEN_IMEM;
-      tSkipListIterNext(pCheckInfo->iter);
+      tsdbTableDataIterNext(pCheckInfo->iter);
       return r2;
     }
     else if(update == TD_ROW_OVERWRITE_UPDATE) {
       pCheckInfo->chosen = CHECKINFO_CHOSEN_MEM;
-      tSkipListIterNext(pCheckInfo->iiter);
+      tsdbTableDataIterNext(pCheckInfo->iiter);
       return r1;
     } else {
       pCheckInfo->chosen = CHECKINFO_CHOSEN_BOTH;
@@ -897,17 +909,11 @@ static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order,
 static SMemRow getSMemRowInTableMem(STableCheckInfo* pCheckInfo, int32_t order, int32_t update, SMemRow* extraRow) {
   SMemRow rmem = NULL, rimem = NULL;
   if (pCheckInfo->iter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    if (node != NULL) {
-      rmem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rmem = tsdbNextIterRow(pCheckInfo->iter);
   }
 
   if (pCheckInfo->iiter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    if (node != NULL) {
-      rimem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rimem = tsdbNextIterRow(pCheckInfo->iiter);
   }
 
   if (rmem == NULL && rimem == NULL) {
@@ -929,11 +935,11 @@ static SMemRow getSMemRowInTableMem(STableCheckInfo* pCheckInfo, int32_t order,
 
   if (r1 == r2) {
     if (update == TD_ROW_DISCARD_UPDATE) {
-      tSkipListIterNext(pCheckInfo->iter);
+      tsdbTableDataIterNext(pCheckInfo->iter);
       pCheckInfo->chosen = CHECKINFO_CHOSEN_IMEM;
       return rimem;
     } else if(update == TD_ROW_OVERWRITE_UPDATE){
-      tSkipListIterNext(pCheckInfo->iiter);
+      tsdbTableDataIterNext(pCheckInfo->iiter);
       pCheckInfo->chosen = CHECKINFO_CHOSEN_MEM;
       return rmem;
     } else {
@@ -966,7 +972,7 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
   bool hasNext = false;
   if (pCheckInfo->chosen == CHECKINFO_CHOSEN_MEM) {
     if (pCheckInfo->iter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iter);
     }
 
     if (hasNext) {
@@ -974,11 +980,11 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
     }
 
     if (pCheckInfo->iiter != NULL) {
-      return tSkipListIterGet(pCheckInfo->iiter) != NULL;
+      return tsdbNextIterRow(pCheckInfo->iiter) != NULL;
     }
   } else if (pCheckInfo->chosen == CHECKINFO_CHOSEN_IMEM){
     if (pCheckInfo->iiter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iiter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iiter);
     }
 
     if (hasNext) {
@@ -986,14 +992,14 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
     }
 
     if (pCheckInfo->iter != NULL) {
-      return tSkipListIterGet(pCheckInfo->iter) != NULL;
+      return tsdbNextIterRow(pCheckInfo->iter) != NULL;
     }
   } else {
     if (pCheckInfo->iter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iter);
     }
     if (pCheckInfo->iiter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iiter) || hasNext;
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iiter) || hasNext;
     }
   }
 
@@ -1403,6 +1409,9 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
   int32_t code = TSDB_CODE_SUCCESS;
   *numOfBlocks = 0;
 
+  // the file blocks are reloaded, drop the statistics cached by block
+  pQueryHandle->pStatisBlock = NULL;
+
   pQueryHandle->cost.headFileLoad += 1;
   int64_t s = taosGetTimestampUs();
 
@@ -1430,9 +1439,33 @@ static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlo
   return code;
 }
 
+// Read the next blocks of the current file ahead, so they are read while the current block is loaded and decompressed
+static void readAheadDataBlocks(STsdbQueryHandle* pQueryHandle) {
+  if (pQueryHandle->rhelper.pRa == NULL) {
+    return;
+  }
+
+  int32_t step = ASCENDING_TRAVERSE(pQueryHandle->order)? 1 : -1;
+  int32_t slot = pQueryHandle->cur.slot;
+  int32_t from = slot + step;
+  int32_t dist = (pQueryHandle->raSlot - slot) * step;
+
+  // the blocks until raSlot are read ahead already
+  if (dist > 0 && dist <= tsReadAheadBlocks) {
+    from = pQueryHandle->raSlot + step;
+  }
+
+  for (int32_t i = from; (i - slot) * step <= tsReadAheadBlocks && i >= 0 && i < pQueryHandle->numOfBlocks; i += step) {
+    tsdbReadAheadBlock(&pQueryHandle->rhelper, pQueryHandle->pDataBlockInfo[i].compBlock);
+    pQueryHandle->raSlot = i;
+  }
+}
+
 static int32_t doLoadFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBlock, STableCheckInfo* pCheckInfo, int32_t slotIndex) {
   int64_t st = taosGetTimestampUs();
 
+  readAheadDataBlocks(pQueryHandle);
+
   STSchema *pSchema = tsdbGetTableSchema(pCheckInfo->pTableObj);
   int32_t   code = tdInitDataCols(pQueryHandle->pDataCols, pSchema);
   if (code != TSDB_CODE_SUCCESS) {
@@ -1598,11 +1631,120 @@ static int32_t handleDataMergeIfNeeded(STsdbQueryHandle* pQueryHandle, SBlock* p
   return code;
 }
 
+static int32_t doLoadBlockStatis(STsdbQueryHandle* pHandle, SBlock* pBlock, bool* exists) {
+  if (pHandle->pStatisBlock == pBlock) {
+    *exists = true;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  // file block with sub-blocks has no statistics data
+  *exists = false;
+  if (pBlock->numOfSubBlocks > 1) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int64_t stime = taosGetTimestampUs();
+  int     statisStatus = tsdbLoadBlockStatis(&pHandle->rhelper, pBlock);
+  if (statisStatus < TSDB_STATIS_OK) {
+    return terrno;
+  } else if (statisStatus > TSDB_STATIS_OK) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int16_t* colIds = pHandle->defaultLoadColumn->pData;
+
+  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
+  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
+  for(int32_t i = 0; i < numOfCols; ++i) {
+    pHandle->statis[i].colId = colIds[i];
+  }
+
+  tsdbGetBlockStatis(&pHandle->rhelper, pHandle->statis, (int)numOfCols, pBlock);
+
+  // always load the first primary timestamp column data
+  SDataStatis* pPrimaryColStatis = &pHandle->statis[0];
+  assert(pPrimaryColStatis->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+
+  pPrimaryColStatis->numOfNull = 0;
+  pPrimaryColStatis->min = pBlock->keyFirst;
+  pPrimaryColStatis->max = pBlock->keyLast;
+
+  //update the number of NULL data rows
+  for(int32_t i = 1; i < numOfCols; ++i) {
+    if (pHandle->statis[i].numOfNull == -1) { // set the column data are all NULL
+      pHandle->statis[i].numOfNull = pBlock->numOfRows;
+    }
+  }
+
+  int64_t elapsed = taosGetTimestampUs() - stime;
+  pHandle->cost.statisInfoLoadTime += elapsed;
+
+  pHandle->pStatisBlock = pBlock;
+  *exists = true;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * Check the file block by its statistics and bloom filters before any data of it is loaded, the block is skipped if
+ * none of its rows is qualified and no row in buffer needs to be merged with it.
+ */
+static bool skipFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBlock, STableCheckInfo* pCheckInfo) {
+  STsdbCfg* pCfg = &pQueryHandle->pTsdb->config;
+  bool      asc = ASCENDING_TRAVERSE(pQueryHandle->order);
+
+  if (pQueryHandle->blockFilterFp == NULL || pQueryHandle->type != TSDB_QUERY_TYPE_ALL ||
+      pQueryHandle->loadExternalRow || pBlock->numOfSubBlocks > 1) {
+    return false;
+  }
+
+  initTableMemIterator(pQueryHandle, pCheckInfo);
+  TSKEY key = extractFirstTraverseKey(pCheckInfo, pQueryHandle->order, pCfg->update);
+  if (key != TSKEY_INITIAL_VAL && ((asc && key <= pBlock->keyLast) || (!asc && key >= pBlock->keyFirst))) {
+    return false;
+  }
+
+  // load the data block instead if the statistics is not available
+  bool exists = false;
+  if (doLoadBlockStatis(pQueryHandle, pBlock, &exists) != TSDB_CODE_SUCCESS || !exists) {
+    return false;
+  }
+
+  pQueryHandle->pFilterBlock = pBlock;
+  pQueryHandle->bloomStatus = 0;
+  pQueryHandle->dictStatus = 0;
+  bool qualified = (*pQueryHandle->blockFilterFp)(pQueryHandle->blockFilterParam, pQueryHandle->statis,
+                                                  (int32_t)QH_GET_NUM_OF_COLS(pQueryHandle), pBlock->numOfRows,
+                                                  pQueryHandle);
+  pQueryHandle->pFilterBlock = NULL;
+  if (qualified) {
+    return false;
+  }
+
+  pCheckInfo->lastKey = asc ? (pBlock->keyLast + 1) : (pBlock->keyFirst - 1);
+  pQueryHandle->cost.skipBlocks += 1;
+
+  tsdbDebug("%p file block skipped by statistics, brange:%" PRId64 "-%" PRId64 ", rows:%d, lastKey:%" PRId64
+            ", tid:%d, 0x%" PRIx64,
+            pQueryHandle, pBlock->keyFirst, pBlock->keyLast, pBlock->numOfRows, pCheckInfo->lastKey,
+            pCheckInfo->tableId.tid, pQueryHandle->qId);
+  return true;
+}
+
 static int32_t loadFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBlock, STableCheckInfo* pCheckInfo, bool* exists) {
   SQueryFilePos* cur = &pQueryHandle->cur;
   int32_t code = TSDB_CODE_SUCCESS;
   bool asc = ASCENDING_TRAVERSE(pQueryHandle->order);
 
+  if (skipFileDataBlock(pQueryHandle, pBlock, pCheckInfo)) {
+    cur->rows = 0;
+    cur->mixBlock = false;
+    cur->blockCompleted = true;
+    cur->lastKey = pCheckInfo->lastKey;
+    pQueryHandle->realNumOfRows = 0;
+    *exists = false;
+    return code;
+  }
+
   if (asc) {
     // query ended in/started from current block
     if (pQueryHandle->window.ekey < pBlock->keyLast || pCheckInfo->lastKey > pBlock->keyFirst) {
@@ -2004,6 +2146,63 @@ static void mergeTwoRowFromMem(STsdbQueryHandle* pQueryHandle, int32_t capacity,
   }
 }
 
+// Copy the in-order rows of the same schema version in data row format column by column, the result is the same as
+// copying them one by one by mergeTwoRowFromMem with forceSetNull
+static void doCopyRowsFromMem(STsdbQueryHandle* pQueryHandle, int32_t capacity, int32_t numOfRows, SMemRow* rows,
+                              TSKEY* keys, int32_t num, STSchema* pSchema) {
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
+  int32_t j = 0;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    int32_t          bytes = pColInfo->info.bytes;
+
+    char* pData = NULL;
+    if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
+      pData = (char*)pColInfo->pData + numOfRows * bytes;
+    } else {
+      pData = (char*)pColInfo->pData + (capacity - numOfRows - num) * bytes;
+    }
+
+    while (j < schemaNCols(pSchema) && pSchema->columns[j].colId < pColInfo->info.colId) {
+      j++;
+    }
+
+    if (j >= schemaNCols(pSchema) || pSchema->columns[j].colId != pColInfo->info.colId) {
+      setNullN(pData, pColInfo->info.type, bytes, num);
+      continue;
+    }
+
+    if (pColInfo->info.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      memcpy(pData, keys, num * sizeof(TSKEY));
+    } else {
+      int32_t offset = TD_DATA_ROW_HEAD_SIZE + pSchema->columns[j].offset;
+      int8_t  type = (int8_t)pColInfo->info.type;
+      for (int32_t k = 0; k < num; ++k, pData += bytes) {
+        void* value = tdGetRowDataOfCol(memRowDataBody(rows[k]), type, offset);
+        if (IS_VAR_DATA_TYPE(type)) {
+          memcpy(pData, value, varDataTLen(value));
+        } else {
+          memcpy(pData, value, bytes);
+        }
+      }
+    }
+
+    j++;
+  }
+}
+
+// The iterator of the chosen row, if the other buffer has no more rows
+static STableDataIter* getChosenMemIterator(STableCheckInfo* pCheckInfo) {
+  if (pCheckInfo->chosen == CHECKINFO_CHOSEN_MEM && tsdbNextIterRow(pCheckInfo->iiter) == NULL) {
+    return pCheckInfo->iter;
+  } else if (pCheckInfo->chosen == CHECKINFO_CHOSEN_IMEM && tsdbNextIterRow(pCheckInfo->iter) == NULL) {
+    return pCheckInfo->iiter;
+  }
+
+  return NULL;
+}
+
 static void moveDataToFront(STsdbQueryHandle* pQueryHandle, int32_t numOfRows, int32_t numOfCols) {
   if (numOfRows == 0 || ASCENDING_TRAVERSE(pQueryHandle->order)) {
     return;
@@ -2184,7 +2383,7 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
     copyAllRemainRowsFromFileBlock(pQueryHandle, pCheckInfo, &blockInfo, endPos);
     return;
   } else if (pCheckInfo->iter != NULL || pCheckInfo->iiter != NULL) {
-    SSkipListNode* node = NULL;
+    SMemRow node = NULL;
     do {
       SMemRow row2 = NULL;
       SMemRow row1 = getSMemRowInTableMem(pCheckInfo, pQueryHandle->order, pCfg->update, &row2);
@@ -2307,9 +2506,9 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
        * copy them all to result buffer, since it may be overlapped with file data block.
        */
       if (node == NULL ||
-          ((memRowKey((SMemRow)SL_GET_NODE_DATA(node)) > pQueryHandle->window.ekey) &&
+          ((memRowKey(node) > pQueryHandle->window.ekey) &&
            ASCENDING_TRAVERSE(pQueryHandle->order)) ||
-          ((memRowKey((SMemRow)SL_GET_NODE_DATA(node)) < pQueryHandle->window.ekey) &&
+          ((memRowKey(node) < pQueryHandle->window.ekey) &&
            !ASCENDING_TRAVERSE(pQueryHandle->order))) {
         // no data in cache or data in cache is greater than the ekey of time window, load data from file block
         if (cur->win.skey == TSKEY_INITIAL_VAL) {
@@ -2682,6 +2881,7 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   assert(pQueryHandle->pFileGroup != NULL && pQueryHandle->numOfBlocks > 0);
   cur->slot = ASCENDING_TRAVERSE(pQueryHandle->order)? 0:pQueryHandle->numOfBlocks-1;
   cur->fid = pQueryHandle->pFileGroup->fid;
+  pQueryHandle->raSlot = cur->slot;
 
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
   return getDataBlockRv(pQueryHandle, pBlockInfo, exists);
@@ -2958,14 +3158,32 @@ static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int
       win->skey = key;
     }
 
-    win->ekey = key;
     if (rv != memRowVersion(row)) {
       pSchema = tsdbGetTableSchemaByVersion(pTable, memRowVersion(row), (int8_t)memRowType(row));
       rv = memRowVersion(row);
     }
-    mergeTwoRowFromMem(pQueryHandle, maxRowsToRead, numOfRows, row, NULL, numOfCols, pTable, pSchema, NULL, true);
 
-    if (++numOfRows >= maxRowsToRead) {
+    // the in-order rows are copied in runs, and the iterator is left at the last one
+    int32_t         num = 0;
+    STableDataIter* pIter = getChosenMemIterator(pCheckInfo);
+    if (pIter != NULL) {
+      SMemRow* rows = NULL;
+      TSKEY*   keys = NULL;
+      num = tsdbTableDataIterGetRun(pIter, maxKey, maxRowsToRead - numOfRows, &rows, &keys);
+      if (num > 1) {
+        doCopyRowsFromMem(pQueryHandle, maxRowsToRead, numOfRows, rows, keys, num, pSchema);
+        tsdbTableDataIterSkip(pIter, num - 1);
+        win->ekey = ASCENDING_TRAVERSE(pQueryHandle->order) ? keys[num - 1] : keys[0];
+      }
+    }
+
+    if (num <= 1) {
+      win->ekey = key;
+      mergeTwoRowFromMem(pQueryHandle, maxRowsToRead, numOfRows, row, NULL, numOfCols, pTable, pSchema, NULL, true);
+      num = 1;
+    }
+
+    if ((numOfRows += num) >= maxRowsToRead) {
       moveToNextRowInMem(pCheckInfo);
       break;
     }
@@ -3701,51 +3919,50 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
   STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[c->slot];
   assert((c->slot >= 0 && c->slot < pHandle->numOfBlocks) || ((c->slot == pHandle->numOfBlocks) && (c->slot == 0)));
 
-  // file block with sub-blocks has no statistics data
-  if (pBlockInfo->compBlock->numOfSubBlocks > 1) {
-    *pBlockStatis = NULL;
-    return TSDB_CODE_SUCCESS;
+  bool    exists = false;
+  int32_t code = doLoadBlockStatis(pHandle, pBlockInfo->compBlock, &exists);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
   }
 
-  int64_t stime = taosGetTimestampUs();
-  int     statisStatus = tsdbLoadBlockStatis(&pHandle->rhelper, pBlockInfo->compBlock);
-  if (statisStatus < TSDB_STATIS_OK) {
-    return terrno;
-  } else if (statisStatus > TSDB_STATIS_OK) {
-    *pBlockStatis = NULL;
-    return TSDB_CODE_SUCCESS;
+  *pBlockStatis = exists ? pHandle->statis : NULL;
+  return TSDB_CODE_SUCCESS;
+}
+
+bool tsdbCheckBlockBloomFilter(TsdbQueryHandleT pQueryHandle, int16_t colId, int8_t type, const void *pVal) {
+  STsdbQueryHandle* pHandle = (STsdbQueryHandle*) pQueryHandle;
+
+  if (pHandle->pFilterBlock == NULL) {
+    return true;
   }
 
-  int16_t* colIds = pHandle->defaultLoadColumn->pData;
+  if (pHandle->bloomStatus == 0) {
+    pHandle->bloomStatus = (tsdbLoadBlockBloom(&pHandle->rhelper, pHandle->pFilterBlock) == 0) ? 1 : -1;
+  }
 
-  size_t numOfCols = QH_GET_NUM_OF_COLS(pHandle);
-  memset(pHandle->statis, 0, numOfCols * sizeof(SDataStatis));
-  for(int32_t i = 0; i < numOfCols; ++i) {
-    pHandle->statis[i].colId = colIds[i];
+  if (pHandle->bloomStatus < 0) {
+    return true;
   }
 
-  tsdbGetBlockStatis(&pHandle->rhelper, pHandle->statis, (int)numOfCols, pBlockInfo->compBlock);
+  return tsdbBlockBloomMayContain(&pHandle->rhelper, colId, type, pVal);
+}
 
-  // always load the first primary timestamp column data
-  SDataStatis* pPrimaryColStatis = &pHandle->statis[0];
-  assert(pPrimaryColStatis->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
+int32_t tsdbGetBlockColDict(TsdbQueryHandleT pQueryHandle, int16_t colId, const char **ppDict) {
+  STsdbQueryHandle* pHandle = (STsdbQueryHandle*) pQueryHandle;
 
-  pPrimaryColStatis->numOfNull = 0;
-  pPrimaryColStatis->min = pBlockInfo->compBlock->keyFirst;
-  pPrimaryColStatis->max = pBlockInfo->compBlock->keyLast;
+  if (pHandle->pFilterBlock == NULL) {
+    return -1;
+  }
 
-  //update the number of NULL data rows
-  for(int32_t i = 1; i < numOfCols; ++i) {
-    if (pHandle->statis[i].numOfNull == -1) { // set the column data are all NULL
-      pHandle->statis[i].numOfNull = pBlockInfo->compBlock->numOfRows;
-    }
+  if (pHandle->dictStatus == 0) {
+    pHandle->dictStatus = (tsdbLoadBlockOffset(&pHandle->rhelper, pHandle->pFilterBlock) == 0) ? 1 : -1;
   }
 
-  int64_t elapsed = taosGetTimestampUs() - stime;
-  pHandle->cost.statisInfoLoadTime += elapsed;
+  if (pHandle->dictStatus < 0) {
+    return -1;
+  }
 
-  *pBlockStatis = pHandle->statis;
-  return TSDB_CODE_SUCCESS;
+  return tsdbLoadBlockColDict(&pHandle->rhelper, pHandle->pFilterBlock, colId, ppDict);
 }
 
 SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
@@ -4058,7 +4275,7 @@ int32_t tsdbQuerySTableByTagCond(STsdbRepo* tsdb, uint64_t uid, TSKEY skey, cons
     goto _error;
   }
 
-  ret = tsdbQueryTableList(pTable, res, filterInfo);
+  ret = tsdbQueryTableList(tsdbGetMeta(tsdb), pTable, res, filterInfo);
   if (ret != TSDB_CODE_SUCCESS) {
     terrno = ret;
     tsdbUnlockRepoMeta(tsdb);
@@ -4235,6 +4452,9 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
     pQueryHandle->pTableCheckInfo = destroyTableCheckInfo(pQueryHandle->pTableCheckInfo);
   }
 
+  SReadAheadStat raStat;
+  tsdbGetReadAheadStat(&pQueryHandle->rhelper, &raStat);
+
   tsdbDestroyReadH(&pQueryHandle->rhelper);
 
   tdFreeDataCols(pQueryHandle->pDataCols);
@@ -4245,8 +4465,16 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
 
   SIOCostSummary* pCost = &pQueryHandle->cost;
 
-  tsdbDebug("%p :io-cost summary: head-file read cnt:%"PRIu64", head-file time:%"PRIu64" us, statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, 0x%"PRIx64,
-      pQueryHandle, pCost->headFileLoad, pCost->headFileLoadTime, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime, pQueryHandle->qId);
+  tsdbDebug("%p :io-cost summary: head-file read cnt:%"PRIu64", head-file time:%"PRIu64" us, statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, skip blocks:%"PRId64", 0x%"PRIx64,
+      pQueryHandle, pCost->headFileLoad, pCost->headFileLoadTime, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime, pCost->skipBlocks, pQueryHandle->qId);
+
+  if (raStat.nBlocks > 0) {
+    int64_t nReads = raStat.nHit + raStat.nMiss;
+    tsdbDebug("%p :read-ahead summary: blocks:%" PRId64 ", bytes:%" PRId64 ", hit:%" PRId64 ", miss:%" PRId64
+              ", hit rate:%.2f%%, wait:%" PRId64 " us, 0x%" PRIx64,
+              pQueryHandle, raStat.nBlocks, raStat.nBytes, raStat.nHit, raStat.nMiss,
+              (nReads > 0) ? raStat.nHit * 100.0 / nReads : 0.0, raStat.waitUs, pQueryHandle->qId);
+  }
 
   tfree(pQueryHandle);
 }
@@ -4278,8 +4506,8 @@ void tsdbDestroyTableGroup(STableGroupInfo *pGroupList) {
 }
 
 
-static FORCE_INLINE int32_t tsdbGetTagDataFromId(void *param, int32_t id, void **data) {
-  STable* pTable = (STable*)(SL_GET_NODE_DATA((SSkipListNode *)param));
+static FORCE_INLINE int32_t tsdbGetTagDataFromTable(void *param, int32_t id, void **data) {
+  STable* pTable = (STable*)param;
 
   if (id == TSDB_TBNAME_COLUMN_INDEX) {
     *data = TABLE_NAME(pTable);
@@ -4290,6 +4518,10 @@ static FORCE_INLINE int32_t tsdbGetTagDataFromId(void *param, int32_t id, void *
   return TSDB_CODE_SUCCESS;
 }
 
+static FORCE_INLINE int32_t tsdbGetTagDataFromId(void *param, int32_t id, void **data) {
+  return tsdbGetTagDataFromTable(SL_GET_NODE_DATA((SSkipListNode *)param), id, data);
+}
+
 
 
 static void queryIndexedColumn(SSkipList* pSkipList, void* filterInfo, SArray* res) {
@@ -4370,6 +4602,52 @@ static void queryIndexlessColumn(SSkipList* pSkipList, void* filterInfo, SArray*
   tSkipListDestroyIter(iter);
 }
 
+static bool tsdbGetTagIndex(void *param, int16_t colId, int8_t type, const void *val, int32_t len,
+                            const SBitmap **ppBitmap) {
+  STable*   pSTable = (STable*)param;
+  STColumn* pCol = tdGetColOfID(pSTable->tagSchema, colId);
+  if (pCol == NULL || colType(pCol) != type) {
+    return false;
+  }
+
+  return tsdbTagIndexGet(pSTable->pTagIndex, colId, type, val, len, ppBitmap);
+}
+
+// Only check the child tables found by the inverted tag indexes, return false if the filter can not use them
+static bool queryByTagIndex(STsdbMeta* pMeta, STable* pSTable, void* filterInfo, SArray* res) {
+  SBitmap* pCands = NULL;
+  if (filterIndexExecute(filterInfo, pSTable, tsdbGetTagIndex, &pCands) != TSDB_CODE_SUCCESS || pCands == NULL) {
+    return false;
+  }
+
+  int8_t*     addToResult = NULL;
+  SBitmapIter iter;
+  uint32_t    tid = 0;
+
+  tBitmapIterInit(&iter, pCands);
+  while (tBitmapIterNext(&iter, &tid)) {
+    STable* pTable = (tid < (uint32_t)pMeta->maxTables) ? pMeta->tables[tid] : NULL;
+    if (pTable == NULL || pTable->pSuper != pSTable) {
+      continue;
+    }
+
+    filterSetColFieldData(filterInfo, pTable, tsdbGetTagDataFromTable);
+    bool all = filterExecute(filterInfo, 1, &addToResult, NULL, 0);
+
+    if (all || (addToResult && *addToResult)) {
+      STableKeyInfo info = {.pTable = (void*)pTable, .lastKey = TSKEY_INITIAL_VAL};
+      taosArrayPush(res, &info);
+    }
+  }
+
+  tsdbDebug("filter by tag index, candidates:%" PRId64 ", qualified:%" PRIzu ", tables:%d", tBitmapCardinality(pCands),
+            taosArrayGetSize(res), (int32_t)SL_SIZE(pSTable->pIndex));
+
+  tfree(addToResult);
+  tBitmapDestroy(pCands);
+  return true;
+}
+
 static FORCE_INLINE int32_t tsdbGetJsonTagDataFromId(void *param, int32_t id, char* name, void **data) {
   JsonMapValue* jsonMapV = (JsonMapValue*)(param);
   STable* pTable = (STable*)(jsonMapV->table);
@@ -4457,12 +4735,12 @@ static int32_t queryByJsonTag(STable* pTable, void* filterInfo, SArray* res){
   return TSDB_CODE_SUCCESS;
 }
 
-static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo) {
+static int32_t tsdbQueryTableList(STsdbMeta* pMeta, STable* pTable, SArray* pRes, void* filterInfo) {
   STSchema*   pTSSchema = pTable->tagSchema;
 
   if(pTSSchema->columns->type == TSDB_DATA_TYPE_JSON){
     return queryByJsonTag(pTable, filterInfo, pRes);
-  }else{
+  }else if (pTable->pTagIndex == NULL || !queryByTagIndex(pMeta, pTable, filterInfo, pRes)) {
     bool indexQuery = false;
     SSkipList *pSkipList = pTable->pIndex;
 
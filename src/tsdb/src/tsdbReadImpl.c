@@ -14,19 +14,55 @@
  */
 
 #include "tsdbint.h"
+#include "tglobal.h"
+#include "tsched.h"
 
 #define TSDB_KEY_COL_OFFSET 0
+#define TSDB_READ_AHEAD_QUEUE_SIZE 4096
+
+typedef enum { TSDB_RA_FREE = 0, TSDB_RA_PENDING, TSDB_RA_READY, TSDB_RA_FAILED } ERaState;
+
+typedef struct {
+  SDFile *pDFile;  // the file read from, to match the loads of the SReadH
+  FileFd  fd;
+  int64_t offset;
+  int32_t len;
+  int8_t  state;
+  void *  pBuf;
+} SReadAheadSlot;
+
+/*
+ * Blocks read ahead by the read-ahead pool for a SReadH. The slots are reused round robin, and all of them are dropped
+ * when the FSET of the SReadH is closed. A load of the SReadH is served from a slot covering its range, waiting for the
+ * slot if the read is still in flight, or read from the file if no slot covers it.
+ */
+struct SReadAhead {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  int             nSlots;
+  int             next;  // next slot to read ahead to
+  int32_t         nPending;
+  SReadAheadStat  stat;
+  SReadAheadSlot  slots[];
+};
+
+static void *tsReadAheadSched = NULL;
 
 static void tsdbResetReadTable(SReadH *pReadh);
 static void tsdbResetReadFile(SReadH *pReadh);
 static int  tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDataCols);
-static int  tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int32_t len, int8_t comp, int numOfRows,
-                                         int maxPoints, char *buffer, int bufferSize);
+static int  tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int32_t len, int8_t comp, uint8_t codec,
+                                         int numOfRows, int maxPoints, char *buffer, int bufferSize);
 static int  tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDataCols, int16_t *colIds,
                                       int numOfColIds);
 static int  tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBlockCol *pBlockCol, SDataCol *pDataCol);
 static int  tsdbLoadBlockStatisFromDFile(SReadH *pReadh, SBlock *pBlock);
 static int  tsdbLoadBlockStatisFromAggr(SReadH *pReadh, SBlock *pBlock);
+static void tsdbResetReadAhead(SReadAhead *pRa);
+static void tsdbFreeReadAhead(SReadAhead *pRa);
+static int64_t tsdbReadDFileAt(SReadH *pReadh, SDFile *pDFile, int64_t offset, void *buf, int64_t nbyte);
+static int  tsdbReadBlockInfo(SReadH *pReadh, uint32_t *dstBlkInfoLen);
+static void tsdbReleaseCachedIdx(SReadH *pReadh);
 
 int tsdbInitReadH(SReadH *pReadh, STsdbRepo *pRepo) {
   ASSERT(pReadh != NULL && pRepo != NULL);
@@ -69,12 +105,18 @@ void tsdbDestroyReadH(SReadH *pReadh) {
   pReadh->pDCols[0] = tdFreeDataCols(pReadh->pDCols[0]);
   pReadh->pDCols[1] = tdFreeDataCols(pReadh->pDCols[1]);
   pReadh->pAggrBlkData = taosTZfree(pReadh->pAggrBlkData);
+  pReadh->pBloom = taosTZfree(pReadh->pBloom);
+  pReadh->pDictBuf = taosTZfree(pReadh->pDictBuf);
+  pReadh->dictLen = 0;
   pReadh->pBlkData = taosTZfree(pReadh->pBlkData);
   pReadh->pBlkInfo = taosTZfree(pReadh->pBlkInfo);
   pReadh->cidx = 0;
   pReadh->pBlkIdx = NULL;
   pReadh->pTable = NULL;
   pReadh->aBlkIdx = taosArrayDestroy(&pReadh->aBlkIdx);
+  tsdbReleaseCachedIdx(pReadh);
+  tsdbFreeReadAhead(pReadh->pRa);
+  pReadh->pRa = NULL;
   tsdbCloseDFileSet(TSDB_READ_FSET(pReadh));
   pReadh->pRepo = NULL;
 }
@@ -91,6 +133,14 @@ int tsdbSetAndOpenReadFSet(SReadH *pReadh, SDFileSet *pSet) {
     return -1;
   }
 
+  if (pReadh->pCache != NULL) {
+    pReadh->cacheGen = tsdbBlockCacheGetGen(pReadh->pCache, TSDB_FSET_FID(pSet));
+  }
+
+  if (pReadh->pIdxCache != NULL) {
+    pReadh->idxGen = tsdbIdxCacheGetGen(pReadh->pIdxCache, TSDB_FSET_FID(pSet));
+  }
+
   return 0;
 }
 
@@ -100,11 +150,17 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
   SDFile *  pHeadf = TSDB_READ_HEAD_FILE(pReadh);
   SBlockIdx blkIdx;
 
-  ASSERT(taosArrayGetSize(pReadh->aBlkIdx) == 0);
+  ASSERT(taosArrayGetSize(pReadh->aBlkIdx) == 0 && pReadh->pIdxHandle == NULL);
 
   // No data at all, just return
   if (pHeadf->info.offset <= 0) return 0;
 
+  if (pReadh->pIdxCache != NULL) {
+    pReadh->pIdxHandle = tsdbIdxCacheGetBlockIdx(pReadh->pIdxCache, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)),
+                                                 pReadh->idxGen, &(pReadh->pCachedIdx), &(pReadh->numOfCachedIdx));
+    if (pReadh->pIdxHandle != NULL) return 0;
+  }
+
   if (tsdbSeekDFile(pHeadf, pHeadf->info.offset, SEEK_SET) < 0) {
     tsdbError("vgId:%d failed to load SBlockIdx part while seek file %s since %s, offset:%u len :%u",
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pHeadf->info.offset,
@@ -152,6 +208,11 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
                              ((SBlockIdx *)taosArrayGet(pReadh->aBlkIdx, tsize - 1))->tid);
   }
 
+  if (pReadh->pIdxCache != NULL) {
+    tsdbIdxCachePutBlockIdx(pReadh->pIdxCache, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)), pReadh->idxGen,
+                            pReadh->aBlkIdx);
+  }
+
   return 0;
 }
 
@@ -170,12 +231,22 @@ int tsdbSetReadTable(SReadH *pReadh, STable *pTable) {
     return -1;
   }
 
-  size_t size = taosArrayGetSize(pReadh->aBlkIdx);
+  // The SBlockIdx array is either shared with other queries by the index cache or loaded by this handle
+  SBlockIdx *aBlkIdx = NULL;
+  size_t     size = 0;
+  if (pReadh->pIdxHandle != NULL) {
+    aBlkIdx = pReadh->pCachedIdx;
+    size = pReadh->numOfCachedIdx;
+  } else {
+    aBlkIdx = TARRAY_GET_START(pReadh->aBlkIdx);
+    size = taosArrayGetSize(pReadh->aBlkIdx);
+  }
+
   if (size > 0) {
     int64_t left = 0, right = size - 1;
     while (left <= right) {
       int64_t mid = (left + right) / 2;
-      SBlockIdx *pBlkIdx = taosArrayGet(pReadh->aBlkIdx, (size_t)mid);
+      SBlockIdx *pBlkIdx = aBlkIdx + mid;
       if (pBlkIdx->tid == TABLE_TID(pTable)) {
         if (pBlkIdx->uid == TABLE_UID(pTable)) {
           pReadh->pBlkIdx = pBlkIdx;
@@ -312,6 +383,39 @@ static int tsdbSBlkInfoRefactor(SDFile *pHeadf, SBlockInfo **pDstBlkInfo, SBlock
 int tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
   ASSERT(pReadh->pBlkIdx != NULL);
 
+  SBlockIdx *pBlkIdx = pReadh->pBlkIdx;
+  int        fid = TSDB_FSET_FID(TSDB_READ_FSET(pReadh));
+  uint32_t   dstBlkInfoLen = 0;
+
+  if (pReadh->pIdxCache == NULL || tsdbIdxCacheGetBlockInfo(pReadh->pIdxCache, fid, pReadh->idxGen, pBlkIdx->uid,
+                                                            &(pReadh->pBlkInfo), &dstBlkInfoLen) < 0) {
+    if (tsdbReadBlockInfo(pReadh, &dstBlkInfoLen) < 0) return -1;
+
+    if (pReadh->pIdxCache != NULL) {
+      tsdbIdxCachePutBlockInfo(pReadh->pIdxCache, fid, pReadh->idxGen, pBlkIdx->uid, pReadh->pBlkInfo, dstBlkInfoLen);
+    }
+  }
+
+  if (extendedLen != NULL) {
+    if (pTarget != NULL) {
+      if (*extendedLen < dstBlkInfoLen) {
+        char *t = realloc(*pTarget, dstBlkInfoLen);
+        if (t == NULL) {
+          terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+          return -1;
+        }
+        *pTarget = t;
+      }
+      memcpy(*pTarget, (void *)(pReadh->pBlkInfo), dstBlkInfoLen);
+    }
+    *extendedLen = dstBlkInfoLen;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// Read the SBlockInfo of the table from the HEAD file to pReadh->pBlkInfo, in the latest SBlock version
+static int tsdbReadBlockInfo(SReadH *pReadh, uint32_t *dstBlkInfoLen) {
   SDFile *    pHeadf = TSDB_READ_HEAD_FILE(pReadh);
   SBlockIdx * pBlkIdx = pReadh->pBlkIdx;
 
@@ -346,27 +450,11 @@ int tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
 
   ASSERT(pBlkIdx->tid == pReadh->pBlkInfo->tid && pBlkIdx->uid == pReadh->pBlkInfo->uid);
 
-  uint32_t dstBlkInfoLen = 0;
-  if (tsdbSBlkInfoRefactor(pHeadf, &(pReadh->pBlkInfo), pBlkIdx, &dstBlkInfoLen) < 0) {
+  if (tsdbSBlkInfoRefactor(pHeadf, &(pReadh->pBlkInfo), pBlkIdx, dstBlkInfoLen) < 0) {
     return -1;
   }
 
-  if (extendedLen != NULL) {
-    if (pTarget != NULL) {
-      if (*extendedLen < dstBlkInfoLen) {
-        char *t = realloc(*pTarget, dstBlkInfoLen);
-        if (t == NULL) {
-          terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
-          return -1;
-        }
-        *pTarget = t;
-      }
-      memcpy(*pTarget, (void *)(pReadh->pBlkInfo), dstBlkInfoLen);
-    }
-    *extendedLen = dstBlkInfoLen;
-  }
-
-  return TSDB_CODE_SUCCESS;
+  return 0;
 }
 
 int tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo) {
@@ -425,16 +513,11 @@ int tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo,
 
 static int tsdbLoadBlockStatisFromDFile(SReadH *pReadh, SBlock *pBlock) {
   SDFile *pDFile = (pBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
-  if (tsdbSeekDFile(pDFile, pBlock->offset, SEEK_SET) < 0) {
-    tsdbError("vgId:%d failed to load block statis part while seek file %s to offset %" PRId64 " since %s",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), (int64_t)pBlock->offset, tstrerror(terrno));
-    return -1;
-  }
 
   size_t size = tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer);
   if (tsdbMakeRoom((void **)(&(pReadh->pBlkData)), size) < 0) return -1;
 
-  int64_t nread = tsdbReadDFile(pDFile, (void *)(pReadh->pBlkData), size);
+  int64_t nread = tsdbReadDFileAt(pReadh, pDFile, pBlock->offset, (void *)(pReadh->pBlkData), size);
   if (nread < 0) {
     tsdbError("vgId:%d failed to load block statis part while read file %s since %s, offset:%" PRId64 " len :%" PRIzu,
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), (int64_t)pBlock->offset, size);
@@ -515,6 +598,150 @@ int tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock) {
   return tsdbLoadBlockStatisFromDFile(pReadh, pBlock);
 }
 
+// Load the bloom filters of the block to pReadh->pBloom, return TSDB_STATIS_NONE if the block has none
+int tsdbLoadBlockBloom(SReadH *pReadh, SBlock *pBlock) {
+  ASSERT(pBlock->numOfSubBlocks <= 1);
+
+  if (pBlock->blkVer == TSDB_SBLK_VER_0 || !pBlock->aggrStat || !pBlock->hasBloom) {
+    return TSDB_STATIS_NONE;
+  }
+
+  SDFile *pDFileAggr = pBlock->last ? TSDB_READ_SMAL_FILE(pReadh) : TSDB_READ_SMAD_FILE(pReadh);
+  int64_t offset = pBlock->aggrOffset + tsdbBlockAggrSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer);
+
+  SBlockBloomHead head;
+  int64_t         nread = tsdbReadDFileAt(pReadh, pDFileAggr, offset, &head, sizeof(head));
+  if (nread < 0) {
+    tsdbError("vgId:%d failed to load block bloom part while read file %s since %s, offset:%" PRId64,
+              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), tstrerror(terrno), offset);
+    return -1;
+  }
+
+  if (nread < sizeof(head) || head.len <= 0 || head.numOfCols <= 0 || head.numOfCols > pBlock->numOfCols) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    tsdbError("vgId:%d block bloom part in file %s is corrupted, offset:%" PRId64, TSDB_READ_REPO_ID(pReadh),
+              TSDB_FILE_FULL_NAME(pDFileAggr), offset);
+    return -1;
+  }
+
+  size_t size = tsdbBlockBloomSize(head.numOfCols, head.len);
+  if (tsdbMakeRoom((void **)(&(pReadh->pBloom)), size) < 0) return -1;
+
+  nread = tsdbReadDFileAt(pReadh, pDFileAggr, offset, pReadh->pBloom, size);
+  if (nread < 0) {
+    tsdbError("vgId:%d failed to load block bloom part while read file %s since %s, offset:%" PRId64 " len :%" PRIzu,
+              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), tstrerror(terrno), offset, size);
+    return -1;
+  }
+
+  if (nread < size || !taosCheckChecksumWhole((uint8_t *)(pReadh->pBloom), (uint32_t)size)) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    tsdbError("vgId:%d block bloom part in file %s is corrupted, offset:%" PRId64 " len :%" PRIzu,
+              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), offset, size);
+    return -1;
+  }
+
+  return 0;
+}
+
+// Check the bloom filters loaded by tsdbLoadBlockBloom, return false only if the value is definitely not in the block
+bool tsdbBlockBloomMayContain(SReadH *pReadh, int16_t colId, int8_t type, const void *pVal) {
+  if (!TSDB_BLOOM_HAS_FILTER(type)) return true;
+
+  SBlockBloomHead *pHead = (SBlockBloomHead *)pReadh->pBloom;
+  SBlockBloomCol * pCols = (SBlockBloomCol *)POINTER_SHIFT(pHead, sizeof(SBlockBloomHead));
+  uint8_t *        pFilters = (uint8_t *)POINTER_SHIFT(pCols, sizeof(SBlockBloomCol) * pHead->numOfCols);
+
+  for (int i = 0; i < pHead->numOfCols; i++) {
+    if (pCols[i].colId == colId) {
+      return tsdbBlockBloomTest(pFilters + (int64_t)pHead->len * i, pHead->len, tsdbBlockBloomHash(type, pVal));
+    }
+  }
+
+  return true;
+}
+
+// Integers are hashed as int64 so that the value of a filter matches no matter how it is converted
+uint32_t tsdbBlockBloomHash(int8_t type, const void *pVal) {
+  if (type == TSDB_DATA_TYPE_BINARY) {
+    return MurmurHash3_32(varDataVal(pVal), varDataLen(pVal));
+  }
+
+  int64_t v = 0;
+  GET_TYPED_DATA(v, int64_t, type, pVal);
+  return MurmurHash3_32((const char *)&v, sizeof(v));
+}
+
+// Double hashing, h_i = h1 + i * h2, by deriving h2 from h1 by rotation
+void tsdbBlockBloomAdd(uint8_t *pFilter, int32_t len, uint32_t hash) {
+  uint32_t nbits = (uint32_t)len * 8;
+  uint32_t delta = (hash >> 17) | (hash << 15);
+  for (int i = 0; i < TSDB_BLOOM_NUM_OF_HASHES; i++) {
+    uint32_t pos = hash % nbits;
+    pFilter[pos / 8] |= (uint8_t)(1 << (pos % 8));
+    hash += delta;
+  }
+}
+
+bool tsdbBlockBloomTest(const uint8_t *pFilter, int32_t len, uint32_t hash) {
+  uint32_t nbits = (uint32_t)len * 8;
+  uint32_t delta = (hash >> 17) | (hash << 15);
+  for (int i = 0; i < TSDB_BLOOM_NUM_OF_HASHES; i++) {
+    uint32_t pos = hash % nbits;
+    if ((pFilter[pos / 8] & (1 << (pos % 8))) == 0) return false;
+    hash += delta;
+  }
+  return true;
+}
+
+// Read a column of the block to pReadh->pDictBuf and return the number of distinct values in its dictionary with the
+// first one in *ppDict, or -1 if the column is not dictionary encoded. The SBlockCol part must be loaded by
+// tsdbLoadBlockOffset. The chunk is kept for tsdbLoadColData, so it is not read again if the block is loaded.
+int tsdbLoadBlockColDict(SReadH *pReadh, SBlock *pBlock, int16_t colId, const char **ppDict) {
+  ASSERT(pBlock->numOfSubBlocks <= 1);
+
+  SDFile *   pDFile = (pBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
+  SBlockCol  blockCol = {0};
+  SBlockCol *pBlockCol = NULL;
+
+  for (int i = 0; i < pBlock->numOfCols; i++) {
+    SBlockCol *pCol = &blockCol;
+    tsdbGetSBlockCol(pBlock, &pCol, pReadh->pBlkData->cols, i);
+    if (pCol->colId >= colId) {
+      if (pCol->colId == colId) pBlockCol = pCol;
+      break;
+    }
+  }
+
+  if (pBlockCol == NULL || (pBlockCol->type != TSDB_DATA_TYPE_BINARY && pBlockCol->type != TSDB_DATA_TYPE_NCHAR)) {
+    return -1;
+  }
+
+  // Dictionaries are encoded by the string compression of the block algorithm, fast or LZ4 codec, not by zlib
+  uint8_t codec = pBlockCol->codec;
+  if (!(codec == TSDB_COL_CODEC_FAST || codec == TSDB_COL_CODEC_LZ4 ||
+        (codec == TSDB_COL_CODEC_DEFAULT && pBlock->algorithm != NO_COMPRESSION))) {
+    return -1;
+  }
+
+  int64_t offset = pBlock->offset + tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer) +
+                   tsdbGetBlockColOffset(pBlockCol);
+  pReadh->dictLen = 0;
+  if (tsdbMakeRoom((void **)(&pReadh->pDictBuf), pBlockCol->len) < 0) return -1;
+
+  int64_t nread = tsdbReadDFileAt(pReadh, pDFile, offset, pReadh->pDictBuf, pBlockCol->len);
+  if (nread < pBlockCol->len || !taosCheckChecksumWhole((uint8_t *)pReadh->pDictBuf, pBlockCol->len)) {
+    tsdbWarn("vgId:%d failed to load block column dictionary in file %s, offset:%" PRId64 " len:%d",
+             TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, pBlockCol->len);
+    return -1;
+  }
+
+  pReadh->pDictFile = pDFile;
+  pReadh->dictOffset = offset;
+  pReadh->dictLen = pBlockCol->len;
+  return tsGetStringDict((char *)pReadh->pDictBuf, pBlockCol->len - (int)sizeof(TSCKSUM), ppDict);
+}
+
 int tsdbEncodeSBlockIdx(void **buf, SBlockIdx *pIdx) {
   int tlen = 0;
 
@@ -605,6 +832,185 @@ void tsdbGetBlockStatis(SReadH *pReadh, SDataStatis *pStatis, int numOfCols, SBl
   }
 }
 
+int tsdbInitReadAheadPool() {
+  if (tsReadAheadBlocks <= 0) return 0;
+
+  tsReadAheadSched = taosInitScheduler(TSDB_READ_AHEAD_QUEUE_SIZE, tsNumOfReadAheadThreads, "tsdbReadAhead");
+  if (tsReadAheadSched == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+void tsdbDestroyReadAheadPool() {
+  if (tsReadAheadSched != NULL) {
+    taosCleanUpScheduler(tsReadAheadSched);
+    tsReadAheadSched = NULL;
+  }
+}
+
+void tsdbEnableBlockCache(SReadH *pReadh) { pReadh->pCache = TSDB_READ_REPO(pReadh)->pBlockCache; }
+
+void tsdbEnableIdxCache(SReadH *pReadh) { pReadh->pIdxCache = TSDB_READ_REPO(pReadh)->pIdxCache; }
+
+int tsdbEnableReadAhead(SReadH *pReadh, int nBlocks) {
+  if (tsReadAheadSched == NULL || nBlocks <= 0 || pReadh->pRa != NULL) return 0;
+
+  // One more slot than the blocks to read ahead, to keep the block being loaded
+  int         nSlots = nBlocks + 1;
+  SReadAhead *pRa = (SReadAhead *)calloc(1, sizeof(SReadAhead) + sizeof(SReadAheadSlot) * nSlots);
+  if (pRa == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pthread_mutex_init(&(pRa->mutex), NULL);
+  pthread_cond_init(&(pRa->cond), NULL);
+  pRa->nSlots = nSlots;
+
+  pReadh->pRa = pRa;
+  return 0;
+}
+
+static void tsdbReadAheadFp(SSchedMsg *pMsg) {
+  SReadAhead *    pRa = (SReadAhead *)pMsg->ahandle;
+  SReadAheadSlot *pSlot = (SReadAheadSlot *)pMsg->thandle;
+
+  int64_t nread = taosPRead(pSlot->fd, pSlot->pBuf, pSlot->len, pSlot->offset);
+
+  pthread_mutex_lock(&(pRa->mutex));
+  pSlot->state = (nread == pSlot->len) ? TSDB_RA_READY : TSDB_RA_FAILED;
+  pRa->nPending--;
+  pthread_cond_broadcast(&(pRa->cond));
+  pthread_mutex_unlock(&(pRa->mutex));
+}
+
+// Read a block ahead, the block is skipped if it is read ahead already or the next slot is still in flight
+void tsdbReadAheadBlock(SReadH *pReadh, SBlock *pBlock) {
+  SReadAhead *pRa = pReadh->pRa;
+  if (pRa == NULL || pBlock->numOfSubBlocks > 1) return;
+
+  SDFile *        pDFile = (pBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
+  SReadAheadSlot *pSlot = pRa->slots + pRa->next;
+
+  if (!TSDB_FILE_OPENED(pDFile)) return;
+
+  pthread_mutex_lock(&(pRa->mutex));
+  for (int i = 0; i < pRa->nSlots; i++) {
+    SReadAheadSlot *pTSlot = pRa->slots + i;
+    if (pTSlot->state != TSDB_RA_FREE && pTSlot->pDFile == pDFile && pTSlot->offset == pBlock->offset) {
+      pthread_mutex_unlock(&(pRa->mutex));
+      return;
+    }
+  }
+
+  if (pSlot->state == TSDB_RA_PENDING) {
+    pthread_mutex_unlock(&(pRa->mutex));
+    return;
+  }
+  pSlot->state = TSDB_RA_FREE;
+  pthread_mutex_unlock(&(pRa->mutex));
+
+  if (tsdbMakeRoom(&(pSlot->pBuf), pBlock->len) < 0) return;
+
+  pSlot->pDFile = pDFile;
+  pSlot->fd = TSDB_FILE_FD(pDFile);
+  pSlot->offset = pBlock->offset;
+  pSlot->len = pBlock->len;
+
+  pthread_mutex_lock(&(pRa->mutex));
+  pSlot->state = TSDB_RA_PENDING;
+  pRa->nPending++;
+  pthread_mutex_unlock(&(pRa->mutex));
+
+  pRa->next = (pRa->next + 1) % pRa->nSlots;
+  pRa->stat.nBlocks++;
+  pRa->stat.nBytes += pBlock->len;
+
+  SSchedMsg msg = {0};
+  msg.fp = tsdbReadAheadFp;
+  msg.ahandle = pRa;
+  msg.thandle = pSlot;
+  taosScheduleTask(tsReadAheadSched, &msg);
+}
+
+void tsdbGetReadAheadStat(SReadH *pReadh, SReadAheadStat *pStat) {
+  if (pReadh->pRa == NULL) {
+    memset(pStat, 0, sizeof(*pStat));
+  } else {
+    *pStat = pReadh->pRa->stat;
+  }
+}
+
+// Wait for the reads in flight and drop all slots
+static void tsdbResetReadAhead(SReadAhead *pRa) {
+  if (pRa == NULL) return;
+
+  pthread_mutex_lock(&(pRa->mutex));
+  while (pRa->nPending > 0) {
+    pthread_cond_wait(&(pRa->cond), &(pRa->mutex));
+  }
+  for (int i = 0; i < pRa->nSlots; i++) {
+    pRa->slots[i].state = TSDB_RA_FREE;
+    pRa->slots[i].pDFile = NULL;
+  }
+  pthread_mutex_unlock(&(pRa->mutex));
+}
+
+static void tsdbFreeReadAhead(SReadAhead *pRa) {
+  if (pRa == NULL) return;
+
+  tsdbResetReadAhead(pRa);
+  for (int i = 0; i < pRa->nSlots; i++) {
+    taosTZfree(pRa->slots[i].pBuf);
+  }
+  pthread_mutex_destroy(&(pRa->mutex));
+  pthread_cond_destroy(&(pRa->cond));
+  free(pRa);
+}
+
+// Read nbyte at offset of the file from the read-ahead slots, or from the file if they do not cover it
+static int64_t tsdbReadDFileAt(SReadH *pReadh, SDFile *pDFile, int64_t offset, void *buf, int64_t nbyte) {
+  SReadAhead *pRa = pReadh->pRa;
+
+  if (pRa != NULL) {
+    pthread_mutex_lock(&(pRa->mutex));
+    for (int i = 0; i < pRa->nSlots; i++) {
+      SReadAheadSlot *pSlot = pRa->slots + i;
+      if (pSlot->state == TSDB_RA_FREE || pSlot->pDFile != pDFile || offset < pSlot->offset ||
+          offset + nbyte > pSlot->offset + pSlot->len) {
+        continue;
+      }
+
+      if (pSlot->state == TSDB_RA_PENDING) {
+        int64_t st = taosGetTimestampUs();
+        while (pSlot->state == TSDB_RA_PENDING) {
+          pthread_cond_wait(&(pRa->cond), &(pRa->mutex));
+        }
+        pRa->stat.waitUs += taosGetTimestampUs() - st;
+      }
+
+      if (pSlot->state == TSDB_RA_READY) {
+        memcpy(buf, POINTER_SHIFT(pSlot->pBuf, offset - pSlot->offset), nbyte);
+        pRa->stat.nHit++;
+        pthread_mutex_unlock(&(pRa->mutex));
+        return nbyte;
+      }
+      break;
+    }
+    pRa->stat.nMiss++;
+    pthread_mutex_unlock(&(pRa->mutex));
+  }
+
+  if (tsdbSeekDFile(pDFile, offset, SEEK_SET) < 0) {
+    return -1;
+  }
+
+  return tsdbReadDFile(pDFile, buf, nbyte);
+}
+
 static void tsdbResetReadTable(SReadH *pReadh) {
   tdResetDataCols(pReadh->pDCols[0]);
   tdResetDataCols(pReadh->pDCols[1]);
@@ -614,9 +1020,21 @@ static void tsdbResetReadTable(SReadH *pReadh) {
 }
 
 static void tsdbResetReadFile(SReadH *pReadh) {
+  tsdbResetReadAhead(pReadh->pRa);
   tsdbResetReadTable(pReadh);
   taosArrayClear(pReadh->aBlkIdx);
+  tsdbReleaseCachedIdx(pReadh);
   tsdbCloseDFileSet(TSDB_READ_FSET(pReadh));
+  pReadh->dictLen = 0;
+}
+
+static void tsdbReleaseCachedIdx(SReadH *pReadh) {
+  if (pReadh->pIdxHandle == NULL) return;
+
+  tsdbIdxCacheRelease(pReadh->pIdxCache, pReadh->pIdxHandle);
+  pReadh->pIdxHandle = NULL;
+  pReadh->pCachedIdx = NULL;
+  pReadh->numOfCachedIdx = 0;
 }
 
 static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDataCols) {
@@ -629,13 +1047,7 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
 
   SBlockData *pBlockData = (SBlockData *)TSDB_READ_BUF(pReadh);
 
-  if (tsdbSeekDFile(pDFile, pBlock->offset, SEEK_SET) < 0) {
-    tsdbError("vgId:%d failed to load block data part while seek file %s to offset %" PRId64 " since %s",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), (int64_t)pBlock->offset, tstrerror(terrno));
-    return -1;
-  }
-
-  int64_t nread = tsdbReadDFile(pDFile, TSDB_READ_BUF(pReadh), pBlock->len);
+  int64_t nread = tsdbReadDFileAt(pReadh, pDFile, pBlock->offset, TSDB_READ_BUF(pReadh), pBlock->len);
   if (nread < 0) {
     tsdbError("vgId:%d failed to load block data part while read file %s since %s, offset:%" PRId64 " len :%d",
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), (int64_t)pBlock->offset,
@@ -681,6 +1093,7 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
     int16_t  tcolId = 0;
     uint32_t toffset = TSDB_KEY_COL_OFFSET;
     int32_t  tlen = pBlock->keyLen;
+    uint8_t  tcodec = TSDB_COL_CODEC_DEFAULT;
 
 
     if (dcol != 0) {
@@ -688,18 +1101,19 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
       tcolId = pBlockCol->colId;
       toffset = tsdbGetBlockColOffset(pBlockCol);
       tlen = pBlockCol->len;
+      tcodec = pBlockCol->codec;
     } else {
       ASSERT(pDataCol->colId == tcolId);
     }
 
     if (tcolId == pDataCol->colId) {
-      if (pBlock->algorithm == TWO_STAGE_COMP) {
+      if (pBlock->algorithm == TWO_STAGE_COMP || tcodec != TSDB_COL_CODEC_DEFAULT) {
         int zsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
         if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), zsize) < 0) return -1;
       }
 
       if (tsdbCheckAndDecodeColumnData(pDataCol, POINTER_SHIFT(pBlockData, tsize + toffset), tlen, pBlock->algorithm,
-                                       pBlock->numOfRows, pDataCols->maxPoints, TSDB_READ_COMP_BUF(pReadh),
+                                       tcodec, pBlock->numOfRows, pDataCols->maxPoints, TSDB_READ_COMP_BUF(pReadh),
                                        (int)taosTSizeof(TSDB_READ_COMP_BUF(pReadh))) < 0) {
         tsdbError("vgId:%d file %s is broken at column %d block offset %" PRId64 " column offset %u",
                   TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tcolId, (int64_t)pBlock->offset, toffset);
@@ -722,8 +1136,8 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
   return 0;
 }
 
-static int tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int32_t len, int8_t comp, int numOfRows,
-                                        int maxPoints, char *buffer, int bufferSize) {
+static int tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int32_t len, int8_t comp, uint8_t codec,
+                                        int numOfRows, int maxPoints, char *buffer, int bufferSize) {
   if (!taosCheckChecksumWhole((uint8_t *)content, len)) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
     return -1;
@@ -732,13 +1146,13 @@ static int tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int32
   tdAllocMemForCol(pDataCol, maxPoints);
 
   // Decode the data
-  if (comp) {
+  if (comp || codec != TSDB_COL_CODEC_DEFAULT) {
     // Need to decompress
-    int tlen = (*(tDataTypes[pDataCol->type].decompFunc))(content, len - sizeof(TSCKSUM), numOfRows, pDataCol->pData,
-                                                             pDataCol->spaceSize, comp, buffer, bufferSize);
+    int tlen = tsdbDecodeColData(pDataCol, content, len - sizeof(TSCKSUM), comp, codec, numOfRows, buffer, bufferSize);
     if (tlen <= 0) {
-      tsdbError("Failed to decompress column, file corrupted, len:%d comp:%d numOfRows:%d maxPoints:%d bufferSize:%d",
-                len, comp, numOfRows, maxPoints, bufferSize);
+      tsdbError("Failed to decompress column, file corrupted, len:%d comp:%d codec:%d numOfRows:%d maxPoints:%d "
+                "bufferSize:%d",
+                len, comp, codec, numOfRows, maxPoints, bufferSize);
       terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
       return -1;
     }
@@ -800,6 +1214,7 @@ static int tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *
       blockCol.len = pBlock->keyLen;
       blockCol.type = pDataCol->type;
       blockCol.offset = TSDB_KEY_COL_OFFSET;
+      blockCol.codec = TSDB_COL_CODEC_DEFAULT;
       pBlockCol = &blockCol;
     } else {  // load non-key rows
       while (true) {
@@ -840,39 +1255,52 @@ static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBloc
   STsdbRepo *pRepo = TSDB_READ_REPO(pReadh);
   STsdbCfg * pCfg = REPO_CFG(pRepo);
   int        tsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
-
-  if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), pBlockCol->len) < 0) return -1;
-  if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), tsize) < 0) return -1;
+  int        fid = TSDB_FSET_FID(TSDB_READ_FSET(pReadh));
+  int8_t     ftype = (pDFile == TSDB_READ_LAST_FILE(pReadh)) ? TSDB_FILE_LAST : TSDB_FILE_DATA;
 
   int64_t offset = pBlock->offset + tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer) +
                    tsdbGetBlockColOffset(pBlockCol);
-  if (tsdbSeekDFile(pDFile, offset, SEEK_SET) < 0) {
-    tsdbError("vgId:%d failed to load block column data while seek file %s to offset %" PRId64 " since %s",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, tstrerror(terrno));
-    return -1;
-  }
 
-  int64_t nread = tsdbReadDFile(pDFile, TSDB_READ_BUF(pReadh), pBlockCol->len);
-  if (nread < 0) {
-    tsdbError("vgId:%d failed to load block column data while read file %s since %s, offset:%" PRId64 " len :%d",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), offset, pBlockCol->len);
-    return -1;
+  if (pReadh->pCache != NULL && tsdbBlockCacheGet(pReadh->pCache, fid, pReadh->cacheGen, ftype, offset, pDataCol,
+                                                  pBlock->numOfRows, pCfg->maxRowsPerFileBlock) == 0) {
+    return 0;
   }
 
-  if (nread < pBlockCol->len) {
-    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
-    tsdbError("vgId:%d block column data in file %s is corrupted, offset:%" PRId64 " expected bytes:%d" PRIzu
-              " read bytes: %" PRId64,
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, pBlockCol->len, nread);
-    return -1;
+  if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), tsize) < 0) return -1;
+
+  // the chunk read by tsdbLoadBlockColDict for the dictionary filter of the block
+  void *content = pReadh->pDictBuf;
+  if (pReadh->dictLen != pBlockCol->len || pReadh->pDictFile != pDFile || pReadh->dictOffset != offset) {
+    if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), pBlockCol->len) < 0) return -1;
+
+    int64_t nread = tsdbReadDFileAt(pReadh, pDFile, offset, TSDB_READ_BUF(pReadh), pBlockCol->len);
+    if (nread < 0) {
+      tsdbError("vgId:%d failed to load block column data while read file %s since %s, offset:%" PRId64 " len :%d",
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), offset, pBlockCol->len);
+      return -1;
+    }
+
+    if (nread < pBlockCol->len) {
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      tsdbError("vgId:%d block column data in file %s is corrupted, offset:%" PRId64 " expected bytes:%d" PRIzu
+                " read bytes: %" PRId64,
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, pBlockCol->len, nread);
+      return -1;
+    }
+    content = TSDB_READ_BUF(pReadh);
   }
 
-  if (tsdbCheckAndDecodeColumnData(pDataCol, pReadh->pBuf, pBlockCol->len, pBlock->algorithm, pBlock->numOfRows,
-                                   pCfg->maxRowsPerFileBlock, pReadh->pCBuf, (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
+  if (tsdbCheckAndDecodeColumnData(pDataCol, content, pBlockCol->len, pBlock->algorithm, pBlockCol->codec,
+                                   pBlock->numOfRows, pCfg->maxRowsPerFileBlock, pReadh->pCBuf,
+                                   (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
     tsdbError("vgId:%d file %s is broken at column %d offset %" PRId64, REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile),
               pBlockCol->colId, offset);
     return -1;
   }
 
+  if (pReadh->pCache != NULL) {
+    tsdbBlockCachePut(pReadh->pCache, fid, pReadh->cacheGen, ftype, offset, pDataCol);
+  }
+
   return 0;
 }
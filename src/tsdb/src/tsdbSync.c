@@ -16,6 +16,7 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "taoserror.h"
+#include "tsync.h"
 #include "tsdbint.h"
 
 // Sync handle
@@ -29,6 +30,10 @@ typedef struct {
   SMFile     mf;
   SDFileSet  df;
   SDFileSet *pdf;
+  void *     pRangeBuf;
+  bool       incr;       // whether the filesets can be synced incrementally, negotiated with the peer
+  int64_t    fullBytes;  // size of the files of the filesets synced
+  int64_t    syncBytes;  // bytes of the files transferred through the socket
 } SSyncH;
 
 #define SYNC_BUFFER(sh) ((sh)->pBuf)
@@ -39,21 +44,27 @@ static int32_t tsdbSyncSendMeta(SSyncH *pSynch);
 static int32_t tsdbSyncRecvMeta(SSyncH *pSynch);
 static int32_t tsdbSendMetaInfo(SSyncH *pSynch);
 static int32_t tsdbRecvMetaInfo(SSyncH *pSynch);
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend);
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend);
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision);
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision);
 static int32_t tsdbSyncSendDFileSetArray(SSyncH *pSynch);
 static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch);
 static bool    tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2);
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch);
+static int32_t tsdbSyncSendMsg(SSyncH *pSynch, uint32_t tlen);
+static int32_t tsdbSyncRecvMsg(SSyncH *pSynch, uint32_t *tlen);
+static int32_t tsdbSyncDigestDFile(SSyncH *pSynch, SDFile *pDFile, uint8_t *digests);
+static int32_t tsdbSyncSendDFileIncr(SSyncH *pSynch, SDFile *pDFile);
+static int32_t tsdbSyncRecvDFileIncr(SSyncH *pSynch, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile);
 static int     tsdbReload(STsdbRepo *pRepo, bool isMfChanged);
 
-int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
+int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd, int8_t caps) {
   STsdbRepo *pRepo = (STsdbRepo *)tsdb;
   SSyncH     synch = {0};
 
   tsdbInitSyncH(&synch, pRepo, socketFd);
+  synch.incr = (caps & TAOS_SYNC_CAP_FILE_INCR) != 0;
   // Disable TSDB commit
   tsem_wait(&(pRepo->readyToCommit));
 
@@ -67,6 +78,9 @@ int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
     goto _err;
   }
 
+  tsdbInfo("vgId:%d, filesets are sent, size:%" PRId64 " sent:%" PRId64 " saved:%" PRId64, REPO_ID(pRepo),
+           synch.fullBytes, synch.syncBytes, synch.fullBytes - synch.syncBytes);
+
   // Enable TSDB commit
   tsem_post(&(pRepo->readyToCommit));
   tsdbDestroySyncH(&synch);
@@ -98,6 +112,13 @@ int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
     goto _err;
   }
 
+  tsdbInfo("vgId:%d, filesets are received, size:%" PRId64 " received:%" PRId64 " saved:%" PRId64, REPO_ID(pRepo),
+           synch.fullBytes, synch.syncBytes, synch.fullBytes - synch.syncBytes);
+
+  // Files received may have the same names as the local ones but different content
+  if (pRepo->pBlockCache != NULL) tsdbBlockCacheInvalidateAll(pRepo->pBlockCache);
+  if (pRepo->pIdxCache != NULL) tsdbIdxCacheInvalidateAll(pRepo->pIdxCache);
+  tsdbRemoveLastCacheFile(pRepo);
   tsdbEndFSTxn(pRepo);
   tsem_post(&(pRepo->readyToCommit));
   tsdbDestroySyncH(&synch);
@@ -120,11 +141,14 @@ static void tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd) {
   tsdbGetRtnSnap(pRepo, &(pSyncH->rtn));
 }
 
-static void tsdbDestroySyncH(SSyncH *pSyncH) { taosTZfree(pSyncH->pBuf); }
+static void tsdbDestroySyncH(SSyncH *pSyncH) {
+  taosTZfree(pSyncH->pBuf);
+  tfree(pSyncH->pRangeBuf);
+}
 
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool       toSendMeta = false;
+  uint8_t    toSendMeta = TSDB_SYNC_SKIP;
   SMFile     mf;
 
   // Send meta info to remote
@@ -199,7 +223,7 @@ static int32_t tsdbSyncRecvMeta(SSyncH *pSynch) {
     // Local has no meta file or has a different meta file, need to copy from remote
     pSynch->mfChanged = true;
 
-    if (tsdbSendDecision(pSynch, true) < 0) {
+    if (tsdbSendDecision(pSynch, TSDB_SYNC_FULL) < 0) {
       tsdbError("vgId:%d, failed to send decision while recv metafile since %s", REPO_ID(pRepo), tstrerror(terrno));
       return -1;
     }
@@ -236,7 +260,7 @@ static int32_t tsdbSyncRecvMeta(SSyncH *pSynch) {
   } else {
     pSynch->mfChanged = false;
     tsdbInfo("vgId:%d, metafile is same, no need to recv", REPO_ID(pRepo));
-    if (tsdbSendDecision(pSynch, false) < 0) {
+    if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
       tsdbError("vgId:%d, failed to send decision while recv metafile since %s", REPO_ID(pRepo), tstrerror(terrno));
       return -1;
     }
@@ -261,7 +285,7 @@ static int32_t tsdbSendMetaInfo(SSyncH *pSynch) {
   }
 
   void *ptr = SYNC_BUFFER(pSynch);
-  taosEncodeFixedU32(&ptr, tlen);
+  taosEncodeFixedU32(&ptr, pSynch->incr ? (tlen | TSDB_SYNC_META_INCR) : tlen);
   void *tptr = ptr;
   if (pMFile) {
     tsdbEncodeSMFileEx(&ptr, pMFile);
@@ -277,7 +301,7 @@ static int32_t tsdbSendMetaInfo(SSyncH *pSynch) {
     return -1;
   }
 
-  tsdbInfo("vgId:%d, metainfo is sent, tlen:%d, writeLen:%d", REPO_ID(pRepo), tlen, writeLen);
+  tsdbInfo("vgId:%d, metainfo is sent, tlen:%d, writeLen:%d incr:%d", REPO_ID(pRepo), tlen, writeLen, pSynch->incr);
   return 0;
 }
 
@@ -296,7 +320,11 @@ static int32_t tsdbRecvMetaInfo(SSyncH *pSynch) {
 
   taosDecodeFixedU32(buf, &tlen);
 
-  tsdbInfo("vgId:%d, metalen is received, readLen:%d, tlen:%d", REPO_ID(pRepo), readLen, tlen);
+  // The senders of old versions never set the flag, their filesets are received fully
+  pSynch->incr = (tlen & TSDB_SYNC_META_INCR) != 0;
+  tlen &= ~TSDB_SYNC_META_INCR;
+
+  tsdbInfo("vgId:%d, metalen is received, readLen:%d, tlen:%d incr:%d", REPO_ID(pRepo), readLen, tlen, pSynch->incr);
   if (tlen == 0) {
     pSynch->pmf = NULL;
     return 0;
@@ -327,9 +355,8 @@ static int32_t tsdbRecvMetaInfo(SSyncH *pSynch) {
   return 0;
 }
 
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = toSend;
 
   int32_t writeLen = sizeof(uint8_t);
   int32_t ret = taosWriteMsg(pSynch->socketFd, (void *)(&decision), writeLen);
@@ -342,19 +369,17 @@ static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
   return 0;
 }
 
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend) {
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = 0;
 
   int32_t readLen = sizeof(uint8_t);
-  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)(&decision), readLen);
+  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)decision, readLen);
   if (ret != readLen) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     tsdbError("vgId:%d, failed to recv decison, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
     return -1;
   }
 
-  *toSend = decision;
   return 0;
 }
 
@@ -423,7 +448,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           return -1;
         }
 
-        if (tsdbSendDecision(pSynch, false) < 0) {
+        if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
           tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
           return -1;
         }
@@ -432,7 +457,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
         int fidLevel = tsdbGetFidLevel(pSynch->pdf->fid, &(pSynch->rtn));
         if (fidLevel < 0) {  // expired fileset
           tsdbInfo("vgId:%d, fileset:%d will be skipped as expired", REPO_ID(pRepo), pSynch->pdf->fid);
-          if (tsdbSendDecision(pSynch, false) < 0) {
+          if (tsdbSendDecision(pSynch, TSDB_SYNC_SKIP) < 0) {
             tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
             return -1;
           }
@@ -446,13 +471,18 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           }
           // Next loop
           continue;
-        } else {
-          tsdbInfo("vgId:%d, fileset:%d will be received", REPO_ID(pRepo), pSynch->pdf->fid);
-          // Notify remote to send there file here
-          if (tsdbSendDecision(pSynch, true) < 0) {
-            tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
-            return -1;
-          }
+        }
+
+        // The local fileset of the same fid is changed by the commits after the replica is offline, only the
+        // changed ranges of its files need to be received
+        bool incr = (pSynch->incr && pLSet != NULL && pLSet->fid == pSynch->pdf->fid);
+        tsdbInfo("vgId:%d, fileset:%d will be received %s", REPO_ID(pRepo), pSynch->pdf->fid,
+                 incr ? "incrementally" : "fully");
+
+        // Notify remote to send there file here
+        if (tsdbSendDecision(pSynch, incr ? TSDB_SYNC_INCR : TSDB_SYNC_FULL) < 0) {
+          tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
+          return -1;
         }
 
         // Create local files and copy from remote
@@ -468,6 +498,16 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
 
         tsdbInitDFileSet(&fset, did, REPO_ID(pRepo), pSynch->pdf->fid, FS_TXN_VERSION(pfs), pSynch->pdf->ver);
 
+        // The local files whose ranges can be reused, except the ones to be overwritten by the new files
+        SDFile *pLDFiles[TSDB_FILE_MAX] = {0};
+        for (TSDB_FILE_T ftype = 0; incr && ftype < tsdbGetNFiles(pSynch->pdf) && ftype < tsdbGetNFiles(pLSet);
+             ftype++) {
+          SDFile *pLDFile = TSDB_DFILE_IN_SET(pLSet, ftype);
+          if (strcmp(TSDB_FILE_FULL_NAME(pLDFile), TSDB_FILE_FULL_NAME(TSDB_DFILE_IN_SET(&fset, ftype))) != 0) {
+            pLDFiles[ftype] = pLDFile;
+          }
+        }
+
         // Create new FSET
         if (tsdbCreateDFileSet(&fset, false) < 0) {
           tsdbError("vgId:%d, failed to create fileset since %s", REPO_ID(pRepo), tstrerror(terrno));
@@ -482,15 +522,27 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
                    pDFile->f.aname, pDFile->info.size, pRDFile->info.size);
 
           int64_t writeLen = pRDFile->info.size;
-          int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
-          if (ret != writeLen) {
-            terrno = TAOS_SYSTEM_ERROR(errno);
-            tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                      pDFile->f.aname, tstrerror(terrno), ret, writeLen);
-            tsdbCloseDFileSet(&fset);
-            tsdbRemoveDFileSet(&fset);
-            return -1;
+          if (incr) {
+            if (tsdbSyncRecvDFileIncr(pSynch, pLDFiles[ftype], pDFile, pRDFile) < 0) {
+              tsdbError("vgId:%d, failed to recv file:%s since %s", REPO_ID(pRepo), pDFile->f.aname,
+                        tstrerror(terrno));
+              tsdbCloseDFileSet(&fset);
+              tsdbRemoveDFileSet(&fset);
+              return -1;
+            }
+          } else {
+            int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
+            if (ret != writeLen) {
+              terrno = TAOS_SYSTEM_ERROR(errno);
+              tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
+                        pDFile->f.aname, tstrerror(terrno), ret, writeLen);
+              tsdbCloseDFileSet(&fset);
+              tsdbRemoveDFileSet(&fset);
+              return -1;
+            }
+            pSynch->syncBytes += writeLen;
           }
+          pSynch->fullBytes += writeLen;
 
           // Update new file info
           pDFile->info = pRDFile->info;
@@ -567,7 +619,7 @@ static bool tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2) {
 
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool toSend = false;
+  uint8_t    toSend = TSDB_SYNC_SKIP;
 
   // skip expired fileset
   if (pSet && tsdbGetFidLevel(pSet->fid, &(pSynch->rtn)) < 0) {
@@ -592,8 +644,16 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
     return -1;
   }
 
-  if (toSend) {
-    tsdbInfo("vgId:%d, fileset:%d will be sent", REPO_ID(pRepo), pSet->fid);
+  if (toSend == TSDB_SYNC_INCR && !pSynch->incr) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, fileset:%d is asked to be sent incrementally, which is not negotiated", REPO_ID(pRepo),
+              pSet->fid);
+    return -1;
+  }
+
+  if (toSend != TSDB_SYNC_SKIP) {
+    tsdbInfo("vgId:%d, fileset:%d will be sent %s", REPO_ID(pRepo), pSet->fid,
+             toSend == TSDB_SYNC_INCR ? "incrementally" : "fully");
 
     for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
       SDFile df = *TSDB_DFILE_IN_SET(pSet, ftype);
@@ -606,14 +666,24 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
       int64_t writeLen = df.info.size;
       tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), df.f.aname, writeLen);
 
-      int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(&df), 0, writeLen);
-      if (ret != writeLen) {
-        terrno = TAOS_SYSTEM_ERROR(errno);
-        tsdbError("vgId:%d, failed to send file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                  df.f.aname, tstrerror(terrno), ret, writeLen);
-        tsdbCloseDFile(&df);
-        return -1;
+      if (toSend == TSDB_SYNC_INCR) {
+        if (tsdbSyncSendDFileIncr(pSynch, &df) < 0) {
+          tsdbError("vgId:%d, failed to send file:%s since %s", REPO_ID(pRepo), df.f.aname, tstrerror(terrno));
+          tsdbCloseDFile(&df);
+          return -1;
+        }
+      } else {
+        int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(&df), 0, writeLen);
+        if (ret != writeLen) {
+          terrno = TAOS_SYSTEM_ERROR(errno);
+          tsdbError("vgId:%d, failed to send file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
+                    df.f.aname, tstrerror(terrno), ret, writeLen);
+          tsdbCloseDFile(&df);
+          return -1;
+        }
+        pSynch->syncBytes += writeLen;
       }
+      pSynch->fullBytes += writeLen;
 
       tsdbInfo("vgId:%d, file:%s is sent", REPO_ID(pRepo), df.f.aname);
       tsdbCloseDFile(&df);
@@ -703,6 +773,269 @@ static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch) {
   return 0;
 }
 
+// Send the content of length tlen after the length header in the sync buffer, with a checksum appended
+static int32_t tsdbSyncSendMsg(SSyncH *pSynch, uint32_t tlen) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+
+  void *ptr = SYNC_BUFFER(pSynch);
+  taosEncodeFixedU32(&ptr, tlen);
+  taosCalcChecksumAppend(0, (uint8_t *)ptr, tlen);
+
+  int32_t writeLen = tlen + sizeof(uint32_t);
+  int32_t ret = taosWriteMsg(pSynch->socketFd, SYNC_BUFFER(pSynch), writeLen);
+  if (ret != writeLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to send msg, ret:%d writeLen:%d", REPO_ID(pRepo), ret, writeLen);
+    return -1;
+  }
+
+  return 0;
+}
+
+// Recv a msg sent by tsdbSyncSendMsg into the sync buffer, tlen is the length with the checksum
+static int32_t tsdbSyncRecvMsg(SSyncH *pSynch, uint32_t *tlen) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  char       buf[sizeof(uint32_t)];
+
+  int32_t readLen = sizeof(uint32_t);
+  int32_t ret = taosReadMsg(pSynch->socketFd, buf, readLen);
+  if (ret != readLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv msg len, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
+    return -1;
+  }
+
+  taosDecodeFixedU32(buf, tlen);
+  if (*tlen < sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, failed to recv msg since invalid len:%u", REPO_ID(pRepo), *tlen);
+    return -1;
+  }
+
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), *tlen) < 0) {
+    tsdbError("vgId:%d, failed to makeroom while recv msg since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
+  ret = taosReadMsg(pSynch->socketFd, SYNC_BUFFER(pSynch), *tlen);
+  if (ret != *tlen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv msg, ret:%d tlen:%u", REPO_ID(pRepo), ret, *tlen);
+    return -1;
+  }
+
+  if (!taosCheckChecksumWhole((uint8_t *)SYNC_BUFFER(pSynch), *tlen)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, failed to checksum while recv msg since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncMakeRangeBuf(SSyncH *pSynch) {
+  if (pSynch->pRangeBuf == NULL) {
+    pSynch->pRangeBuf = malloc(TSDB_SYNC_RANGE_SIZE);
+    if (pSynch->pRangeBuf == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+// Digests of the ranges of an opened file, from its current offset
+static int32_t tsdbSyncDigestDFile(SSyncH *pSynch, SDFile *pDFile, uint8_t *digests) {
+  uint32_t nRanges = tsdbSyncNRanges(pDFile->info.size);
+
+  if (tsdbSyncMakeRangeBuf(pSynch) < 0) return -1;
+
+  for (uint32_t i = 0; i < nRanges; ++i) {
+    int64_t len = tsdbSyncRangeLen(pDFile->info.size, i);
+    if (tsdbReadDFile(pDFile, pSynch->pRangeBuf, len) < len) {
+      if (terrno == 0) terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      return -1;
+    }
+
+    MD5_CTX ctx;
+    MD5Init(&ctx);
+    MD5Update(&ctx, (uint8_t *)pSynch->pRangeBuf, (unsigned int)len);
+    MD5Final(&ctx);
+    memcpy(digests + (size_t)i * TSDB_SYNC_DIGEST_LEN, ctx.digest, TSDB_SYNC_DIGEST_LEN);
+  }
+
+  return 0;
+}
+
+// The receiver sends the size and the range digests of its local file, the sender replies with a flag for each
+// range of its file telling whether the range is sent, then sends the ranges flagged.
+static int32_t tsdbSyncSendDFileIncr(SSyncH *pSynch, SDFile *pDFile) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  uint32_t   tlen = 0;
+  uint64_t   lsize = 0;
+  uint32_t   nRanges = tsdbSyncNRanges(pDFile->info.size);
+  uint32_t   nLRanges = 0;
+  uint8_t *  digests = NULL;
+  int64_t    sentBytes = 0;
+  int32_t    code = -1;
+
+  if (tsdbSyncRecvMsg(pSynch, &tlen) < 0) return -1;
+
+  void *ptr = SYNC_BUFFER(pSynch);
+  ptr = taosDecodeFixedU64(ptr, &lsize);
+  nLRanges = tsdbSyncNRanges(lsize);
+  if (tlen != sizeof(uint64_t) + (size_t)nLRanges * TSDB_SYNC_DIGEST_LEN + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, file:%s, invalid range digests, tlen:%u size:%" PRIu64, REPO_ID(pRepo), pDFile->f.aname,
+              tlen, lsize);
+    return -1;
+  }
+
+  // Keep the digests of remote since the sync buffer is reused to send the flags
+  digests = malloc((size_t)nLRanges * TSDB_SYNC_DIGEST_LEN + 1);
+  if (digests == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+  memcpy(digests, ptr, (size_t)nLRanges * TSDB_SYNC_DIGEST_LEN);
+
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), sizeof(uint32_t) + nRanges + sizeof(TSCKSUM)) < 0) goto _exit;
+  uint8_t *flags = (uint8_t *)SYNC_BUFFER(pSynch) + sizeof(uint32_t);
+
+  if (tsdbSyncMakeRangeBuf(pSynch) < 0) goto _exit;
+  for (uint32_t i = 0; i < nRanges; ++i) {
+    int64_t len = tsdbSyncRangeLen(pDFile->info.size, i);
+    flags[i] = 1;
+    if (!tsdbSyncRangeReusable(pDFile->info.size, lsize, i)) continue;
+
+    if (tsdbSeekDFile(pDFile, tsdbSyncRangeOffset(i), SEEK_SET) < 0) goto _exit;
+    if (tsdbReadDFile(pDFile, pSynch->pRangeBuf, len) < len) {
+      if (terrno == 0) terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      goto _exit;
+    }
+
+    MD5_CTX ctx;
+    MD5Init(&ctx);
+    MD5Update(&ctx, (uint8_t *)pSynch->pRangeBuf, (unsigned int)len);
+    MD5Final(&ctx);
+    if (memcmp(ctx.digest, digests + (size_t)i * TSDB_SYNC_DIGEST_LEN, TSDB_SYNC_DIGEST_LEN) == 0) flags[i] = 0;
+  }
+
+  if (tsdbSyncSendMsg(pSynch, nRanges + sizeof(TSCKSUM)) < 0) goto _exit;
+
+  flags = (uint8_t *)SYNC_BUFFER(pSynch) + sizeof(uint32_t);
+  for (uint32_t i = 0; i < nRanges; ++i) {
+    if (flags[i] == 0) continue;
+
+    int64_t offset = tsdbSyncRangeOffset(i);
+    int64_t len = tsdbSyncRangeLen(pDFile->info.size, i);
+    int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(pDFile), &offset, len);
+    if (ret != len) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to send file:%s range:%u since %s, ret:%" PRId64 " len:%" PRId64, REPO_ID(pRepo),
+                pDFile->f.aname, i, tstrerror(terrno), ret, len);
+      goto _exit;
+    }
+    sentBytes += len;
+  }
+
+  pSynch->syncBytes += sentBytes;
+  tsdbInfo("vgId:%d, file:%s is sent incrementally, size:%" PRId64 " sent:%" PRId64 " remote size:%" PRIu64,
+           REPO_ID(pRepo), pDFile->f.aname, pDFile->info.size, sentBytes, lsize);
+  code = 0;
+
+_exit:
+  free(digests);
+  return code;
+}
+
+static int32_t tsdbSyncRecvDFileIncr(SSyncH *pSynch, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  SDFile     ldf;
+  uint64_t   lsize = 0;
+  uint32_t   nRanges = tsdbSyncNRanges(pRDFile->info.size);
+  uint32_t   tlen = 0;
+  uint8_t *  flags = NULL;
+  int64_t    recvBytes = 0;
+  int32_t    code = -1;
+
+  // Without a readable local file, all ranges are received
+  if (pLDFile != NULL) {
+    tsdbInitDFileEx(&ldf, pLDFile);
+    if (tsdbOpenDFile(&ldf, O_RDONLY) < 0) {
+      tsdbWarn("vgId:%d, file:%s can not be reused since %s", REPO_ID(pRepo), ldf.f.aname, tstrerror(terrno));
+    } else {
+      lsize = ldf.info.size;
+    }
+  }
+
+  uint32_t nLRanges = tsdbSyncNRanges(lsize);
+  tlen = sizeof(uint64_t) + nLRanges * TSDB_SYNC_DIGEST_LEN + sizeof(TSCKSUM);
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), sizeof(uint32_t) + tlen) < 0) goto _exit;
+
+  void *ptr = POINTER_SHIFT(SYNC_BUFFER(pSynch), sizeof(uint32_t));
+  taosEncodeFixedU64(&ptr, lsize);
+  if (lsize > 0 && tsdbSyncDigestDFile(pSynch, &ldf, (uint8_t *)ptr) < 0) {
+    tsdbError("vgId:%d, failed to digest file:%s since %s", REPO_ID(pRepo), ldf.f.aname, tstrerror(terrno));
+    goto _exit;
+  }
+
+  if (tsdbSyncSendMsg(pSynch, tlen) < 0) goto _exit;
+  if (tsdbSyncRecvMsg(pSynch, &tlen) < 0) goto _exit;
+  if (tlen != nRanges + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, file:%s, invalid range flags, tlen:%u ranges:%u", REPO_ID(pRepo), pDFile->f.aname, tlen,
+              nRanges);
+    goto _exit;
+  }
+
+  flags = malloc(nRanges + 1);
+  if (flags == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _exit;
+  }
+  memcpy(flags, SYNC_BUFFER(pSynch), nRanges);
+
+  if (tsdbSyncMakeRangeBuf(pSynch) < 0) goto _exit;
+  for (uint32_t i = 0; i < nRanges; ++i) {
+    int64_t len = tsdbSyncRangeLen(pRDFile->info.size, i);
+    if (flags[i] != 0) {
+      int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, len);
+      if (ret != len) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        tsdbError("vgId:%d, failed to recv file:%s range:%u since %s, ret:%" PRId64 " len:%" PRId64, REPO_ID(pRepo),
+                  pDFile->f.aname, i, tstrerror(terrno), ret, len);
+        goto _exit;
+      }
+      recvBytes += len;
+    } else {
+      if (i >= nLRanges) {
+        terrno = TSDB_CODE_TDB_MESSED_MSG;
+        goto _exit;
+      }
+
+      if (tsdbSeekDFile(&ldf, tsdbSyncRangeOffset(i), SEEK_SET) < 0 ||
+          tsdbReadDFile(&ldf, pSynch->pRangeBuf, len) < len || tsdbWriteDFile(pDFile, pSynch->pRangeBuf, len) < 0) {
+        if (terrno == 0) terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+        tsdbError("vgId:%d, failed to copy range:%u of file:%s since %s", REPO_ID(pRepo), i, ldf.f.aname,
+                  tstrerror(terrno));
+        goto _exit;
+      }
+    }
+  }
+
+  pSynch->syncBytes += recvBytes;
+  tsdbInfo("vgId:%d, file:%s is received incrementally, size:%" PRIu64 " received:%" PRId64 " local size:%" PRIu64,
+           REPO_ID(pRepo), pDFile->f.aname, pRDFile->info.size, recvBytes, lsize);
+  code = 0;
+
+_exit:
+  if (pLDFile != NULL) tsdbCloseDFile(&ldf);
+  tfree(flags);
+  return code;
+}
+
 static int tsdbReload(STsdbRepo *pRepo, bool isMfChanged) {
   // TODO: may need to stop and restart stream
   // if (isMfChanged) {
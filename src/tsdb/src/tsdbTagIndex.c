@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+#include "tsdbTagIndex.h"
+
+typedef struct {
+  int16_t   colId;
+  int8_t    type;
+  SHashObj *pValues;  // tag value -> SBitmap *
+  SBitmap  *pEmpty;   // tables of the empty binary or nchar value, which can not be a hash key
+} STagColIndex;
+
+struct STagIndex {
+  SArray *pCols;   // STagColIndex, created when the first table with a non NULL value of the column is added
+  bool    broken;  // a table failed to be added, so the index can no longer be used
+};
+
+static STagColIndex *tsdbTagIndexGetCol(STagIndex *pIndex, int16_t colId, int8_t type, bool create);
+static SBitmap     **tsdbTagIndexGetBitmap(STagColIndex *pColIdx, const void *key, int32_t len);
+static void         *tsdbTagIndexGetKey(int8_t type, void *val, int32_t *len);
+
+STagIndex *tsdbNewTagIndex() {
+  STagIndex *pIndex = (STagIndex *)calloc(1, sizeof(*pIndex));
+  if (pIndex == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pIndex->pCols = taosArrayInit(4, sizeof(STagColIndex));
+  if (pIndex->pCols == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    free(pIndex);
+    return NULL;
+  }
+
+  return pIndex;
+}
+
+void tsdbFreeTagIndex(STagIndex *pIndex) {
+  if (pIndex == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pIndex->pCols); ++i) {
+    STagColIndex *pColIdx = (STagColIndex *)taosArrayGet(pIndex->pCols, i);
+
+    // the hash table does not call its free function, so release the bitmaps here
+    SBitmap **ppBitmap = taosHashIterate(pColIdx->pValues, NULL);
+    while (ppBitmap != NULL) {
+      tBitmapDestroy(*ppBitmap);
+      ppBitmap = taosHashIterate(pColIdx->pValues, ppBitmap);
+    }
+    taosHashCleanup(pColIdx->pValues);
+    tBitmapDestroy(pColIdx->pEmpty);
+  }
+  taosArrayDestroy(&pIndex->pCols);
+  free(pIndex);
+}
+
+void tsdbTagIndexAdd(STagIndex *pIndex, STSchema *pTagSchema, SKVRow tagVal, int32_t tid) {
+  if (pIndex->broken) return;
+
+  for (int i = 0; i < schemaNCols(pTagSchema); ++i) {
+    STColumn *pCol = schemaColAt(pTagSchema, i);
+    if (!TSDB_TAG_INDEX_TYPE(colType(pCol))) continue;
+
+    void *val = tdGetKVRowValOfCol(tagVal, colColId(pCol));
+    if (val == NULL || isNull(val, colType(pCol))) continue;
+
+    int32_t       len = 0;
+    void         *key = tsdbTagIndexGetKey(colType(pCol), val, &len);
+    STagColIndex *pColIdx = tsdbTagIndexGetCol(pIndex, colColId(pCol), colType(pCol), true);
+    if (pColIdx == NULL) goto _err;
+
+    SBitmap **ppBitmap = tsdbTagIndexGetBitmap(pColIdx, key, len);
+    if (ppBitmap == NULL || *ppBitmap == NULL) {
+      SBitmap *pBitmap = tBitmapCreate();
+      if (pBitmap == NULL) goto _err;
+      if (len == 0) {
+        pColIdx->pEmpty = pBitmap;
+      } else if (taosHashPut(pColIdx->pValues, key, len, &pBitmap, sizeof(pBitmap)) < 0) {
+        tBitmapDestroy(pBitmap);
+        goto _err;
+      }
+      ppBitmap = tsdbTagIndexGetBitmap(pColIdx, key, len);
+    }
+
+    if (tBitmapAdd(*ppBitmap, (uint32_t)tid) < 0) goto _err;
+  }
+
+  return;
+
+_err:
+  tsdbError("failed to add table tid %d into the tag index since out of memory, the index is disabled", tid);
+  pIndex->broken = true;
+}
+
+void tsdbTagIndexRemove(STagIndex *pIndex, STSchema *pTagSchema, SKVRow tagVal, int32_t tid) {
+  if (pIndex->broken) return;
+
+  for (int i = 0; i < schemaNCols(pTagSchema); ++i) {
+    STColumn *pCol = schemaColAt(pTagSchema, i);
+    if (!TSDB_TAG_INDEX_TYPE(colType(pCol))) continue;
+
+    void *val = tdGetKVRowValOfCol(tagVal, colColId(pCol));
+    if (val == NULL || isNull(val, colType(pCol))) continue;
+
+    STagColIndex *pColIdx = tsdbTagIndexGetCol(pIndex, colColId(pCol), colType(pCol), false);
+    if (pColIdx == NULL) continue;
+
+    int32_t   len = 0;
+    void     *key = tsdbTagIndexGetKey(colType(pCol), val, &len);
+    SBitmap **ppBitmap = tsdbTagIndexGetBitmap(pColIdx, key, len);
+    if (ppBitmap == NULL || *ppBitmap == NULL) continue;
+
+    tBitmapRemove(*ppBitmap, (uint32_t)tid);
+    if (tBitmapCardinality(*ppBitmap) == 0) {
+      if (len == 0) {
+        tBitmapDestroy(pColIdx->pEmpty);
+        pColIdx->pEmpty = NULL;
+      } else {
+        tBitmapDestroy(*ppBitmap);
+        taosHashRemove(pColIdx->pValues, key, len);
+      }
+    }
+  }
+}
+
+// Return false if the column is not indexed, otherwise the bitmap of the value, or NULL if no table has the value
+bool tsdbTagIndexGet(STagIndex *pIndex, int16_t colId, int8_t type, const void *val, int32_t len,
+                     const SBitmap **ppBitmap) {
+  *ppBitmap = NULL;
+  if (pIndex->broken || !TSDB_TAG_INDEX_TYPE(type)) return false;
+
+  // no table has a non NULL value of the column yet
+  STagColIndex *pColIdx = tsdbTagIndexGetCol(pIndex, colId, type, false);
+  if (pColIdx == NULL) return true;
+
+  SBitmap **ppBitmap0 = tsdbTagIndexGetBitmap(pColIdx, val, len);
+  if (ppBitmap0 != NULL) {
+    *ppBitmap = *ppBitmap0;
+  }
+
+  return true;
+}
+
+static STagColIndex *tsdbTagIndexGetCol(STagIndex *pIndex, int16_t colId, int8_t type, bool create) {
+  for (size_t i = 0; i < taosArrayGetSize(pIndex->pCols); ++i) {
+    STagColIndex *pColIdx = (STagColIndex *)taosArrayGet(pIndex->pCols, i);
+    if (pColIdx->colId == colId) {
+      return pColIdx;
+    }
+  }
+
+  if (!create) return NULL;
+
+  STagColIndex colIdx = {.colId = colId, .type = type};
+  colIdx.pValues = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (colIdx.pValues == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  if (taosArrayPush(pIndex->pCols, &colIdx) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    taosHashCleanup(colIdx.pValues);
+    return NULL;
+  }
+
+  return (STagColIndex *)taosArrayGetLast(pIndex->pCols);
+}
+
+static SBitmap **tsdbTagIndexGetBitmap(STagColIndex *pColIdx, const void *key, int32_t len) {
+  if (len == 0) {
+    return &pColIdx->pEmpty;
+  }
+
+  return (SBitmap **)taosHashGet(pColIdx->pValues, key, len);
+}
+
+// The key of a binary or nchar value is its content without the length header, as the keys of the set of in
+static void *tsdbTagIndexGetKey(int8_t type, void *val, int32_t *len) {
+  if (IS_VAR_DATA_TYPE(type)) {
+    *len = varDataLen(val);
+    return varDataVal(val);
+  }
+
+  *len = tDataTypes[type].bytes;
+  return val;
+}
@@ -43,6 +43,15 @@ typedef enum SHashLockTypeE {
   HASH_ENTRY_LOCK  = 1,
 } SHashLockTypeE;
 
+// The chained layout keeps a linked list of nodes per slot, and is required by the per entry lock. The open
+// addressing layout probes groups of control bytes in a flat array of slots, with small keys copied inline into the
+// slots and the nodes allocated from slabs of the table, so lookups touch far fewer cache lines. The data returned
+// by either layout keeps its address until it is removed.
+typedef enum SHashLayoutE {
+  HASH_CHAINED          = 0,
+  HASH_OPEN_ADDRESSING  = 1,
+} SHashLayoutE;
+
 typedef struct SHashObj SHashObj;
 
 /**
@@ -56,6 +65,19 @@ typedef struct SHashObj SHashObj;
  */
 SHashObj *taosHashInit(size_t capacity, _hash_fn_t fn, bool update, SHashLockTypeE type);
 
+/**
+ * initialize a hash table with the specified layout, the open addressing layout protects the whole table with
+ * one lock if a lock is required
+ *
+ * @param capacity   initial capacity of the hash table
+ * @param fn         hash function
+ * @param update     whether the hash table allows in place update
+ * @param type       whether the hash table has per entry lock
+ * @param layout     layout of the slots
+ * @return           hash table object
+ */
+SHashObj *taosHashInitWithLayout(size_t capacity, _hash_fn_t fn, bool update, SHashLockTypeE type, SHashLayoutE layout);
+
 /**
  * set equal func of the hash table
  *
@@ -187,6 +209,18 @@ int32_t taosHashGetMaxOverflowLinkLength(SHashObj *pHashObj);
  */
 size_t taosHashGetMemSize(const SHashObj *pHashObj);
 
+/**
+ * iterate the hash table, start with p of NULL and pass the data returned to get the next one. An iteration ends
+ * when NULL is returned or taosHashCancelIterate is called.
+ *
+ * The open addressing layout rehashes the whole table when it grows, so inserting new keys while an iteration is in
+ * progress would skip or repeat entries. Such an insert fails instead, updating or removing the existing keys is fine.
+ * An iteration stopped before NULL is returned has to be cancelled, or the table can not grow any more.
+ *
+ * @param pHashObj   hash table object
+ * @param p          data returned by the previous call, or NULL to start
+ * @return           next data, or NULL if there is no more
+ */
 void *taosHashIterate(SHashObj *pHashObj, void *p);
 
 void  taosHashCancelIterate(SHashObj *pHashObj, void *p);
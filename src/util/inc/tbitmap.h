@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TBITMAP_H
+#define TDENGINE_TBITMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A compressed bitmap of uint32 values. The values are split by their high 16 bits into containers, a container
+// keeps a sorted array of the low 16 bits when it is sparse and a 65536 bits bitset when it is dense, like the
+// roaring bitmap. It is not thread safe.
+typedef struct SBitmap SBitmap;
+
+typedef struct SBitmapIter {
+  const SBitmap *pBitmap;
+  int32_t        c;     // container index
+  int32_t        i;     // array index or bitset word index
+  uint64_t       word;  // bits not visited of the current bitset word
+} SBitmapIter;
+
+SBitmap *tBitmapCreate();
+void     tBitmapDestroy(SBitmap *pBitmap);
+SBitmap *tBitmapDup(const SBitmap *pBitmap);
+int32_t  tBitmapAdd(SBitmap *pBitmap, uint32_t val);
+void     tBitmapRemove(SBitmap *pBitmap, uint32_t val);
+bool     tBitmapContains(const SBitmap *pBitmap, uint32_t val);
+int64_t  tBitmapCardinality(const SBitmap *pBitmap);
+int64_t  tBitmapMemSize(const SBitmap *pBitmap);
+
+// pDst = pDst & pSrc, pDst = pDst | pSrc
+int32_t tBitmapAnd(SBitmap *pDst, const SBitmap *pSrc);
+int32_t tBitmapOr(SBitmap *pDst, const SBitmap *pSrc);
+
+// visit the values in ascending order
+void tBitmapIterInit(SBitmapIter *pIter, const SBitmap *pBitmap);
+bool tBitmapIterNext(SBitmapIter *pIter, uint32_t *val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TBITMAP_H
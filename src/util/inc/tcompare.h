@@ -46,6 +46,14 @@ int patternMatch(const char *pattern, const char *str, size_t size, const SPatte
 
 int WCSPatternMatch(const uint32_t *pattern, const uint32_t *str, size_t size, const SPatternCompareInfo *pInfo);
 
+// A MATCH/NMATCH pattern compiled once and evaluated over many strings. It keeps the scratch buffer of the NUL
+// terminated subject, so it must not be shared by threads.
+typedef struct SRegexMatcher SRegexMatcher;
+
+SRegexMatcher *regexMatcherCreate(const char *pattern, size_t len);
+void           regexMatcherDestroy(SRegexMatcher *pMatcher);
+int32_t        regexMatcherExec(SRegexMatcher *pMatcher, const char *str, size_t len);
+
 int32_t doCompare(const char* a, const char* b, int32_t type, size_t size);
 
 __compar_fn_t getKeyComparFunc(int32_t keyType, int32_t order);
@@ -32,6 +32,7 @@ int64_t tfOpen(const char *pathname, int32_t flags);
 int64_t tfOpenM(const char *pathname, int32_t flags, mode_t mode);
 int64_t tfClose(int64_t tfd);
 int64_t tfWrite(int64_t tfd, void *buf, int64_t count);
+int64_t tfWritev(int64_t tfd, struct iovec *iov, int32_t iovcnt);
 int64_t tfRead(int64_t tfd, void *buf, int64_t count);
 int32_t tfFsync(int64_t tfd);
 bool    tfValid(int64_t tfd);
@@ -50,14 +50,39 @@ extern "C" {
 #define HEAD_MODE(x)  x%2
 #define HEAD_ALGO(x)  x/2
 
+// first byte of compressed strings: 0 original, 1 LZ4 and STRING_DICT_COMPRESS encoded by a dictionary
+#define STRING_DICT_COMPRESS 2
+
+// a string column is dictionary encoded only if it has no more than this many distinct values, and at least
+// TS_STRING_DICT_MIN_RATIO rows per distinct value
+#define TS_STRING_DICT_MAX_ENTRIES 4096
+#define TS_STRING_DICT_MIN_RATIO   8
+
+// level of zlib used when a column codec does not give one
+#define TS_ZLIB_DEFAULT_LEVEL 6
+
+// instruction sets used to decompress integers and timestamps, chosen by the cpu at the first decompression
+#define TSDB_SIMD_NONE  0
+#define TSDB_SIMD_SSE42 1
+#define TSDB_SIMD_AVX2  2
+
 extern int tsCompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsCompressBoolImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressBoolImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressStringImp(const char *const input, int inputSize, char *const output, int outputSize);
 extern int tsDecompressStringImp(const char *const input, int compressedSize, char *const output, int outputSize);
+extern int tsCompressStringDictImp(const char *const input, int inputSize, const int nelements, char *const output,
+                                   int outputSize);
+extern int tsDecompressStringDictImp(const char *const input, int compressedSize, const int nelements,
+                                     char *const output, int outputSize, char *const buffer, int bufferSize);
+extern int tsGetStringDict(const char *const input, int compressedSize, const char **ppDict);
+extern int tsCompressZlibImp(const char *const input, int inputSize, char *const output, int outputSize, int level);
+extern int tsDecompressZlibImp(const char *const input, int compressedSize, char *const output, int outputSize);
 extern int tsCompressTimestampImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output);
+extern int tsGetCpuSimdLevel();
+extern int tsSetDecompressSimdLevel(int level);
 extern int tsCompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressFloatImp(const char *const input, const int nelements, char *const output);
@@ -214,6 +239,9 @@ static FORCE_INLINE int tsCompressString(const char *const input, int inputSize,
 
 static FORCE_INLINE int tsDecompressString(const char *const input, int compressedSize, const int nelements, char *const output,
                        int outputSize, char algorithm, char *const buffer, int bufferSize) {
+  if (compressedSize > 0 && input[0] == STRING_DICT_COMPRESS) {
+    return tsDecompressStringDictImp(input, compressedSize, nelements, output, outputSize, buffer, bufferSize);
+  }
   return tsDecompressStringImp(input, compressedSize, output, outputSize);
 }
 
@@ -35,6 +35,8 @@ extern "C" {
 
 // For thread safety setting
 #define SL_THREAD_SAFE (uint8_t)0x4
+// Single writer with lock-free readers, no rwlock is created even if SL_THREAD_SAFE is set
+#define SL_SINGLE_WRITER (uint8_t)0x8
 
 typedef char *SSkipListKey;
 typedef char *(*__sl_key_fn_t)(const void *);
@@ -62,6 +64,12 @@ typedef struct SSkipListNode {
  * In this case, one should use the concurrent skip list (by using michael-scott algorithm) instead of
  * this simple version in a multi-thread environment, to achieve higher performance of read/write operations.
  *
+ * SL_SINGLE_WRITER mode: only one thread modifies the list while any number of threads read it without lock.
+ * A new node is fully built before it is published into each level, from the bottom level upward, by CAS on
+ * the forward (and backward) pointer of its neighbour, and readers load the pointers with acquire semantics.
+ * Unlinked nodes are retired rather than freed, and reclaimed only when the list is destroyed, so the owner
+ * of the list (e.g. the reference count of the memtable) decides the epoch after which no reader exists.
+ *
  * Note: Duplicated primary key situation.
  * In case of duplicated primary key, two ways can be employed to handle this situation:
  * 1. add as normal insertion without special process.
@@ -100,6 +108,14 @@ typedef struct tSkipListState {
   uint64_t nTotalElapsedTimeForInsert;
 } tSkipListState;
 
+/*
+ * Level segregated arena for skip list nodes. Nodes of the same level have the same size and are carved out of
+ * the pages of that level one after another. Nodes are never freed one by one, all pages are released together
+ * by tSkipListArenaDestroy, so the arena must outlive every skip list using it. The arena is not thread safe,
+ * all skip lists sharing an arena must be written by the same thread.
+ */
+typedef struct SSkipListArena SSkipListArena;
+
 typedef enum {
   SSkipListPutSuccess    = 0,
   SSkipListPutEarlyStop  = 1,
@@ -119,6 +135,8 @@ typedef struct SSkipList {
   uint32_t          size;
   SSkipListNode *   pHead;  // point to the first element
   SSkipListNode *   pTail;  // point to the last element
+  SArray *          pRetired;  // nodes unlinked in SL_SINGLE_WRITER mode, freed in tSkipListDestroy
+  SSkipListArena *  pArena;    // nodes are allocated from the arena if not NULL
 #if SKIP_LIST_RECORD_PERFORMANCE
   tSkipListState state;  // skiplist state
 #endif
@@ -134,6 +152,7 @@ typedef struct SSkipListIterator {
 } SSkipListIterator;
 
 #define SL_IS_THREAD_SAFE(s) (((s)->flags) & SL_THREAD_SAFE)
+#define SL_IS_SINGLE_WRITER(s) (((s)->flags) & SL_SINGLE_WRITER)
 #define SL_DUP_MODE(s) (((s)->flags) & ((((uint8_t)1) << 2) - 1))
 #define SL_GET_NODE_KEY(s, n) ((s)->keyFn((n)->pData))
 #define SL_GET_MIN_KEY(s) SL_GET_NODE_KEY(s, SL_NODE_GET_FORWARD_POINTER((s)->pHead, 0))
@@ -149,11 +168,19 @@ SArray *           tSkipListGet(SSkipList *pSkipList, SSkipListKey pKey);
 void               tSkipListPrint(SSkipList *pSkipList, int16_t nlevel);
 SSkipListIterator *tSkipListCreateIter(SSkipList *pSkipList);
 SSkipListIterator *tSkipListCreateIterFromVal(SSkipList *pSkipList, const char *val, int32_t type, int32_t order);
+void               tSkipListInitIterFromVal(SSkipListIterator *iter, SSkipList *pSkipList, const char *val, int32_t type,
+                                            int32_t order);
 bool               tSkipListIterNext(SSkipListIterator *iter);
 SSkipListNode *    tSkipListIterGet(SSkipListIterator *iter);
 void *             tSkipListDestroyIter(SSkipListIterator *iter);
 uint32_t           tSkipListRemove(SSkipList *pSkipList, SSkipListKey key);
 void               tSkipListRemoveNode(SSkipList *pSkipList, SSkipListNode *pNode);
+void               tSkipListSetArena(SSkipList *pSkipList, SSkipListArena *pArena);
+
+SSkipListArena *tSkipListArenaCreate(int32_t pageSize);
+void            tSkipListArenaDestroy(SSkipListArena *pArena);
+void            tSkipListArenaGetUsage(SSkipListArena *pArena, int64_t *numOfPages, int64_t *usedBytes, int64_t *allocBytes);
+int64_t         tSkipListArenaGetTotalBytes();
 
 #ifdef __cplusplus
 }
@@ -37,6 +37,25 @@
 #define GET_HASH_NODE_DATA(_n) ((char*)(_n) + sizeof(SHashNode))
 #define GET_HASH_PNODE(_n) ((SHashNode *)((char*)(_n) - sizeof(SHashNode)))
 
+// open addressing layout: a control byte per slot is empty, deleted or the low 7 bits of the hash value of a full
+// slot, and the control bytes of a group of slots are matched together as a 64 bits word
+#define HASH_OA_GROUP_WIDTH   8
+#define HASH_OA_INLINE_KEY    16
+#define HASH_OA_MAX_CAPACITY  (HASH_MAX_CAPACITY * 8)
+#define HASH_OA_CTRL_EMPTY    ((uint8_t)0x80)
+#define HASH_OA_CTRL_DELETED  ((uint8_t)0xFE)
+#define HASH_OA_IS_FULL(_c)   (((_c) & 0x80) == 0)
+#define HASH_OA_H1(_v)        ((_v) >> 7)
+#define HASH_OA_H2(_v)        ((uint8_t)((_v) & 0x7F))
+#define HASH_OA_LSBS          0x0101010101010101ULL
+#define HASH_OA_MSBS          0x8080808080808080ULL
+#define HASH_OA_MAX_LOAD(_c)  ((_c) - (_c) / 8)
+
+// nodes no larger than 8 * HASH_OA_SLAB_CLASSES bytes are allocated from the slabs, and reused by size
+#define HASH_OA_SLAB_SIZE     (64 * 1024)
+#define HASH_OA_SLAB_CLASSES  32
+#define HASH_OA_NODE_SIZE(_k, _d) ((sizeof(SHashNode) + (_k) + (_d) + 7) & ~((size_t)7))
+
 /*
  * typedef
  */
@@ -47,6 +66,13 @@ typedef struct SHashEntry {
   SHashNode *next;
 } SHashEntry;
 
+typedef struct SHashSlot {
+  SHashNode *pNode;
+  uint32_t   hashVal;
+  uint32_t   keyLen;                    // 0 if the node is removed but still referenced by an iterator
+  char       key[HASH_OA_INLINE_KEY];   // copy of a small key, so the node is not visited for a mismatch
+} SHashSlot;
+
 typedef struct SHashObj {
   SHashEntry    **hashList;
   size_t          capacity;     // number of slots
@@ -57,7 +83,15 @@ typedef struct SHashObj {
   SRWLatch        lock;         // read-write spin lock
   SHashLockTypeE  type;         // lock type
   bool            enableUpdate; // enable update
-  SArray         *pMemBlock;    // memory block allocated for SHashEntry
+  SArray         *pMemBlock;    // memory block allocated for SHashEntry, or the slabs of the open addressing layout
+  SHashLayoutE    layout;
+  uint8_t        *ctrl;         // control bytes, the first group is mirrored after the last slot
+  SHashSlot      *slots;
+  size_t          numOfUsed;    // slots that are not empty, including the deleted ones
+  char           *pSlab;        // the slab in use and its allocated bytes
+  size_t          slabUsed;
+  SHashNode      *freeNodes[HASH_OA_SLAB_CLASSES];
+  int32_t         numOfIters;   // iterations of the open addressing layout in progress, no resize is allowed
 } SHashObj;
 
 /*
@@ -219,6 +253,26 @@ static void pushfrontNodeInEntryList(SHashEntry *pEntry, SHashNode *pNode);
  */
 static FORCE_INLINE bool taosHashTableEmpty(const SHashObj *pHashObj);
 
+/**
+ * fill the header, data and key of a hash node
+ */
+static void doInitHashNode(SHashNode *pNode, const void *key, size_t keyLen, const void *pData, size_t dsize, uint32_t hashVal);
+
+/*
+ * the open addressing layout
+ */
+static int32_t   taosHashOAInit(SHashObj *pHashObj);
+static int32_t   taosHashOAPut(SHashObj *pHashObj, const void *key, size_t keyLen, void *data, size_t size, uint32_t hashVal);
+static void     *taosHashOAGet(SHashObj *pHashObj, const void *key, size_t keyLen, uint32_t hashVal, void (*fp)(void *),
+                               void **d, size_t *sz);
+static int32_t   taosHashOARemove(SHashObj *pHashObj, const void *key, size_t keyLen, uint32_t hashVal, void *data,
+                                  size_t dsize);
+static void      taosHashOACondTraverse(SHashObj *pHashObj, bool (*fp)(void *, void *), void *param);
+static void      taosHashOAClear(SHashObj *pHashObj);
+static int32_t   taosHashOAGetMaxProbeLength(SHashObj *pHashObj);
+static void     *taosHashOAIterate(SHashObj *pHashObj, void *p);
+static void      taosHashOACancelIterate(SHashObj *pHashObj, void *p);
+
 /**
  * initialize a hash table
  *
@@ -229,6 +283,10 @@ static FORCE_INLINE bool taosHashTableEmpty(const SHashObj *pHashObj);
  * @return           hash table object
  */
 SHashObj *taosHashInit(size_t capacity, _hash_fn_t fn, bool update, SHashLockTypeE type) {
+  return taosHashInitWithLayout(capacity, fn, update, type, HASH_CHAINED);
+}
+
+SHashObj *taosHashInitWithLayout(size_t capacity, _hash_fn_t fn, bool update, SHashLockTypeE type, SHashLayoutE layout) {
   if (fn == NULL) {
     uError("hash table must have a valid hash function");
     assert(0);
@@ -251,9 +309,20 @@ SHashObj *taosHashInit(size_t capacity, _hash_fn_t fn, bool update, SHashLockTyp
   pHashObj->hashFp  = fn;
   pHashObj->type = type;
   pHashObj->enableUpdate = update;
+  pHashObj->layout = layout;
 
   assert((pHashObj->capacity & (pHashObj->capacity - 1)) == 0);
 
+  if (layout == HASH_OPEN_ADDRESSING) {
+    if (taosHashOAInit(pHashObj) != 0) {
+      free(pHashObj);
+      uError("failed to allocate memory, reason:%s", strerror(errno));
+      return NULL;
+    }
+
+    return pHashObj;
+  }
+
   pHashObj->hashList = (SHashEntry **)calloc(pHashObj->capacity, sizeof(void *));
   if (pHashObj->hashList == NULL) {
     free(pHashObj);
@@ -316,6 +385,10 @@ int32_t taosHashPut(SHashObj *pHashObj, const void *key, size_t keyLen, void *da
   }
 
   uint32_t   hashVal = (*pHashObj->hashFp)(key, (uint32_t)keyLen);
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOAPut(pHashObj, key, keyLen, data, size, hashVal);
+  }
+
   SHashNode *pNewNode = doCreateHashNode(key, keyLen, data, size, hashVal);
   if (pNewNode == NULL) {
     return -1;
@@ -395,6 +468,9 @@ void* taosHashGetCloneExt(SHashObj *pHashObj, const void *key, size_t keyLen, vo
   }
 
   uint32_t hashVal = (*pHashObj->hashFp)(key, (uint32_t)keyLen);
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOAGet(pHashObj, key, keyLen, hashVal, fp, d, sz);
+  }
 
   // only add the read lock to disable the resize process
   taosHashRLock(pHashObj);
@@ -448,6 +524,9 @@ void* taosHashGetClone(SHashObj *pHashObj, const void *key, size_t keyLen, void
   }
 
   uint32_t hashVal = (*pHashObj->hashFp)(key, (uint32_t)keyLen);
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOAGet(pHashObj, key, keyLen, hashVal, fp, (d != NULL) ? &d : NULL, NULL);
+  }
 
   // only add the read lock to disable the resize process
   taosHashRLock(pHashObj);
@@ -500,6 +579,9 @@ int32_t taosHashRemoveWithData(SHashObj *pHashObj, const void *key, size_t keyLe
   }
 
   uint32_t hashVal = (*pHashObj->hashFp)(key, (uint32_t)keyLen);
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOARemove(pHashObj, key, keyLen, hashVal, data, dsize);
+  }
 
   // disable the resize process
   taosHashRLock(pHashObj);
@@ -561,6 +643,11 @@ void taosHashCondTraverse(SHashObj *pHashObj, bool (*fp)(void *, void *), void *
     return;
   }
 
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    taosHashOACondTraverse(pHashObj, fp, param);
+    return;
+  }
+
   // disable the resize process
   taosHashRLock(pHashObj);
 
@@ -604,6 +691,11 @@ void taosHashClear(SHashObj *pHashObj) {
     return;
   }
 
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    taosHashOAClear(pHashObj);
+    return;
+  }
+
   SHashNode *pNode, *pNext;
 
   taosHashWLock(pHashObj);
@@ -641,6 +733,8 @@ void taosHashCleanup(SHashObj *pHashObj) {
 
   taosHashClear(pHashObj);
   tfree(pHashObj->hashList);
+  tfree(pHashObj->ctrl);
+  tfree(pHashObj->slots);
 
   // destroy mem block
   size_t memBlock = taosArrayGetSize(pHashObj->pMemBlock);
@@ -659,6 +753,10 @@ int32_t taosHashGetMaxOverflowLinkLength(SHashObj *pHashObj) {
     return 0;
   }
 
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOAGetMaxProbeLength(pHashObj);
+  }
+
   int32_t num = 0;
 
   taosHashRLock(pHashObj);
@@ -756,17 +854,20 @@ SHashNode *doCreateHashNode(const void *key, size_t keyLen, const void *pData, s
     return NULL;
   }
 
-  pNewNode->keyLen  = (uint32_t)keyLen;
-  pNewNode->hashVal = hashVal;
-  pNewNode->dataLen = (uint32_t)dsize;
-  pNewNode->refCount   = 1;
-  pNewNode->removed = 0;
-  pNewNode->next    = NULL;
+  doInitHashNode(pNewNode, key, keyLen, pData, dsize, hashVal);
+  return pNewNode;
+}
 
-  memcpy(GET_HASH_NODE_DATA(pNewNode), pData, dsize);
-  memcpy(GET_HASH_NODE_KEY(pNewNode), key, keyLen);
+void doInitHashNode(SHashNode *pNode, const void *key, size_t keyLen, const void *pData, size_t dsize, uint32_t hashVal) {
+  pNode->keyLen  = (uint32_t)keyLen;
+  pNode->hashVal = hashVal;
+  pNode->dataLen = (uint32_t)dsize;
+  pNode->refCount   = 1;
+  pNode->removed = 0;
+  pNode->next    = NULL;
 
-  return pNewNode;
+  memcpy(GET_HASH_NODE_DATA(pNode), pData, dsize);
+  memcpy(GET_HASH_NODE_KEY(pNode), key, keyLen);
 }
 
 void pushfrontNodeInEntryList(SHashEntry *pEntry, SHashNode *pNode) {
@@ -783,6 +884,11 @@ size_t taosHashGetMemSize(const SHashObj *pHashObj) {
     return 0;
   }
 
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return pHashObj->capacity * (sizeof(SHashSlot) + sizeof(uint8_t)) +
+           taosArrayGetSize(pHashObj->pMemBlock) * HASH_OA_SLAB_SIZE + sizeof(SHashObj);
+  }
+
   return (pHashObj->capacity * (sizeof(SHashEntry) + POINTER_BYTES)) + sizeof(SHashNode) * taosHashGetSize(pHashObj) + sizeof(SHashObj);
 }
 
@@ -846,6 +952,9 @@ static void *taosHashReleaseNode(SHashObj *pHashObj, void *p, int *slot) {
 
 void *taosHashIterate(SHashObj *pHashObj, void *p) {
   if (pHashObj == NULL) return NULL;
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    return taosHashOAIterate(pHashObj, p);
+  }
 
   int  slot = 0;
   char *data = NULL;
@@ -896,6 +1005,10 @@ void *taosHashIterate(SHashObj *pHashObj, void *p) {
 
 void taosHashCancelIterate(SHashObj *pHashObj, void *p) {
   if (pHashObj == NULL || p == NULL) return;
+  if (pHashObj->layout == HASH_OPEN_ADDRESSING) {
+    taosHashOACancelIterate(pHashObj, p);
+    return;
+  }
 
   // only add the read lock to disable the resize process
   taosHashRLock(pHashObj);
@@ -908,3 +1021,478 @@ void taosHashCancelIterate(SHashObj *pHashObj, void *p) {
   taosHashEntryWUnlock(pHashObj, pe);
   taosHashRUnlock(pHashObj);
 }
+
+/*
+ * The open addressing layout. The table is protected by the table lock only, and a removed node referenced by an
+ * iterator keeps its slot with a zero key length until it is released, like the removed flag of the chained layout.
+ */
+static FORCE_INLINE uint64_t taosHashOAGroup(const uint8_t *ctrl, size_t pos) {
+  uint64_t group;
+  memcpy(&group, ctrl + pos, sizeof(group));
+  return group;
+}
+
+// the bytes of the group equal to h2 have the highest bit set, a false positive is possible but rare
+static FORCE_INLINE uint64_t taosHashOAMatch(uint64_t group, uint8_t h2) {
+  uint64_t x = group ^ (HASH_OA_LSBS * h2);
+  return (x - HASH_OA_LSBS) & ~x & HASH_OA_MSBS;
+}
+
+static FORCE_INLINE uint64_t taosHashOAMatchEmpty(uint64_t group) { return group & (~group << 6) & HASH_OA_MSBS; }
+
+static FORCE_INLINE uint64_t taosHashOAMatchFree(uint64_t group) { return group & HASH_OA_MSBS; }
+
+static FORCE_INLINE size_t taosHashOAMatchPos(size_t pos, uint64_t match, size_t mask) {
+  return (pos + (BUILDIN_CTZL(match) >> 3)) & mask;
+}
+
+static FORCE_INLINE void taosHashOASetCtrl(uint8_t *ctrl, size_t capacity, size_t index, uint8_t c) {
+  ctrl[index] = c;
+  if (index < HASH_OA_GROUP_WIDTH - 1) {
+    ctrl[capacity + index] = c;
+  }
+}
+
+static int32_t taosHashOAAllocSlots(size_t capacity, uint8_t **ctrl, SHashSlot **slots) {
+  *ctrl = malloc(capacity + HASH_OA_GROUP_WIDTH - 1);
+  *slots = malloc(capacity * sizeof(SHashSlot));
+  if (*ctrl == NULL || *slots == NULL) {
+    tfree(*ctrl);
+    tfree(*slots);
+    return -1;
+  }
+
+  memset(*ctrl, HASH_OA_CTRL_EMPTY, capacity + HASH_OA_GROUP_WIDTH - 1);
+  return 0;
+}
+
+int32_t taosHashOAInit(SHashObj *pHashObj) {
+  pHashObj->capacity = MAX(pHashObj->capacity, HASH_OA_GROUP_WIDTH);
+  if (taosHashOAAllocSlots(pHashObj->capacity, &pHashObj->ctrl, &pHashObj->slots) != 0) {
+    return -1;
+  }
+
+  pHashObj->pMemBlock = taosArrayInit(8, sizeof(void *));
+  if (pHashObj->pMemBlock == NULL) {
+    tfree(pHashObj->ctrl);
+    tfree(pHashObj->slots);
+    return -1;
+  }
+
+  return 0;
+}
+
+static SHashNode *taosHashOAAllocNode(SHashObj *pHashObj, size_t keyLen, size_t dsize) {
+  size_t size = HASH_OA_NODE_SIZE(keyLen, dsize);
+  size_t cls = size >> 3;
+  if (cls >= HASH_OA_SLAB_CLASSES) {
+    return malloc(size);
+  }
+
+  SHashNode *pNode = pHashObj->freeNodes[cls];
+  if (pNode != NULL) {
+    pHashObj->freeNodes[cls] = pNode->next;
+    return pNode;
+  }
+
+  if (pHashObj->pSlab == NULL || pHashObj->slabUsed + size > HASH_OA_SLAB_SIZE) {
+    char *pSlab = malloc(HASH_OA_SLAB_SIZE);
+    if (pSlab == NULL || taosArrayPush(pHashObj->pMemBlock, &pSlab) == NULL) {
+      tfree(pSlab);
+      return NULL;
+    }
+
+    pHashObj->pSlab = pSlab;
+    pHashObj->slabUsed = 0;
+  }
+
+  pNode = (SHashNode *)(pHashObj->pSlab + pHashObj->slabUsed);
+  pHashObj->slabUsed += size;
+  return pNode;
+}
+
+static void taosHashOAFreeNode(SHashObj *pHashObj, SHashNode *pNode) {
+  size_t cls = HASH_OA_NODE_SIZE(pNode->keyLen, pNode->dataLen) >> 3;
+  if (cls >= HASH_OA_SLAB_CLASSES) {
+    free(pNode);
+    return;
+  }
+
+  pNode->next = pHashObj->freeNodes[cls];
+  pHashObj->freeNodes[cls] = pNode;
+}
+
+static SHashSlot *taosHashOAFind(SHashObj *pHashObj, const void *key, size_t keyLen, uint32_t hashVal) {
+  size_t  mask = pHashObj->capacity - 1;
+  size_t  pos = HASH_OA_H1(hashVal) & mask;
+  uint8_t h2 = HASH_OA_H2(hashVal);
+
+  for (size_t step = HASH_OA_GROUP_WIDTH;; pos = (pos + step) & mask, step += HASH_OA_GROUP_WIDTH) {
+    uint64_t group = taosHashOAGroup(pHashObj->ctrl, pos);
+
+    for (uint64_t match = taosHashOAMatch(group, h2); match != 0; match &= match - 1) {
+      SHashSlot *pSlot = &pHashObj->slots[taosHashOAMatchPos(pos, match, mask)];
+      if (pSlot->hashVal != hashVal || pSlot->keyLen != keyLen) {
+        continue;
+      }
+
+      const char *slotKey = (keyLen <= HASH_OA_INLINE_KEY) ? pSlot->key : GET_HASH_NODE_KEY(pSlot->pNode);
+      if ((*(pHashObj->equalFp))(slotKey, key, keyLen) == 0) {
+        return pSlot;
+      }
+    }
+
+    if (taosHashOAMatchEmpty(group) != 0) {
+      return NULL;
+    }
+  }
+}
+
+// the slot of a node that is still in the table, the removed ones included
+static size_t taosHashOAFindNode(SHashObj *pHashObj, SHashNode *pNode) {
+  size_t  mask = pHashObj->capacity - 1;
+  size_t  pos = HASH_OA_H1(pNode->hashVal) & mask;
+  uint8_t h2 = HASH_OA_H2(pNode->hashVal);
+
+  for (size_t step = HASH_OA_GROUP_WIDTH;; pos = (pos + step) & mask, step += HASH_OA_GROUP_WIDTH) {
+    uint64_t group = taosHashOAGroup(pHashObj->ctrl, pos);
+
+    for (uint64_t match = taosHashOAMatch(group, h2); match != 0; match &= match - 1) {
+      size_t index = taosHashOAMatchPos(pos, match, mask);
+      if (pHashObj->slots[index].pNode == pNode) {
+        return index;
+      }
+    }
+
+    assert(taosHashOAMatchEmpty(group) == 0);
+  }
+}
+
+static size_t taosHashOAFindFree(const uint8_t *ctrl, size_t capacity, uint32_t hashVal) {
+  size_t mask = capacity - 1;
+  size_t pos = HASH_OA_H1(hashVal) & mask;
+
+  for (size_t step = HASH_OA_GROUP_WIDTH;; pos = (pos + step) & mask, step += HASH_OA_GROUP_WIDTH) {
+    uint64_t match = taosHashOAMatchFree(taosHashOAGroup(ctrl, pos));
+    if (match != 0) {
+      return taosHashOAMatchPos(pos, match, mask);
+    }
+  }
+}
+
+// rehash into a table twice as large, or of the same size to drop the deleted slots
+static int32_t taosHashOAResize(SHashObj *pHashObj) {
+  if (pHashObj->numOfIters > 0) {
+    uError("hash table can not be resized during %d iterations, capacity remain:%zu", pHashObj->numOfIters,
+           pHashObj->capacity);
+    return -1;
+  }
+
+  size_t numOfFull = 0;
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    numOfFull += HASH_OA_IS_FULL(pHashObj->ctrl[i]);
+  }
+
+  size_t newCapacity = pHashObj->capacity;
+  if (numOfFull >= HASH_OA_MAX_LOAD(newCapacity) / 2) {
+    newCapacity <<= 1u;
+  }
+
+  if (newCapacity > HASH_OA_MAX_CAPACITY) {
+    uError("current capacity:%zu, maximum capacity:%d, no more element can be added", pHashObj->capacity,
+           HASH_OA_MAX_CAPACITY);
+    return -1;
+  }
+
+  int64_t    st = taosGetTimestampUs();
+  uint8_t   *ctrl = NULL;
+  SHashSlot *slots = NULL;
+  if (taosHashOAAllocSlots(newCapacity, &ctrl, &slots) != 0) {
+    uError("hash table resize failed due to out of memory, capacity remain:%zu", pHashObj->capacity);
+    return -1;
+  }
+
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    if (!HASH_OA_IS_FULL(pHashObj->ctrl[i])) {
+      continue;
+    }
+
+    SHashSlot *pSlot = &pHashObj->slots[i];
+    size_t     index = taosHashOAFindFree(ctrl, newCapacity, pSlot->hashVal);
+    slots[index] = *pSlot;
+    taosHashOASetCtrl(ctrl, newCapacity, index, HASH_OA_H2(pSlot->hashVal));
+  }
+
+  free(pHashObj->ctrl);
+  free(pHashObj->slots);
+  pHashObj->ctrl = ctrl;
+  pHashObj->slots = slots;
+  pHashObj->capacity = newCapacity;
+  pHashObj->numOfUsed = numOfFull;
+
+  uDebug("hash table resize completed, new capacity:%d, load factor:%f, elapsed time:%fms", (int32_t)newCapacity,
+         ((double)numOfFull) / newCapacity, (taosGetTimestampUs() - st) / 1000.0);
+  return 0;
+}
+
+static void taosHashOAEraseSlot(SHashObj *pHashObj, size_t index) {
+  taosHashOAFreeNode(pHashObj, pHashObj->slots[index].pNode);
+  taosHashOASetCtrl(pHashObj->ctrl, pHashObj->capacity, index, HASH_OA_CTRL_DELETED);
+  atomic_sub_fetch_64(&pHashObj->size, 1);
+}
+
+// remove the node of the slot, or only hide it if an iterator still refers to it
+static void taosHashOARemoveSlot(SHashObj *pHashObj, SHashSlot *pSlot) {
+  SHashNode *pNode = pSlot->pNode;
+
+  pNode->removed = 1;
+  if (atomic_sub_fetch_32(&pNode->refCount, 1) <= 0) {
+    taosHashOAEraseSlot(pHashObj, pSlot - pHashObj->slots);
+  } else {
+    pSlot->keyLen = 0;
+  }
+}
+
+int32_t taosHashOAPut(SHashObj *pHashObj, const void *key, size_t keyLen, void *data, size_t size, uint32_t hashVal) {
+  taosHashWLock(pHashObj);
+
+  SHashSlot *pSlot = taosHashOAFind(pHashObj, key, keyLen, hashVal);
+  if (pSlot != NULL) {
+    if (!pHashObj->enableUpdate) {
+      taosHashWUnlock(pHashObj);
+      return -1;
+    }
+
+    SHashNode *pNode = pSlot->pNode;
+    if (pNode->dataLen == size && pNode->refCount <= 1) {
+      memcpy(GET_HASH_NODE_DATA(pNode), data, size);
+      taosHashWUnlock(pHashObj);
+      return 0;
+    }
+
+    if (pNode->refCount <= 1) {
+      SHashNode *pNewNode = taosHashOAAllocNode(pHashObj, keyLen, size);
+      if (pNewNode == NULL) {
+        taosHashWUnlock(pHashObj);
+        return -1;
+      }
+
+      doInitHashNode(pNewNode, key, keyLen, data, size, hashVal);
+      taosHashOAFreeNode(pHashObj, pNode);
+      pSlot->pNode = pNewNode;
+      taosHashWUnlock(pHashObj);
+      return 0;
+    }
+
+    // the node is held by an iterator, so hide it and add a new one
+    taosHashOARemoveSlot(pHashObj, pSlot);
+  }
+
+  if (pHashObj->numOfUsed + 1 > HASH_OA_MAX_LOAD(pHashObj->capacity) && taosHashOAResize(pHashObj) != 0) {
+    taosHashWUnlock(pHashObj);
+    return -1;
+  }
+
+  SHashNode *pNewNode = taosHashOAAllocNode(pHashObj, keyLen, size);
+  if (pNewNode == NULL) {
+    uError("failed to allocate memory, reason:%s", strerror(errno));
+    taosHashWUnlock(pHashObj);
+    return -1;
+  }
+  doInitHashNode(pNewNode, key, keyLen, data, size, hashVal);
+
+  size_t index = taosHashOAFindFree(pHashObj->ctrl, pHashObj->capacity, hashVal);
+  if (pHashObj->ctrl[index] == HASH_OA_CTRL_EMPTY) {
+    pHashObj->numOfUsed += 1;
+  }
+
+  pSlot = &pHashObj->slots[index];
+  pSlot->pNode = pNewNode;
+  pSlot->hashVal = hashVal;
+  pSlot->keyLen = (uint32_t)keyLen;
+  if (keyLen <= HASH_OA_INLINE_KEY) {
+    memcpy(pSlot->key, key, keyLen);
+  }
+  taosHashOASetCtrl(pHashObj->ctrl, pHashObj->capacity, index, HASH_OA_H2(hashVal));
+
+  atomic_add_fetch_64(&pHashObj->size, 1);
+  taosHashWUnlock(pHashObj);
+  return 0;
+}
+
+// copy the data into the buffer *d if it is given, the buffer is allocated or enlarged if sz is given as well
+void *taosHashOAGet(SHashObj *pHashObj, const void *key, size_t keyLen, uint32_t hashVal, void (*fp)(void *),
+                    void **d, size_t *sz) {
+  char *data = NULL;
+
+  taosHashRLock(pHashObj);
+
+  SHashSlot *pSlot = taosHashOAFind(pHashObj, key, keyLen, hashVal);
+  if (pSlot != NULL) {
+    SHashNode *pNode = pSlot->pNode;
+    data = GET_HASH_NODE_DATA(pNode);
+    if (fp != NULL) {
+      fp(data);
+    }
+
+    if (d != NULL && sz != NULL) {
+      if (*d == NULL) {
+        *sz = pNode->dataLen;
+        *d = calloc(1, *sz);
+      } else if (*sz < pNode->dataLen) {
+        *sz = pNode->dataLen;
+        *d = realloc(*d, *sz);
+      }
+    }
+
+    if (d != NULL) {
+      memcpy(*d, data, pNode->dataLen);
+    }
+  }
+
+  taosHashRUnlock(pHashObj);
+  return data;
+}
+
+int32_t taosHashOARemove(SHashObj *pHashObj, const void *key, size_t keyLen, uint32_t hashVal, void *data,
+                         size_t dsize) {
+  taosHashWLock(pHashObj);
+
+  SHashSlot *pSlot = taosHashOAFind(pHashObj, key, keyLen, hashVal);
+  if (pSlot == NULL) {
+    taosHashWUnlock(pHashObj);
+    return -1;
+  }
+
+  if (data) memcpy(data, GET_HASH_NODE_DATA(pSlot->pNode), dsize);
+  taosHashOARemoveSlot(pHashObj, pSlot);
+
+  taosHashWUnlock(pHashObj);
+  return 0;
+}
+
+void taosHashOACondTraverse(SHashObj *pHashObj, bool (*fp)(void *, void *), void *param) {
+  taosHashWLock(pHashObj);
+
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    SHashSlot *pSlot = &pHashObj->slots[i];
+    if (!HASH_OA_IS_FULL(pHashObj->ctrl[i]) || pSlot->keyLen == 0) {
+      continue;
+    }
+
+    if (!fp(param, GET_HASH_NODE_DATA(pSlot->pNode))) {
+      taosHashOARemoveSlot(pHashObj, pSlot);
+    }
+  }
+
+  taosHashWUnlock(pHashObj);
+}
+
+void taosHashOAClear(SHashObj *pHashObj) {
+  taosHashWLock(pHashObj);
+
+  // the slab nodes are released with the slabs
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    if (HASH_OA_IS_FULL(pHashObj->ctrl[i])) {
+      SHashNode *pNode = pHashObj->slots[i].pNode;
+      if ((HASH_OA_NODE_SIZE(pNode->keyLen, pNode->dataLen) >> 3) >= HASH_OA_SLAB_CLASSES) {
+        free(pNode);
+      }
+    }
+  }
+
+  size_t numOfSlabs = taosArrayGetSize(pHashObj->pMemBlock);
+  for (size_t i = 0; i < numOfSlabs; ++i) {
+    void *p = taosArrayGetP(pHashObj->pMemBlock, i);
+    tfree(p);
+  }
+  taosArrayClear(pHashObj->pMemBlock);
+
+  memset(pHashObj->ctrl, HASH_OA_CTRL_EMPTY, pHashObj->capacity + HASH_OA_GROUP_WIDTH - 1);
+  memset(pHashObj->freeNodes, 0, sizeof(pHashObj->freeNodes));
+  pHashObj->pSlab = NULL;
+  pHashObj->slabUsed = 0;
+  pHashObj->numOfUsed = 0;
+  pHashObj->size = 0;
+
+  // the nodes held by the iterations in progress are released as well, so no iteration is left to end
+  pHashObj->numOfIters = 0;
+
+  taosHashWUnlock(pHashObj);
+}
+
+// the maximum number of groups probed to find an element
+int32_t taosHashOAGetMaxProbeLength(SHashObj *pHashObj) {
+  int32_t num = 0;
+  size_t  mask = pHashObj->capacity - 1;
+
+  taosHashRLock(pHashObj);
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    if (!HASH_OA_IS_FULL(pHashObj->ctrl[i])) {
+      continue;
+    }
+
+    size_t  pos = HASH_OA_H1(pHashObj->slots[i].hashVal) & mask;
+    int32_t len = 1;
+    for (size_t step = HASH_OA_GROUP_WIDTH; ((i - pos) & mask) >= HASH_OA_GROUP_WIDTH; step += HASH_OA_GROUP_WIDTH) {
+      pos = (pos + step) & mask;
+      len += 1;
+    }
+
+    num = MAX(num, len);
+  }
+  taosHashRUnlock(pHashObj);
+
+  return num;
+}
+
+// release the node returned by the previous iteration, and return its slot
+static size_t taosHashOAReleaseNode(SHashObj *pHashObj, void *p) {
+  SHashNode *pNode = GET_HASH_PNODE(p);
+  size_t     index = taosHashOAFindNode(pHashObj, pNode);
+
+  if (atomic_sub_fetch_32(&pNode->refCount, 1) <= 0) {
+    taosHashOAEraseSlot(pHashObj, index);
+  }
+
+  return index;
+}
+
+void *taosHashOAIterate(SHashObj *pHashObj, void *p) {
+  char *data = NULL;
+
+  taosHashWLock(pHashObj);
+
+  size_t i = 0;
+  if (p != NULL) {
+    i = taosHashOAReleaseNode(pHashObj, p) + 1;
+  }
+
+  for (; i < pHashObj->capacity; ++i) {
+    SHashSlot *pSlot = &pHashObj->slots[i];
+    if (HASH_OA_IS_FULL(pHashObj->ctrl[i]) && pSlot->keyLen != 0) {
+      atomic_add_fetch_32(&pSlot->pNode->refCount, 1);
+      data = GET_HASH_NODE_DATA(pSlot->pNode);
+      break;
+    }
+  }
+
+  // the iteration starts with the first data returned, and ends with NULL returned
+  if (p == NULL && data != NULL) {
+    pHashObj->numOfIters += 1;
+  } else if (p != NULL && data == NULL && pHashObj->numOfIters > 0) {
+    pHashObj->numOfIters -= 1;
+  }
+
+  taosHashWUnlock(pHashObj);
+  return data;
+}
+
+void taosHashOACancelIterate(SHashObj *pHashObj, void *p) {
+  taosHashWLock(pHashObj);
+  taosHashOAReleaseNode(pHashObj, p);
+  if (pHashObj->numOfIters > 0) {
+    pHashObj->numOfIters -= 1;
+  }
+  taosHashWUnlock(pHashObj);
+}
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "taoserror.h"
+#include "tbitmap.h"
+
+// an array container of more values takes more memory than a bitset
+#define BITMAP_ARRAY_MAX  4096
+#define BITMAP_BITS_WORDS 1024
+
+typedef struct SBitmapContainer {
+  uint16_t key;     // high 16 bits of the values
+  int8_t   isBits;
+  int32_t  card;
+  int32_t  cap;     // capacity of the array
+  void    *data;    // sorted uint16_t array, or bitset of BITMAP_BITS_WORDS words
+} SBitmapContainer;
+
+struct SBitmap {
+  int32_t           num;
+  int32_t           cap;
+  SBitmapContainer *containers;  // sorted by key
+};
+
+#define BITMAP_HIGH(v) ((uint16_t)((v) >> 16))
+#define BITMAP_LOW(v) ((uint16_t)((v)&0xFFFF))
+#define BITMAP_BIT_GET(b, l) ((b)[(l) >> 6] & (1ULL << ((l)&63)))
+#define BITMAP_BIT_SET(b, l) ((b)[(l) >> 6] |= (1ULL << ((l)&63)))
+#define BITMAP_BIT_CLR(b, l) ((b)[(l) >> 6] &= ~(1ULL << ((l)&63)))
+
+static FORCE_INLINE int32_t bitmapPopCount(uint64_t w) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(w);
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (int32_t)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// lower bound of v in the sorted array
+static int32_t bitmapArrayFind(const uint16_t *arr, int32_t num, uint16_t v, bool *found) {
+  int32_t s = 0, e = num;
+  while (s < e) {
+    int32_t m = (s + e) >> 1;
+    if (arr[m] < v) {
+      s = m + 1;
+    } else {
+      e = m;
+    }
+  }
+
+  *found = (s < num && arr[s] == v);
+  return s;
+}
+
+static int32_t bitmapFindContainer(const SBitmap *pBitmap, uint16_t key, bool *found) {
+  int32_t s = 0, e = pBitmap->num;
+  while (s < e) {
+    int32_t m = (s + e) >> 1;
+    if (pBitmap->containers[m].key < key) {
+      s = m + 1;
+    } else {
+      e = m;
+    }
+  }
+
+  *found = (s < pBitmap->num && pBitmap->containers[s].key == key);
+  return s;
+}
+
+static int32_t bitmapInsertContainer(SBitmap *pBitmap, int32_t idx, uint16_t key) {
+  if (pBitmap->num >= pBitmap->cap) {
+    int32_t           cap = (pBitmap->cap == 0) ? 4 : pBitmap->cap * 2;
+    SBitmapContainer *p = realloc(pBitmap->containers, sizeof(SBitmapContainer) * cap);
+    if (p == NULL) {
+      terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+      return -1;
+    }
+    pBitmap->containers = p;
+    pBitmap->cap = cap;
+  }
+
+  memmove(pBitmap->containers + idx + 1, pBitmap->containers + idx, sizeof(SBitmapContainer) * (pBitmap->num - idx));
+  memset(pBitmap->containers + idx, 0, sizeof(SBitmapContainer));
+  pBitmap->containers[idx].key = key;
+  pBitmap->num++;
+  return 0;
+}
+
+static void bitmapRemoveContainer(SBitmap *pBitmap, int32_t idx) {
+  free(pBitmap->containers[idx].data);
+  memmove(pBitmap->containers + idx, pBitmap->containers + idx + 1,
+          sizeof(SBitmapContainer) * (pBitmap->num - idx - 1));
+  pBitmap->num--;
+}
+
+static int32_t bitmapContainerToBits(SBitmapContainer *c) {
+  uint64_t *bits = calloc(BITMAP_BITS_WORDS, sizeof(uint64_t));
+  if (bits == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  uint16_t *arr = c->data;
+  for (int32_t i = 0; i < c->card; ++i) {
+    BITMAP_BIT_SET(bits, arr[i]);
+  }
+
+  free(c->data);
+  c->data = bits;
+  c->isBits = 1;
+  c->cap = 0;
+  return 0;
+}
+
+static int32_t bitmapContainerToArray(SBitmapContainer *c) {
+  uint16_t *arr = malloc(sizeof(uint16_t) * MAX(c->card, 1));
+  if (arr == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  uint64_t *bits = c->data;
+  int32_t   n = 0;
+  for (int32_t w = 0; w < BITMAP_BITS_WORDS; ++w) {
+    uint64_t word = bits[w];
+    while (word != 0) {
+      arr[n++] = (uint16_t)((w << 6) + BUILDIN_CTZL(word));
+      word &= word - 1;
+    }
+  }
+
+  free(c->data);
+  c->data = arr;
+  c->isBits = 0;
+  c->cap = MAX(c->card, 1);
+  return 0;
+}
+
+static int32_t bitmapContainerDup(SBitmapContainer *dst, const SBitmapContainer *src) {
+  *dst = *src;
+  size_t size = src->isBits ? sizeof(uint64_t) * BITMAP_BITS_WORDS : sizeof(uint16_t) * src->cap;
+  dst->data = malloc(MAX(size, 1));
+  if (dst->data == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  memcpy(dst->data, src->data, size);
+  return 0;
+}
+
+SBitmap *tBitmapCreate() {
+  SBitmap *pBitmap = calloc(1, sizeof(SBitmap));
+  if (pBitmap == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+  }
+
+  return pBitmap;
+}
+
+void tBitmapDestroy(SBitmap *pBitmap) {
+  if (pBitmap == NULL) return;
+
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    free(pBitmap->containers[i].data);
+  }
+  free(pBitmap->containers);
+  free(pBitmap);
+}
+
+SBitmap *tBitmapDup(const SBitmap *pBitmap) {
+  SBitmap *pNew = tBitmapCreate();
+  if (pNew == NULL || pBitmap->num == 0) {
+    return pNew;
+  }
+
+  pNew->containers = malloc(sizeof(SBitmapContainer) * pBitmap->num);
+  if (pNew->containers == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    free(pNew);
+    return NULL;
+  }
+  pNew->cap = pBitmap->num;
+
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    if (bitmapContainerDup(&pNew->containers[i], &pBitmap->containers[i]) < 0) {
+      tBitmapDestroy(pNew);
+      return NULL;
+    }
+    pNew->num++;
+  }
+
+  return pNew;
+}
+
+int32_t tBitmapAdd(SBitmap *pBitmap, uint32_t val) {
+  uint16_t low = BITMAP_LOW(val);
+  bool     found = false;
+  int32_t  idx = bitmapFindContainer(pBitmap, BITMAP_HIGH(val), &found);
+  if (!found && bitmapInsertContainer(pBitmap, idx, BITMAP_HIGH(val)) < 0) {
+    return -1;
+  }
+
+  SBitmapContainer *c = &pBitmap->containers[idx];
+  if (!c->isBits) {
+    int32_t pos = bitmapArrayFind(c->data, c->card, low, &found);
+    if (found) return 0;
+
+    if (c->card < BITMAP_ARRAY_MAX) {
+      if (c->card >= c->cap) {
+        int32_t   cap = MIN((c->cap == 0) ? 4 : c->cap * 2, BITMAP_ARRAY_MAX);
+        uint16_t *arr = realloc(c->data, sizeof(uint16_t) * cap);
+        if (arr == NULL) {
+          terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+          if (c->card == 0) bitmapRemoveContainer(pBitmap, idx);
+          return -1;
+        }
+        c->data = arr;
+        c->cap = cap;
+      }
+
+      uint16_t *arr = c->data;
+      memmove(arr + pos + 1, arr + pos, sizeof(uint16_t) * (c->card - pos));
+      arr[pos] = low;
+      c->card++;
+      return 0;
+    }
+
+    if (bitmapContainerToBits(c) < 0) return -1;
+  }
+
+  uint64_t *bits = c->data;
+  if (!BITMAP_BIT_GET(bits, low)) {
+    BITMAP_BIT_SET(bits, low);
+    c->card++;
+  }
+  return 0;
+}
+
+void tBitmapRemove(SBitmap *pBitmap, uint32_t val) {
+  uint16_t low = BITMAP_LOW(val);
+  bool     found = false;
+  int32_t  idx = bitmapFindContainer(pBitmap, BITMAP_HIGH(val), &found);
+  if (!found) return;
+
+  SBitmapContainer *c = &pBitmap->containers[idx];
+  if (c->isBits) {
+    uint64_t *bits = c->data;
+    if (!BITMAP_BIT_GET(bits, low)) return;
+
+    BITMAP_BIT_CLR(bits, low);
+    c->card--;
+    if (c->card > 0 && c->card <= BITMAP_ARRAY_MAX) {
+      // keep the bitset if out of memory, it is still valid
+      bitmapContainerToArray(c);
+    }
+  } else {
+    uint16_t *arr = c->data;
+    int32_t   pos = bitmapArrayFind(arr, c->card, low, &found);
+    if (!found) return;
+
+    memmove(arr + pos, arr + pos + 1, sizeof(uint16_t) * (c->card - pos - 1));
+    c->card--;
+  }
+
+  if (c->card == 0) {
+    bitmapRemoveContainer(pBitmap, idx);
+  }
+}
+
+bool tBitmapContains(const SBitmap *pBitmap, uint32_t val) {
+  bool    found = false;
+  int32_t idx = bitmapFindContainer(pBitmap, BITMAP_HIGH(val), &found);
+  if (!found) return false;
+
+  const SBitmapContainer *c = &pBitmap->containers[idx];
+  if (c->isBits) {
+    return BITMAP_BIT_GET((uint64_t *)c->data, BITMAP_LOW(val)) != 0;
+  }
+
+  bitmapArrayFind(c->data, c->card, BITMAP_LOW(val), &found);
+  return found;
+}
+
+int64_t tBitmapCardinality(const SBitmap *pBitmap) {
+  int64_t card = 0;
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    card += pBitmap->containers[i].card;
+  }
+
+  return card;
+}
+
+int64_t tBitmapMemSize(const SBitmap *pBitmap) {
+  int64_t size = sizeof(SBitmap) + sizeof(SBitmapContainer) * pBitmap->cap;
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    const SBitmapContainer *c = &pBitmap->containers[i];
+    size += c->isBits ? sizeof(uint64_t) * BITMAP_BITS_WORDS : sizeof(uint16_t) * c->cap;
+  }
+
+  return size;
+}
+
+// c = c & o, the result is kept in the type of the smaller container
+static int32_t bitmapContainerAnd(SBitmapContainer *c, const SBitmapContainer *o) {
+  if (!c->isBits) {
+    uint16_t *arr = c->data;
+    int32_t   n = 0;
+    if (o->isBits) {
+      for (int32_t i = 0; i < c->card; ++i) {
+        if (BITMAP_BIT_GET((uint64_t *)o->data, arr[i])) arr[n++] = arr[i];
+      }
+    } else {
+      const uint16_t *oarr = o->data;
+      for (int32_t i = 0, j = 0; i < c->card && j < o->card;) {
+        if (arr[i] < oarr[j]) {
+          i++;
+        } else if (arr[i] > oarr[j]) {
+          j++;
+        } else {
+          arr[n++] = arr[i];
+          i++;
+          j++;
+        }
+      }
+    }
+
+    c->card = n;
+    return 0;
+  }
+
+  uint64_t *bits = c->data;
+  if (o->isBits) {
+    const uint64_t *obits = o->data;
+    int32_t         card = 0;
+    for (int32_t w = 0; w < BITMAP_BITS_WORDS; ++w) {
+      bits[w] &= obits[w];
+      card += bitmapPopCount(bits[w]);
+    }
+
+    c->card = card;
+    if (card > 0 && card <= BITMAP_ARRAY_MAX) {
+      bitmapContainerToArray(c);
+    }
+    return 0;
+  }
+
+  uint16_t *arr = malloc(sizeof(uint16_t) * MAX(o->card, 1));
+  if (arr == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  const uint16_t *oarr = o->data;
+  int32_t         n = 0;
+  for (int32_t j = 0; j < o->card; ++j) {
+    if (BITMAP_BIT_GET(bits, oarr[j])) arr[n++] = oarr[j];
+  }
+
+  free(c->data);
+  c->data = arr;
+  c->isBits = 0;
+  c->cap = MAX(o->card, 1);
+  c->card = n;
+  return 0;
+}
+
+// c = c | o
+static int32_t bitmapContainerOr(SBitmapContainer *c, const SBitmapContainer *o) {
+  if (!c->isBits && !o->isBits && c->card + o->card <= BITMAP_ARRAY_MAX) {
+    uint16_t *arr = malloc(sizeof(uint16_t) * (c->card + o->card));
+    if (arr == NULL) {
+      terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    const uint16_t *carr = c->data, *oarr = o->data;
+    int32_t         i = 0, j = 0, n = 0;
+    while (i < c->card && j < o->card) {
+      if (carr[i] < oarr[j]) {
+        arr[n++] = carr[i++];
+      } else if (carr[i] > oarr[j]) {
+        arr[n++] = oarr[j++];
+      } else {
+        arr[n++] = carr[i++];
+        j++;
+      }
+    }
+    while (i < c->card) arr[n++] = carr[i++];
+    while (j < o->card) arr[n++] = oarr[j++];
+
+    free(c->data);
+    c->data = arr;
+    c->cap = c->card + o->card;
+    c->card = n;
+    return 0;
+  }
+
+  if (!c->isBits && bitmapContainerToBits(c) < 0) {
+    return -1;
+  }
+
+  uint64_t *bits = c->data;
+  int32_t   card = 0;
+  if (o->isBits) {
+    const uint64_t *obits = o->data;
+    for (int32_t w = 0; w < BITMAP_BITS_WORDS; ++w) {
+      bits[w] |= obits[w];
+      card += bitmapPopCount(bits[w]);
+    }
+  } else {
+    const uint16_t *oarr = o->data;
+    card = c->card;
+    for (int32_t j = 0; j < o->card; ++j) {
+      if (!BITMAP_BIT_GET(bits, oarr[j])) {
+        BITMAP_BIT_SET(bits, oarr[j]);
+        card++;
+      }
+    }
+  }
+
+  c->card = card;
+  return 0;
+}
+
+int32_t tBitmapAnd(SBitmap *pDst, const SBitmap *pSrc) {
+  int32_t n = 0, j = 0, code = 0;
+
+  for (int32_t i = 0; i < pDst->num; ++i) {
+    SBitmapContainer *c = &pDst->containers[i];
+    while (j < pSrc->num && pSrc->containers[j].key < c->key) {
+      j++;
+    }
+
+    if (code == 0 && j < pSrc->num && pSrc->containers[j].key == c->key) {
+      code = bitmapContainerAnd(c, &pSrc->containers[j]);
+    } else {
+      c->card = 0;
+    }
+
+    if (c->card > 0) {
+      pDst->containers[n++] = *c;
+    } else {
+      free(c->data);
+    }
+  }
+
+  pDst->num = n;
+  return code;
+}
+
+int32_t tBitmapOr(SBitmap *pDst, const SBitmap *pSrc) {
+  for (int32_t j = 0; j < pSrc->num; ++j) {
+    const SBitmapContainer *o = &pSrc->containers[j];
+
+    bool    found = false;
+    int32_t idx = bitmapFindContainer(pDst, o->key, &found);
+    if (found) {
+      if (bitmapContainerOr(&pDst->containers[idx], o) < 0) return -1;
+      continue;
+    }
+
+    if (bitmapInsertContainer(pDst, idx, o->key) < 0) return -1;
+    if (bitmapContainerDup(&pDst->containers[idx], o) < 0) {
+      pDst->containers[idx].data = NULL;
+      bitmapRemoveContainer(pDst, idx);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+void tBitmapIterInit(SBitmapIter *pIter, const SBitmap *pBitmap) {
+  pIter->pBitmap = pBitmap;
+  pIter->c = 0;
+  pIter->i = 0;
+  pIter->word = 0;
+}
+
+bool tBitmapIterNext(SBitmapIter *pIter, uint32_t *val) {
+  const SBitmap *pBitmap = pIter->pBitmap;
+
+  while (pIter->c < pBitmap->num) {
+    const SBitmapContainer *c = &pBitmap->containers[pIter->c];
+    uint32_t                high = ((uint32_t)c->key) << 16;
+
+    if (c->isBits) {
+      const uint64_t *bits = c->data;
+      while (pIter->word == 0 && pIter->i < BITMAP_BITS_WORDS) {
+        pIter->word = bits[pIter->i++];
+      }
+
+      if (pIter->word != 0) {
+        *val = high | (uint32_t)(((pIter->i - 1) << 6) + BUILDIN_CTZL(pIter->word));
+        pIter->word &= pIter->word - 1;
+        return true;
+      }
+    } else if (pIter->i < c->card) {
+      *val = high | ((const uint16_t *)c->data)[pIter->i++];
+      return true;
+    }
+
+    pIter->c++;
+    pIter->i = 0;
+    pIter->word = 0;
+  }
+
+  return false;
+}
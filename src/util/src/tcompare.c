@@ -512,41 +512,125 @@ int32_t compareStrRegexCompNMatch(const void* pLeft, const void* pRight) {
   return compareStrRegexComp(pLeft, pRight) ? 0 : 1;
 }
 
-int32_t compareStrRegexComp(const void* pLeft, const void* pRight) {
-  size_t sz = varDataLen(pRight);
-  char *pattern = malloc(sz + 1);
-  memcpy(pattern, varDataVal(pRight), varDataLen(pRight));
-  pattern[sz] = 0;
+struct SRegexMatcher {
+  char   *pattern;
+  size_t  len;
+  int     code;  // result of regcomp, a pattern failed to compile matches nothing
+  regex_t regex;
+  char   *buf;
+  size_t  bufLen;
+};
 
-  sz = varDataLen(pLeft);
-  char *str = malloc(sz + 1);
-  memcpy(str, varDataVal(pLeft), sz);
-  str[sz] = 0;
+SRegexMatcher *regexMatcherCreate(const char *pattern, size_t len) {
+  SRegexMatcher *pMatcher = calloc(1, sizeof(SRegexMatcher));
+  if (pMatcher == NULL) {
+    return NULL;
+  }
 
-  int errCode = 0;
-  regex_t regex;
-  char    msgbuf[256] = {0};
-
-  int cflags = REG_EXTENDED;
-  if ((errCode = regcomp(&regex, pattern, cflags)) != 0) {
-    regerror(errCode, &regex, msgbuf, sizeof(msgbuf));
-    uError("Failed to compile regex pattern %s. reason %s", pattern, msgbuf);
-    regfree(&regex);
-    free(str);
-    free(pattern);
+  pMatcher->pattern = malloc(len + 1);
+  if (pMatcher->pattern == NULL) {
+    free(pMatcher);
+    return NULL;
+  }
+  memcpy(pMatcher->pattern, pattern, len);
+  pMatcher->pattern[len] = 0;
+  pMatcher->len = len;
+
+  // the matched positions are never used, REG_NOSUB lets regexec skip tracking them
+  pMatcher->code = regcomp(&pMatcher->regex, pMatcher->pattern, REG_EXTENDED | REG_NOSUB);
+  if (pMatcher->code != 0) {
+    char msgbuf[256] = {0};
+    regerror(pMatcher->code, &pMatcher->regex, msgbuf, sizeof(msgbuf));
+    uError("Failed to compile regex pattern %s. reason %s", pMatcher->pattern, msgbuf);
+  }
+
+  return pMatcher;
+}
+
+void regexMatcherDestroy(SRegexMatcher *pMatcher) {
+  if (pMatcher == NULL) {
+    return;
+  }
+
+  if (pMatcher->code == 0) {
+    regfree(&pMatcher->regex);
+  }
+  free(pMatcher->pattern);
+  free(pMatcher->buf);
+  free(pMatcher);
+}
+
+// return 0 if the string matches the pattern and 1 otherwise
+int32_t regexMatcherExec(SRegexMatcher *pMatcher, const char *str, size_t len) {
+  if (pMatcher->code != 0) {
     return 1;
   }
 
-  errCode = regexec(&regex, str, 0, NULL, 0);
+  if (len + 1 > pMatcher->bufLen) {
+    size_t bufLen = MAX(len + 1, pMatcher->bufLen * 2);
+    char  *buf = realloc(pMatcher->buf, bufLen);
+    if (buf == NULL) {
+      return 1;
+    }
+
+    pMatcher->buf = buf;
+    pMatcher->bufLen = bufLen;
+  }
+
+  memcpy(pMatcher->buf, str, len);
+  pMatcher->buf[len] = 0;
+
+  int errCode = regexec(&pMatcher->regex, pMatcher->buf, 0, NULL, 0);
   if (errCode != 0 && errCode != REG_NOMATCH) {
-    regerror(errCode, &regex, msgbuf, sizeof(msgbuf));
-    uDebug("Failed to match %s with pattern %s, reason %s", str, pattern, msgbuf)
+    char msgbuf[256] = {0};
+    regerror(errCode, &pMatcher->regex, msgbuf, sizeof(msgbuf));
+    uDebug("Failed to match %s with pattern %s, reason %s", pMatcher->buf, pMatcher->pattern, msgbuf);
   }
-  int32_t result = (errCode == 0) ? 0 : 1;
-  regfree(&regex);
-  free(str);
-  free(pattern);
-  return result;
+
+  return (errCode == 0) ? 0 : 1;
+}
+
+// The last pattern compiled by each thread. The callers evaluate the same pattern over many rows, so it is
+// compiled again only when the pattern changes. The matcher is freed by the key destructor when the thread exits.
+static pthread_key_t  tsRegexMatcherKey;
+static pthread_once_t tsRegexMatcherKeyOnce = PTHREAD_ONCE_INIT;
+static int32_t        tsRegexMatcherKeyErr = 0;
+
+static void regexMatcherKeyDestroy(void *param) { regexMatcherDestroy((SRegexMatcher *)param); }
+
+static void regexMatcherKeyInit(void) {
+  tsRegexMatcherKeyErr = pthread_key_create(&tsRegexMatcherKey, regexMatcherKeyDestroy);
+  if (tsRegexMatcherKeyErr != 0) {
+    uError("failed to create the thread key of regex matchers, reason %s", strerror(tsRegexMatcherKeyErr));
+  }
+}
+
+int32_t compareStrRegexComp(const void* pLeft, const void* pRight) {
+  size_t len = varDataLen(pRight);
+
+  pthread_once(&tsRegexMatcherKeyOnce, regexMatcherKeyInit);
+  if (tsRegexMatcherKeyErr != 0) {
+    SRegexMatcher *pMatcher = regexMatcherCreate(varDataVal(pRight), len);
+    if (pMatcher == NULL) {
+      return 1;
+    }
+
+    int32_t ret = regexMatcherExec(pMatcher, varDataVal(pLeft), varDataLen(pLeft));
+    regexMatcherDestroy(pMatcher);
+    return ret;
+  }
+
+  SRegexMatcher *pMatcher = (SRegexMatcher *)pthread_getspecific(tsRegexMatcherKey);
+  if (pMatcher == NULL || pMatcher->len != len || memcmp(pMatcher->pattern, varDataVal(pRight), len) != 0) {
+    regexMatcherDestroy(pMatcher);
+    pMatcher = regexMatcherCreate(varDataVal(pRight), len);
+    pthread_setspecific(tsRegexMatcherKey, pMatcher);
+    if (pMatcher == NULL) {
+      return 1;
+    }
+  }
+
+  return regexMatcherExec(pMatcher, varDataVal(pLeft), varDataLen(pLeft));
 }
 
 int32_t compareStrContainJson(const void* pLeft, const void* pRight) {
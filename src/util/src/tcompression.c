@@ -38,6 +38,10 @@
  * STRING Compression Algorithm:
  *   We us LZ4 method to compress the string type.
  *
+ * ZLIB Compression:
+ *   Columns configured by columnCodec to be compressed harder are deflated by zlib, after
+ *   the one stage compression of their type if they are not strings.
+ *
  * FLOAT Compression Algorithm:
  *   We use the same method with Akumuli to compress float and double types. The compression
  *   algorithm assumes the float/double values change slightly. So we take the XOR between two
@@ -45,15 +49,24 @@
  *   of leading zeros are larger than the trailing zeros, then record the last serveral bytes
  *   of the XORed value with informations. If not, record the first corresponding bytes.
  *
+ * SIMD Decompression:
+ *   On x86 the integers and timestamps are decompressed with AVX2, or SSE4.2 if AVX2 is not
+ *   supported by the cpu. The fields of a simple 8B word, or the delta of deltas of a chunk of
+ *   timestamps, are extracted first, then zigzag decoded and prefix summed several values at a
+ *   time. The output is the same as the scalar decompression.
+ *
  */
 
 #include "os.h"
 #include "lz4.h"
+#include "zlib.h"
 #ifdef TD_TSZ  
   #include "td_sz.h"
 #endif
 #include "taosdef.h"
 #include "tscompression.h"
+#include "hashfunc.h"
+#include "ttype.h"
 #include "tulog.h"
 #include "tglobal.h"
 
@@ -66,6 +79,19 @@ static const int TEST_NUMBER = 1;
 #define ZIGZAG_ENCODE(T, v) ((u##T)((v) >> (sizeof(T) * 8 - 1))) ^ (((u##T)(v)) << 1)  // zigzag encode
 #define ZIGZAG_DECODE(T, v) ((v) >> 1) ^ -((T)((v)&1))                                 // zigzag decode
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(_TD_ARM_) && !defined(_TD_MIPS_) && \
+    !defined(WINDOWS)
+#define TD_DECOMPRESS_SIMD
+#include <immintrin.h>
+#endif
+
+#define TS_DECOMPRESS_CHUNK 128  // timestamps decoded at a time by SIMD, must be even
+
+static const char tsS8bBits[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+static const int  tsS8bElems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+
+static int32_t tsDecompressSimdLevel = -1;  // resolved at the first decompression
+
 #ifdef TD_TSZ
 bool lossyFloat  = false;
 bool lossyDouble = false;
@@ -73,16 +99,11 @@ bool lossyDouble = false;
 // init call
 int tsCompressInit(){
   // config 
-  if(lossyColumns[0] == 0){
-    lossyFloat = false;
-    lossyDouble = false;
-    return 0;
-  }
-
   lossyFloat  = strstr(lossyColumns, "float") != NULL;
   lossyDouble = strstr(lossyColumns, "double") != NULL;
 
-  if(lossyFloat == false && lossyDouble == false)
+  // the columns set to the tsz codec by columnCodec are lossy compressed whatever lossyColumns is
+  if(lossyFloat == false && lossyDouble == false && strstr(tsColumnCodec, "tsz") == NULL)
         return 0;
   
   tdszInit(fPrecision, dPrecision, maxRange, curRange, Compressor);
@@ -232,6 +253,161 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
   return opos;
 }
 
+int tsGetCpuSimdLevel() {
+#ifdef TD_DECOMPRESS_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return TSDB_SIMD_AVX2;
+  if (__builtin_cpu_supports("sse4.2")) return TSDB_SIMD_SSE42;
+#endif
+  return TSDB_SIMD_NONE;
+}
+
+// Use the instruction set of level at most, return the level used
+int tsSetDecompressSimdLevel(int level) {
+  int cpuLevel = tsGetCpuSimdLevel();
+  if (level < TSDB_SIMD_NONE) level = TSDB_SIMD_NONE;
+  tsDecompressSimdLevel = (level < cpuLevel) ? level : cpuLevel;
+  return tsDecompressSimdLevel;
+}
+
+static FORCE_INLINE int tsGetDecompressSimdLevel() {
+  if (tsDecompressSimdLevel < 0) {
+    tsDecompressSimdLevel = tsGetCpuSimdLevel();
+  }
+  return tsDecompressSimdLevel;
+}
+
+#ifdef TD_DECOMPRESS_SIMD
+static FORCE_INLINE void tsStoreDecodedINT(char *const output, int pos, const int64_t *values, int n, const char type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BIGINT:
+      memcpy((int64_t *)output + pos, values, n * LONG_BYTES);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      for (int i = 0; i < n; i++) *((int32_t *)output + pos + i) = (int32_t)values[i];
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      for (int i = 0; i < n; i++) *((int16_t *)output + pos + i) = (int16_t)values[i];
+      break;
+    case TSDB_DATA_TYPE_TINYINT:
+      for (int i = 0; i < n; i++) *((int8_t *)output + pos + i) = (int8_t)values[i];
+      break;
+  }
+}
+
+// Words of a few wide fields are not worth the vector setup
+static FORCE_INLINE void tsDecodeS8bWord(uint64_t w, int n, int64_t *values, int64_t prev_value) {
+  int      bit = tsS8bBits[w & INT64MASK(4)];
+  uint64_t mask = INT64MASK(bit);
+
+  w >>= 4;
+  for (int i = 0; i < n; i++, w >>= bit) {
+    uint64_t zigzag_value = w & mask;
+    prev_value += (int64_t)ZIGZAG_DECODE(int64_t, zigzag_value);
+    values[i] = prev_value;
+  }
+}
+
+// prefix sum of the 4 lanes
+__attribute__((target("avx2"))) static FORCE_INLINE __m256i tsPrefixSumAvx2(__m256i v) {
+  v = _mm256_add_epi64(v, _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)),
+                                             _mm256_setzero_si256(), 0x03));
+  return _mm256_add_epi64(v, _mm256_permute2x128_si256(v, v, 0x08));
+}
+
+__attribute__((target("avx2"))) static FORCE_INLINE __m256i tsZigzagDecodeAvx2(__m256i v) {
+  return _mm256_xor_si256(_mm256_srli_epi64(v, 1),
+                          _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(v, _mm256_set1_epi64x(1))));
+}
+
+__attribute__((target("sse4.2"))) static FORCE_INLINE __m128i tsPrefixSumSse42(__m128i v) {
+  return _mm_add_epi64(v, _mm_slli_si128(v, 8));
+}
+
+__attribute__((target("sse4.2"))) static FORCE_INLINE __m128i tsZigzagDecodeSse42(__m128i v) {
+  return _mm_xor_si128(_mm_srli_epi64(v, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi64x(1))));
+}
+
+// Decode the simple 8B words 4 values at a time, ip points to the first word
+__attribute__((target("avx2"))) static void tsDecompressINTAvx2(const char *ip, const int nelements,
+                                                                   char *const output, const char type) {
+  int64_t values[240];
+  int64_t prev_value = 0;
+
+  for (int count = 0; count < nelements; ip += LONG_BYTES) {
+    uint64_t w = 0;
+    memcpy(&w, ip, LONG_BYTES);
+
+    int selector = (int)(w & INT64MASK(4));
+    int n = MIN(tsS8bElems[selector], nelements - count);
+
+    if (selector == 0 || selector == 1) {
+      for (int i = 0; i < n; i++) values[i] = prev_value;
+    } else if (n <= 4) {
+      tsDecodeS8bWord(w, n, values, prev_value);
+    } else {
+      int     bit = tsS8bBits[selector];
+      __m256i vw = _mm256_set1_epi64x((int64_t)w);
+      __m256i mask = _mm256_set1_epi64x((int64_t)INT64MASK(bit));
+      __m256i shift = _mm256_setr_epi64x(4, 4 + bit, 4 + 2 * bit, 4 + 3 * bit);
+      __m256i step = _mm256_set1_epi64x(4 * bit);
+      __m256i prev = _mm256_set1_epi64x(prev_value);
+
+      for (int i = 0; i < n; i += 4) {
+        __m256i v = _mm256_and_si256(_mm256_srlv_epi64(vw, shift), mask);
+        v = _mm256_add_epi64(tsPrefixSumAvx2(tsZigzagDecodeAvx2(v)), prev);
+        _mm256_storeu_si256((__m256i *)(values + i), v);
+        prev = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+        shift = _mm256_add_epi64(shift, step);
+      }
+    }
+
+    prev_value = values[n - 1];
+    tsStoreDecodedINT(output, count, values, n, type);
+    count += n;
+  }
+}
+
+// Decode the simple 8B words 2 values at a time, ip points to the first word
+__attribute__((target("sse4.2"))) static void tsDecompressINTSse42(const char *ip, const int nelements,
+                                                                      char *const output, const char type) {
+  int64_t values[240];
+  int64_t prev_value = 0;
+
+  for (int count = 0; count < nelements; ip += LONG_BYTES) {
+    uint64_t w = 0;
+    memcpy(&w, ip, LONG_BYTES);
+
+    int selector = (int)(w & INT64MASK(4));
+    int n = MIN(tsS8bElems[selector], nelements - count);
+
+    if (selector == 0 || selector == 1) {
+      for (int i = 0; i < n; i++) values[i] = prev_value;
+    } else if (n <= 2) {
+      tsDecodeS8bWord(w, n, values, prev_value);
+    } else {
+      int     bit = tsS8bBits[selector];
+      __m128i vw = _mm_set1_epi64x((int64_t)w);
+      __m128i mask = _mm_set1_epi64x((int64_t)INT64MASK(bit));
+      __m128i prev = _mm_set1_epi64x(prev_value);
+
+      for (int i = 0; i < n; i += 2) {
+        __m128i lo = _mm_srl_epi64(vw, _mm_cvtsi32_si128(4 + bit * i));
+        __m128i hi = _mm_srl_epi64(vw, _mm_cvtsi32_si128(4 + bit * (i + 1)));
+        __m128i v = _mm_and_si128(_mm_unpacklo_epi64(lo, hi), mask);
+        v = _mm_add_epi64(tsPrefixSumSse42(tsZigzagDecodeSse42(v)), prev);
+        _mm_storeu_si128((__m128i *)(values + i), v);
+        prev = _mm_unpackhi_epi64(v, v);
+      }
+    }
+
+    prev_value = values[n - 1];
+    tsStoreDecodedINT(output, count, values, n, type);
+    count += n;
+  }
+}
+#endif
+
 int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type) {
   int word_length = 0;
   switch (type) {
@@ -258,6 +434,19 @@ int tsDecompressINTImp(const char *const input, const int nelements, char *const
     return nelements * word_length;
   }
 
+#ifdef TD_DECOMPRESS_SIMD
+  switch (tsGetDecompressSimdLevel()) {
+    case TSDB_SIMD_AVX2:
+      tsDecompressINTAvx2(input + 1, nelements, output, type);
+      return nelements * word_length;
+    case TSDB_SIMD_SSE42:
+      tsDecompressINTSse42(input + 1, nelements, output, type);
+      return nelements * word_length;
+    default:
+      break;
+  }
+#endif
+
   // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
   // 12  13  14  15
   char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
@@ -468,6 +657,276 @@ int tsDecompressStringImp(const char *const input, int compressedSize, char *con
   }
 }
 
+/* ----------------------------------------Zlib Compression
+ * ---------------------------------------------- */
+// Slower than LZ4 but smaller, for the columns configured to be compressed harder. The first byte is 0 if the data
+// is kept as it is, or 1 if it is deflated.
+int tsCompressZlibImp(const char *const input, int inputSize, char *const output, int outputSize, int level) {
+  uLongf dlen = (outputSize > 1) ? (uLongf)(outputSize - 1) : 0;
+
+  if (level < Z_BEST_SPEED || level > Z_BEST_COMPRESSION) level = TS_ZLIB_DEFAULT_LEVEL;
+
+  int code = compress2((Bytef *)(output + 1), &dlen, (const Bytef *)input, (uLong)inputSize, level);
+  if (code != Z_OK || dlen >= (uLongf)inputSize) {
+    if (inputSize + 1 > outputSize) return -1;
+    output[0] = 0;
+    memcpy(output + 1, input, inputSize);
+    return inputSize + 1;
+  }
+
+  output[0] = 1;
+  return (int)dlen + 1;
+}
+
+int tsDecompressZlibImp(const char *const input, int compressedSize, char *const output, int outputSize) {
+  if (compressedSize < 1) return -1;
+
+  if (input[0] == 0) {
+    if (compressedSize - 1 > outputSize) return -1;
+    memcpy(output, input + 1, compressedSize - 1);
+    return compressedSize - 1;
+  } else if (input[0] == 1) {
+    uLongf dlen = (uLongf)outputSize;
+    int    code = uncompress((Bytef *)output, &dlen, (const Bytef *)(input + 1), (uLong)(compressedSize - 1));
+    if (code != Z_OK) {
+      uError("Failed to decompress data with zlib, code:%d", code);
+      return -1;
+    }
+    return (int)dlen;
+  } else {
+    uError("Invalid decompress zlib indicator:%d", input[0]);
+    return -1;
+  }
+}
+
+/* ----------------------------------------String Dictionary Compression
+ * ---------------------------------------------- */
+// The strings of a column, stored one after another as VarDataT, are encoded as
+//   STRING_DICT_COMPRESS | nEntries(int32) | dictLen(int32) | entries | bits(int8) | codesComp(int8) | codesLen(int32)
+//   | codes
+// The distinct strings are kept in the entries in the order they first appear, and the code of each row is packed
+// in bits bits from the lowest bit of the codes. The codes are compressed by LZ4 if codesComp is 1, the entries never
+// are, so that they can be read by tsGetStringDict without decoding the rows.
+#define STRING_DICT_HEAD_SIZE (1 + sizeof(int32_t) * 2)
+#define STRING_DICT_CODES_HEAD_SIZE (2 + sizeof(int32_t))
+
+static FORCE_INLINE int32_t tsStringDictBits(int32_t nEntries) {
+  int32_t bits = 0;
+  while ((1 << bits) < nEntries) bits++;
+  return bits;
+}
+
+// Return -1 if the column has too many distinct values or the encoded size is not less than outputSize, the caller
+// compresses it in another way then.
+int tsCompressStringDictImp(const char *const input, int inputSize, const int nelements, char *const output,
+                            int outputSize) {
+  int32_t maxEntries = MIN(nelements / TS_STRING_DICT_MIN_RATIO, TS_STRING_DICT_MAX_ENTRIES);
+  if (maxEntries < 1) maxEntries = 1;
+
+  int32_t nSlots = 16;
+  while (nSlots < maxEntries * 2) nSlots <<= 1;
+
+  // slots of the hash table with entry index + 1, offsets of the entries in input and code of each row
+  int32_t  rawLen = (int32_t)(((int64_t)nelements * tsStringDictBits(maxEntries) + 7) / 8);
+  int32_t *slots = (int32_t *)calloc(1, sizeof(int32_t) * (nSlots + maxEntries) + sizeof(uint16_t) * nelements + rawLen);
+  if (slots == NULL) return -1;
+  int32_t * offsets = slots + nSlots;
+  uint16_t *codes = (uint16_t *)(offsets + maxEntries);
+  uint8_t * packed = (uint8_t *)(codes + nelements);
+
+  int     ret = -1;
+  int32_t nEntries = 0;
+  int32_t dictLen = 0;
+  int32_t pos = 0;
+  for (int i = 0; i < nelements; i++) {
+    if (pos + (int32_t)VARSTR_HEADER_SIZE > inputSize) goto _exit;
+    const char *val = input + pos;
+    int32_t     tlen = (int32_t)varDataTLen(val);
+    if (pos + tlen > inputSize) goto _exit;
+
+    uint32_t h = MurmurHash3_32(val, tlen) & (nSlots - 1);
+    while (true) {
+      int32_t e = slots[h];
+      if (e == 0) {
+        if (nEntries >= maxEntries) goto _exit;
+        offsets[nEntries] = pos;
+        slots[h] = ++nEntries;
+        dictLen += tlen;
+        codes[i] = (uint16_t)(nEntries - 1);
+        break;
+      }
+
+      const char *ev = input + offsets[e - 1];
+      if (varDataTLen(ev) == tlen && memcmp(ev, val, tlen) == 0) {
+        codes[i] = (uint16_t)(e - 1);
+        break;
+      }
+      h = (h + 1) & (nSlots - 1);
+    }
+
+    pos += tlen;
+  }
+
+  int32_t bits = tsStringDictBits(nEntries);
+  rawLen = (int32_t)(((int64_t)nelements * bits + 7) / 8);
+
+  int32_t opos = STRING_DICT_HEAD_SIZE + dictLen + STRING_DICT_CODES_HEAD_SIZE;
+  if (opos + rawLen >= MIN(outputSize, inputSize + 1)) goto _exit;
+
+  output[0] = STRING_DICT_COMPRESS;
+  memcpy(output + 1, &nEntries, sizeof(int32_t));
+  memcpy(output + 1 + sizeof(int32_t), &dictLen, sizeof(int32_t));
+  char *dict = output + STRING_DICT_HEAD_SIZE;
+  for (int32_t e = 0; e < nEntries; e++) {
+    const char *ev = input + offsets[e];
+    memcpy(dict, ev, varDataTLen(ev));
+    dict += varDataTLen(ev);
+  }
+
+  uint64_t acc = 0;
+  int32_t  nbits = 0;
+  uint8_t *p = packed;
+  if (bits > 0) {
+    for (int i = 0; i < nelements; i++) {
+      acc |= (uint64_t)codes[i] << nbits;
+      nbits += bits;
+      while (nbits >= BITS_PER_BYTE) {
+        *(p++) = (uint8_t)acc;
+        acc >>= BITS_PER_BYTE;
+        nbits -= BITS_PER_BYTE;
+      }
+    }
+    if (nbits > 0) *(p++) = (uint8_t)acc;
+  }
+
+  // the codes of the columns with long runs of a value are much smaller after LZ4
+  int8_t  codesComp = 0;
+  int32_t codesLen = rawLen;
+  if (rawLen > 0) {
+    int32_t clen = LZ4_compress_default((char *)packed, output + opos, rawLen, outputSize - opos);
+    if (clen > 0 && clen < rawLen - rawLen / 4) {
+      codesComp = 1;
+      codesLen = clen;
+    }
+  }
+  if (codesComp == 0) memcpy(output + opos, packed, rawLen);
+
+  dict[0] = (char)bits;
+  dict[1] = codesComp;
+  memcpy(dict + 2, &codesLen, sizeof(int32_t));
+  ret = opos + codesLen;
+
+_exit:
+  free(slots);
+  return ret;
+}
+
+// Return the number of entries and the first entry in *ppDict, or -1 if the input is not encoded by a dictionary
+int tsGetStringDict(const char *const input, int compressedSize, const char **ppDict) {
+  if (compressedSize < (int)(STRING_DICT_HEAD_SIZE + STRING_DICT_CODES_HEAD_SIZE) || input[0] != STRING_DICT_COMPRESS) {
+    return -1;
+  }
+
+  int32_t nEntries, dictLen;
+  memcpy(&nEntries, input + 1, sizeof(int32_t));
+  memcpy(&dictLen, input + 1 + sizeof(int32_t), sizeof(int32_t));
+  if (nEntries <= 0 || nEntries > TS_STRING_DICT_MAX_ENTRIES || dictLen <= 0 ||
+      dictLen > compressedSize - (int)(STRING_DICT_HEAD_SIZE + STRING_DICT_CODES_HEAD_SIZE)) {
+    return -1;
+  }
+
+  const char *dict = input + STRING_DICT_HEAD_SIZE;
+  int32_t     pos = 0;
+  for (int32_t e = 0; e < nEntries; e++) {
+    if (pos + (int32_t)VARSTR_HEADER_SIZE > dictLen) return -1;
+    pos += varDataTLen(dict + pos);
+  }
+  if (pos != dictLen) return -1;
+
+  *ppDict = dict;
+  return nEntries;
+}
+
+int tsDecompressStringDictImp(const char *const input, int compressedSize, const int nelements, char *const output,
+                              int outputSize, char *const buffer, int bufferSize) {
+  const char *dict = NULL;
+  int32_t     nEntries = tsGetStringDict(input, compressedSize, &dict);
+  if (nEntries < 0) {
+    uError("Invalid dictionary encoded string, compressed size:%d", compressedSize);
+    return -1;
+  }
+
+  int32_t offsets[TS_STRING_DICT_MAX_ENTRIES];
+  int32_t pos = 0;
+  for (int32_t e = 0; e < nEntries; e++) {
+    offsets[e] = pos;
+    pos += varDataTLen(dict + pos);
+  }
+
+  const char *head = dict + pos;
+  int32_t     bits = head[0];
+  int8_t      codesComp = head[1];
+  int32_t     codesLen;
+  memcpy(&codesLen, head + 2, sizeof(int32_t));
+
+  const char *codes = head + STRING_DICT_CODES_HEAD_SIZE;
+  int32_t     rawLen = (int32_t)(((int64_t)nelements * bits + 7) / 8);
+  if (bits != tsStringDictBits(nEntries) || codesLen != compressedSize - (int32_t)(codes - input) ||
+      (codesComp == 0 && codesLen != rawLen)) {
+    uError("Invalid dictionary encoded string codes, bits:%d entries:%d codes len:%d", bits, nEntries, codesLen);
+    return -1;
+  }
+
+  char *tmp = NULL;
+  if (codesComp) {
+    if (buffer != NULL && bufferSize >= rawLen) {
+      tmp = buffer;
+    } else if ((tmp = (char *)malloc(rawLen)) == NULL) {
+      return -1;
+    }
+
+    if (LZ4_decompress_safe(codes, tmp, codesLen, rawLen) != rawLen) {
+      uError("Failed to decompress dictionary encoded string codes with LZ4 algorithm, codes len:%d", codesLen);
+      if (tmp != buffer) free(tmp);
+      return -1;
+    }
+    codes = tmp;
+  }
+
+  int32_t        opos = 0;
+  const uint8_t *p = (const uint8_t *)codes;
+  uint64_t       acc = 0;
+  int32_t        nbits = 0;
+  uint32_t       mask = (uint32_t)INT32MASK(bits);
+  for (int i = 0; i < nelements; i++) {
+    while (nbits < bits) {
+      acc |= (uint64_t)(*(p++)) << nbits;
+      nbits += BITS_PER_BYTE;
+    }
+    uint32_t code = (uint32_t)acc & mask;
+    acc >>= bits;
+    nbits -= bits;
+
+    if (code >= (uint32_t)nEntries) {
+      opos = -1;
+      break;
+    }
+
+    const char *ev = dict + offsets[code];
+    int32_t     tlen = (int32_t)varDataTLen(ev);
+    if (opos + tlen > outputSize) {
+      opos = -1;
+      break;
+    }
+    memcpy(output + opos, ev, tlen);
+    opos += tlen;
+  }
+
+  if (tmp != NULL && tmp != buffer) free(tmp);
+  if (opos < 0) uError("Invalid dictionary encoded string codes, entries:%d rows:%d", nEntries, nelements);
+  return opos;
+}
+
 /* --------------------------------------------Timestamp Compression
  * ---------------------------------------------- */
 // TODO: Take care here, we assumes little endian encoding.
@@ -567,6 +1026,143 @@ _exit_over:
   return nelements * LONG_BYTES + 1;
 }
 
+#ifdef TD_DECOMPRESS_SIMD
+// Decode the delta of deltas, the deltas and the values 4 at a time
+__attribute__((target("avx2"))) static void tsDecodeTimestampAvx2(const uint64_t *dd, int n, int64_t *ostream,
+                                                                     int64_t *prev_delta, int64_t *prev_value) {
+  int     i = 0;
+  __m256i delta = _mm256_set1_epi64x(*prev_delta);
+  __m256i value = _mm256_set1_epi64x(*prev_value);
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = tsZigzagDecodeAvx2(_mm256_loadu_si256((const __m256i *)(dd + i)));
+    v = _mm256_add_epi64(tsPrefixSumAvx2(v), delta);
+    delta = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    v = _mm256_add_epi64(tsPrefixSumAvx2(v), value);
+    value = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    _mm256_storeu_si256((__m256i *)(ostream + i), v);
+  }
+
+  *prev_delta = _mm256_extract_epi64(delta, 0);
+  *prev_value = _mm256_extract_epi64(value, 0);
+  for (; i < n; i++) {
+    *prev_delta += (int64_t)ZIGZAG_DECODE(int64_t, dd[i]);
+    *prev_value += *prev_delta;
+    ostream[i] = *prev_value;
+  }
+}
+
+// Decode the delta of deltas, the deltas and the values 2 at a time
+__attribute__((target("sse4.2"))) static void tsDecodeTimestampSse42(const uint64_t *dd, int n, int64_t *ostream,
+                                                                        int64_t *prev_delta, int64_t *prev_value) {
+  int     i = 0;
+  __m128i delta = _mm_set1_epi64x(*prev_delta);
+  __m128i value = _mm_set1_epi64x(*prev_value);
+
+  for (; i + 2 <= n; i += 2) {
+    __m128i v = tsZigzagDecodeSse42(_mm_loadu_si128((const __m128i *)(dd + i)));
+    v = _mm_add_epi64(tsPrefixSumSse42(v), delta);
+    delta = _mm_unpackhi_epi64(v, v);
+    v = _mm_add_epi64(tsPrefixSumSse42(v), value);
+    value = _mm_unpackhi_epi64(v, v);
+    _mm_storeu_si128((__m128i *)(ostream + i), v);
+  }
+
+  *prev_delta = _mm_cvtsi128_si64(delta);
+  *prev_value = _mm_cvtsi128_si64(value);
+  for (; i < n; i++) {
+    *prev_delta += (int64_t)ZIGZAG_DECODE(int64_t, dd[i]);
+    *prev_value += *prev_delta;
+    ostream[i] = *prev_value;
+  }
+}
+
+// mask of the low nbytes of a word, sizes larger than a word only appear in corrupted input
+static const uint64_t tsBytesMask[16] = {0,
+                                         0xFF,
+                                         0xFFFF,
+                                         0xFFFFFF,
+                                         0xFFFFFFFF,
+                                         0xFFFFFFFFFF,
+                                         0xFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF,
+                                         0xFFFFFFFFFFFFFFFF};
+
+static int tsDecompressTimestampSimd(const char *const input, const int nelements, char *const output, int level) {
+  int64_t *ostream = (int64_t *)output;
+  uint64_t dd[TS_DECOMPRESS_CHUNK];
+  int      npairs = (nelements + 1) / 2;
+  int      ipos = 1, opos = 0;
+  int64_t  prev_value = 0;
+  int64_t  prev_delta = 0;
+
+  while (opos < nelements) {
+    int n = MIN(TS_DECOMPRESS_CHUNK, nelements - opos);
+
+    // Extract the delta of deltas of the chunk, each pair of them leads by a byte of their sizes. The remaining
+    // input is at least one byte per pair, so a pair is loaded by unaligned 8 bytes loads if 8 pairs follow it.
+    int k = 0;
+    for (; k + 1 < n && (opos + k) / 2 + LONG_BYTES < npairs; k += 2) {
+      uint8_t flags = (uint8_t)input[ipos];
+      if (flags == 0) {  // regular intervals, the most common case
+        dd[k] = 0;
+        dd[k + 1] = 0;
+        ipos++;
+        continue;
+      }
+
+      int      nbytes1 = flags & INT8MASK(4);
+      uint64_t dd1 = 0, dd2 = 0;
+
+      memcpy(&dd1, input + ipos + 1, LONG_BYTES);
+      memcpy(&dd2, input + ipos + 1 + nbytes1, LONG_BYTES);
+      dd[k] = dd1 & tsBytesMask[nbytes1];
+      dd[k + 1] = dd2 & tsBytesMask[flags >> 4];
+      ipos += 1 + nbytes1 + (flags >> 4);
+    }
+
+    for (; k < n; k += 2) {
+      uint8_t flags = (uint8_t)input[ipos++];
+      int     nbytes1 = flags & INT8MASK(4);
+      int     nbytes2 = (flags >> 4) & INT8MASK(4);
+
+      dd[k] = 0;
+      memcpy(dd + k, input + ipos, nbytes1);
+      ipos += nbytes1;
+      if (k + 1 < n) {
+        dd[k + 1] = 0;
+        memcpy(dd + k + 1, input + ipos, nbytes2);
+        ipos += nbytes2;
+      }
+    }
+
+    int start = 0;
+    if (opos == 0) {  // the first value is stored as it is
+      prev_value = (int64_t)ZIGZAG_DECODE(int64_t, dd[0]);
+      prev_delta = 0;
+      ostream[0] = prev_value;
+      start = 1;
+    }
+
+    if (level == TSDB_SIMD_AVX2) {
+      tsDecodeTimestampAvx2(dd + start, n - start, ostream + opos + start, &prev_delta, &prev_value);
+    } else {
+      tsDecodeTimestampSse42(dd + start, n - start, ostream + opos + start, &prev_delta, &prev_value);
+    }
+    opos += n;
+  }
+
+  return nelements * LONG_BYTES;
+}
+#endif
+
 int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output) {
   assert(nelements >= 0);
   if (nelements == 0) return 0;
@@ -575,6 +1171,13 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
     memcpy(output, input + 1, nelements * LONG_BYTES);
     return nelements * LONG_BYTES;
   } else if (input[0] == 1) {  // Decompress
+#ifdef TD_DECOMPRESS_SIMD
+    int level = tsGetDecompressSimdLevel();
+    if (level != TSDB_SIMD_NONE) {
+      return tsDecompressTimestampSimd(input, nelements, output, level);
+    }
+#endif
+
     int64_t *ostream = (int64_t *)output;
 
     int     ipos = 1, opos = 0;
@@ -80,6 +80,19 @@ int64_t tfWrite(int64_t tfd, void *buf, int64_t count) {
   return ret;
 }
 
+int64_t tfWritev(int64_t tfd, struct iovec *iov, int32_t iovcnt) {
+  void *p = taosAcquireRef(tsFileRsetId, tfd);
+  if (p == NULL) return -1;
+
+  int32_t fd = (int32_t)(uintptr_t)p;
+
+  int64_t ret = taosWritev(fd, iov, iovcnt);
+  if (ret < 0) terrno = TAOS_SYSTEM_ERROR(errno);
+
+  taosReleaseRef(tsFileRsetId, tfd);
+  return ret;
+}
+
 int64_t tfRead(int64_t tfd, void *buf, int64_t count) {
   void *p = taosAcquireRef(tsFileRsetId, tfd);
   if (p == NULL) return -1;
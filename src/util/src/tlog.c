@@ -36,25 +36,44 @@
 #define MAX_LOG_INTERVAL 25
 #define LOG_MAX_WAIT_MSEC 1000
 
+#define LOG_MAX_IOV 1024
+#define LOG_MAX_PUSH_RETRY 16
+
 #define LOG_BUF_BUFFER(x) ((x)->buffer)
-#define LOG_BUF_START(x)  ((x)->buffStart)
-#define LOG_BUF_END(x)    ((x)->buffEnd)
+#define LOG_BUF_HEAD(x)   ((x)->buffHead)
+#define LOG_BUF_TAIL(x)   ((x)->buffTail)
 #define LOG_BUF_SIZE(x)   ((x)->buffSize)
-#define LOG_BUF_MUTEX(x)  ((x)->buffMutex)
 
+// A line in the buffer is a record of its length followed by its content, padded to 4 bytes so that the length
+// never wraps around the end of the buffer. The length is set after the content is copied, so a zero length means
+// the record is still being copied.
+#define LOG_REC_SIZE(len) (((int32_t)sizeof(int32_t) + (len) + 3) & ~3)
+
+// The buffer is a ring of multiple producers and a single consumer. The logging threads reserve their records by
+// moving the tail forward with CAS and copy their lines without any lock, and the log thread writes the committed
+// records from the head to the file with writev.
 typedef struct {
   char *          buffer;
-  int32_t         buffStart;
-  int32_t         buffEnd;
+  int64_t         buffHead;   // position of the first record not written yet, moved by the log thread only
+  int64_t         buffTail;   // position after the last reserved record
+  int64_t         lostLines;  // lines dropped since the buffer is full, reported by the log thread
   int32_t         buffSize;
   int32_t         minBuffSize;
   int32_t         fd;
   int32_t         stop;
   pthread_t       asyncThread;
-  pthread_mutex_t buffMutex;
-  tsem_t          buffNotEmpty;
+  struct iovec    iov[LOG_MAX_IOV];
 } SLogBuff;
 
+// the formatted time of the current second and the thread id, to build the head of each line of a thread
+typedef struct {
+  int64_t sec;
+  int32_t timeLen;
+  int32_t tidLen;
+  char    time[24];
+  char    tid[24];
+} SLogHead;
+
 typedef struct {
   int32_t fileNum;
   int32_t maxLines;
@@ -356,6 +375,43 @@ static int32_t taosOpenLogFile(char *fn, int32_t maxLines, int32_t maxFileNum) {
   return 0;
 }
 
+// Build the head of a line, e.g. "10/18 12:00:00.000123 00001234 UTL ". The time of the current second and the thread
+// id are formatted once and cached by each thread, so localtime_r and sprintf are not called for each line.
+static int32_t taosBuildLogHead(char *buffer, const char *flags) {
+  static threadlocal SLogHead logHead = {0};
+  struct timeval timeSecs;
+
+  gettimeofday(&timeSecs, NULL);
+  if (logHead.sec != timeSecs.tv_sec || logHead.tidLen == 0) {
+    struct tm Tm, *ptm;
+    time_t    curTime = timeSecs.tv_sec;
+
+    ptm = localtime_r(&curTime, &Tm);
+    logHead.timeLen = snprintf(logHead.time, sizeof(logHead.time), "%02d/%02d %02d:%02d:%02d.", ptm->tm_mon + 1,
+                               ptm->tm_mday, ptm->tm_hour, ptm->tm_min, ptm->tm_sec);
+    logHead.tidLen = snprintf(logHead.tid, sizeof(logHead.tid), " %08" PRId64 " ", taosGetSelfPthreadId());
+    logHead.sec = timeSecs.tv_sec;
+  }
+
+  int32_t len = logHead.timeLen;
+  memcpy(buffer, logHead.time, len);
+
+  int32_t usec = (int32_t)timeSecs.tv_usec;
+  for (int32_t i = 5; i >= 0; --i) {
+    buffer[len + i] = (char)('0' + usec % 10);
+    usec /= 10;
+  }
+  len += 6;
+
+  memcpy(buffer + len, logHead.tid, logHead.tidLen);
+  len += logHead.tidLen;
+
+  int32_t flagsLen = (int32_t)strlen(flags);
+  memcpy(buffer + len, flags, flagsLen + 1);
+
+  return len + flagsLen;
+}
+
 void taosPrintLog(const char *flags, int32_t dflag, const char *format, ...) {
   if (tsTotalLogDirGB != 0 && tsAvailLogDirGB < tsMinimalLogDirGB) {
     printf("server disk:%s space remain %.3f GB, total %.1f GB, stop print log.\n", tsLogDir, tsAvailLogDirGB, tsTotalLogDirGB);
@@ -369,17 +425,8 @@ void taosPrintLog(const char *flags, int32_t dflag, const char *format, ...) {
   va_list        argpointer;
   char           buffer[MAX_LOGLINE_BUFFER_SIZE] = { 0 };
   int32_t        len;
-  struct tm      Tm, *ptm;
-  struct timeval timeSecs;
-  time_t         curTime;
 
-  gettimeofday(&timeSecs, NULL);
-  curTime = timeSecs.tv_sec;
-  ptm = localtime_r(&curTime, &Tm);
-
-  len = sprintf(buffer, "%02d/%02d %02d:%02d:%02d.%06d %08" PRId64 " ", ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_hour,
-                ptm->tm_min, ptm->tm_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId());
-  len += sprintf(buffer + len, "%s", flags);
+  len = taosBuildLogHead(buffer, flags);
 
   va_start(argpointer, format);
   int32_t writeLen = vsnprintf(buffer + len, MAX_LOGLINE_CONTENT_SIZE, format, argpointer);
@@ -456,17 +503,8 @@ void taosPrintLongString(const char *flags, int32_t dflag, const char *format, .
   va_list        argpointer;
   char           buffer[MAX_LOGLINE_DUMP_BUFFER_SIZE];
   int32_t        len;
-  struct tm      Tm, *ptm;
-  struct timeval timeSecs;
-  time_t         curTime;
-
-  gettimeofday(&timeSecs, NULL);
-  curTime = timeSecs.tv_sec;
-  ptm = localtime_r(&curTime, &Tm);
 
-  len = sprintf(buffer, "%02d/%02d %02d:%02d:%02d.%06d %08" PRId64 " ", ptm->tm_mon + 1, ptm->tm_mday, ptm->tm_hour,
-                ptm->tm_min, ptm->tm_sec, (int32_t)timeSecs.tv_usec, taosGetSelfPthreadId());
-  len += sprintf(buffer + len, "%s", flags);
+  len = taosBuildLogHead(buffer, flags);
 
   va_start(argpointer, format);
   len += vsnprintf(buffer + len, MAX_LOGLINE_DUMP_CONTENT_SIZE, format, argpointer);
@@ -513,17 +551,16 @@ static SLogBuff *taosLogBuffNew(int32_t bufSize) {
   tLogBuff = calloc(1, sizeof(SLogBuff));
   if (tLogBuff == NULL) return NULL;
 
-  LOG_BUF_BUFFER(tLogBuff) = malloc(bufSize);
+  // the records are aligned to 4 bytes, and the zeroed buffer has no committed record
+  bufSize = bufSize & ~3;
+  LOG_BUF_BUFFER(tLogBuff) = calloc(1, bufSize);
   if (LOG_BUF_BUFFER(tLogBuff) == NULL) goto _err;
 
-  LOG_BUF_START(tLogBuff) = LOG_BUF_END(tLogBuff) = 0;
+  LOG_BUF_HEAD(tLogBuff) = LOG_BUF_TAIL(tLogBuff) = 0;
   LOG_BUF_SIZE(tLogBuff) = bufSize;
   tLogBuff->minBuffSize = bufSize / 10;
   tLogBuff->stop = 0;
 
-  if (pthread_mutex_init(&LOG_BUF_MUTEX(tLogBuff), NULL) < 0) goto _err;
-  //tsem_init(&(tLogBuff->buffNotEmpty), 0, 0);
-
   return tLogBuff;
 
 _err:
@@ -534,102 +571,133 @@ _err:
 
 #if 0
 static void taosLogBuffDestroy(SLogBuff *tLogBuff) {
-  tsem_destroy(&(tLogBuff->buffNotEmpty));
-  pthread_mutex_destroy(&(tLogBuff->buffMutex));
   free(tLogBuff->buffer);
   tfree(tLogBuff);
 }
 #endif
 
-static void taosCopyLogBuffer(SLogBuff *tLogBuff, int32_t start, int32_t end, char *msg, int32_t msgLen) {
-  if (start > end) {
-    memcpy(LOG_BUF_BUFFER(tLogBuff) + end, msg, msgLen);
+static void taosCopyLogBuffer(SLogBuff *tLogBuff, int32_t pos, char *msg, int32_t msgLen) {
+  if (LOG_BUF_SIZE(tLogBuff) - pos < msgLen) {
+    memcpy(LOG_BUF_BUFFER(tLogBuff) + pos, msg, LOG_BUF_SIZE(tLogBuff) - pos);
+    memcpy(LOG_BUF_BUFFER(tLogBuff), msg + LOG_BUF_SIZE(tLogBuff) - pos, msgLen - LOG_BUF_SIZE(tLogBuff) + pos);
   } else {
-    if (LOG_BUF_SIZE(tLogBuff) - end < msgLen) {
-      memcpy(LOG_BUF_BUFFER(tLogBuff) + end, msg, LOG_BUF_SIZE(tLogBuff) - end);
-      memcpy(LOG_BUF_BUFFER(tLogBuff), msg + LOG_BUF_SIZE(tLogBuff) - end, msgLen - LOG_BUF_SIZE(tLogBuff) + end);
-    } else {
-      memcpy(LOG_BUF_BUFFER(tLogBuff) + end, msg, msgLen);
-    }
+    memcpy(LOG_BUF_BUFFER(tLogBuff) + pos, msg, msgLen);
   }
-  LOG_BUF_END(tLogBuff) = (LOG_BUF_END(tLogBuff) + msgLen) % LOG_BUF_SIZE(tLogBuff);
 }
 
 static int32_t taosPushLogBuffer(SLogBuff *tLogBuff, char *msg, int32_t msgLen) {
-  int32_t start = 0;
-  int32_t end = 0;
-  int32_t remainSize = 0;
-  static int64_t lostLine = 0;
-  char tmpBuf[60] = {0};
-  int32_t tmpBufLen = 0;
+  int32_t recSize = LOG_REC_SIZE(msgLen);
+  int32_t retry = 0;
+  int64_t head = 0;
+  int64_t tail = 0;
 
   if (tLogBuff == NULL || tLogBuff->stop) return -1;
 
-  pthread_mutex_lock(&LOG_BUF_MUTEX(tLogBuff));
-  start = LOG_BUF_START(tLogBuff);
-  end = LOG_BUF_END(tLogBuff);
+  while (1) {
+    tail = atomic_load_64(&LOG_BUF_TAIL(tLogBuff));
+    head = atomic_load_64(&LOG_BUF_HEAD(tLogBuff));
 
-  remainSize = (start > end) ? (start - end - 1) : (start + LOG_BUF_SIZE(tLogBuff) - end - 1);
+    if (tail - head + recSize < LOG_BUF_SIZE(tLogBuff)) {
+      if (atomic_val_compare_exchange_64(&LOG_BUF_TAIL(tLogBuff), tail, tail + recSize) == tail) break;
+      continue;
+    }
 
-  if (lostLine > 0) {
-    sprintf(tmpBuf, "...Lost %"PRId64" lines here...\n", lostLine);
-    tmpBufLen = (int32_t)strlen(tmpBuf);
+    // the log thread may wait for a thread preempted before it commits its record, so give up the cpu for a while
+    if (++retry > LOG_MAX_PUSH_RETRY) {
+      atomic_add_fetch_64(&tLogBuff->lostLines, 1);
+      atomic_add_fetch_64(&asyncLogLostLines, 1);
+      return -1;
+    }
+    sched_yield();
   }
 
-  if (remainSize <= msgLen || ((lostLine > 0) && (remainSize <= (msgLen + tmpBufLen)))) {
-    lostLine++;
-    asyncLogLostLines++;
-    pthread_mutex_unlock(&LOG_BUF_MUTEX(tLogBuff));
-    return -1;
-  }
+  int32_t pos = (int32_t)(tail % LOG_BUF_SIZE(tLogBuff));
+  taosCopyLogBuffer(tLogBuff, (pos + (int32_t)sizeof(int32_t)) % LOG_BUF_SIZE(tLogBuff), msg, msgLen);
 
-  if (lostLine > 0) {
-    taosCopyLogBuffer(tLogBuff, start, end, tmpBuf, tmpBufLen);
-    lostLine = 0;
-  }
+  // commit the record
+  atomic_store_32((int32_t *)(LOG_BUF_BUFFER(tLogBuff) + pos), msgLen);
 
-  taosCopyLogBuffer(tLogBuff, LOG_BUF_START(tLogBuff), LOG_BUF_END(tLogBuff), msg, msgLen);
+  return 0;
+}
 
-  //int32_t w = atomic_sub_fetch_32(&waitLock, 1);
-  /*
-  if (w <= 0 || ((remainSize - msgLen - tmpBufLen) < (LOG_BUF_SIZE(tLogBuff) * 4 /5))) {
-    tsem_post(&(tLogBuff->buffNotEmpty));
-    dbgPostN++;
-  } else {
-    dbgNoPostN++;
-  }
-  */
+static int32_t taosGetLogRemainSize(SLogBuff *tLogBuff) {
+  return (int32_t)(atomic_load_64(&LOG_BUF_TAIL(tLogBuff)) - LOG_BUF_HEAD(tLogBuff));
+}
 
-  pthread_mutex_unlock(&LOG_BUF_MUTEX(tLogBuff));
+// Write the committed records from the head to the file until a record still being copied, and return the size of
+// the records written
+static int32_t taosPollLogBuffer(SLogBuff *tLogBuff) {
+  int32_t size = LOG_BUF_SIZE(tLogBuff);
+  int64_t tail = atomic_load_64(&LOG_BUF_TAIL(tLogBuff));
+  int64_t start = LOG_BUF_HEAD(tLogBuff);
+  int64_t head = start;
+
+  while (head < tail) {
+    int32_t iovcnt = 0;
+    int64_t pos = head;
+
+    while (pos < tail && iovcnt < LOG_MAX_IOV - 1) {
+      int32_t offset = (int32_t)(pos % size);
+      int32_t len = atomic_load_32((int32_t *)(LOG_BUF_BUFFER(tLogBuff) + offset));
+      if (len <= 0) break;
+
+      offset = (offset + (int32_t)sizeof(int32_t)) % size;
+      if (size - offset < len) {
+        tLogBuff->iov[iovcnt].iov_base = LOG_BUF_BUFFER(tLogBuff) + offset;
+        tLogBuff->iov[iovcnt++].iov_len = size - offset;
+        tLogBuff->iov[iovcnt].iov_base = LOG_BUF_BUFFER(tLogBuff);
+        tLogBuff->iov[iovcnt++].iov_len = len - size + offset;
+      } else {
+        tLogBuff->iov[iovcnt].iov_base = LOG_BUF_BUFFER(tLogBuff) + offset;
+        tLogBuff->iov[iovcnt++].iov_len = len;
+      }
 
+      pos += LOG_REC_SIZE(len);
+    }
 
-  return 0;
-}
+    if (iovcnt == 0) break;
+    taosWritev(tLogBuff->fd, tLogBuff->iov, iovcnt);
 
-static int32_t taosGetLogRemainSize(SLogBuff *tLogBuff, int32_t start, int32_t end) {
-  int32_t rSize = end - start;
+    // zero the records written, so that the bytes are read as uncommitted lengths once the ring wraps around
+    int32_t offset = (int32_t)(head % size);
+    int32_t len = (int32_t)(pos - head);
+    if (size - offset < len) {
+      memset(LOG_BUF_BUFFER(tLogBuff) + offset, 0, size - offset);
+      memset(LOG_BUF_BUFFER(tLogBuff), 0, len - size + offset);
+    } else {
+      memset(LOG_BUF_BUFFER(tLogBuff) + offset, 0, len);
+    }
+
+    head = pos;
+    atomic_store_64(&LOG_BUF_HEAD(tLogBuff), head);
+  }
 
-  return rSize >= 0 ? rSize : LOG_BUF_SIZE(tLogBuff) + rSize;
+  int64_t lostLines = atomic_exchange_64(&tLogBuff->lostLines, 0);
+  if (lostLines > 0) {
+    char tmpBuf[60] = {0};
+    sprintf(tmpBuf, "...Lost %" PRId64 " lines here...\n", lostLines);
+    taosWrite(tLogBuff->fd, tmpBuf, (int32_t)strlen(tmpBuf));
+  }
+
+  return (int32_t)(head - start);
 }
 
 static void taosWriteLog(SLogBuff *tLogBuff) {
   static int32_t lastDuration = 0;
   int32_t remainChecked = 0;
-  int32_t start, end, pollSize;
-  
+  int32_t pollSize;
+
   do {
     if (remainChecked == 0) {
-      start = LOG_BUF_START(tLogBuff);
-      end = LOG_BUF_END(tLogBuff);
-
-      if (start == end) {
+      pollSize = taosGetLogRemainSize(tLogBuff);
+      if (pollSize == 0) {
         dbgEmptyW++;
         writeInterval = MAX_LOG_INTERVAL;
         return;
       }
 
-      pollSize = taosGetLogRemainSize(tLogBuff, start, end);
-      if (pollSize < tLogBuff->minBuffSize) {
+      // write all lines before the log thread stops
+      if (pollSize < tLogBuff->minBuffSize && !tLogBuff->stop) {
         lastDuration += writeInterval;
         if (lastDuration < LOG_MAX_WAIT_MSEC) {
           break;
@@ -639,13 +707,9 @@ static void taosWriteLog(SLogBuff *tLogBuff) {
       lastDuration = 0;
     }
 
-    if (start < end) {
-      taosWrite(tLogBuff->fd, LOG_BUF_BUFFER(tLogBuff) + start, pollSize);
-    } else {
-        int32_t tsize = LOG_BUF_SIZE(tLogBuff) - start;
-        taosWrite(tLogBuff->fd, LOG_BUF_BUFFER(tLogBuff) + start, tsize);
-
-        taosWrite(tLogBuff->fd, LOG_BUF_BUFFER(tLogBuff), end);
+    pollSize = taosPollLogBuffer(tLogBuff);
+    if (pollSize == 0) {
+      break;
     }
 
     dbgWN++;
@@ -665,12 +729,7 @@ static void taosWriteLog(SLogBuff *tLogBuff) {
       }
     }
 
-    LOG_BUF_START(tLogBuff) = (LOG_BUF_START(tLogBuff) + pollSize) % LOG_BUF_SIZE(tLogBuff);
-
-    start = LOG_BUF_START(tLogBuff);
-    end = LOG_BUF_END(tLogBuff);
-
-    pollSize = taosGetLogRemainSize(tLogBuff, start, end);
+    pollSize = taosGetLogRemainSize(tLogBuff);
     if (pollSize < tLogBuff->minBuffSize) {
       break;
     }
@@ -688,10 +747,13 @@ static void *taosAsyncOutputLog(void *param) {
   while (1) {
     taosMsleep(writeInterval);
 
+    // all lines are written by the last poll once the log is stopped
+    int32_t stop = atomic_load_32(&tLogBuff->stop);
+
     // Polling the buffer
     taosWriteLog(tLogBuff);
 
-    if (tLogBuff->stop) break;
+    if (stop) break;
   }
 
   return NULL;
@@ -20,15 +20,28 @@
 #include "tulog.h"
 #include "tutil.h"
 
+// pointers published by the writer in SL_SINGLE_WRITER mode are read with acquire semantics
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+#define SL_LOAD_PTR(p) atomic_load_ptr(&(p))
+#else
+#define SL_LOAD_PTR(p) __atomic_load_n(&(p), __ATOMIC_ACQUIRE)
+#endif
+#define SL_NODE_LOAD_FORWARD_POINTER(n, l) ((SSkipListNode *)SL_LOAD_PTR(SL_NODE_GET_FORWARD_POINTER(n, l)))
+#define SL_NODE_LOAD_BACKWARD_POINTER(n, l) ((SSkipListNode *)SL_LOAD_PTR(SL_NODE_GET_BACKWARD_POINTER(n, l)))
+
 static int                initForwardBackwardPtr(SSkipList *pSkipList);
 static SSkipListNode *    getPriorNode(SSkipList *pSkipList, const char *val, int32_t order, SSkipListNode **pCur);
 static void               tSkipListRemoveNodeImpl(SSkipList *pSkipList, SSkipListNode *pNode);
 static void               tSkipListCorrectLevel(SSkipList *pSkipList);
 static SSkipListIterator *doCreateSkipListIterator(SSkipList *pSkipList, int32_t order);
+static void               doInitSkipListIterator(SSkipListIterator *iter, SSkipList *pSkipList, int32_t order);
 static void tSkipListDoInsert(SSkipList *pSkipList, SSkipListNode **direction, SSkipListNode *pNode, bool isForward);
 static bool tSkipListGetPosToPut(SSkipList *pSkipList, SSkipListNode **backward, void *pData);
 static SSkipListNode *tSkipListNewNode(uint8_t level);
+static SSkipListNode *tSkipListNewDataNode(SSkipList *pSkipList, uint8_t level);
+static void           tSkipListFreeDataNode(SSkipList *pSkipList, SSkipListNode *pNode);
 #define tSkipListFreeNode(n) tfree((n))
+#define SL_NODE_SIZE(l) (sizeof(SSkipListNode) + sizeof(SSkipListNode *) * (l) * 2)
 static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipListNode **direction, bool isForward,
                                        bool hasDup);
 
@@ -37,6 +50,7 @@ static FORCE_INLINE int     tSkipListWLock(SSkipList *pSkipList);
 static FORCE_INLINE int     tSkipListRLock(SSkipList *pSkipList);
 static FORCE_INLINE int     tSkipListUnlock(SSkipList *pSkipList);
 static FORCE_INLINE int32_t getSkipListRandLevel(SSkipList *pSkipList);
+static FORCE_INLINE void    tSkipListPublishPtr(SSkipList *pSkipList, SSkipListNode **ptr, SSkipListNode *pNode);
 
 SSkipList *tSkipListCreate(uint8_t maxLevel, uint8_t keyType, uint16_t keyLen, __compar_fn_t comparFn, uint8_t flags,
                            __sl_key_fn_t fn) {
@@ -64,7 +78,13 @@ SSkipList *tSkipListCreate(uint8_t maxLevel, uint8_t keyType, uint16_t keyLen, _
     return NULL;
   }
 
-  if (SL_IS_THREAD_SAFE(pSkipList)) {
+  if (SL_IS_SINGLE_WRITER(pSkipList)) {
+    pSkipList->pRetired = taosArrayInit(4, POINTER_BYTES);
+    if (pSkipList->pRetired == NULL) {
+      tSkipListDestroy(pSkipList);
+      return NULL;
+    }
+  } else if (SL_IS_THREAD_SAFE(pSkipList)) {
     pSkipList->lock = (pthread_rwlock_t *)calloc(1, sizeof(pthread_rwlock_t));
     if (pSkipList->lock == NULL) {
       tSkipListDestroy(pSkipList);
@@ -92,13 +112,23 @@ void tSkipListDestroy(SSkipList *pSkipList) {
 
   tSkipListWLock(pSkipList);
 
-  SSkipListNode *pNode = SL_NODE_GET_FORWARD_POINTER(pSkipList->pHead, 0);
+  // nodes in the arena are released together with the arena
+  if (pSkipList->pArena == NULL) {
+    SSkipListNode *pNode = SL_NODE_GET_FORWARD_POINTER(pSkipList->pHead, 0);
 
-  while (pNode != pSkipList->pTail) {
-    SSkipListNode *pTemp = pNode;
-    pNode = SL_NODE_GET_FORWARD_POINTER(pNode, 0);
-    tSkipListFreeNode(pTemp);
+    while (pNode != pSkipList->pTail) {
+      SSkipListNode *pTemp = pNode;
+      pNode = SL_NODE_GET_FORWARD_POINTER(pNode, 0);
+      tSkipListFreeNode(pTemp);
+    }
+
+    size_t nRetired = (pSkipList->pRetired == NULL) ? 0 : taosArrayGetSize(pSkipList->pRetired);
+    for (size_t i = 0; i < nRetired; ++i) {
+      SSkipListNode *pTemp = *(SSkipListNode **)taosArrayGet(pSkipList->pRetired, i);
+      tSkipListFreeNode(pTemp);
+    }
   }
+  taosArrayDestroy(&pSkipList->pRetired);
 
   tfree(pSkipList->insertHandleFn);
 
@@ -140,7 +170,10 @@ void tSkipListPutBatchByIter(SSkipList *pSkipList, void *iter, iter_next_fn_t it
   tSkipListWLock(pSkipList);
 
   void* pData = iterate(iter);
-  if(pData == NULL) return;
+  if(pData == NULL) {
+    tSkipListUnlock(pSkipList);
+    return;
+  }
 
   // backward to put the first data
   hasDup = tSkipListGetPosToPut(pSkipList, backward, pData);
@@ -247,7 +280,7 @@ SArray *tSkipListGet(SSkipList *pSkipList, SSkipListKey key) {
 
   SSkipListNode *pNode = getPriorNode(pSkipList, key, TSDB_ORDER_ASC, NULL);
   while (1) {
-    SSkipListNode *p = SL_NODE_GET_FORWARD_POINTER(pNode, 0);
+    SSkipListNode *p = SL_NODE_LOAD_FORWARD_POINTER(pNode, 0);
     if (p == pSkipList->pTail) {
       break;
     }
@@ -270,6 +303,11 @@ void tSkipListRemoveNode(SSkipList *pSkipList, SSkipListNode *pNode) {
   tSkipListUnlock(pSkipList);
 }
 
+void tSkipListSetArena(SSkipList *pSkipList, SSkipListArena *pArena) {
+  ASSERT(pSkipList->size == 0 && pSkipList->pArena == NULL);
+  pSkipList->pArena = pArena;
+}
+
 SSkipListIterator *tSkipListCreateIter(SSkipList *pSkipList) {
   if (pSkipList == NULL) return NULL;
 
@@ -281,8 +319,21 @@ SSkipListIterator *tSkipListCreateIterFromVal(SSkipList *pSkipList, const char *
   ASSERT(pSkipList != NULL);
 
   SSkipListIterator *iter = doCreateSkipListIterator(pSkipList, order);
+  if (iter == NULL) return NULL;
+
+  tSkipListInitIterFromVal(iter, pSkipList, val, type, order);
+  return iter;
+}
+
+void tSkipListInitIterFromVal(SSkipListIterator *iter, SSkipList *pSkipList, const char *val, int32_t type,
+                              int32_t order) {
+  ASSERT(order == TSDB_ORDER_ASC || order == TSDB_ORDER_DESC);
+  ASSERT(pSkipList != NULL);
+
+  memset(iter, 0, sizeof(*iter));
+  doInitSkipListIterator(iter, pSkipList, order);
   if (val == NULL) {
-    return iter;
+    return;
   }
 
   tSkipListRLock(pSkipList);
@@ -290,8 +341,6 @@ SSkipListIterator *tSkipListCreateIterFromVal(SSkipList *pSkipList, const char *
   iter->cur = getPriorNode(pSkipList, val, order, &(iter->next));
 
   tSkipListUnlock(pSkipList);
-
-  return iter;
 }
 
 bool tSkipListIterNext(SSkipListIterator *iter) {
@@ -309,14 +358,14 @@ bool tSkipListIterNext(SSkipListIterator *iter) {
       return false;
     }
 
-    iter->cur = SL_NODE_GET_FORWARD_POINTER(iter->cur, 0);
+    iter->cur = SL_NODE_LOAD_FORWARD_POINTER(iter->cur, 0);
 
     // a new node is inserted into between iter->cur and iter->next, ignore it
     if (iter->cur != iter->next && (iter->next != NULL)) {
       iter->cur = iter->next;
     }
 
-    iter->next = SL_NODE_GET_FORWARD_POINTER(iter->cur, 0);
+    iter->next = SL_NODE_LOAD_FORWARD_POINTER(iter->cur, 0);
     iter->step++;
   } else {
     if (iter->cur == pSkipList->pHead) {
@@ -325,14 +374,14 @@ bool tSkipListIterNext(SSkipListIterator *iter) {
       return false;
     }
 
-    iter->cur = SL_NODE_GET_BACKWARD_POINTER(iter->cur, 0);
+    iter->cur = SL_NODE_LOAD_BACKWARD_POINTER(iter->cur, 0);
 
     // a new node is inserted into between iter->cur and iter->next, ignore it
     if (iter->cur != iter->next && (iter->next != NULL)) {
       iter->cur = iter->next;
     }
 
-    iter->next = SL_NODE_GET_BACKWARD_POINTER(iter->cur, 0);
+    iter->next = SL_NODE_LOAD_BACKWARD_POINTER(iter->cur, 0);
     iter->step++;
   }
 
@@ -400,24 +449,23 @@ void tSkipListPrint(SSkipList *pSkipList, int16_t nlevel) {
 }
 
 static void tSkipListDoInsert(SSkipList *pSkipList, SSkipListNode **direction, SSkipListNode *pNode, bool isForward) {
+  // the pointers of the new node are set before it is linked, so a lock-free reader never sees a half built node
   for (int32_t i = 0; i < pNode->level; ++i) {
     SSkipListNode *x = direction[i];
     if (isForward) {
-      SL_NODE_GET_BACKWARD_POINTER(pNode, i) = x;
-
       SSkipListNode *next = SL_NODE_GET_FORWARD_POINTER(x, i);
-      SL_NODE_GET_BACKWARD_POINTER(next, i) = pNode;
-
+      SL_NODE_GET_BACKWARD_POINTER(pNode, i) = x;
       SL_NODE_GET_FORWARD_POINTER(pNode, i) = next;
-      SL_NODE_GET_FORWARD_POINTER(x, i) = pNode;
-    } else {
-      SL_NODE_GET_FORWARD_POINTER(pNode, i) = x;
 
+      tSkipListPublishPtr(pSkipList, &SL_NODE_GET_FORWARD_POINTER(x, i), pNode);
+      tSkipListPublishPtr(pSkipList, &SL_NODE_GET_BACKWARD_POINTER(next, i), pNode);
+    } else {
       SSkipListNode *prev = SL_NODE_GET_BACKWARD_POINTER(x, i);
-      SL_NODE_GET_FORWARD_POINTER(prev, i) = pNode;
-
+      SL_NODE_GET_FORWARD_POINTER(pNode, i) = x;
       SL_NODE_GET_BACKWARD_POINTER(pNode, i) = prev;
-      SL_NODE_GET_BACKWARD_POINTER(x, i) = pNode;
+
+      tSkipListPublishPtr(pSkipList, &SL_NODE_GET_FORWARD_POINTER(prev, i), pNode);
+      tSkipListPublishPtr(pSkipList, &SL_NODE_GET_BACKWARD_POINTER(x, i), pNode);
     }
   }
 
@@ -428,18 +476,22 @@ static void tSkipListDoInsert(SSkipList *pSkipList, SSkipListNode **direction, S
 
 static SSkipListIterator *doCreateSkipListIterator(SSkipList *pSkipList, int32_t order) {
   SSkipListIterator *iter = calloc(1, sizeof(SSkipListIterator));
+  if (iter == NULL) return NULL;
+
+  doInitSkipListIterator(iter, pSkipList, order);
+  return iter;
+}
 
+static void doInitSkipListIterator(SSkipListIterator *iter, SSkipList *pSkipList, int32_t order) {
   iter->pSkipList = pSkipList;
   iter->order = order;
   if (order == TSDB_ORDER_ASC) {
     iter->cur = pSkipList->pHead;
-    iter->next = SL_NODE_GET_FORWARD_POINTER(iter->cur, 0);
+    iter->next = SL_NODE_LOAD_FORWARD_POINTER(iter->cur, 0);
   } else {
     iter->cur = pSkipList->pTail;
-    iter->next = SL_NODE_GET_BACKWARD_POINTER(iter->cur, 0);
+    iter->next = SL_NODE_LOAD_BACKWARD_POINTER(iter->cur, 0);
   }
-
-  return iter;
 }
 
 static FORCE_INLINE int tSkipListWLock(SSkipList *pSkipList) {
@@ -463,6 +515,18 @@ static FORCE_INLINE int tSkipListUnlock(SSkipList *pSkipList) {
   return 0;
 }
 
+static FORCE_INLINE void tSkipListPublishPtr(SSkipList *pSkipList, SSkipListNode **ptr, SSkipListNode *pNode) {
+  if (SL_IS_SINGLE_WRITER(pSkipList)) {
+    // only one writer exists, so the CAS never fails, it is used for the full barrier to publish pNode
+    SSkipListNode *old = *ptr;
+    if (atomic_val_compare_exchange_ptr(ptr, old, pNode) != old) {
+      ASSERT(false);
+    }
+  } else {
+    *ptr = pNode;
+  }
+}
+
 static bool tSkipListGetPosToPut(SSkipList *pSkipList, SSkipListNode **backward, void *pData) {
   int     compare = 0;
   bool    hasDupKey = false;
@@ -531,11 +595,16 @@ static void tSkipListRemoveNodeImpl(SSkipList *pSkipList, SSkipListNode *pNode)
     SSkipListNode *prev = SL_NODE_GET_BACKWARD_POINTER(pNode, j);
     SSkipListNode *next = SL_NODE_GET_FORWARD_POINTER(pNode, j);
 
-    SL_NODE_GET_FORWARD_POINTER(prev, j) = next;
-    SL_NODE_GET_BACKWARD_POINTER(next, j) = prev;
+    tSkipListPublishPtr(pSkipList, &SL_NODE_GET_FORWARD_POINTER(prev, j), next);
+    tSkipListPublishPtr(pSkipList, &SL_NODE_GET_BACKWARD_POINTER(next, j), prev);
   }
 
-  tSkipListFreeNode(pNode);
+  // a lock-free reader may still stand on the node, so it is kept until the list is destroyed
+  if (SL_IS_SINGLE_WRITER(pSkipList) && pSkipList->pArena == NULL) {
+    taosArrayPush(pSkipList->pRetired, &pNode);
+  } else {
+    tSkipListFreeDataNode(pSkipList, pNode);
+  }
   pSkipList->size--;
 }
 
@@ -609,12 +678,12 @@ static SSkipListNode *getPriorNode(SSkipList *pSkipList, const char *val, int32_
   if (order == TSDB_ORDER_ASC) {
     pNode = pSkipList->pHead;
     for (int32_t i = pSkipList->level - 1; i >= 0; --i) {
-      SSkipListNode *p = SL_NODE_GET_FORWARD_POINTER(pNode, i);
+      SSkipListNode *p = SL_NODE_LOAD_FORWARD_POINTER(pNode, i);
       while (p != pSkipList->pTail) {
         char *key = SL_GET_NODE_KEY(pSkipList, p);
         if (comparFn(key, val) < 0) {
           pNode = p;
-          p = SL_NODE_GET_FORWARD_POINTER(p, i);
+          p = SL_NODE_LOAD_FORWARD_POINTER(p, i);
         } else {
           if (pCur != NULL) {
             *pCur = p;
@@ -626,12 +695,12 @@ static SSkipListNode *getPriorNode(SSkipList *pSkipList, const char *val, int32_
   } else {
     pNode = pSkipList->pTail;
     for (int32_t i = pSkipList->level - 1; i >= 0; --i) {
-      SSkipListNode *p = SL_NODE_GET_BACKWARD_POINTER(pNode, i);
+      SSkipListNode *p = SL_NODE_LOAD_BACKWARD_POINTER(pNode, i);
       while (p != pSkipList->pHead) {
         char *key = SL_GET_NODE_KEY(pSkipList, p);
         if (comparFn(key, val) > 0) {
           pNode = p;
-          p = SL_NODE_GET_BACKWARD_POINTER(p, i);
+          p = SL_NODE_LOAD_BACKWARD_POINTER(p, i);
         } else {
           if (pCur != NULL) {
             *pCur = p;
@@ -668,7 +737,7 @@ static int initForwardBackwardPtr(SSkipList *pSkipList) {
 }
 
 static SSkipListNode *tSkipListNewNode(uint8_t level) {
-  int32_t tsize = sizeof(SSkipListNode) + sizeof(SSkipListNode *) * level * 2;
+  int32_t tsize = (int32_t)SL_NODE_SIZE(level);
 
   SSkipListNode *pNode = (SSkipListNode *)calloc(1, tsize);
   if (pNode == NULL) return NULL;
@@ -677,6 +746,97 @@ static SSkipListNode *tSkipListNewNode(uint8_t level) {
   return pNode;
 }
 
+typedef struct SSkipListArenaPage {
+  struct SSkipListArenaPage *next;
+  char                       data[];
+} SSkipListArenaPage;
+
+struct SSkipListArena {
+  int32_t             pageSize;
+  SSkipListArenaPage *pPages;                             // all pages of all levels, released together
+  char *              pFree[MAX_SKIP_LIST_LEVEL + 1];     // next free node in the current page of each level
+  int32_t             nFree[MAX_SKIP_LIST_LEVEL + 1];     // number of free nodes in the current page of each level
+  int64_t             numOfPages;                         // pages allocated
+  int64_t             usedBytes;                          // bytes of the nodes allocated from the pages
+};
+
+// bytes of the pages of all arenas alive
+static int64_t tsSkipListArenaBytes = 0;
+
+SSkipListArena *tSkipListArenaCreate(int32_t pageSize) {
+  SSkipListArena *pArena = (SSkipListArena *)calloc(1, sizeof(SSkipListArena));
+  if (pArena == NULL) return NULL;
+
+  // a page holds at least one node of the highest level
+  pArena->pageSize = MAX(pageSize, (int32_t)SL_NODE_SIZE(MAX_SKIP_LIST_LEVEL));
+  return pArena;
+}
+
+void tSkipListArenaDestroy(SSkipListArena *pArena) {
+  if (pArena == NULL) return;
+
+  SSkipListArenaPage *pPage = pArena->pPages;
+  while (pPage != NULL) {
+    SSkipListArenaPage *pTemp = pPage;
+    pPage = pPage->next;
+    free(pTemp);
+  }
+
+  int64_t allocBytes = pArena->numOfPages * (int64_t)(sizeof(SSkipListArenaPage) + pArena->pageSize);
+  atomic_sub_fetch_64(&tsSkipListArenaBytes, allocBytes);
+  free(pArena);
+}
+
+void tSkipListArenaGetUsage(SSkipListArena *pArena, int64_t *numOfPages, int64_t *usedBytes, int64_t *allocBytes) {
+  int64_t pages = atomic_load_64(&pArena->numOfPages);
+
+  *numOfPages = pages;
+  *usedBytes = atomic_load_64(&pArena->usedBytes);
+  *allocBytes = pages * (int64_t)(sizeof(SSkipListArenaPage) + pArena->pageSize);
+}
+
+int64_t tSkipListArenaGetTotalBytes() { return atomic_load_64(&tsSkipListArenaBytes); }
+
+static SSkipListNode *tSkipListArenaAlloc(SSkipListArena *pArena, uint8_t level) {
+  int32_t nodeSize = (int32_t)SL_NODE_SIZE(level);
+
+  ASSERT(level > 0 && level <= MAX_SKIP_LIST_LEVEL);
+  if (pArena->nFree[level] == 0) {
+    SSkipListArenaPage *pPage = (SSkipListArenaPage *)malloc(sizeof(SSkipListArenaPage) + pArena->pageSize);
+    if (pPage == NULL) return NULL;
+
+    pPage->next = pArena->pPages;
+    pArena->pPages = pPage;
+    pArena->pFree[level] = pPage->data;
+    pArena->nFree[level] = pArena->pageSize / nodeSize;
+    atomic_add_fetch_64(&pArena->numOfPages, 1);
+    atomic_add_fetch_64(&tsSkipListArenaBytes, (int64_t)(sizeof(SSkipListArenaPage) + pArena->pageSize));
+  }
+
+  SSkipListNode *pNode = (SSkipListNode *)pArena->pFree[level];
+  pArena->pFree[level] += nodeSize;
+  pArena->nFree[level] -= 1;
+  atomic_add_fetch_64(&pArena->usedBytes, nodeSize);
+
+  memset(pNode, 0, nodeSize);
+  pNode->level = level;
+  return pNode;
+}
+
+static SSkipListNode *tSkipListNewDataNode(SSkipList *pSkipList, uint8_t level) {
+  if (pSkipList->pArena != NULL) {
+    return tSkipListArenaAlloc(pSkipList->pArena, level);
+  }
+
+  return tSkipListNewNode(level);
+}
+
+static void tSkipListFreeDataNode(SSkipList *pSkipList, SSkipListNode *pNode) {
+  if (pSkipList->pArena == NULL) {
+    tSkipListFreeNode(pNode);
+  }
+}
+
 static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipListNode **direction, bool isForward,
                                        bool hasDup) {
   uint8_t        dupMode = SL_DUP_MODE(pSkipList);
@@ -706,7 +866,7 @@ static SSkipListNode *tSkipListPutImpl(SSkipList *pSkipList, void *pData, SSkipL
       }
     }
   } else {
-    pNode = tSkipListNewNode(getSkipListRandLevel(pSkipList));
+    pNode = tSkipListNewDataNode(pSkipList, getSkipListRandLevel(pSkipList));
     if (pNode != NULL) {
       // insertHandleFn will be assigned only for timeseries data,
       // in which case, pData is pointed to an memory to be freed later;
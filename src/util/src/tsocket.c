@@ -143,6 +143,22 @@ int32_t taosWriteMsg(SOCKET fd, void *buf, int32_t nbytes) {
   return (nbytes - nleft);
 }
 
+// write a message made of several buffers, e.g. a head and a body, with one system call instead of copying them into
+// one buffer, the iov is modified if it is written partially
+int32_t taosWriteMsgV(SOCKET fd, struct iovec *iov, int32_t iovcnt) {
+#ifdef WINDOWS
+  int32_t nwritten = 0;
+  for (int32_t i = 0; i < iovcnt; ++i) {
+    if (taosWriteMsg(fd, iov[i].iov_base, (int32_t)iov[i].iov_len) != (int32_t)iov[i].iov_len) return -1;
+    nwritten += (int32_t)iov[i].iov_len;
+  }
+
+  return nwritten;
+#else
+  return (int32_t)taosWritev(fd, iov, iovcnt);
+#endif
+}
+
 int32_t taosReadMsg(SOCKET fd, void *buf, int32_t nbytes) {
   int32_t nleft, nread;
   char *  ptr = (char *)buf;
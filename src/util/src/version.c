@@ -0,0 +1,7 @@
+char version[12] = "2.4.0.0";
+char compatible_version[12] = "2.0.0.0";
+char gitinfo[48] = "150d745fdd5d4fbb8a37ace383939d75ebd93cf1";
+char gitinfoOfInternal[48] = "150d745fdd5d4fbb8a37ace383939d75ebd93cf1";
+char buildinfo[64] = "Built at 2026-10-18 13:19:16";
+
+void libtaos_2_4_0_0_Linux_x32_stable() {};
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+#include "tbitmap.h"
+
+namespace {
+
+void checkBitmap(const SBitmap *pBitmap, const std::set<uint32_t> &expect) {
+  ASSERT_EQ(tBitmapCardinality(pBitmap), (int64_t)expect.size());
+
+  SBitmapIter iter;
+  tBitmapIterInit(&iter, pBitmap);
+
+  uint32_t v = 0;
+  for (std::set<uint32_t>::const_iterator it = expect.begin(); it != expect.end(); ++it) {
+    ASSERT_TRUE(tBitmapIterNext(&iter, &v));
+    ASSERT_EQ(v, *it);
+    ASSERT_TRUE(tBitmapContains(pBitmap, v));
+  }
+  ASSERT_FALSE(tBitmapIterNext(&iter, &v));
+}
+
+// values in [0, range) with the given density, crossing the array and bitset containers
+void genBitmap(SBitmap *pBitmap, std::set<uint32_t> &s, uint32_t range, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    uint32_t v = (uint32_t)rand() % range;
+    ASSERT_EQ(tBitmapAdd(pBitmap, v), 0);
+    s.insert(v);
+  }
+}
+
+}  // namespace
+
+TEST(bitmapTest, add_remove) {
+  SBitmap           *pBitmap = tBitmapCreate();
+  std::set<uint32_t> s;
+  srand(1);
+
+  checkBitmap(pBitmap, s);
+
+  // sparse and dense containers, and the largest values
+  genBitmap(pBitmap, s, 200000, 3000);
+  for (uint32_t v = 300000; v < 310000; ++v) {
+    tBitmapAdd(pBitmap, v);
+    s.insert(v);
+  }
+  tBitmapAdd(pBitmap, UINT32_MAX);
+  s.insert(UINT32_MAX);
+  checkBitmap(pBitmap, s);
+  EXPECT_FALSE(tBitmapContains(pBitmap, 299999));
+
+  // a dense container becomes sparse and then empty
+  for (uint32_t v = 300000; v < 310000; ++v) {
+    if (v % 3 != 0) {
+      tBitmapRemove(pBitmap, v);
+      s.erase(v);
+    }
+  }
+  checkBitmap(pBitmap, s);
+
+  for (int32_t i = 0; i < 5000; ++i) {
+    uint32_t v = (uint32_t)rand() % 320000;
+    tBitmapRemove(pBitmap, v);
+    s.erase(v);
+  }
+  tBitmapRemove(pBitmap, UINT32_MAX);
+  s.erase(UINT32_MAX);
+  checkBitmap(pBitmap, s);
+
+  SBitmap *pDup = tBitmapDup(pBitmap);
+  checkBitmap(pDup, s);
+  tBitmapDestroy(pDup);
+
+  for (std::set<uint32_t>::iterator it = s.begin(); it != s.end(); ++it) {
+    tBitmapRemove(pBitmap, *it);
+  }
+  s.clear();
+  checkBitmap(pBitmap, s);
+  tBitmapDestroy(pBitmap);
+}
+
+TEST(bitmapTest, and_or) {
+  srand(2);
+
+  // sparse with sparse, sparse with dense and dense with dense
+  int32_t nums[][2] = {{100, 200}, {100, 50000}, {50000, 100}, {40000, 60000}, {0, 1000}};
+  for (int32_t k = 0; k < 5; ++k) {
+    SBitmap           *a = tBitmapCreate(), *b = tBitmapCreate();
+    std::set<uint32_t> sa, sb, expect;
+
+    genBitmap(a, sa, 400000, nums[k][0]);
+    genBitmap(b, sb, 400000, nums[k][1]);
+
+    SBitmap *c = tBitmapDup(a);
+    ASSERT_EQ(tBitmapAnd(c, b), 0);
+    std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(expect, expect.begin()));
+    checkBitmap(c, expect);
+    tBitmapDestroy(c);
+
+    expect.clear();
+    c = tBitmapDup(a);
+    ASSERT_EQ(tBitmapOr(c, b), 0);
+    std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::inserter(expect, expect.begin()));
+    checkBitmap(c, expect);
+    tBitmapDestroy(c);
+
+    tBitmapDestroy(a);
+    tBitmapDestroy(b);
+  }
+}
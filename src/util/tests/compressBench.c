@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tscompression.h"
+#include "ttype.h"
+#include "tutil.h"
+
+typedef int (*compress_func)(const char *const input, int inputSize, const int nelements, char *const output,
+                             int outputSize, char algorithm, char *const buffer, int bufferSize);
+typedef int (*decompress_func)(const char *const input, int compressedSize, const int nelements, char *const output,
+                               int outputSize, char algorithm, char *const buffer, int bufferSize);
+
+typedef struct {
+  const char *    name;
+  int32_t         bytes;
+  compress_func   compFp;
+  decompress_func decompFp;
+} SBenchType;
+
+static SBenchType types[] = {
+    {"tinyint", sizeof(int8_t), tsCompressTinyint, tsDecompressTinyint},
+    {"smallint", sizeof(int16_t), tsCompressSmallint, tsDecompressSmallint},
+    {"int", sizeof(int32_t), tsCompressInt, tsDecompressInt},
+    {"bigint", sizeof(int64_t), tsCompressBigint, tsDecompressBigint},
+    {"timestamp", sizeof(int64_t), tsCompressTimestamp, tsDecompressTimestamp},
+};
+
+static const char *levelNames[] = {"scalar", "sse4.2", "avx2"};
+
+static void setValue(char *data, int32_t bytes, int32_t i, int64_t v) {
+  switch (bytes) {
+    case 1: ((int8_t *)data)[i] = (int8_t)v; break;
+    case 2: ((int16_t *)data)[i] = (int16_t)v; break;
+    case 4: ((int32_t *)data)[i] = (int32_t)v; break;
+    default: ((int64_t *)data)[i] = v; break;
+  }
+}
+
+// pattern 0: constant, 1: small deltas, 2: random values of the full width, 3: timestamps with jitter
+static void genData(char *data, int32_t bytes, int32_t numOfRows, int32_t pattern) {
+  int64_t v = 1600000000000;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    switch (pattern) {
+      case 0: v = 42; break;
+      case 1: v += rand() % 7 - 3; break;
+      case 2: v = ((int64_t)rand() << 33) ^ ((int64_t)rand() << 12) ^ rand(); break;
+      default: v += 1000 + ((rand() % 10 == 0) ? rand() % 50 : 0); break;
+    }
+    setValue(data, bytes, i, v);
+  }
+}
+
+static void runBench(SBenchType *pType, int32_t pattern, char algorithm, int32_t numOfRows, int32_t loops) {
+  static const char *patternNames[] = {"constant", "small-delta", "random", "ts-jitter"};
+
+  int32_t size = pType->bytes * numOfRows;
+  int32_t bufSize = size * 2 + 1024;
+  char *  data = (char *)malloc(size);
+  char *  comp = (char *)malloc(bufSize);
+  char *  buffer = (char *)malloc(bufSize);
+  char *  expect = (char *)malloc(size);
+  char *  output = (char *)malloc(size);
+
+  genData(data, pType->bytes, numOfRows, pattern);
+  int32_t compLen = (*pType->compFp)(data, size, numOfRows, comp, bufSize, algorithm, buffer, bufSize);
+
+  // the scalar decoder gives the reference output
+  tsSetDecompressSimdLevel(TSDB_SIMD_NONE);
+  (*pType->decompFp)(comp, compLen, numOfRows, expect, size, algorithm, buffer, bufSize);
+  if (memcmp(expect, data, size) != 0) {
+    printf("%s %s: scalar round trip mismatch\n", pType->name, patternNames[pattern]);
+    exit(1);
+  }
+
+  int32_t cpuLevel = tsGetCpuSimdLevel();
+  printf("%-9s %-11s %-3s ratio:%6.2f", pType->name, patternNames[pattern], algorithm == ONE_STAGE_COMP ? "1" : "2",
+         (double)size / compLen);
+
+  for (int32_t level = TSDB_SIMD_NONE; level <= cpuLevel; ++level) {
+    tsSetDecompressSimdLevel(level);
+
+    memset(output, 0, size);
+    int64_t st = taosGetTimestampUs();
+    for (int32_t i = 0; i < loops; ++i) {
+      (*pType->decompFp)(comp, compLen, numOfRows, output, size, algorithm, buffer, bufSize);
+    }
+    int64_t el = taosGetTimestampUs() - st;
+
+    if (memcmp(output, expect, size) != 0) {
+      printf("\n%s %s: %s output differs from scalar\n", pType->name, patternNames[pattern], levelNames[level]);
+      exit(1);
+    }
+
+    printf("  %s:%8.1f MB/s", levelNames[level], (double)size * loops / (el > 0 ? el : 1));
+  }
+  printf("\n");
+
+  tsSetDecompressSimdLevel(cpuLevel);
+  free(data);
+  free(comp);
+  free(buffer);
+  free(expect);
+  free(output);
+}
+
+// strings of card distinct values with up to 24 chars, in random order or in runs of 100 rows
+static int32_t genStrings(char *data, int32_t numOfRows, int32_t card, bool runs) {
+  int32_t pos = 0;
+  int32_t v = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (!runs || i % 100 == 0) v = rand() % card;
+    char *p = data + pos;
+    varDataSetLen(p, snprintf(varDataVal(p), 32, "fw-%d.%d-%.*s", v, v * 7 % 13, v % 12, "abcdefghijkl"));
+    pos += varDataTLen(p);
+  }
+  return pos;
+}
+
+static double benchStringDecode(const char *comp, int32_t compLen, int32_t numOfRows, char *output, int32_t size,
+                                char *buffer, int32_t bufSize, int32_t loops) {
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    tsDecompressString(comp, compLen, numOfRows, output, size, ONE_STAGE_COMP, buffer, bufSize);
+  }
+  int64_t el = taosGetTimestampUs() - st;
+  return (double)size * loops / (el > 0 ? el : 1);
+}
+
+static void runStringBench(int32_t card, bool runs, int32_t numOfRows, int32_t loops) {
+  int32_t bufSize = numOfRows * 34 + 1024;
+  char *  data = (char *)malloc(bufSize);
+  char *  comp = (char *)malloc(bufSize);
+  char *  buffer = (char *)malloc(bufSize);
+  char *  output = (char *)malloc(bufSize);
+
+  int32_t size = genStrings(data, numOfRows, card, runs);
+  printf("strings   card:%-5d %-6s", card, runs ? "runs" : "random");
+
+  int32_t compLen = tsCompressStringImp(data, size, comp, bufSize);
+  if (tsDecompressString(comp, compLen, numOfRows, output, bufSize, ONE_STAGE_COMP, buffer, bufSize) != size ||
+      memcmp(output, data, size) != 0) {
+    printf("\nlz4 round trip mismatch\n");
+    exit(1);
+  }
+  printf("  lz4 ratio:%6.2f %8.1f MB/s", (double)size / compLen,
+         benchStringDecode(comp, compLen, numOfRows, output, size, buffer, bufSize, loops));
+
+  compLen = tsCompressZlibImp(data, size, comp, bufSize, TS_ZLIB_DEFAULT_LEVEL);
+  if (tsDecompressZlibImp(comp, compLen, output, bufSize) != size || memcmp(output, data, size) != 0) {
+    printf("\nzlib round trip mismatch\n");
+    exit(1);
+  }
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    tsDecompressZlibImp(comp, compLen, output, bufSize);
+  }
+  int64_t el = taosGetTimestampUs() - st;
+  printf("  zlib ratio:%6.2f %8.1f MB/s", (double)size / compLen, (double)size * loops / (el > 0 ? el : 1));
+
+  compLen = tsCompressStringDictImp(data, size, numOfRows, comp, bufSize);
+  if (compLen < 0) {
+    printf("  dict: too many distinct values\n");
+  } else {
+    if (tsDecompressString(comp, compLen, numOfRows, output, bufSize, ONE_STAGE_COMP, buffer, bufSize) != size ||
+        memcmp(output, data, size) != 0) {
+      printf("\ndict round trip mismatch\n");
+      exit(1);
+    }
+    printf("  dict ratio:%7.2f %8.1f MB/s\n", (double)size / compLen,
+           benchStringDecode(comp, compLen, numOfRows, output, size, buffer, bufSize, loops));
+  }
+
+  free(data);
+  free(comp);
+  free(buffer);
+  free(output);
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfRows = 4096;
+  int32_t loops = 2000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-n]: number of rows of each block, default: %d\n", numOfRows);
+      printf("  [-l]: number of times each block is decompressed, default: %d\n", loops);
+      exit(0);
+    }
+  }
+
+  printf("cpu simd level: %s\n", levelNames[tsGetCpuSimdLevel()]);
+
+  // odd sizes also check the remainders of the vectorized loops
+  int32_t sizes[] = {1, 2, 3, 5, 129, 241, numOfRows};
+  for (int32_t t = 0; t < tListLen(types); ++t) {
+    for (int32_t pattern = 0; pattern < 4; ++pattern) {
+      for (int32_t s = 0; s < tListLen(sizes) - 1; ++s) {
+        runBench(&types[t], pattern, ONE_STAGE_COMP, sizes[s], 1);
+        runBench(&types[t], pattern, TWO_STAGE_COMP, sizes[s], 1);
+      }
+    }
+  }
+
+  printf("\nthroughput of %d rows:\n", numOfRows);
+  for (int32_t t = 0; t < tListLen(types); ++t) {
+    for (int32_t pattern = 0; pattern < 4; ++pattern) {
+      runBench(&types[t], pattern, ONE_STAGE_COMP, numOfRows, loops);
+      runBench(&types[t], pattern, TWO_STAGE_COMP, numOfRows, loops);
+    }
+  }
+
+  printf("\nstrings of %d rows:\n", numOfRows);
+  int32_t cards[] = {1, 10, 100, 500, 4096};
+  for (int32_t c = 0; c < tListLen(cards); ++c) {
+    runStringBench(cards[c], false, numOfRows, loops);
+    runStringBench(cards[c], true, numOfRows, loops);
+  }
+  runStringBench(1, false, 3, 1);
+
+  return 0;
+}
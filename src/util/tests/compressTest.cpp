@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "os.h"
+#include "taosdef.h"
+#include "ttype.h"
+#include "tscompression.h"
+
+namespace {
+
+// the binary column of the strings, an empty string in values is a null
+std::vector<char> toColumn(const std::vector<std::string>& values) {
+  std::vector<char> col;
+  for (size_t i = 0; i < values.size(); ++i) {
+    char        head[VARSTR_HEADER_SIZE + 1];
+    std::string v = values[i].empty() ? std::string(1, (char)TSDB_DATA_BINARY_NULL) : values[i];
+    varDataSetLen(head, v.size());
+    col.insert(col.end(), head, head + VARSTR_HEADER_SIZE);
+    col.insert(col.end(), v.begin(), v.end());
+  }
+  return col;
+}
+
+std::vector<std::string> randomValues(int32_t numOfRows, int32_t card, bool runs) {
+  std::vector<std::string> values;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int32_t v = runs ? (i / 64) % card : rand() % card;
+    values.push_back(v == 0 ? std::string() : "value_" + std::to_string(v));
+  }
+  return values;
+}
+
+// encode the strings by a dictionary and decode them, return the encoded length or -1
+int32_t dictRoundTrip(const std::vector<std::string>& values) {
+  std::vector<char> col = toColumn(values);
+  int32_t           size = (int32_t)col.size();
+  int32_t           numOfRows = (int32_t)values.size();
+  std::vector<char> comp(size + 1024), output(size + 1024), buffer(size + 1024);
+
+  int32_t compLen = tsCompressStringDictImp(col.data(), size, numOfRows, comp.data(), (int32_t)comp.size());
+  if (compLen < 0) {
+    return -1;
+  }
+  EXPECT_EQ(comp[0], STRING_DICT_COMPRESS);
+
+  EXPECT_EQ(tsDecompressStringDictImp(comp.data(), compLen, numOfRows, output.data(), (int32_t)output.size(),
+                                      buffer.data(), (int32_t)buffer.size()),
+            size);
+  EXPECT_EQ(memcmp(output.data(), col.data(), size), 0);
+
+  // no buffer for the codes compressed
+  EXPECT_EQ(tsDecompressStringDictImp(comp.data(), compLen, numOfRows, output.data(), (int32_t)output.size(), NULL, 0),
+            size);
+  EXPECT_EQ(memcmp(output.data(), col.data(), size), 0);
+
+  // the read path dispatches on the first byte
+  EXPECT_EQ(tsDecompressString(comp.data(), compLen, numOfRows, output.data(), (int32_t)output.size(), ONE_STAGE_COMP,
+                               buffer.data(), (int32_t)buffer.size()),
+            size);
+  return compLen;
+}
+
+}  // namespace
+
+TEST(testCase, compressStringDictRoundTrip) {
+  srand(1);
+  for (int32_t card : {1, 2, 7, 100, 500}) {
+    for (bool runs : {false, true}) {
+      ASSERT_GT(dictRoundTrip(randomValues(4096, card, runs)), 0) << "card:" << card << " runs:" << runs;
+    }
+  }
+
+  // rows not a multiple of the bytes of the codes
+  ASSERT_GT(dictRoundTrip(randomValues(1001, 13, false)), 0);
+}
+
+TEST(testCase, compressStringDictEntries) {
+  std::vector<std::string> values;
+  for (int32_t i = 0; i < 64; ++i) {
+    values.push_back(i % 3 == 0 ? "ok" : (i % 3 == 1 ? "warn" : ""));
+  }
+  std::vector<char> col = toColumn(values);
+  std::vector<char> comp(col.size() + 1024);
+  int32_t compLen = tsCompressStringDictImp(col.data(), (int32_t)col.size(), 64, comp.data(), (int32_t)comp.size());
+  ASSERT_GT(compLen, 0);
+  ASSERT_LT(compLen, (int32_t)col.size());
+
+  // the distinct values in order of first appearance
+  const char* pDict = NULL;
+  ASSERT_EQ(tsGetStringDict(comp.data(), compLen, &pDict), 3);
+  ASSERT_EQ(std::string((const char*)varDataVal(pDict), varDataLen(pDict)), "ok");
+  pDict += varDataTLen(pDict);
+  ASSERT_EQ(std::string((const char*)varDataVal(pDict), varDataLen(pDict)), "warn");
+  pDict += varDataTLen(pDict);
+  ASSERT_TRUE(isNull(pDict, TSDB_DATA_TYPE_BINARY));
+}
+
+TEST(testCase, compressStringDictRejected) {
+  // fewer than TS_STRING_DICT_MIN_RATIO rows per distinct value
+  ASSERT_EQ(dictRoundTrip(randomValues(4096, 4096, false)), -1);
+
+  std::vector<std::string> values;
+  for (int32_t i = 0; i < 4096; ++i) {
+    values.push_back("v" + std::to_string(i));
+  }
+  ASSERT_EQ(dictRoundTrip(values), -1);
+
+  // an LZ4 compressed string is not a dictionary
+  std::vector<char> col = toColumn(randomValues(4096, 10, false));
+  std::vector<char> comp(col.size() + 1024);
+  int32_t compLen = tsCompressStringImp(col.data(), (int32_t)col.size(), comp.data(), (int32_t)comp.size());
+  ASSERT_GT(compLen, 0);
+  const char* pDict = NULL;
+  ASSERT_EQ(tsGetStringDict(comp.data(), compLen, &pDict), -1);
+}
+
+TEST(testCase, compressStringDictCorrupted) {
+  std::vector<std::string> values = randomValues(4096, 50, false);
+  std::vector<char>        col = toColumn(values);
+  std::vector<char>        comp(col.size() + 1024), output(col.size() + 1024);
+  int32_t compLen = tsCompressStringDictImp(col.data(), (int32_t)col.size(), 4096, comp.data(), (int32_t)comp.size());
+  ASSERT_GT(compLen, 0);
+
+  // truncated
+  ASSERT_EQ(tsDecompressStringDictImp(comp.data(), compLen - 1, 4096, output.data(), (int32_t)output.size(), NULL, 0),
+            -1);
+
+  // too many entries
+  std::vector<char> bad(comp.begin(), comp.begin() + compLen);
+  int32_t           nEntries = TS_STRING_DICT_MAX_ENTRIES + 1;
+  memcpy(bad.data() + 1, &nEntries, sizeof(int32_t));
+  ASSERT_EQ(tsDecompressStringDictImp(bad.data(), compLen, 4096, output.data(), (int32_t)output.size(), NULL, 0), -1);
+
+  // the output is too small
+  ASSERT_EQ(tsDecompressStringDictImp(comp.data(), compLen, 4096, output.data(), (int32_t)col.size() - 1, NULL, 0),
+            -1);
+}
+
+TEST(testCase, compressZlibRoundTrip) {
+  std::vector<char> col = toColumn(randomValues(4096, 100, false));
+  int32_t           size = (int32_t)col.size();
+  std::vector<char> comp(size + 1024), output(size);
+
+  for (int32_t level = 0; level <= 10; ++level) {
+    int32_t compLen = tsCompressZlibImp(col.data(), size, comp.data(), (int32_t)comp.size(), level);
+    ASSERT_GT(compLen, 0) << "level:" << level;
+    ASSERT_LT(compLen, size / 2);
+    ASSERT_EQ(comp[0], 1);
+    ASSERT_EQ(tsDecompressZlibImp(comp.data(), compLen, output.data(), size), size);
+    ASSERT_EQ(memcmp(output.data(), col.data(), size), 0);
+  }
+
+  // the output is too small
+  ASSERT_EQ(tsDecompressZlibImp(comp.data(), tsCompressZlibImp(col.data(), size, comp.data(), (int32_t)comp.size(), 6),
+                                output.data(), size - 1),
+            -1);
+
+  // corrupted
+  comp[0] = 2;
+  ASSERT_EQ(tsDecompressZlibImp(comp.data(), size, output.data(), size), -1);
+  ASSERT_EQ(tsDecompressZlibImp(comp.data(), 0, output.data(), size), -1);
+}
+
+TEST(testCase, compressZlibIncompressible) {
+  // random bytes are stored as they are
+  std::vector<char> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (char)(rand() & 0xff);
+  }
+  std::vector<char> comp(data.size() + 1), output(data.size());
+
+  int32_t compLen = tsCompressZlibImp(data.data(), (int32_t)data.size(), comp.data(), (int32_t)comp.size(), 9);
+  ASSERT_EQ(compLen, (int32_t)data.size() + 1);
+  ASSERT_EQ(comp[0], 0);
+  ASSERT_EQ(tsDecompressZlibImp(comp.data(), compLen, output.data(), (int32_t)output.size()), (int32_t)data.size());
+  ASSERT_EQ(memcmp(output.data(), data.data(), data.size()), 0);
+
+  // no room for the data stored
+  ASSERT_EQ(tsCompressZlibImp(data.data(), (int32_t)data.size(), comp.data(), (int32_t)data.size(), 9), -1);
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "hash.h"
+#include "tutil.h"
+
+// the keys of the result rows of the query engine: the window start or the group value, and the group id
+typedef struct {
+  int64_t  ts;
+  uint64_t groupId;
+} SBenchKey;
+
+typedef struct {
+  int64_t putUs;
+  int64_t getUs;
+  int64_t missUs;
+  int64_t groupUs;
+} SBenchResult;
+
+static const char *layoutName[] = {"chained", "open addressing"};
+
+static void benchKey(SBenchKey *pKey, int32_t i) {
+  pKey->ts = 1600000000000LL + (int64_t)i * 60000;
+  pKey->groupId = (uint64_t)(i % 97);
+}
+
+static void runBench(SHashLayoutE layout, int32_t num, int32_t numOfRows, int32_t *order, SBenchResult *pRes) {
+  SHashObj *pHashObj = taosHashInitWithLayout(num / 16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true,
+                                              HASH_NO_LOCK, layout);
+  SBenchKey key = {0};
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < num; ++i) {
+    void *p = &order[i];
+    benchKey(&key, order[i]);
+    taosHashPut(pHashObj, &key, sizeof(key), &p, POINTER_BYTES);
+  }
+  pRes->putUs += taosGetTimestampUs() - st;
+
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < num; ++i) {
+    benchKey(&key, i);
+    void **p = taosHashGet(pHashObj, &key, sizeof(key));
+    if (p == NULL || *(int32_t *)(*p) != i) {
+      printf("%s: wrong value of key %d\n", layoutName[layout], i);
+      exit(1);
+    }
+  }
+  pRes->getUs += taosGetTimestampUs() - st;
+
+  st = taosGetTimestampUs();
+  for (int32_t i = num; i < num * 2; ++i) {
+    benchKey(&key, i);
+    if (taosHashGet(pHashObj, &key, sizeof(key)) != NULL) {
+      printf("%s: unexpected key %d\n", layoutName[layout], i);
+      exit(1);
+    }
+  }
+  pRes->missUs += taosGetTimestampUs() - st;
+  taosHashCleanup(pHashObj);
+
+  // group by: look up the result row of each row, and add it for a new group
+  pHashObj = taosHashInitWithLayout(16, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK, layout);
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    benchKey(&key, order[i % num] % (num / 10));
+    void **p = taosHashGet(pHashObj, &key, sizeof(key));
+    if (p == NULL) {
+      void *pRow = &order[i % num];
+      taosHashPut(pHashObj, &key, sizeof(key), &pRow, POINTER_BYTES);
+    }
+  }
+  pRes->groupUs += taosGetTimestampUs() - st;
+
+  if (taosHashGetSize(pHashObj) != num / 10) {
+    printf("%s: %d groups, expect %d\n", layoutName[layout], taosHashGetSize(pHashObj), num / 10);
+    exit(1);
+  }
+  taosHashCleanup(pHashObj);
+}
+
+int main(int argc, char *argv[]) {
+  int32_t num = 1000000;
+  int32_t loops = 3;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      num = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-n]: number of keys, default: %d\n", num);
+      printf("  [-l]: number of loops, default: %d\n", loops);
+      exit(0);
+    }
+  }
+
+  num = MAX(num, 10);
+  int32_t  numOfRows = num * 10;
+  int32_t *order = malloc(sizeof(int32_t) * num);
+  for (int32_t i = 0; i < num; ++i) {
+    order[i] = i;
+  }
+
+  srand(1);
+  for (int32_t i = num - 1; i > 0; --i) {
+    int32_t j = rand() % (i + 1);
+    int32_t t = order[i];
+    order[i] = order[j];
+    order[j] = t;
+  }
+
+  printf("keys:%d, rows of group by:%d, groups:%d, loops:%d\n", num, numOfRows, num / 10, loops);
+  for (int32_t layout = HASH_CHAINED; layout <= HASH_OPEN_ADDRESSING; ++layout) {
+    SBenchResult res = {0};
+    for (int32_t l = 0; l < loops; ++l) {
+      runBench((SHashLayoutE)layout, num, numOfRows, order, &res);
+    }
+
+    printf("%-16s put:%8.1f ns  get:%8.1f ns  miss:%8.1f ns  group by:%8.1f ns/row\n", layoutName[layout],
+           res.putUs * 1000.0 / loops / num, res.getUs * 1000.0 / loops / num, res.missUs * 1000.0 / loops / num,
+           res.groupUs * 1000.0 / loops / numOfRows);
+  }
+
+  free(order);
+  return 0;
+}
@@ -3,6 +3,8 @@
 #include <limits.h>
 #include <taosdef.h>
 #include <iostream>
+#include <map>
+#include <string>
 
 #include "hash.h"
 #include "taos.h"
@@ -132,6 +134,200 @@ void noLockPerformanceTest() {
   taosHashCleanup(hashTable);
 }
 
+bool keepEven(void* param, void* data) { return (*(int32_t*)data) % 2 == 0; }
+
+void checkOpenAddressing(SHashObj* hashTable, const std::map<std::string, int32_t>& expect) {
+  ASSERT_EQ(taosHashGetSize(hashTable), (int32_t)expect.size());
+
+  for (auto it = expect.begin(); it != expect.end(); ++it) {
+    int32_t* p = (int32_t*)taosHashGet(hashTable, it->first.c_str(), it->first.size());
+    ASSERT_TRUE(p != nullptr);
+    ASSERT_EQ(*p, it->second);
+    ASSERT_EQ(taosHashGetDataKeyLen(hashTable, p), it->first.size());
+    ASSERT_EQ(memcmp(taosHashGetDataKey(hashTable, p), it->first.c_str(), it->first.size()), 0);
+  }
+
+  size_t  num = 0;
+  void*   p = taosHashIterate(hashTable, nullptr);
+  while (p) {
+    std::string key((char*)taosHashGetDataKey(hashTable, p), taosHashGetDataKeyLen(hashTable, p));
+    auto        it = expect.find(key);
+    ASSERT_TRUE(it != expect.end());
+    ASSERT_EQ(*(int32_t*)p, it->second);
+    num += 1;
+    p = taosHashIterate(hashTable, p);
+  }
+  ASSERT_EQ(num, expect.size());
+}
+
+// keys shorter and longer than the inline keys, updates, removes during the iteration, and clear
+void openAddressingTest() {
+  SHashObj* hashTable = taosHashInitWithLayout(4, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true,
+                                               HASH_NO_LOCK, HASH_OPEN_ADDRESSING);
+  std::map<std::string, int32_t> expect;
+  char                           key[128] = {0};
+
+  for (int32_t i = 0; i < 20000; ++i) {
+    int32_t len = (i % 3 == 0) ? sprintf(key, "%d_1_%dabcefg_long_key", i, i + 10) : sprintf(key, "%d", i);
+    ASSERT_EQ(taosHashPut(hashTable, key, len, &i, sizeof(int32_t)), 0);
+    expect[std::string(key, len)] = i;
+  }
+  checkOpenAddressing(hashTable, expect);
+
+  // update in place and with a larger data
+  for (int32_t i = 0; i < 20000; i += 7) {
+    int32_t len = sprintf(key, "%d", i);
+    int64_t v = -i;
+    if (expect.count(std::string(key, len)) == 0) continue;
+    ASSERT_EQ(taosHashPut(hashTable, key, len, &v, (i % 2) ? sizeof(int64_t) : sizeof(int32_t)), 0);
+    expect[std::string(key, len)] = -i;
+  }
+  checkOpenAddressing(hashTable, expect);
+
+  for (int32_t i = 0; i < 20000; i += 2) {
+    int32_t len = (i % 3 == 0) ? sprintf(key, "%d_1_%dabcefg_long_key", i, i + 10) : sprintf(key, "%d", i);
+    ASSERT_EQ(taosHashRemove(hashTable, key, len), 0);
+    ASSERT_EQ(taosHashRemove(hashTable, key, len), -1);
+    expect.erase(std::string(key, len));
+  }
+  checkOpenAddressing(hashTable, expect);
+
+  // remove the current element during the iteration
+  void* p = taosHashIterate(hashTable, nullptr);
+  while (p) {
+    std::string k((char*)taosHashGetDataKey(hashTable, p), taosHashGetDataKeyLen(hashTable, p));
+    if (*(int32_t*)p % 5 == 0) {
+      ASSERT_EQ(taosHashRemove(hashTable, k.c_str(), k.size()), 0);
+      ASSERT_TRUE(taosHashGet(hashTable, k.c_str(), k.size()) == nullptr);
+      expect.erase(k);
+    }
+    p = taosHashIterate(hashTable, p);
+  }
+  checkOpenAddressing(hashTable, expect);
+
+  taosHashCondTraverse(hashTable, keepEven, nullptr);
+  for (auto it = expect.begin(); it != expect.end();) {
+    it = (it->second % 2 == 0) ? std::next(it) : expect.erase(it);
+  }
+  checkOpenAddressing(hashTable, expect);
+
+  taosHashClear(hashTable);
+  expect.clear();
+  checkOpenAddressing(hashTable, expect);
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    int32_t len = sprintf(key, "%d", i);
+    ASSERT_EQ(taosHashPut(hashTable, key, len, &i, sizeof(int32_t)), 0);
+    expect[std::string(key, len)] = i;
+  }
+  checkOpenAddressing(hashTable, expect);
+  taosHashCleanup(hashTable);
+
+  // no new key is added if the table has to grow during an iteration, until the iteration ends
+  hashTable = taosHashInitWithLayout(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK,
+                                     HASH_OPEN_ADDRESSING);
+  expect.clear();
+  for (int32_t i = 0; i < 10; ++i) {
+    int32_t len = sprintf(key, "%d", i);
+    ASSERT_EQ(taosHashPut(hashTable, key, len, &i, sizeof(int32_t)), 0);
+    expect[std::string(key, len)] = i;
+  }
+
+  p = taosHashIterate(hashTable, nullptr);
+  int32_t i = 10;
+  for (; i < 10000; ++i) {
+    int32_t len = sprintf(key, "%d", i);
+    if (taosHashPut(hashTable, key, len, &i, sizeof(int32_t)) != 0) break;
+    expect[std::string(key, len)] = i;
+  }
+  ASSERT_LT(i, 10000);
+  taosHashCancelIterate(hashTable, p);
+
+  int32_t len = sprintf(key, "%d", i);
+  ASSERT_EQ(taosHashPut(hashTable, key, len, &i, sizeof(int32_t)), 0);
+  expect[std::string(key, len)] = i;
+  checkOpenAddressing(hashTable, expect);
+
+  for (i += 1; i < 10000; ++i) {
+    len = sprintf(key, "%d", i);
+    ASSERT_EQ(taosHashPut(hashTable, key, len, &i, sizeof(int32_t)), 0);
+    expect[std::string(key, len)] = i;
+  }
+  checkOpenAddressing(hashTable, expect);
+  taosHashCleanup(hashTable);
+
+  // no update
+  hashTable = taosHashInitWithLayout(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false, HASH_ENTRY_LOCK,
+                                     HASH_OPEN_ADDRESSING);
+  int32_t k = 1, v = 2;
+  ASSERT_EQ(taosHashPut(hashTable, &k, sizeof(k), &v, sizeof(v)), 0);
+  ASSERT_EQ(taosHashPut(hashTable, &k, sizeof(k), &k, sizeof(k)), -1);
+  ASSERT_EQ(*(int32_t*)taosHashGet(hashTable, &k, sizeof(k)), v);
+  taosHashCleanup(hashTable);
+}
+
+// put the keys from "from" to "to", return the first one failed or "to"
+int32_t putKeys(SHashObj* hashTable, int32_t from, int32_t to, std::map<std::string, int32_t>& expect) {
+  char key[32] = {0};
+  for (int32_t i = from; i < to; ++i) {
+    int32_t len = sprintf(key, "%d", i);
+    if (taosHashPut(hashTable, key, len, &i, sizeof(int32_t)) != 0) return i;
+    expect[std::string(key, len)] = i;
+  }
+  return to;
+}
+
+// the iterations cancelled, ended or cleared do not keep the open addressing layout from growing
+void openAddressingIterateTest() {
+  SHashObj* hashTable = taosHashInitWithLayout(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true,
+                                               HASH_NO_LOCK, HASH_OPEN_ADDRESSING);
+  std::map<std::string, int32_t> expect;
+  ASSERT_EQ(putKeys(hashTable, 0, 10, expect), 10);
+
+  // cancelled in the middle
+  void* p = taosHashIterate(hashTable, nullptr);
+  p = taosHashIterate(hashTable, p);
+  p = taosHashIterate(hashTable, p);
+  ASSERT_TRUE(p != nullptr);
+  taosHashCancelIterate(hashTable, p);
+  ASSERT_EQ(putKeys(hashTable, 10, 1000, expect), 1000);
+  checkOpenAddressing(hashTable, expect);
+
+  // cancelled at the last element
+  size_t num = 1;
+  p = taosHashIterate(hashTable, nullptr);
+  for (; num < expect.size(); ++num) {
+    p = taosHashIterate(hashTable, p);
+  }
+  ASSERT_TRUE(p != nullptr);
+  taosHashCancelIterate(hashTable, p);
+  ASSERT_EQ(putKeys(hashTable, 1000, 5000, expect), 5000);
+  checkOpenAddressing(hashTable, expect);
+
+  // two iterations, the table grows after both of them are over
+  void* p1 = taosHashIterate(hashTable, nullptr);
+  void* p2 = taosHashIterate(hashTable, nullptr);
+  int32_t i = putKeys(hashTable, 5000, 100000, expect);
+  ASSERT_LT(i, 100000);
+  taosHashCancelIterate(hashTable, p1);
+  ASSERT_EQ(putKeys(hashTable, i, i + 1, expect), i);
+  while (p2) {
+    p2 = taosHashIterate(hashTable, p2);
+  }
+  ASSERT_EQ(putKeys(hashTable, i, 100000, expect), 100000);
+  checkOpenAddressing(hashTable, expect);
+
+  // cleared during an iteration
+  p = taosHashIterate(hashTable, nullptr);
+  ASSERT_TRUE(p != nullptr);
+  taosHashClear(hashTable);
+  expect.clear();
+  ASSERT_EQ(putKeys(hashTable, 0, 100000, expect), 100000);
+  checkOpenAddressing(hashTable, expect);
+
+  taosHashCleanup(hashTable);
+}
+
 void multithreadsTest() {
   //todo
 }
@@ -154,3 +350,11 @@ TEST(testCase, hashTest) {
   noLockPerformanceTest();
   multithreadsTest();
 }
+
+TEST(testCase, hashOpenAddressingTest) {
+  openAddressingTest();
+}
+
+TEST(testCase, hashOpenAddressingIterateTest) {
+  openAddressingIterateTest();
+}
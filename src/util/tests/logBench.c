@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tlog.h"
+#include "tutil.h"
+
+extern int64_t asyncLogLostLines;
+
+typedef struct {
+  int32_t  index;
+  int32_t  numOfLines;
+  int64_t  us;
+  pthread_t thread;
+} SBenchThread;
+
+static void *logThreadFunc(void *param) {
+  SBenchThread *pThread = (SBenchThread *)param;
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < pThread->numOfLines; ++i) {
+    taosPrintLog("UTL ", DEBUG_FILE, "logBench line:%d of thread:%d, vgId:%d, msg:%p, version:%" PRId64 " is processed",
+                 i, pThread->index, i % 100, pThread, (int64_t)i * 7);
+  }
+  pThread->us = taosGetTimestampUs() - st;
+
+  return NULL;
+}
+
+// the lines of the benchmark in the log file, to check that no line is lost or broken besides the reported ones
+static int64_t countLogLines(const char *fileName) {
+  FILE *fp = fopen(fileName, "r");
+  if (fp == NULL) return -1;
+
+  char    line[1024];
+  int64_t num = 0;
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    char *p = strstr(line, "UTL logBench line:");
+    if (p != NULL && strstr(p, " is processed\n") != NULL) num++;
+  }
+
+  fclose(fp);
+  return num;
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfThreads = 64;
+  int32_t numOfLines = 50000;
+  char    dir[PATH_MAX] = "/tmp/logBench";
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+      numOfThreads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfLines = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i < argc - 1) {
+      tstrncpy(dir, argv[++i], sizeof(dir));
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-t]: number of logging threads, default: %d\n", numOfThreads);
+      printf("  [-n]: number of lines of each thread, default: %d\n", numOfLines);
+      printf("  [-d]: log directory, default: %s\n", dir);
+      exit(0);
+    }
+  }
+
+  char name[PATH_MAX + 16];
+  char fileName[PATH_MAX + 32];
+  taosMkDir(dir, 0755);
+  snprintf(name, sizeof(name), "%s/logBench", dir);
+  snprintf(fileName, sizeof(fileName), "%s.0", name);
+  (void)remove(fileName);
+  snprintf(fileName, sizeof(fileName), "%s.1", name);
+  (void)remove(fileName);
+
+  if (taosInitLog(name, INT32_MAX, 1) < 0) {
+    printf("failed to init log in %s\n", dir);
+    exit(1);
+  }
+
+  SBenchThread *threads = calloc(numOfThreads, sizeof(SBenchThread));
+  int64_t       st = taosGetTimestampUs();
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    threads[i].index = i;
+    threads[i].numOfLines = numOfLines;
+    pthread_create(&threads[i].thread, NULL, logThreadFunc, &threads[i]);
+  }
+
+  int64_t maxUs = 0;
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_join(threads[i].thread, NULL);
+    maxUs = MAX(maxUs, threads[i].us);
+  }
+  int64_t us = taosGetTimestampUs() - st;
+  taosCloseLog();
+
+  int64_t total = (int64_t)numOfThreads * numOfLines;
+  int64_t lost = asyncLogLostLines;
+  printf("threads:%d, lines:%" PRId64 ", elapsed:%.3f ms, slowest thread:%.3f ms, %.1f ns/line, %.3f M lines/s, lost:%" PRId64
+         "\n",
+         numOfThreads, total, us / 1000.0, maxUs / 1000.0, us * 1000.0 / total, total / (double)us, lost);
+
+  snprintf(fileName, sizeof(fileName), "%s.0", name);
+  int64_t written = countLogLines(fileName);
+  if (written != total - lost) {
+    printf("%" PRId64 " lines in %s, expect %" PRId64 "\n", written, fileName, total - lost);
+    exit(1);
+  }
+
+  free(threads);
+  return 0;
+}
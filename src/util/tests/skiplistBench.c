@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tcompare.h"
+#include "tskiplist.h"
+#include "tutil.h"
+
+typedef struct {
+  SSkipList *pSkipList;
+  int64_t   *keys;
+  int32_t    numOfKeys;
+  int32_t    stop;
+  int64_t    writeUs;
+  int64_t    maxPutUs;
+} SBenchWriter;
+
+typedef struct {
+  SBenchWriter *pWriter;
+  int32_t       scanLen;
+  uint32_t      seed;
+  int64_t       numOfScans;
+} SBenchReader;
+
+static char *getInt64Key(const void *data) { return (char *)data; }
+
+static void *writeThread(void *param) {
+  SBenchWriter *pWriter = (SBenchWriter *)param;
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < pWriter->numOfKeys; ++i) {
+    int64_t s = taosGetTimestampUs();
+    tSkipListPut(pWriter->pSkipList, &pWriter->keys[i]);
+    int64_t el = taosGetTimestampUs() - s;
+    if (el > pWriter->maxPutUs) pWriter->maxPutUs = el;
+  }
+  pWriter->writeUs = taosGetTimestampUs() - st;
+
+  atomic_store_32(&pWriter->stop, 1);
+  return NULL;
+}
+
+static void *readThread(void *param) {
+  SBenchReader *pReader = (SBenchReader *)param;
+  SBenchWriter *pWriter = pReader->pWriter;
+
+  while (atomic_load_32(&pWriter->stop) == 0) {
+    int64_t key = rand_r(&pReader->seed) % pWriter->numOfKeys;
+    int32_t order = (pReader->numOfScans & 1) ? TSDB_ORDER_DESC : TSDB_ORDER_ASC;
+
+    SSkipListIterator *pIter = tSkipListCreateIterFromVal(pWriter->pSkipList, (char *)&key, TSDB_DATA_TYPE_BIGINT, order);
+    int64_t prev = (order == TSDB_ORDER_ASC) ? INT64_MIN : INT64_MAX;
+    for (int32_t i = 0; i < pReader->scanLen && tSkipListIterNext(pIter); ++i) {
+      int64_t cur = *(int64_t *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+      if ((order == TSDB_ORDER_ASC && cur <= prev) || (order == TSDB_ORDER_DESC && cur >= prev)) {
+        printf("out of order key %" PRId64 " after %" PRId64 "\n", cur, prev);
+        exit(1);
+      }
+      prev = cur;
+    }
+    tSkipListDestroyIter(pIter);
+
+    pReader->numOfScans++;
+  }
+
+  return NULL;
+}
+
+static void runBench(const char *name, uint8_t flags, int64_t *keys, int32_t numOfKeys, int32_t numOfReaders,
+                     int32_t scanLen) {
+  SBenchWriter writer = {0};
+  writer.pSkipList = tSkipListCreate(5, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t),
+                                     getKeyComparFunc(TSDB_DATA_TYPE_BIGINT, TSDB_ORDER_ASC), flags, getInt64Key);
+  writer.keys = keys;
+  writer.numOfKeys = numOfKeys;
+
+  SBenchReader *pReaders = (SBenchReader *)calloc(numOfReaders, sizeof(SBenchReader));
+  pthread_t    *pThreads = (pthread_t *)calloc(numOfReaders + 1, sizeof(pthread_t));
+
+  for (int32_t i = 0; i < numOfReaders; ++i) {
+    pReaders[i].pWriter = &writer;
+    pReaders[i].scanLen = scanLen;
+    pReaders[i].seed = (uint32_t)i + 1;
+    pthread_create(&pThreads[i + 1], NULL, readThread, &pReaders[i]);
+  }
+  pthread_create(&pThreads[0], NULL, writeThread, &writer);
+
+  int64_t numOfScans = 0;
+  for (int32_t i = 0; i <= numOfReaders; ++i) {
+    pthread_join(pThreads[i], NULL);
+    if (i > 0) numOfScans += pReaders[i - 1].numOfScans;
+  }
+
+  if (SL_SIZE(writer.pSkipList) != (uint32_t)numOfKeys) {
+    printf("%s: size %u, expect %d\n", name, SL_SIZE(writer.pSkipList), numOfKeys);
+    exit(1);
+  }
+
+  printf("%-10s readers:%2d  put:%8.3f us/row  max put:%8" PRId64 " us  scans:%10" PRId64 " (%.0f/s)\n", name,
+         numOfReaders, (double)writer.writeUs / numOfKeys, writer.maxPutUs, numOfScans,
+         numOfScans * 1000000.0 / (writer.writeUs > 0 ? writer.writeUs : 1));
+
+  tSkipListDestroy(writer.pSkipList);
+  free(pReaders);
+  free(pThreads);
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfKeys = 100000;
+  int32_t scanLen = 100;
+  int32_t readers[] = {1, 8, 32};
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfKeys = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-s") == 0 && i < argc - 1) {
+      scanLen = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-n]: number of rows inserted by the writer, default: %d\n", numOfKeys);
+      printf("  [-s]: number of rows visited by each reader scan, default: %d\n", scanLen);
+      exit(0);
+    }
+  }
+
+  // mostly in order keys with some disorder, which is the typical pattern of the memtable
+  int64_t *keys = (int64_t *)malloc(sizeof(int64_t) * numOfKeys);
+  for (int32_t i = 0; i < numOfKeys; ++i) {
+    keys[i] = i;
+  }
+  for (int32_t i = 0; i < numOfKeys / 10; ++i) {
+    int32_t a = rand() % numOfKeys;
+    int32_t b = a + rand() % 100;
+    if (b >= numOfKeys) b = numOfKeys - 1;
+    int64_t t = keys[a];
+    keys[a] = keys[b];
+    keys[b] = t;
+  }
+
+  for (int32_t i = 0; i < tListLen(readers); ++i) {
+    runBench("rwlock", SL_DISCARD_DUP_KEY | SL_THREAD_SAFE, keys, numOfKeys, readers[i], scanLen);
+    runBench("lock-free", SL_DISCARD_DUP_KEY | SL_SINGLE_WRITER, keys, numOfKeys, readers[i], scanLen);
+  }
+
+  free(keys);
+  return 0;
+}
@@ -3,6 +3,7 @@
 #include <taosdef.h>
 #include <tcompare.h>
 #include <iostream>
+#include <vector>
 
 #include "os.h"
 #include "taosmsg.h"
@@ -377,4 +378,54 @@ TEST(testCase, skiplist_test) {
       free(pKeys);*/
 }
 
-#endif
\ No newline at end of file
+#endif
+namespace {
+
+char* getInt64Key(const void* data) { return (char*)data; }
+
+}  // namespace
+
+TEST(testCase, skiplist_arena_usage) {
+  int64_t totalBytes = tSkipListArenaGetTotalBytes();
+
+  SSkipListArena* pArena = tSkipListArenaCreate(4096);
+  ASSERT_TRUE(pArena != NULL);
+
+  int64_t numOfPages = -1, usedBytes = -1, allocBytes = -1;
+  tSkipListArenaGetUsage(pArena, &numOfPages, &usedBytes, &allocBytes);
+  ASSERT_EQ(numOfPages, 0);
+  ASSERT_EQ(usedBytes, 0);
+  ASSERT_EQ(allocBytes, 0);
+
+  SSkipList* pSkipList = tSkipListCreate(MAX_SKIP_LIST_LEVEL, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t),
+                                         getKeyComparFunc(TSDB_DATA_TYPE_BIGINT, TSDB_ORDER_ASC), SL_DISCARD_DUP_KEY,
+                                         getInt64Key);
+  ASSERT_TRUE(pSkipList != NULL);
+  tSkipListSetArena(pSkipList, pArena);
+
+  std::vector<int64_t> keys(20000);
+  int64_t              lastPages = 0, lastUsed = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = (int64_t)i;
+    ASSERT_TRUE(tSkipListPut(pSkipList, &keys[i]) != NULL);
+
+    if ((i + 1) % 5000 == 0) {
+      tSkipListArenaGetUsage(pArena, &numOfPages, &usedBytes, &allocBytes);
+      ASSERT_GT(numOfPages, lastPages);
+      ASSERT_GT(usedBytes, lastUsed);
+      ASSERT_GE(allocBytes, usedBytes);
+      ASSERT_GE(allocBytes, numOfPages * 4096);
+      ASSERT_EQ(tSkipListArenaGetTotalBytes() - totalBytes, allocBytes);
+      lastPages = numOfPages;
+      lastUsed = usedBytes;
+    }
+  }
+  ASSERT_EQ(SL_SIZE(pSkipList), (uint32_t)keys.size());
+
+  // the nodes belong to the arena, destroying the skiplist releases nothing
+  tSkipListDestroy(pSkipList);
+  ASSERT_EQ(tSkipListArenaGetTotalBytes() - totalBytes, allocBytes);
+
+  tSkipListArenaDestroy(pArena);
+  ASSERT_EQ(tSkipListArenaGetTotalBytes(), totalBytes);
+}
@@ -4,6 +4,8 @@
 #include <iostream>
 
 #include "taos.h"
+#include "tcompare.h"
+#include "ttype.h"
 #include "tutil.h"
 
 TEST(testCase, str_escape_test) {
@@ -239,4 +241,39 @@ TEST(testCase, string_strnchr_test) {
 
 //   char a16[] = "'-'.";
 //   EXPECT_TRUE(strnchr(a16, '.', strlen(a16), true) != NULL);
-// }
\ No newline at end of file
+// }
+TEST(testCase, regex_matcher_test) {
+  const char *pattern = "^d[0-9]+_x$";
+  SRegexMatcher *pMatcher = regexMatcherCreate(pattern, strlen(pattern));
+  ASSERT_TRUE(pMatcher != NULL);
+
+  EXPECT_EQ(0, regexMatcherExec(pMatcher, "d1001_x", 7));
+  EXPECT_EQ(1, regexMatcherExec(pMatcher, "d1001_xy", 8));
+  // only len bytes of the subject are matched
+  EXPECT_EQ(0, regexMatcherExec(pMatcher, "d7_xyz", 4));
+  EXPECT_EQ(1, regexMatcherExec(pMatcher, "", 0));
+
+  // the scratch buffer grows with the subject
+  std::string s = "d" + std::string(10000, '9') + "_x";
+  EXPECT_EQ(0, regexMatcherExec(pMatcher, s.c_str(), s.size()));
+  regexMatcherDestroy(pMatcher);
+
+  // an invalid pattern matches nothing
+  pMatcher = regexMatcherCreate("a[", 2);
+  ASSERT_TRUE(pMatcher != NULL);
+  EXPECT_EQ(1, regexMatcherExec(pMatcher, "a[", 2));
+  regexMatcherDestroy(pMatcher);
+
+  // compareStrRegexComp compiles the pattern again when it changes
+  char str[32], p1[32], p2[32];
+  const char *src[] = {"abc", "^a", "^b"};
+  char       *dst[] = {str, p1, p2};
+  for (int i = 0; i < 3; ++i) {
+    varDataSetLen(dst[i], strlen(src[i]));
+    memcpy(varDataVal(dst[i]), src[i], strlen(src[i]));
+  }
+  EXPECT_EQ(0, compareStrRegexComp(str, p1));
+  EXPECT_EQ(1, compareStrRegexComp(str, p2));
+  EXPECT_EQ(0, compareStrRegexComp(str, p1));
+  EXPECT_EQ(1, compareStrRegexCompNMatch(str, p1));
+}
@@ -42,6 +42,8 @@ typedef struct {
   int32_t  queuedWMsg;
   int32_t  queuedRMsg;
   int32_t  flowctrlLevel;
+  int64_t  flowctrlMsgs;      // msgs delayed by flowctrl
+  int64_t  flowctrlRejected;  // msgs rejected after too many retries of flowctrl
   int8_t   preClose;  // drop and close switch
   int8_t   reserved[3];
   int64_t  sequence;  // for topic
@@ -56,11 +58,14 @@ typedef struct {
   uint64_t version;   // current version
   uint64_t cversion;  // version while commit start
   uint64_t fversion;  // version on saved data file
+  uint64_t bversion;  // version before the batch of writes whose wal is not written yet
   uint32_t tblMsgVer; // create table msg version
   void *   wqueue;    // write queue
   void *   qqueue;    // read query queue
   void *   fqueue;    // read fetch/cancel queue
   void *   wal;
+  SArray * pBatchHeads;   // heads and msgs of the batch of writes whose wal is not written yet
+  SArray * pBatchWrites;
   void *   tsdb;
   int64_t  sync;
   void *   events;
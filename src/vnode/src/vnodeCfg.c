@@ -36,6 +36,8 @@ static void vnodeLoadCfg(SVnodeObj *pVnode, SCreateVnodeMsg* vnodeMsg) {
   pVnode->tsdbCfg.compression = vnodeMsg->cfg.compression;
   pVnode->tsdbCfg.update = vnodeMsg->cfg.update;
   pVnode->tsdbCfg.cacheLastRow = vnodeMsg->cfg.cacheLastRow;
+  const char *dbName = strchr(vnodeMsg->db, TS_PATH_DELIMITER[0]);
+  tstrncpy(pVnode->tsdbCfg.db, (dbName != NULL) ? dbName + 1 : vnodeMsg->db, sizeof(pVnode->tsdbCfg.db));
   pVnode->walCfg.walLevel = vnodeMsg->cfg.walLevel;
   pVnode->walCfg.fsyncPeriod = vnodeMsg->cfg.fsyncPeriod;
   pVnode->walCfg.keep = TAOS_WAL_NOT_KEEP;
@@ -474,6 +474,9 @@ void vnodeDestroy(SVnodeObj *pVnode) {
     pVnode->wal = NULL;
   }
 
+  taosArrayDestroy(&pVnode->pBatchHeads);
+  taosArrayDestroy(&pVnode->pBatchWrites);
+
   if (pVnode->wqueue) {
     dnodeFreeVWriteQueue(pVnode->wqueue);
     pVnode->wqueue = NULL;
@@ -35,7 +35,8 @@ static SStep tsVnodeSteps[] = {
   {"vnode-write",  vnodeInitWrite,      vnodeCleanupWrite},
   {"vnode-read",   vnodeInitRead,       vnodeCleanupRead},
   {"vnode-hash",   vnodeInitHash,       vnodeCleanupHash},
-  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue}
+  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue},
+  {"tsdb-ra",      tsdbInitReadAheadPool, tsdbDestroyReadAheadPool}
 };
 
 int32_t vnodeInitMgmt() {
@@ -143,12 +144,14 @@ static void vnodeBuildVloadMsg(SVnodeObj *pVnode, SStatusMsg *pStatus) {
   int64_t totalStorage = 0;
   int64_t compStorage = 0;
   int64_t pointsWritten = 0;
+  int64_t memArenaPages = 0;
+  int64_t memArenaBytes = 0;
 
   if (vnodeInClosingStatus(pVnode)) return;
   if (pStatus->openVnodes >= TSDB_MAX_VNODES) return;
 
   if (pVnode->tsdb) {
-    tsdbReportStat(pVnode->tsdb, &pointsWritten, &totalStorage, &compStorage);
+    tsdbReportStat(pVnode->tsdb, &pointsWritten, &totalStorage, &compStorage, &memArenaPages, &memArenaBytes);
   }
 
   SVnodeLoad *pLoad = &pStatus->load[pStatus->openVnodes++];
@@ -158,6 +161,8 @@ static void vnodeBuildVloadMsg(SVnodeObj *pVnode, SStatusMsg *pStatus) {
   pLoad->totalStorage = htobe64(totalStorage);
   pLoad->compStorage = htobe64(compStorage);
   pLoad->pointsWritten = htobe64(pointsWritten);
+  pLoad->memArenaPages = htobe64(memArenaPages);
+  pLoad->memArenaBytes = htobe64(memArenaBytes);
   pLoad->vnodeVersion = htobe64(pVnode->version);
   pLoad->status = pVnode->status;
   pLoad->role = pVnode->role;
@@ -199,6 +204,33 @@ void vnodeBuildStatusMsg(void *param) {
   }
 }
 
+// The depth of the write queue, the counts of flowctrl and the memtable arena usage of each vnode, return the number
+// of vnodes
+int32_t vnodeGetWQueueStat(SVnodeWQueueStat *pStats, int32_t maxNum) {
+  int32_t num = 0;
+
+  void *pIter = taosHashIterate(tsVnodesHash, NULL);
+  while (pIter) {
+    SVnodeObj **pVnode = pIter;
+    if (*pVnode && num < maxNum) {
+      SVnodeWQueueStat *pStat = &pStats[num++];
+      pStat->vgId = (*pVnode)->vgId;
+      pStat->queuedMsgs = atomic_load_32(&(*pVnode)->queuedWMsg);
+      pStat->queuedBytes = atomic_load_64(&(*pVnode)->queuedWMsgSize);
+      pStat->flowctrlMsgs = atomic_load_64(&(*pVnode)->flowctrlMsgs);
+      pStat->flowctrlRejected = atomic_load_64(&(*pVnode)->flowctrlRejected);
+      if ((*pVnode)->tsdb != NULL && !vnodeInClosingStatus(*pVnode)) {
+        int64_t totalStorage = 0, compStorage = 0, pointsWritten = 0;
+        tsdbReportStat((*pVnode)->tsdb, &pointsWritten, &totalStorage, &compStorage, &pStat->memArenaPages,
+                       &pStat->memArenaBytes);
+      }
+    }
+    pIter = taosHashIterate(tsVnodesHash, pIter);
+  }
+
+  return num;
+}
+
 void vnodeSetAccess(SVgroupAccess *pAccess, int32_t numOfVnodes) {
   for (int32_t i = 0; i < numOfVnodes; ++i) {
     pAccess[i].vgId = htonl(pAccess[i].vgId);
@@ -26,6 +26,10 @@
 
 #define MAX_QUEUED_MSG_NUM 100000
 #define MAX_QUEUED_MSG_SIZE 1024*1024*1024  //1GB
+// a throttled msg is rejected over these limits whatever tsEnableFlowCtrl is
+#define MAX_FLOWCTRL_RETRY 100
+#define MAX_FLOWCTRL_RETRY_HARD 1000
+#define MAX_QUEUED_MSG_SIZE_HARD (MAX_QUEUED_MSG_SIZE * 2LL)
 
 static int64_t tsSubmitReqSucNum = 0;
 static int64_t tsSubmitRowNum = 0;
@@ -41,6 +45,7 @@ static int32_t vnodeProcessDropStableMsg(SVnodeObj *pVnode, void *pCont, SRspRet
 static int32_t vnodeProcessUpdateTagValMsg(SVnodeObj *pVnode, void *pCont, SRspRet *);
 static int32_t vnodePerformFlowCtrl(SVWriteMsg *pWrite);
 static int32_t vnodeCheckWal(SVnodeObj *pVnode);
+static int32_t vnodeAddIntoBatch(SVnodeObj *pVnode, SWalHead *pHead, SVWriteMsg *pWrite);
 
 int32_t vnodeInitWrite(void) {
   vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_SUBMIT]          = vnodeProcessSubmitMsg;
@@ -102,6 +107,25 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
     return syncCode;
   }
 
+  // the writes from the write queue are held until the end of the batch, then vnodeFlushWrites writes the wal of
+  // the whole batch at once and applies them in order
+  if (pWrite != NULL) {
+    if (vnodeAddIntoBatch(pVnode, pHead, pWrite) == 0) {
+      pVnode->version = pHead->version;
+      return syncCode;
+    }
+
+    // no memory to hold it, the writes held before it are written first to keep the order of the versions
+    code = vnodeFlushWrites(pVnode);
+    if (code < 0) {
+      if (syncCode > 0) atomic_sub_fetch_32(&pWrite->processedCount, 1);
+      vError("vgId:%d, hver:%" PRIu64 " vver:%" PRIu64 " not written since the batch before it failed, code:0x%x",
+             pVnode->vgId, pHead->version, pVnode->version, code);
+      pHead->version = 0;
+      return code;
+    }
+  }
+
   // write into WAL
   if (!(tsShortcutFlag & TSDB_SHORTCUT_NR_VNODE_WAL_WRITE)) {
     code = walWrite(pVnode->wal, pHead);
@@ -125,6 +149,80 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
   return syncCode;
 }
 
+static int32_t vnodeAddIntoBatch(SVnodeObj *pVnode, SWalHead *pHead, SVWriteMsg *pWrite) {
+  if (pVnode->pBatchHeads == NULL) {
+    pVnode->pBatchHeads = taosArrayInit(64, POINTER_BYTES);
+    pVnode->pBatchWrites = taosArrayInit(64, POINTER_BYTES);
+    if (pVnode->pBatchHeads == NULL || pVnode->pBatchWrites == NULL) {
+      taosArrayDestroy(&pVnode->pBatchHeads);
+      taosArrayDestroy(&pVnode->pBatchWrites);
+      return -1;
+    }
+  }
+
+  if (taosArrayGetSize(pVnode->pBatchHeads) == 0) {
+    pVnode->bversion = pVnode->version;
+  }
+
+  if (taosArrayPush(pVnode->pBatchHeads, &pHead) == NULL) return -1;
+  if (taosArrayPush(pVnode->pBatchWrites, &pWrite) == NULL) {
+    taosArrayPop(pVnode->pBatchHeads);
+    return -1;
+  }
+
+  return 0;
+}
+
+// The code of each write in the batch is set to the result of the write, if the wal or the write fails. Return the
+// code of the wal write of the batch.
+int32_t vnodeFlushWrites(void *vparam) {
+  SVnodeObj *pVnode = vparam;
+  int32_t    numOfWrites = (int32_t)taosArrayGetSize(pVnode->pBatchHeads);
+  if (numOfWrites == 0) return 0;
+
+  SWalHead **pHeads = (SWalHead **)TARRAY_GET_START(pVnode->pBatchHeads);
+  SVWriteMsg **pWrites = (SVWriteMsg **)TARRAY_GET_START(pVnode->pBatchWrites);
+
+  int32_t code = 0;
+  if (!(tsShortcutFlag & TSDB_SHORTCUT_NR_VNODE_WAL_WRITE)) {
+    code = walWriteBatch(pVnode->wal, pHeads, numOfWrites);
+  }
+
+  if (code < 0) {
+    vError("vgId:%d, failed to write wal of %d msgs, hver:%" PRIu64 "-%" PRIu64 " vver:%" PRIu64 " code:0x%x",
+           pVnode->vgId, numOfWrites, pHeads[0]->version, pHeads[numOfWrites - 1]->version, pVnode->bversion, code);
+  }
+
+  // the versions were assigned ahead, roll back and advance it with each write applied, as the commit takes it
+  pVnode->version = pVnode->bversion;
+
+  for (int32_t i = 0; i < numOfWrites; ++i) {
+    SWalHead *  pHead = pHeads[i];
+    SVWriteMsg *pWrite = pWrites[i];
+    int32_t     syncCode = pWrite->code;
+
+    if (code < 0) {
+      pHead->version = 0;
+    } else {
+      pVnode->version = pHead->version;
+
+      // write data locally
+      pWrite->code = (*vnodeProcessWriteMsgFp[pHead->msgType])(pVnode, pHead->cont, &pWrite->rspRet);
+    }
+
+    if (code < 0 || pWrite->code < 0) {
+      if (syncCode > 0) atomic_sub_fetch_32(&pWrite->processedCount, 1);
+      if (code < 0) pWrite->code = code;
+    } else {
+      pWrite->code = syncCode;
+    }
+  }
+
+  taosArrayClear(pVnode->pBatchHeads);
+  taosArrayClear(pVnode->pBatchWrites);
+  return code;
+}
+
 static int32_t vnodeCheckWrite(SVnodeObj *pVnode) {
   if (!(pVnode->accessState & TSDB_VN_WRITE_ACCCESS)) {
     vDebug("vgId:%d, no write auth, refCount:%d pVnode:%p", pVnode->vgId, pVnode->refCount, pVnode);
@@ -315,18 +413,13 @@ static int32_t vnodeWriteToWQueueImp(SVWriteMsg *pWrite) {
   int32_t queued = atomic_add_fetch_32(&pVnode->queuedWMsg, 1);
   int64_t queuedSize = atomic_add_fetch_64(&pVnode->queuedWMsgSize, pWrite->walHead.len);
 
-  if (queued > MAX_QUEUED_MSG_NUM || queuedSize > MAX_QUEUED_MSG_SIZE) {
-    if (pWrite->qtype == TAOS_QTYPE_FWD) {
-      queued = atomic_sub_fetch_32(&pVnode->queuedWMsg, 1);
-      queuedSize = atomic_sub_fetch_64(&pVnode->queuedWMsgSize, pWrite->walHead.len);
+  // the msgs from client are delayed by vnodePerformFlowCtrl before the queue is full, so the limits are soft here
+  // and the thread writing into the queue is never blocked
+  if ((queued > MAX_QUEUED_MSG_NUM || queuedSize > MAX_QUEUED_MSG_SIZE) && pWrite->qtype == TAOS_QTYPE_FWD) {
+    queued = atomic_sub_fetch_32(&pVnode->queuedWMsg, 1);
+    queuedSize = atomic_sub_fetch_64(&pVnode->queuedWMsgSize, pWrite->walHead.len);
 
-      return -1;
-    }
-
-    int32_t ms = (queued / MAX_QUEUED_MSG_NUM) * 10 + 3;
-    if (ms > 100) ms = 100;
-    vDebug("vgId:%d, too many msg:%d in vwqueue, flow control %dms", pVnode->vgId, queued, ms);
-    taosMsleep(ms);
+    return -1;
   }
 
   vTrace("vgId:%d, write into vwqueue, refCount:%d queued:%d size:%" PRId64, pVnode->vgId, pVnode->refCount,
@@ -355,7 +448,12 @@ int32_t vnodeWriteToWQueue(void *vparam, void *wparam, int32_t qtype, void *rpar
   }
 
   int32_t code = vnodePerformFlowCtrl(pWrite);
-  if (code != 0) return 0;
+  if (code == TSDB_CODE_VND_ACTION_IN_PROGRESS) return 0;
+  if (code != 0) {
+    taosFreeQitem(pWrite);
+    vnodeRelease(pVnode);
+    return code;
+  }
 
   return vnodeWriteToWQueueImp(pWrite);
 }
@@ -377,32 +475,27 @@ void vnodeFreeFromWQueue(void *vparam, SVWriteMsg *pWrite) {
 static void vnodeFlowCtrlMsgToWQueue(void *param, void *tmrId) {
   SVWriteMsg *pWrite = param;
   SVnodeObj * pVnode = pWrite->pVnode;
-  int32_t     code = TSDB_CODE_VND_IS_SYNCING;
-
-  if (pVnode->flowctrlLevel <= 0) code = TSDB_CODE_VND_IS_FLOWCTRL;
 
   pWrite->processedCount++;
-  if (pWrite->processedCount >= 100) {
-    vError("vgId:%d, msg:%p, failed to process since %s, retry:%d", pVnode->vgId, pWrite, tstrerror(code),
+
+  // the vnode may be closing, let vnodeWriteToWQueueImp reject the msg
+  int32_t code = vnodeInReadyOrUpdatingStatus(pVnode) ? vnodePerformFlowCtrl(pWrite) : 0;
+  if (code == TSDB_CODE_VND_ACTION_IN_PROGRESS) return;
+
+  void *handle = pWrite->rpcMsg.handle;
+  if (code == 0) {
+    vDebug("vgId:%d, msg:%p, write into vwqueue after flowctrl, retry:%d", pVnode->vgId, pWrite,
            pWrite->processedCount);
-    void *handle = pWrite->rpcMsg.handle;
+    pWrite->processedCount = 0;
+    code = vnodeWriteToWQueueImp(pWrite);
+  } else {
     taosFreeQitem(pWrite);
     vnodeRelease(pVnode);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
     SRpcMsg rpcRsp = {.handle = handle, .code = code};
     rpcSendResponse(&rpcRsp);
-  } else {
-    code = vnodePerformFlowCtrl(pWrite);
-    if (code == 0) {
-      vDebug("vgId:%d, msg:%p, write into vwqueue after flowctrl, retry:%d", pVnode->vgId, pWrite,
-             pWrite->processedCount);
-      pWrite->processedCount = 0;
-      void *handle = pWrite->rpcMsg.handle;
-      code = vnodeWriteToWQueueImp(pWrite);
-      if (code != TSDB_CODE_SUCCESS) {
-        SRpcMsg rpcRsp = {.handle = handle, .code = code};
-        rpcSendResponse(&rpcRsp);
-      }
-    }
   }
 }
 
@@ -413,20 +506,40 @@ static int32_t vnodePerformFlowCtrl(SVWriteMsg *pWrite) {
       pVnode->flowctrlLevel <= 0)
     return 0;
 
+  int32_t code = 0;
+  if (tsEnableFlowCtrl != 0 && pWrite->processedCount >= MAX_FLOWCTRL_RETRY) {
+    code = pVnode->flowctrlLevel > 0 ? TSDB_CODE_VND_IS_SYNCING : TSDB_CODE_VND_IS_FLOWCTRL;
+  } else if (pWrite->processedCount >= MAX_FLOWCTRL_RETRY_HARD || pVnode->queuedWMsgSize >= MAX_QUEUED_MSG_SIZE_HARD) {
+    code = TSDB_CODE_VND_IS_FLOWCTRL;
+  }
+
+  if (code != 0) {
+    vError("vgId:%d, msg:%p, failed to process since %s, retry:%d queued:%d size:%" PRId64, pVnode->vgId, pWrite,
+           tstrerror(code), pWrite->processedCount, pVnode->queuedWMsg, pVnode->queuedWMsgSize);
+    atomic_add_fetch_64(&pVnode->flowctrlRejected, 1);
+    return code;
+  }
+
+  // The msg is put into the queue later by the timer instead of sleeping in the thread dispatching msgs of all
+  // vnodes. Without flowctrl, the msg is delayed as long as the sleep before, up to the hard limits above.
+  int32_t ms = 100;
   if (tsEnableFlowCtrl == 0) {
-    int32_t ms = (int32_t)pow(2, pVnode->flowctrlLevel + 2);
+    if (pVnode->flowctrlLevel > 0) {
+      ms = (int32_t)pow(2, pVnode->flowctrlLevel + 2);
+    } else {
+      ms = (pVnode->queuedWMsg / MAX_QUEUED_MSG_NUM) * 10 + 3;
+    }
     if (ms > 100) ms = 100;
-    vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl for %d ms", pVnode->vgId, pWrite, pWrite->rpcMsg.ahandle, ms);
-    taosMsleep(ms);
-    return 0;
-  } else {
-    void *unUsedTimerId = NULL;
-    taosTmrReset(vnodeFlowCtrlMsgToWQueue, 100, pWrite, tsDnodeTmr, &unUsedTimerId);
-
-    vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl, retry:%d", pVnode->vgId, pWrite, pWrite->rpcMsg.ahandle,
-           pWrite->processedCount);
-    return TSDB_CODE_VND_ACTION_IN_PROGRESS;
   }
+
+  if (pWrite->processedCount == 0) atomic_add_fetch_64(&pVnode->flowctrlMsgs, 1);
+
+  void *unUsedTimerId = NULL;
+  taosTmrReset(vnodeFlowCtrlMsgToWQueue, ms, pWrite, tsDnodeTmr, &unUsedTimerId);
+
+  vTrace("vgId:%d, msg:%p, app:%p, perform flowctrl for %d ms, retry:%d queued:%d size:%" PRId64, pVnode->vgId, pWrite,
+         pWrite->rpcMsg.ahandle, ms, pWrite->processedCount, pVnode->queuedWMsg, pVnode->queuedWMsgSize);
+  return TSDB_CODE_VND_ACTION_IN_PROGRESS;
 }
 
 void vnodeWaitWriteCompleted(SVnodeObj *pVnode) {
@@ -447,5 +560,13 @@ SVnodeStatisInfo vnodeGetStatisInfo() {
   info.submitRowNum = atomic_exchange_64(&tsSubmitRowNum, 0);
   info.submitRowSucNum = atomic_exchange_64(&tsSubmitRowSucNum, 0);
 
+  STsdbBlockCacheStat cacheStat = {0};
+  tsdbGetBlockCacheStat(&cacheStat);
+  info.blockCacheHits = cacheStat.hits;
+  info.blockCacheMisses = cacheStat.misses;
+  info.blockCacheEvictions = cacheStat.evictions;
+  info.blockCacheBytes = cacheStat.bytes;
+  info.blockCacheEntries = cacheStat.entries;
+
   return info;
 }
@@ -134,6 +134,16 @@ static int walValidateChecksum(SWalHead *pHead) {
 
 #endif
 
+static void walSignHead(SWalHead *pHead) {
+  pHead->signature = WAL_SIGNATURE;
+#if defined(WAL_CHECKSUM_WHOLE)
+  walUpdateChecksum(pHead);
+#else
+  pHead->sver = 0;
+  taosCalcChecksumAppend(0, (uint8_t *)pHead, sizeof(SWalHead));
+#endif
+}
+
 int32_t walWrite(void *handle, SWalHead *pHead) {
   if (handle == NULL) return -1;
 
@@ -145,13 +155,7 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
   if (pWal->level == TAOS_WAL_NOLOG) return 0;
   if (pHead->version <= pWal->version) return 0;
 
-  pHead->signature = WAL_SIGNATURE;
-#if defined(WAL_CHECKSUM_WHOLE)
-  walUpdateChecksum(pHead);
-#else
-  pHead->sver = 0;
-  taosCalcChecksumAppend(0, (uint8_t *)pHead, sizeof(SWalHead));
-#endif
+  walSignHead(pHead);
 
   int32_t contLen = pHead->len + sizeof(SWalHead);
 
@@ -173,6 +177,60 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
   return code;
 }
 
+// Write the records of a batch with one writev, in the same format as walWrite. The records are skipped as walWrite
+// does if their versions are not larger than the last version written. If it fails, none of the records is taken as
+// written, and a partially written record is dropped by walRestore like a torn write.
+int32_t walWriteBatch(void *handle, SWalHead **pHeads, int32_t numOfHeads) {
+  if (handle == NULL) return -1;
+
+  SWal *pWal = handle;
+
+  // no wal
+  if (!tfValid(pWal->tfd)) return 0;
+  if (pWal->level == TAOS_WAL_NOLOG) return 0;
+  if (numOfHeads <= 0) return 0;
+
+  struct iovec *iov = malloc(sizeof(struct iovec) * numOfHeads);
+  if (iov == NULL) {
+    wError("vgId:%d, file:%s, failed to write %d records since no enough memory", pWal->vgId, pWal->name, numOfHeads);
+    return TSDB_CODE_COM_OUT_OF_MEMORY;
+  }
+
+  int32_t  iovcnt = 0;
+  int64_t  contLen = 0;
+  uint64_t version = pWal->version;
+  for (int32_t i = 0; i < numOfHeads; ++i) {
+    SWalHead *pHead = pHeads[i];
+    if (pHead->version <= version) continue;
+
+    walSignHead(pHead);
+    iov[iovcnt].iov_base = pHead;
+    iov[iovcnt].iov_len = sizeof(SWalHead) + pHead->len;
+    contLen += iov[iovcnt].iov_len;
+    version = pHead->version;
+    iovcnt++;
+  }
+
+  int32_t code = 0;
+  if (iovcnt > 0) {
+    pthread_mutex_lock(&pWal->mutex);
+
+    if (tfWritev(pWal->tfd, iov, iovcnt) != contLen) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, file:%s, failed to write %d records since %s", pWal->vgId, pWal->name, iovcnt, strerror(errno));
+    } else {
+      wTrace("vgId:%d, write wal batch, fileId:%" PRId64 " tfd:%" PRId64 " records:%d len:%" PRId64 " hver:%" PRIu64
+             " wver:%" PRIu64, pWal->vgId, pWal->fileId, pWal->tfd, iovcnt, contLen, version, pWal->version);
+      pWal->version = version;
+    }
+
+    pthread_mutex_unlock(&pWal->mutex);
+  }
+
+  free(iov);
+  return code;
+}
+
 void walFsync(void *handle, bool forceFsync) {
   SWal *pWal = handle;
   if (pWal == NULL || !tfValid(pWal->tfd)) return;
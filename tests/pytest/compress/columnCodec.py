@@ -0,0 +1,123 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import glob
+import random
+import taos
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    # the first 4 rules are valid, the others are ignored
+    updatecfgDict = {'columnCodec': 'dbfast.st.*=fast,dbzlib.*.*=zlib,dbadapt.st.*=adaptive,*.nt.2=zlib9,'
+                                    'bad,st.x=fast,dbfast.st.2=zstd,x.y.st.2=fast'}
+
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.dbs = ["dbfast", "dbzlib", "dbadapt"]
+        self.tables = 5
+        self.rows = 4000
+        self.batch = 200
+        self.ts = 1600000000000
+
+    def getPath(self, pattern):
+        selfPath = os.path.dirname(os.path.realpath(__file__))
+        projPath = selfPath[:selfPath.find("tests")]
+        return glob.glob("%s/sim/dnode1/%s" % (projPath, pattern))
+
+    def countLog(self, msg):
+        with open(self.getPath("log/taosdlog.0")[0], errors="ignore") as f:
+            return f.read().count(msg)
+
+    # bytes of the data and last files of the database
+    def dataSize(self, db):
+        tdSql.query("show %s.vgroups" % db)
+        vgId = tdSql.getData(0, 0)
+        files = self.getPath("data/vnode/vnode%d/tsdb/data/*.data" % vgId)
+        files += self.getPath("data/vnode/vnode%d/tsdb/data/*.last" % vgId)
+        return sum(os.path.getsize(f) for f in files)
+
+    # text of a few words, compressed much better by zlib than by LZ4
+    def genRows(self):
+        random.seed(1)
+        words = ["w%d%s" % (i, "x" * (i % 7)) for i in range(300)]
+        rows = []
+        for t in range(self.tables):
+            rows.append([(self.ts + j * 1000, " ".join(random.choice(words) for k in range(8)), t * j)
+                         for j in range(self.rows)])
+        return rows
+
+    def queryAll(self, db):
+        result = []
+        for sql in ["select tbname, count(*), sum(c2), first(c1), last(c1) from %s.st group by tbname",
+                    "select * from %s.t1 limit 30 offset 1990",
+                    "select count(*), last(c1) from %s.st where c1 like 'w1x%%'",
+                    "select * from %s.nt"]:
+            tdSql.query(sql % db)
+            result.append(tdSql.queryResult)
+        return result
+
+    def run(self):
+        tdSql.prepare()
+        rows = self.genRows()
+        for db in self.dbs:
+            tdSql.execute("create database if not exists %s" % db)
+            tdSql.execute("create table %s.st (ts timestamp, c1 binary(100), c2 int) tags (t int)" % db)
+            tdSql.execute("create table %s.nt (ts timestamp, c1 binary(100), c2 int)" % db)
+            for t in range(self.tables):
+                tdSql.execute("create table %s.t%d using %s.st tags (%d)" % (db, t, db, t))
+                for i in range(0, self.rows, self.batch):
+                    tdSql.execute("insert into %s.t%d values %s" %
+                                  (db, t, " ".join("(%d, '%s', %d)" % r for r in rows[t][i:i + self.batch])))
+            tdSql.execute("insert into %s.nt values %s" %
+                          (db, " ".join("(%d, '%s', %d)" % r for r in rows[0][:self.batch])))
+        expected = self.queryAll(self.dbs[0])
+        tdSql.checkEqual(expected[0][1][1], self.rows)
+
+        tdLog.info("=============== step1: commit by the rules of the databases")
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        tdSql.checkEqual(self.countLog("4 column codec rules are set"), 1)
+        for rule in ["bad", "st.x=fast", "dbfast.st.2=zstd", "x.y.st.2=fast"]:
+            tdSql.checkEqual(self.countLog("invalid column codec rule %s is ignored" % rule), 1)
+        for db in self.dbs:
+            tdSql.checkEqual(self.queryAll(db), expected)
+
+        tdLog.info("=============== step2: the adaptive codec chooses zlib for the text")
+        sizes = {}
+        for db in self.dbs:
+            sizes[db] = self.dataSize(db)
+        tdLog.info("data file bytes: %s" % sizes)
+        tdSql.checkEqual(sizes["dbzlib"] < sizes["dbfast"] * 7 // 8, True)
+        tdSql.checkEqual(sizes["dbadapt"] < sizes["dbfast"] * 7 // 8, True)
+        tdSql.checkEqual(sizes["dbadapt"] <= sizes["dbzlib"] * 21 // 20, True)
+
+        tdLog.info("=============== step3: read the files written by the codecs after a restart")
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        for db in self.dbs:
+            tdSql.checkEqual(self.queryAll(db), expected)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
@@ -5,6 +5,7 @@ ulimit -c unlimited
 python3 test.py -f dbmgmt/nanoSecondCheck.py
 #
 python3 ./test.py -f tsdb/tsdbComp.py
+python3 ./test.py -f compress/columnCodec.py
 # user
 python3 ./test.py -f user/user_create.py
 python3 ./test.py -f user/pass_len.py
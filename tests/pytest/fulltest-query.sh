@@ -124,6 +124,7 @@ python3 ./test.py -f query/bug6586.py
 python3 test.py -f query/queryInterval.py
 python3 test.py -f query/queryFillTest.py
 python3 ./test.py -f query/last_cache.py
+python3 ./test.py -f query/lastCacheFile.py
 python3 ./test.py -f query/last_row_cache.py
 python3 ./test.py -f query/queryGroupbySort.py
 python3 ./test.py -f query/filterAllUnsignedIntTypes.py
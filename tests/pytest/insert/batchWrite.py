@@ -0,0 +1,101 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+import threading
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.numOfThreads = 8
+        self.numOfInserts = 200
+        self.ts = 1600000000000
+
+    # The writes of the threads reach the vnode at the same time, so the write queue takes several of them at once
+    # and writes their wal as a batch. Each thread writes rows of its own table, and overwrites the rows of a table
+    # shared by all the threads.
+    def insertData(self, threadId):
+        conn = taos.connect(host="127.0.0.1", user="root", password="taosdata", config=tdDnodes.getSimCfgPath())
+        cursor = conn.cursor()
+        for i in range(self.numOfInserts):
+            cursor.execute("insert into db.t%d values (%d, %d, %d) db.tshared values (%d, %d, %d)" %
+                           (threadId, self.ts + i, threadId, i, self.ts + i % 20, threadId, i))
+        cursor.close()
+        conn.close()
+
+    def queryAll(self):
+        result = []
+        tdSql.query("select tbname, count(*), sum(v) from db.st group by tbname")
+        result.append(sorted(tdSql.queryResult))
+        tdSql.query("select * from db.tshared")
+        result.append(tdSql.queryResult)
+        return result
+
+    def run(self):
+        tdSql.prepare()
+        tdSql.execute("create database if not exists db update 1")
+        tdSql.execute("create table db.st (ts timestamp, tid int, v int) tags (t int)")
+        for i in range(self.numOfThreads):
+            tdSql.execute("create table db.t%d using db.st tags (%d)" % (i, i))
+        tdSql.execute("create table db.tshared using db.st tags (-1)")
+
+        tdLog.info("=============== step1: insert by %d threads" % self.numOfThreads)
+        threads = []
+        for i in range(self.numOfThreads):
+            t = threading.Thread(target=self.insertData, args=(i, ))
+            threads.append(t)
+            t.start()
+        for t in threads:
+            t.join()
+
+        for i in range(self.numOfThreads):
+            tdSql.query("select count(*), sum(v) from db.t%d" % i)
+            tdSql.checkData(0, 0, self.numOfInserts)
+            tdSql.checkData(0, 1, self.numOfInserts * (self.numOfInserts - 1) // 2)
+
+        # a row of the shared table is the one of the last write applied
+        tdSql.query("select * from db.tshared")
+        tdSql.checkRows(20)
+        for r in range(20):
+            tdSql.checkEqual(tdSql.getData(r, 2) % 20, r)
+        before = self.queryAll()
+
+        tdLog.info("=============== step2: kill the dnode and restore the writes from the wal")
+        tdDnodes.forcestop(1)
+        tdDnodes.start(1)
+
+        after = self.queryAll()
+        tdSql.checkEqual(after, before)
+
+        tdLog.info("=============== step3: restart the dnode to commit the writes")
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+
+        after = self.queryAll()
+        tdSql.checkEqual(after, before)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
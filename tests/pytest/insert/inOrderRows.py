@@ -0,0 +1,105 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1600000000000
+        self.numOfRows = 10000
+        self.batch = 500
+
+    def rows(self, start, end):
+        return [(self.ts + i * 1000, i, i * 0.1 + 1 / 3.0) for i in range(start, end)]
+
+    def insertRows(self, table, rows):
+        for i in range(0, len(rows), self.batch):
+            tdSql.execute("insert into %s values %s" %
+                          (table, " ".join("(%d, %d, %.15f)" % r for r in rows[i:i + self.batch])))
+
+    def queryTable(self, table):
+        result = []
+        for sql in ["select count(*), sum(c1), avg(c2), first(c1), last(c1) from %s",
+                    "select count(*), avg(c2), max(c1) from %s where ts > %d and ts <= %d" %
+                    ("%s", self.ts + 1234 * 1000, self.ts + 8765 * 1000),
+                    "select avg(c2), count(*) from %s interval(17s)",
+                    "select * from %s order by ts desc limit 20 offset 4100",
+                    "select * from %s where ts >= %d limit 10" % ("%s", self.ts + 4090 * 1000)]:
+            tdSql.query(sql % table)
+            result.append(tdSql.queryResult)
+        return result
+
+    # The rows of db.tord are appended in order, the ones of db.tout are inserted in reversed batches so the skiplist
+    # is created by the second batch, and the ones of db.tdup in order with some rows written again, so the skiplist is
+    # created in the middle. All of them have the same rows in the end, which are read and committed in the same
+    # blocks, so even the sums of double are the same.
+    def checkAll(self, step):
+        tdLog.info("=============== %s" % step)
+        expected = self.queryTable("db.tord")
+        tdSql.checkEqual(expected[0][0][0], self.numOfRows)
+        tdSql.checkEqual(self.queryTable("db.tout"), expected)
+        tdSql.checkEqual(self.queryTable("db.tdup"), expected)
+
+    def run(self):
+        tdSql.prepare()
+        tdSql.execute("create database if not exists db update 1")
+        tdSql.execute("create table db.st (ts timestamp, c1 int, c2 double) tags (t int)")
+        tdSql.execute("create table db.tord using db.st tags (1)")
+        tdSql.execute("create table db.tout using db.st tags (2)")
+        tdSql.execute("create table db.tdup using db.st tags (3)")
+
+        rows = self.rows(0, self.numOfRows)
+        self.insertRows("db.tord", rows)
+
+        for i in range(self.numOfRows - self.batch, -1, -self.batch):
+            self.insertRows("db.tout", rows[i:i + self.batch])
+
+        self.insertRows("db.tdup", rows[:6000])
+        self.insertRows("db.tdup", [(ts, c1 + 1, c2 + 1) for ts, c1, c2 in rows[4000:4100]])
+        self.insertRows("db.tdup", rows[4000:])
+
+        self.checkAll("step1: query the rows in the memtable")
+
+        # more rows are appended after the rows in the memtable are queried
+        tdSql.query("select * from db.tord")
+        more = self.rows(self.numOfRows, self.numOfRows + 100)
+        for table in ["db.tord", "db.tout", "db.tdup"]:
+            self.insertRows(table, more)
+        tdSql.checkRows(self.numOfRows)
+        self.numOfRows += len(more)
+        self.checkAll("step2: query the rows appended")
+
+        tdDnodes.forcestop(1)
+        tdDnodes.start(1)
+        self.checkAll("step3: restore the rows from the wal")
+
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        self.checkAll("step4: query the rows committed")
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
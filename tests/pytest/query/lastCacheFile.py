@@ -0,0 +1,123 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import glob
+import time
+import taos
+from util.log import *
+from util.cases import *
+from util.sql import *
+from util.dnodes import *
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.tables = 10
+        self.rows = 100
+        self.ts = 1600000000000
+
+    def getPath(self, pattern):
+        selfPath = os.path.dirname(os.path.realpath(__file__))
+        projPath = selfPath[:selfPath.find("tests")]
+        paths = glob.glob("%s/sim/dnode1/%s" % (projPath, pattern))
+        if len(paths) == 0:
+            tdLog.exit("%s not found" % pattern)
+        return paths[0]
+
+    def countLog(self, msg):
+        with open(self.getPath("log/taosdlog.0"), errors="ignore") as f:
+            return f.read().count(msg)
+
+    def insertData(self, start):
+        for i in range(self.tables):
+            values = []
+            for j in range(start, start + self.rows):
+                # the last value of c2 is older than the last row
+                c2 = "null" if j % 3 == 0 else str(j * 0.5)
+                values.append("(%d, %d, %s, 'b%d')" % (self.ts + j * 1000, i * j, c2, j))
+            tdSql.execute("insert into db.t%d values %s" % (i, " ".join(values)))
+
+    def queryLast(self):
+        result = []
+        for sql in ["select last_row(*) from db.st group by tbname",
+                    "select last(*) from db.st group by tbname",
+                    "select last_row(*) from db.t3",
+                    "select last(c2) from db.t7"]:
+            tdSql.query(sql)
+            result.append(tdSql.queryResult)
+        return result
+
+    # restart the dnode and check the LAST cache is the same, restored from the file if fromFile
+    def restart(self, expected, fromFile):
+        restored = self.countLog("tables is restored from file")
+        tdDnodes.stop(1)
+        tdDnodes.start(1)
+        tdSql.checkEqual(self.queryLast(), expected)
+        tdSql.checkEqual(self.countLog("tables is restored from file") > restored, fromFile)
+
+    def run(self):
+        tdSql.prepare()
+        tdSql.execute("create database if not exists db cachelast 3")
+        tdSql.execute("create table db.st (ts timestamp, c1 int, c2 double, c3 binary(16)) tags (t int)")
+        for i in range(self.tables):
+            tdSql.execute("create table db.t%d using db.st tags (%d)" % (i, i))
+        self.insertData(0)
+        expected = self.queryLast()
+
+        tdLog.info("=============== step1: save the LAST cache at close and restore it at open")
+        self.restart(expected, True)
+        lastCacheFile = self.getPath("data/vnode/vnode*/tsdb/lastcache")
+
+        tdLog.info("=============== step2: the file of a crc mismatch is ignored and saved again at close")
+        tdDnodes.stop(1)
+        with open(lastCacheFile, "r+b") as f:
+            f.seek(40)
+            b = f.read(1)
+            f.seek(40)
+            f.write(bytes([b[0] ^ 0xff]))
+        corrupted = self.countLog("is ignored since it is corrupted")
+        tdDnodes.start(1)
+        tdSql.checkEqual(self.queryLast(), expected)
+        tdSql.checkEqual(self.countLog("is ignored since it is corrupted"), corrupted + 1)
+        self.restart(expected, True)
+
+        tdLog.info("=============== step3: the file is saved again at close after a compaction")
+        self.insertData(self.rows)
+        expected = self.queryLast()
+        self.restart(expected, True)
+
+        compacted = self.countLog("compact over, succeed")
+        tdSql.query("show vgroups")
+        tdSql.execute("compact vnodes in(%d)" % tdSql.getData(0, 0))
+        for i in range(60):
+            if self.countLog("compact over, succeed") > compacted:
+                break
+            time.sleep(1)
+        tdSql.checkEqual(self.countLog("compact over, succeed") > compacted, True)
+        tdSql.checkEqual(self.queryLast(), expected)
+
+        outdated = self.countLog("is outdated")
+        self.restart(expected, True)
+        tdSql.checkEqual(self.countLog("is outdated"), outdated)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())